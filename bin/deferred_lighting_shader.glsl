@@ -0,0 +1,171 @@
+#version 330 core
+
+// lighting pass of the deferred renderer, same lights and falloff as fragment_shader.glsl
+
+out vec4 frag_color;
+
+uniform sampler2D gbuffer_albedo;
+uniform sampler2D gbuffer_normal;
+uniform sampler2D gbuffer_depth;
+uniform sampler2D gbuffer_baked;
+
+layout (std140) uniform frame_block {
+   mat4 view;
+   mat4 projection;
+   mat4 view_proj;
+   mat4 inv_view_proj;
+   vec4 camera_pos;
+   vec4 time;
+   ivec4 light_count;
+   vec4 light_pos[8];
+   vec4 light_color[8];
+   vec4 cluster_params;
+   ivec4 cluster_size;
+   mat4 shadow_view_proj[4];
+   vec4 shadow_splits;
+   vec4 shadow_texel;
+   vec4 sun_direction;
+   vec4 sun_color;
+   vec4 probe_origin;
+   vec4 probe_size;
+};
+
+uniform samplerBuffer light_data;
+uniform usamplerBuffer cluster_grid;
+uniform usamplerBuffer light_indices;
+
+// directional sun, one depth layer per cascade
+
+uniform sampler2DArrayShadow shadow_map;
+
+// point light cube faces packed into one atlas, point_shadow_data holds each shadowing light's tile origins
+
+uniform sampler2DShadow point_shadow_atlas;
+uniform samplerBuffer point_shadow_data;
+
+// cascade picked by view depth, the lookup is pushed off the surface along the normal by a couple of that
+// cascade's texels so flat ground does not shadow itself. four hardware 2x2 pcf taps soften the edge
+
+float sun_shadow(vec3 position, vec3 normal, float view_depth)
+{
+   if(view_depth >= shadow_splits.w) return 1.0;
+
+   int cascade = view_depth < shadow_splits.x ? 0 : view_depth < shadow_splits.y ? 1 : view_depth < shadow_splits.z ? 2 : 3;
+
+   vec4 coord = shadow_view_proj[cascade] * vec4(position + normal * shadow_texel[cascade] * 2.0, 1.0);
+   coord.xyz = coord.xyz * 0.5 + 0.5;
+
+   vec2 texel = 1.0 / vec2(textureSize(shadow_map, 0).xy);
+   float lit = 0.0;
+
+   lit += texture(shadow_map, vec4(coord.xy + vec2(-0.5, -0.5) * texel, float(cascade), coord.z));
+   lit += texture(shadow_map, vec4(coord.xy + vec2(0.5, -0.5) * texel, float(cascade), coord.z));
+   lit += texture(shadow_map, vec4(coord.xy + vec2(-0.5, 0.5) * texel, float(cascade), coord.z));
+   lit += texture(shadow_map, vec4(coord.xy + vec2(0.5, 0.5) * texel, float(cascade), coord.z));
+
+   return lit * 0.25;
+}
+
+// cube face from the major axis of the light to surface vector, faces are laid out and oriented exactly as
+// rhino_point_shadows.c renders them. depth is rebuilt from the face's perspective projection
+
+const vec3 face_forward[6] = vec3[6](vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0));
+const vec3 face_up[6] = vec3[6](vec3(0.0, 1.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, -1.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 1.0, 0.0));
+
+float point_shadow(int slot, vec3 light_position, vec3 position, vec3 normal)
+{
+   // tile size in uv, near, far and tile size in texels
+
+   vec4 params = texelFetch(point_shadow_data, slot * 4 + 3);
+
+   // normal offset by about a texel and a half at this distance, a 90 degree face spans twice the distance
+
+   vec3 to_surface = position - light_position;
+   to_surface += normal * (3.0 * length(to_surface) / params.w);
+
+   vec3 axis = abs(to_surface);
+   int face = axis.x >= axis.y && axis.x >= axis.z ? (to_surface.x > 0.0 ? 0 : 1) : axis.y >= axis.z ? (to_surface.y > 0.0 ? 2 : 3) : (to_surface.z > 0.0 ? 4 : 5);
+
+   vec3 forward = face_forward[face];
+   vec3 up = face_up[face];
+   float face_depth = dot(to_surface, forward);
+   vec2 ndc = vec2(dot(to_surface, cross(forward, up)), dot(to_surface, up)) / face_depth;
+
+   float near_plane = params.y, far_plane = params.z;
+   float depth = ((far_plane + near_plane) / (far_plane - near_plane) - 2.0 * far_plane * near_plane / ((far_plane - near_plane) * face_depth)) * 0.5 + 0.5;
+
+   // stay half a texel inside the tile so filtering never reads a neighbouring light
+
+   vec4 origins = texelFetch(point_shadow_data, slot * 4 + face / 2);
+   vec2 origin = face % 2 == 0 ? origins.xy : origins.zw;
+   vec2 tile_uv = clamp(ndc * 0.5 + 0.5, vec2(0.5 / params.w), vec2(1.0 - 0.5 / params.w));
+
+   return texture(point_shadow_atlas, vec3(origin + tile_uv * params.x, depth));
+}
+
+vec3 octahedral_decode(vec2 e)
+{
+   vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+   float t = clamp(-n.z, 0.0, 1.0);
+   n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+   return normalize(n);
+}
+
+void main()
+{
+   ivec2 pixel = ivec2(gl_FragCoord.xy);
+   float depth = texelFetch(gbuffer_depth, pixel, 0).r;
+
+   // nothing was drawn here, keep the clear colour
+
+   if(depth == 1.0) discard;
+
+   vec2 screen_uv = (vec2(pixel) + 0.5) / vec2(textureSize(gbuffer_depth, 0));
+   vec4 worldpos = inv_view_proj * vec4(vec3(screen_uv, depth) * 2.0 - 1.0, 1.0);
+   worldpos /= worldpos.w;
+
+   vec3 albedo = texelFetch(gbuffer_albedo, pixel, 0).rgb;
+   vec3 normal = octahedral_decode(texelFetch(gbuffer_normal, pixel, 0).xy);
+   vec4 baked = texelFetch(gbuffer_baked, pixel, 0);
+
+   vec3 light = vec3(0.0);
+
+   for(int i = 0; i < light_count.x; i++) {
+      float dist = clamp(distance(light_pos[i].xyz, worldpos.xyz) * 0.6, 0, 4);
+      light += light_color[i].rgb / dist;
+   }
+
+   // screen tile and depth slice pick the cluster, its light list was built on the cpu this frame
+
+   float view_depth = -(view * worldpos).z;
+   int slice = clamp(int(log(view_depth) * cluster_params.x - cluster_params.y), 0, cluster_size.z - 1);
+   ivec2 tile = clamp(ivec2(gl_FragCoord.xy / cluster_params.zw), ivec2(0), cluster_size.xy - 1);
+   uvec2 range = texelFetch(cluster_grid, tile.x + cluster_size.x * (tile.y + cluster_size.y * slice)).xy;
+
+   // sun, shadowed through the cascades, or already in the lightmap together with the sky and bounce light. baked
+   // light with alpha 0 is probe light, which comes on top of the sun
+
+   light += baked.rgb;
+   if(baked.a == 0.0) light += sun_color.rgb * max(dot(normal, -sun_direction.xyz), 0.0) * sun_shadow(worldpos.xyz, normal, view_depth);
+
+   for(uint i = 0u; i < range.y; i++) {
+      int index = int(texelFetch(light_indices, int(range.x + i)).x);
+      vec4 position_radius = texelFetch(light_data, index * 2);
+      vec4 color_shadow = texelFetch(light_data, index * 2 + 1);
+      vec3 color = color_shadow.rgb;
+
+      float dist = distance(position_radius.xyz, worldpos.xyz);
+      float window = clamp(1.0 - pow(dist / position_radius.w, 4.0), 0.0, 1.0);
+      vec3 to_light = (position_radius.xyz - worldpos.xyz) / max(dist, 0.0001);
+
+      float lit = max(dot(normal, to_light), 0.0) * window;
+
+      // w of the colour texel is the light's shadow slot, negative when it has none
+
+      if(lit > 0.0 && color_shadow.a >= 0.0) lit *= point_shadow(int(color_shadow.a), position_radius.xyz, worldpos.xyz, normal);
+
+      light += color * lit * window / (1.0 + dist * dist);
+   }
+
+   frag_color = vec4(albedo * light, 1.0);
+}
\ No newline at end of file
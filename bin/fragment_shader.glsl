@@ -2,16 +2,214 @@
 
 in vec2 uv_coord;
 in vec4 worldpos;
+in vec2 lightmap_uv;
 
 out vec4 frag_color;
 
 uniform sampler2D texture_sample1;
-uniform vec4 light_pos;
-uniform float texture_scale;
+
+// sun, sky and bounce light baked by rhino_lightbake, only read by objects with a lightmap rect
+
+uniform sampler2D lightmap;
+
+// seven rgba slabs of l2 sh irradiance coefficients over the probe grid, read by objects without a lightmap
+
+uniform sampler3D probe_grid;
+
+layout (std140) uniform frame_block {
+   mat4 view;
+   mat4 projection;
+   mat4 view_proj;
+   mat4 inv_view_proj;
+   vec4 camera_pos;
+   vec4 time;
+   ivec4 light_count;
+   vec4 light_pos[8];
+   vec4 light_color[8];
+   vec4 cluster_params;
+   ivec4 cluster_size;
+   mat4 shadow_view_proj[4];
+   vec4 shadow_splits;
+   vec4 shadow_texel;
+   vec4 sun_direction;
+   vec4 sun_color;
+   vec4 probe_origin;
+   vec4 probe_size;
+};
+
+// object_params x is the texture scale, y the lod cross-fade (0 draws everything, > 0 keeps dither cells below the
+// value, < 0 keeps the complementary cells)
+
+layout (std140) uniform object_block {
+   mat4 model;
+   vec4 object_params;
+   vec4 object_lightmap;
+};
+
+// clustered point lights, cluster_grid holds (offset, count) into light_indices per cluster and light_data two
+// texels per light (position and radius, colour)
+
+uniform samplerBuffer light_data;
+uniform usamplerBuffer cluster_grid;
+uniform usamplerBuffer light_indices;
+
+// directional sun, one depth layer per cascade
+
+uniform sampler2DArrayShadow shadow_map;
+
+// point light cube faces packed into one atlas, point_shadow_data holds each shadowing light's tile origins
+
+uniform sampler2DShadow point_shadow_atlas;
+uniform samplerBuffer point_shadow_data;
+
+// cascade picked by view depth, the lookup is pushed off the surface along the normal by a couple of that
+// cascade's texels so flat ground does not shadow itself. four hardware 2x2 pcf taps soften the edge
+
+float sun_shadow(vec3 position, vec3 normal, float view_depth)
+{
+   if(view_depth >= shadow_splits.w) return 1.0;
+
+   int cascade = view_depth < shadow_splits.x ? 0 : view_depth < shadow_splits.y ? 1 : view_depth < shadow_splits.z ? 2 : 3;
+
+   vec4 coord = shadow_view_proj[cascade] * vec4(position + normal * shadow_texel[cascade] * 2.0, 1.0);
+   coord.xyz = coord.xyz * 0.5 + 0.5;
+
+   vec2 texel = 1.0 / vec2(textureSize(shadow_map, 0).xy);
+   float lit = 0.0;
+
+   lit += texture(shadow_map, vec4(coord.xy + vec2(-0.5, -0.5) * texel, float(cascade), coord.z));
+   lit += texture(shadow_map, vec4(coord.xy + vec2(0.5, -0.5) * texel, float(cascade), coord.z));
+   lit += texture(shadow_map, vec4(coord.xy + vec2(-0.5, 0.5) * texel, float(cascade), coord.z));
+   lit += texture(shadow_map, vec4(coord.xy + vec2(0.5, 0.5) * texel, float(cascade), coord.z));
+
+   return lit * 0.25;
+}
+
+// cube face from the major axis of the light to surface vector, faces are laid out and oriented exactly as
+// rhino_point_shadows.c renders them. depth is rebuilt from the face's perspective projection
+
+const vec3 face_forward[6] = vec3[6](vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0));
+const vec3 face_up[6] = vec3[6](vec3(0.0, 1.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, -1.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 1.0, 0.0));
+
+float point_shadow(int slot, vec3 light_position, vec3 position, vec3 normal)
+{
+   // tile size in uv, near, far and tile size in texels
+
+   vec4 params = texelFetch(point_shadow_data, slot * 4 + 3);
+
+   // normal offset by about a texel and a half at this distance, a 90 degree face spans twice the distance
+
+   vec3 to_surface = position - light_position;
+   to_surface += normal * (3.0 * length(to_surface) / params.w);
+
+   vec3 axis = abs(to_surface);
+   int face = axis.x >= axis.y && axis.x >= axis.z ? (to_surface.x > 0.0 ? 0 : 1) : axis.y >= axis.z ? (to_surface.y > 0.0 ? 2 : 3) : (to_surface.z > 0.0 ? 4 : 5);
+
+   vec3 forward = face_forward[face];
+   vec3 up = face_up[face];
+   float face_depth = dot(to_surface, forward);
+   vec2 ndc = vec2(dot(to_surface, cross(forward, up)), dot(to_surface, up)) / face_depth;
+
+   float near_plane = params.y, far_plane = params.z;
+   float depth = ((far_plane + near_plane) / (far_plane - near_plane) - 2.0 * far_plane * near_plane / ((far_plane - near_plane) * face_depth)) * 0.5 + 0.5;
+
+   // stay half a texel inside the tile so filtering never reads a neighbouring light
+
+   vec4 origins = texelFetch(point_shadow_data, slot * 4 + face / 2);
+   vec2 origin = face % 2 == 0 ? origins.xy : origins.zw;
+   vec2 tile_uv = clamp(ndc * 0.5 + 0.5, vec2(0.5 / params.w), vec2(1.0 - 0.5 / params.w));
+
+   return texture(point_shadow_atlas, vec3(origin + tile_uv * params.x, depth));
+}
+
+// l2 sh irradiance from the probe grid, the coefficients come premultiplied so only the polynomial is left. the
+// coordinate is clamped between the outer probes, so positions outside the grid read the nearest ones and the
+// filtering never leaves a coefficient's slab
+
+vec3 probe_irradiance(vec3 position, vec3 n)
+{
+   vec3 size = probe_size.xyz;
+   vec3 cell = clamp((position - probe_origin.xyz) / probe_origin.w, vec3(0.0), size - 1.0) + 0.5;
+   vec3 coord = vec3(cell.x / (size.x * 7.0), cell.y / size.y, cell.z / size.z);
+   vec3 slab = vec3(1.0 / 7.0, 0.0, 0.0);
+
+   vec4 t0 = texture(probe_grid, coord);
+   vec4 t1 = texture(probe_grid, coord + slab);
+   vec4 t2 = texture(probe_grid, coord + slab * 2.0);
+   vec4 t3 = texture(probe_grid, coord + slab * 3.0);
+   vec4 t4 = texture(probe_grid, coord + slab * 4.0);
+   vec4 t5 = texture(probe_grid, coord + slab * 5.0);
+   vec4 t6 = texture(probe_grid, coord + slab * 6.0);
+
+   vec3 irradiance = t0.xyz
+      + vec3(t0.w, t1.xy) * n.y + vec3(t1.zw, t2.x) * n.z + t2.yzw * n.x
+      + t3.xyz * (n.x * n.y) + vec3(t3.w, t4.xy) * (n.y * n.z) + vec3(t4.zw, t5.x) * (3.0 * n.z * n.z - 1.0)
+      + t5.yzw * (n.x * n.z) + t6.xyz * (n.x * n.x - n.y * n.y);
+
+   return max(irradiance, vec3(0.0));
+}
+
+const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
 
 void main()
 {
+   float lod_fade = object_params.y;
+
+   if(lod_fade != 0.0) {
+      ivec2 cell = ivec2(gl_FragCoord.xy) & 3;
+      float threshold = (bayer[cell.y * 4 + cell.x] + 0.5) / 16.0;
+      if(lod_fade > 0.0 ? threshold >= lod_fade : threshold < -lod_fade) discard;
+   }
+
    // OLD : frag_color = vec4(col.xyz, 1.0f);
-   float dist = clamp(abs(distance(light_pos, worldpos)) * 0.6, 0, 4);
-   frag_color = texture(texture_sample1, uv_coord * texture_scale) / dist;
+   vec3 light = vec3(0.0);
+
+   // flat normal from screen space derivatives, always faces the camera
+   vec3 normal = normalize(cross(dFdx(worldpos.xyz), dFdy(worldpos.xyz)));
+
+   for(int i = 0; i < light_count.x; i++) {
+      float dist = clamp(distance(light_pos[i].xyz, worldpos.xyz) * 0.6, 0, 4);
+      light += light_color[i].rgb / dist;
+   }
+
+   // only the lights binned into this fragment's cluster, slices are spaced exponentially in view depth
+
+   float depth = -(view * worldpos).z;
+   int slice = clamp(int(log(depth) * cluster_params.x - cluster_params.y), 0, cluster_size.z - 1);
+   ivec2 tile = clamp(ivec2(gl_FragCoord.xy / cluster_params.zw), ivec2(0), cluster_size.xy - 1);
+   uvec2 range = texelFetch(cluster_grid, tile.x + cluster_size.x * (tile.y + cluster_size.y * slice)).xy;
+
+   // sun, shadowed through the cascades, or already in the lightmap together with the sky and bounce light. without
+   // a lightmap the sky and bounce light can come from the probe grid instead
+
+   if(object_lightmap.x > 0.0) light += texture(lightmap, lightmap_uv).rgb;
+   else {
+      light += sun_color.rgb * max(dot(normal, -sun_direction.xyz), 0.0) * sun_shadow(worldpos.xyz, normal, depth);
+      if(object_lightmap.w > 0.0 && probe_size.w > 0.0) light += probe_irradiance(worldpos.xyz, normal);
+   }
+
+   for(uint i = 0u; i < range.y; i++) {
+      int index = int(texelFetch(light_indices, int(range.x + i)).x);
+      vec4 position_radius = texelFetch(light_data, index * 2);
+      vec4 color_shadow = texelFetch(light_data, index * 2 + 1);
+      vec3 color = color_shadow.rgb;
+
+      // inverse square with a smooth window so the light reaches exactly zero at its radius
+
+      float dist = distance(position_radius.xyz, worldpos.xyz);
+      float window = clamp(1.0 - pow(dist / position_radius.w, 4.0), 0.0, 1.0);
+
+      vec3 to_light = (position_radius.xyz - worldpos.xyz) / max(dist, 0.0001);
+
+      float lit = max(dot(normal, to_light), 0.0) * window;
+
+      // w of the colour texel is the light's shadow slot, negative when it has none
+
+      if(lit > 0.0 && color_shadow.a >= 0.0) lit *= point_shadow(int(color_shadow.a), position_radius.xyz, worldpos.xyz, normal);
+
+      light += color * lit * window / (1.0 + dist * dist);
+   }
+
+   vec4 albedo = texture(texture_sample1, uv_coord * object_params.x);
+   frag_color = vec4(albedo.rgb * light, albedo.a);
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#version 330 core
+
+// geometry pass of the deferred renderer, albedo, an octahedral normal and baked light (alpha 1 where there is a
+// lightmap and the sun is already in it, 0 where it is only probe light). position is rebuilt from depth later
+
+in vec2 uv_coord;
+in vec4 worldpos;
+in vec2 lightmap_uv;
+
+layout (location = 0) out vec4 gbuffer_albedo;
+layout (location = 1) out vec2 gbuffer_normal;
+layout (location = 2) out vec4 gbuffer_baked;
+
+uniform sampler2D texture_sample1;
+uniform sampler2D lightmap;
+
+// seven rgba slabs of l2 sh irradiance coefficients over the probe grid, read by objects without a lightmap
+
+uniform sampler3D probe_grid;
+
+layout (std140) uniform frame_block {
+   mat4 view;
+   mat4 projection;
+   mat4 view_proj;
+   mat4 inv_view_proj;
+   vec4 camera_pos;
+   vec4 time;
+   ivec4 light_count;
+   vec4 light_pos[8];
+   vec4 light_color[8];
+   vec4 cluster_params;
+   ivec4 cluster_size;
+   mat4 shadow_view_proj[4];
+   vec4 shadow_splits;
+   vec4 shadow_texel;
+   vec4 sun_direction;
+   vec4 sun_color;
+   vec4 probe_origin;
+   vec4 probe_size;
+};
+
+layout (std140) uniform object_block {
+   mat4 model;
+   vec4 object_params;
+   vec4 object_lightmap;
+};
+
+// l2 sh irradiance from the probe grid, the coefficients come premultiplied so only the polynomial is left. the
+// coordinate is clamped between the outer probes, so positions outside the grid read the nearest ones and the
+// filtering never leaves a coefficient's slab
+
+vec3 probe_irradiance(vec3 position, vec3 n)
+{
+   vec3 size = probe_size.xyz;
+   vec3 cell = clamp((position - probe_origin.xyz) / probe_origin.w, vec3(0.0), size - 1.0) + 0.5;
+   vec3 coord = vec3(cell.x / (size.x * 7.0), cell.y / size.y, cell.z / size.z);
+   vec3 slab = vec3(1.0 / 7.0, 0.0, 0.0);
+
+   vec4 t0 = texture(probe_grid, coord);
+   vec4 t1 = texture(probe_grid, coord + slab);
+   vec4 t2 = texture(probe_grid, coord + slab * 2.0);
+   vec4 t3 = texture(probe_grid, coord + slab * 3.0);
+   vec4 t4 = texture(probe_grid, coord + slab * 4.0);
+   vec4 t5 = texture(probe_grid, coord + slab * 5.0);
+   vec4 t6 = texture(probe_grid, coord + slab * 6.0);
+
+   vec3 irradiance = t0.xyz
+      + vec3(t0.w, t1.xy) * n.y + vec3(t1.zw, t2.x) * n.z + t2.yzw * n.x
+      + t3.xyz * (n.x * n.y) + vec3(t3.w, t4.xy) * (n.y * n.z) + vec3(t4.zw, t5.x) * (3.0 * n.z * n.z - 1.0)
+      + t5.yzw * (n.x * n.z) + t6.xyz * (n.x * n.x - n.y * n.y);
+
+   return max(irradiance, vec3(0.0));
+}
+
+const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+
+// unit vector onto the octahedron, lower half folded over the diagonals so it fits in two channels
+
+vec2 octahedral_encode(vec3 n)
+{
+   n /= abs(n.x) + abs(n.y) + abs(n.z);
+   vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+   return n.z >= 0.0 ? n.xy : folded;
+}
+
+void main()
+{
+   float lod_fade = object_params.y;
+
+   if(lod_fade != 0.0) {
+      ivec2 cell = ivec2(gl_FragCoord.xy) & 3;
+      float threshold = (bayer[cell.y * 4 + cell.x] + 0.5) / 16.0;
+      if(lod_fade > 0.0 ? threshold >= lod_fade : threshold < -lod_fade) discard;
+   }
+
+   vec3 normal = normalize(cross(dFdx(worldpos.xyz), dFdy(worldpos.xyz)));
+
+   gbuffer_albedo = vec4(texture(texture_sample1, uv_coord * object_params.x).rgb, 1.0);
+   gbuffer_normal = octahedral_encode(normal);
+   gbuffer_baked = vec4(0.0);
+
+   if(object_lightmap.x > 0.0) gbuffer_baked = vec4(texture(lightmap, lightmap_uv).rgb, 1.0);
+   else if(object_lightmap.w > 0.0 && probe_size.w > 0.0) gbuffer_baked.rgb = probe_irradiance(worldpos.xyz, normal);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#version 330 core
+
+// puts the post effects back over the full resolution scene. occlusion and fog are brought up with a bilateral
+// upsample, each of the four low resolution texels around a pixel weighted by its bilinear weight and by how well
+// its depth matches the pixel's, so edges stay sharp. bloom is meant to spread and is just filtered
+
+out vec4 frag_color;
+
+uniform sampler2D scene_color;
+uniform sampler2D scene_depth;
+uniform sampler2D ssao;
+uniform sampler2D ssao_depth;
+uniform sampler2D fog;
+uniform sampler2D fog_depth;
+uniform sampler2D bloom;
+
+// bloom, occlusion and fog switched on, then bloom intensity and occlusion strength
+
+uniform ivec4 effects;
+uniform vec4 post_params;
+
+layout (std140) uniform frame_block {
+   mat4 view;
+   mat4 projection;
+   mat4 view_proj;
+   mat4 inv_view_proj;
+   vec4 camera_pos;
+   vec4 time;
+   ivec4 light_count;
+   vec4 light_pos[8];
+   vec4 light_color[8];
+   vec4 cluster_params;
+   ivec4 cluster_size;
+   mat4 shadow_view_proj[4];
+   vec4 shadow_splits;
+   vec4 shadow_texel;
+   vec4 sun_direction;
+   vec4 sun_color;
+   vec4 probe_origin;
+   vec4 probe_size;
+};
+
+float linear_depth(float depth)
+{
+   return projection[3][2] / (depth * 2.0 - 1.0 + projection[2][2]);
+}
+
+vec4 bilateral_upsample(sampler2D source, sampler2D source_depth, float depth)
+{
+   vec2 size = vec2(textureSize(source_depth, 0));
+   vec2 position = gl_FragCoord.xy * size / vec2(textureSize(scene_depth, 0)) - 0.5;
+   ivec2 base = ivec2(floor(position));
+   vec2 f = fract(position);
+   ivec2 limit = ivec2(size) - 1;
+
+   vec4 sum = vec4(0.0);
+   float total = 0.0;
+
+   vec4 nearest = vec4(0.0);
+   float nearest_difference = 1e30;
+
+   for(int i = 0; i < 4; i++) {
+      ivec2 offset = ivec2(i & 1, i >> 1);
+      ivec2 tap = clamp(base + offset, ivec2(0), limit);
+
+      float bilinear = (offset.x == 1 ? f.x : 1.0 - f.x) * (offset.y == 1 ? f.y : 1.0 - f.y);
+      float difference = abs(texelFetch(source_depth, tap, 0).r - depth);
+      float weight = bilinear * exp(-difference / (depth * 0.02 + 0.001));
+
+      vec4 value = texelFetch(source, tap, 0);
+
+      sum += value * weight;
+      total += weight;
+
+      if(difference < nearest_difference) {
+         nearest_difference = difference;
+         nearest = value;
+      }
+   }
+
+   // nothing around matches, a surface thinner than a low resolution texel, take the closest in depth
+
+   return total > 0.0001 ? sum / total : nearest;
+}
+
+void main()
+{
+   ivec2 pixel = ivec2(gl_FragCoord.xy);
+   vec3 color = texelFetch(scene_color, pixel, 0).rgb;
+   float depth = linear_depth(texelFetch(scene_depth, pixel, 0).r);
+
+   if(effects.y != 0) color *= mix(1.0, bilateral_upsample(ssao, ssao_depth, depth).r, post_params.y);
+
+   if(effects.z != 0) {
+      vec4 scattering = bilateral_upsample(fog, fog_depth, depth);
+      color = color * scattering.a + scattering.rgb;
+   }
+
+   if(effects.x != 0) color += texture(bloom, gl_FragCoord.xy / vec2(textureSize(scene_color, 0))).rgb * post_params.x;
+
+   frag_color = vec4(color, 1.0);
+}
@@ -0,0 +1,102 @@
+#version 330 core
+
+// height fog marched from the camera to the surface, in-scattering sky light everywhere and sun light wherever the
+// cascades see the sun, so shadowed regions cut shafts through it. rgb is the light scattered in, alpha what is
+// left of the surface behind
+
+out vec4 frag_color;
+
+uniform sampler2D linear_depth;
+uniform sampler2DArrayShadow shadow_map;
+
+// density at the base height, how fast it falls off above it, the base height and the distance the sky is taken at
+
+uniform vec4 fog_params;
+uniform vec3 fog_color;
+
+layout (std140) uniform frame_block {
+   mat4 view;
+   mat4 projection;
+   mat4 view_proj;
+   mat4 inv_view_proj;
+   vec4 camera_pos;
+   vec4 time;
+   ivec4 light_count;
+   vec4 light_pos[8];
+   vec4 light_color[8];
+   vec4 cluster_params;
+   ivec4 cluster_size;
+   mat4 shadow_view_proj[4];
+   vec4 shadow_splits;
+   vec4 shadow_texel;
+   vec4 sun_direction;
+   vec4 sun_color;
+   vec4 probe_origin;
+   vec4 probe_size;
+};
+
+#define STEPS 16
+
+// henyey-greenstein scaled so isotropic scattering would be 1
+
+const float anisotropy = 0.6;
+
+float interleaved_gradient_noise(vec2 position)
+{
+   return fract(52.9829189 * fract(dot(position, vec2(0.06711056, 0.00583715))));
+}
+
+float sun_visibility(vec3 position, float view_depth)
+{
+   if(view_depth >= shadow_splits.w) return 1.0;
+
+   int cascade = view_depth < shadow_splits.x ? 0 : view_depth < shadow_splits.y ? 1 : view_depth < shadow_splits.z ? 2 : 3;
+
+   vec4 coord = shadow_view_proj[cascade] * vec4(position, 1.0);
+   coord.xyz = coord.xyz * 0.5 + 0.5;
+
+   return texture(shadow_map, vec4(coord.xy, float(cascade), coord.z));
+}
+
+void main()
+{
+   vec2 size = vec2(textureSize(linear_depth, 0));
+   vec2 ndc = gl_FragCoord.xy / size * 2.0 - 1.0;
+
+   float far_plane = projection[3][2] / (projection[2][2] + 1.0);
+   float depth = texelFetch(linear_depth, ivec2(gl_FragCoord.xy), 0).r;
+
+   vec4 far_point = inv_view_proj * vec4(ndc, 1.0, 1.0);
+   vec3 ray = normalize(far_point.xyz / far_point.w - camera_pos.xyz);
+   vec3 forward = -vec3(view[0][2], view[1][2], view[2][2]);
+   float depth_per_distance = dot(ray, forward);
+
+   // sky pixels march out to the fog distance, everything else stops at its surface
+
+   float march_distance = depth > far_plane * 0.99 ? fog_params.w : min(depth / depth_per_distance, fog_params.w);
+   float step_length = march_distance / float(STEPS);
+   float offset = interleaved_gradient_noise(gl_FragCoord.xy);
+
+   float cosine = dot(ray, -sun_direction.xyz);
+   float phase = (1.0 - anisotropy * anisotropy) / pow(1.0 + anisotropy * anisotropy - 2.0 * anisotropy * cosine, 1.5);
+
+   vec3 scattered = vec3(0.0);
+   float transmittance = 1.0;
+
+   for(int i = 0; i < STEPS; i++) {
+      float t = (float(i) + offset) * step_length;
+      vec3 position = camera_pos.xyz + ray * t;
+
+      float density = fog_params.x * exp(-max(position.y - fog_params.z, 0.0) * fog_params.y);
+      float extinction = exp(-density * step_length);
+
+      vec3 light = fog_color + sun_color.rgb * sun_visibility(position, t * depth_per_distance) * phase;
+
+      // light scattered in over the step, integrated exactly for constant density
+
+      scattered += transmittance * light * (1.0 - extinction);
+      transmittance *= extinction;
+   }
+
+   frag_color = vec4(scattered, transmittance);
+}
@@ -0,0 +1,7 @@
+#version 330 core
+
+// depth only, shadow cascades need nothing but the rasterised depth
+
+void main()
+{
+}
\ No newline at end of file
@@ -2,18 +2,52 @@
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aUv;
+layout (location = 2) in vec2 aLightmapUv;
 
 out vec2 uv_coord;
 out vec4 worldpos;
+out vec2 lightmap_uv;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// shared by every program, see rhino_uniforms.h for the matching c structs
+
+layout (std140) uniform frame_block {
+   mat4 view;
+   mat4 projection;
+   mat4 view_proj;
+   mat4 inv_view_proj;
+   vec4 camera_pos;
+   vec4 time;
+   ivec4 light_count;
+   vec4 light_pos[8];
+   vec4 light_color[8];
+   vec4 cluster_params;
+   ivec4 cluster_size;
+   mat4 shadow_view_proj[4];
+   vec4 shadow_splits;
+   vec4 shadow_texel;
+   vec4 sun_direction;
+   vec4 sun_color;
+   vec4 probe_origin;
+   vec4 probe_size;
+};
+
+layout (std140) uniform object_block {
+   mat4 model;
+   vec4 object_params;
+   vec4 object_lightmap;
+};
+
+// 0 draws the camera view, n draws into shadow cascade n - 1 and -1 into a point light cube face with
+// point_view_proj
+
+uniform int shadow_layer;
+uniform mat4 point_view_proj;
 
 void main()
 {
    vec4 world_pos = model * vec4(aPos, 1.0);
    uv_coord = aUv;
+   lightmap_uv = aLightmapUv * object_lightmap.xy + object_lightmap.zw;
    worldpos = world_pos;
-   gl_Position = projection * view * world_pos;
+   gl_Position = (shadow_layer > 0 ? shadow_view_proj[shadow_layer - 1] : shadow_layer < 0 ? point_view_proj : view_proj) * world_pos;
 }
\ No newline at end of file
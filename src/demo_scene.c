@@ -0,0 +1,77 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "demo_scene.h"
+
+// cube primitive as vertex coordinates
+
+static const float cube_vertices[] = {
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+    0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+    0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+    0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+    0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+    0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+    0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+    0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+    0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+};
+
+int demo_scene_create(rhino_scene* scene, rhino_mesh* cube_mesh, rhino_mesh* sphere_mesh, unsigned int texture) {
+    // index the cube and upload it, meshes build their lod chain on creation
+
+    rhino_mesh_create_from_array(cube_mesh, cube_vertices, sizeof(cube_vertices) / (5 * sizeof(float)));
+    rhino_mesh_create_sphere(sphere_mesh, 64, 128);
+
+    int crate = rhino_scene_add(scene, cube_mesh, texture, 1);
+    scene->entities[crate].dynamic = true;
+
+    for(int i = 0; i < SPHERE_COUNT; i++) {
+        int sphere = rhino_scene_add(scene, sphere_mesh, texture, 1);
+
+        glm_translate(scene->entities[sphere].model, (vec3){3.0f, 0.5f, -SPHERE_SPACING * i});
+        glm_scale(scene->entities[sphere].model, (vec3){2, 2, 2});
+    }
+
+    rhino_scene_update(scene);
+
+    return crate;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_mesh.h"
+#include "rhino_scene.h"
+
+// the demo's static content, built the same way by the demo and by rhino_lightbake so a bake lines up with what
+// gets drawn
+
+// row of detailed spheres receding from the camera, gives the lod system something to work with
+
+#define SPHERE_COUNT 16
+#define SPHERE_SPACING 4.0f
+
+// low afternoon sun, shadowed through cascades and baked into the lightmap
+
+#define SUN_DIRECTION (vec3){ -0.4f, -1.0f, -0.3f }
+#define SUN_COLOR (vec3){ 0.8f, 0.75f, 0.65f }
+
+// sky radiance overhead and at the horizon, lights the lightmaps and the probe grid
+
+#define SKY_ZENITH (vec3){ 0.10f, 0.14f, 0.22f }
+#define SKY_HORIZON (vec3){ 0.16f, 0.17f, 0.18f }
+
+// light the fog scatters in besides the sun, picked so distant terrain fades towards the clear colour
+
+#define FOG_COLOR (vec3){ 0.45f, 0.55f, 0.65f }
+
+// offline lighting treats every surface as plain diffuse of this reflectance, the textures are applied at runtime
+
+#define SURFACE_ALBEDO 0.5f
+#define TERRAIN_ALBEDO 0.35f
+
+// irradiance probe grid around the crate and the sphere row, placed so no probe lands inside a sphere
+
+#define PROBE_ORIGIN (vec3){ -8.0f, -1.0f, -67.0f }
+#define PROBE_SIZE_X 12
+#define PROBE_SIZE_Y 5
+#define PROBE_SIZE_Z 38
+#define PROBE_SPACING 2.0f
+
+// creates the cube and sphere meshes and adds the rotating crate and the sphere row to scene, returns the crate
+// entity. the crate is dynamic, the spheres are static
+
+int demo_scene_create(rhino_scene* scene, rhino_mesh* cube_mesh, rhino_mesh* sphere_mesh, unsigned int texture);
@@ -5,6 +5,10 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
 
 #include "libs/stb_image.h"
 
@@ -16,6 +20,30 @@
 #include "textures.h"
 #include "rhino_callbacks.h"
 #include "rhino_global.h"
+#include "rhino_mesh.h"
+#include "rhino_lod.h"
+#include "rhino_scene.h"
+#include "rhino_pick.h"
+#include "rhino_terrain.h"
+#include "rhino_uniforms.h"
+#include "rhino_commands.h"
+#include "rhino_camera.h"
+#include "rhino_lights.h"
+#include "rhino_timer.h"
+#include "rhino_deferred.h"
+#include "rhino_shadows.h"
+#include "rhino_point_shadows.h"
+#include "rhino_lightmap.h"
+#include "rhino_probes.h"
+#include "rhino_graph.h"
+#include "rhino_resolution.h"
+#include "rhino_quality.h"
+#include "rhino_pacing.h"
+#include "rhino_capture.h"
+#include "rhino_post.h"
+#include "rhino_jobs.h"
+#include "rhino_sim.h"
+#include "demo_scene.h"
 
 // window dimensions
 
@@ -24,118 +52,691 @@
 
 rhino_state rhino;
 
-// time between each frame, used for things such as values that change overtime to stay consistent (e.g movement)
+// time between each frame and since the start of the loop. movement and animation run on the simulation's clock,
+// these are for frame statistics and visual fades
 
 float delta_time = 0.01f;
-float time;
+double elapsed_time;
 
 float window_width, window_height;
 
 #define PRINT_FRAME_TIME_PER_SECONDS 1.0f
 
-// resize gl viewport as window is resized, print debug info also
+// --headless renders this many frames into a hidden window at a fixed step and prints the averages
 
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+#define HEADLESS_FRAMES 300
+#define HEADLESS_STEP (1.0f / 60.0f)
+
+typedef struct headless_run_t {
+    bool enabled;
+    int frames;
+    int frame;
+    double cpu_seconds;
+    double gpu_ms;
+} headless_run;
+
+// point lights drifting over the terrain in front of the start position, light 0 is the main light circling the
+// crate and the first DEMO_SHADOW_LIGHTS after it are stationary lanterns, all of those cast shadows
+
+#define DEMO_LIGHTS 512
+#define DEMO_LIGHT_AREA 120.0f
+#define DEMO_SHADOW_LIGHTS 31
+
+#define MAIN_LIGHT_RADIUS 15.0f
+#define MAIN_LIGHT_COLOR (vec3){ 6.0f, 6.0f, 6.0f }
+
+typedef struct demo_light_t {
+    vec3 base;
+    float phase, speed, orbit;
+} demo_light;
+
+demo_light* demo_lights;
+
+// --bench-lights runs every light count single threaded and then on every job system thread, BENCH_FRAMES each
+
+#define BENCH_WARMUP_FRAMES 30
+#define BENCH_FRAMES 200
+
+const int bench_light_counts[] = { 1000, 10000, 100000 };
+
+#define BENCH_PHASES (int)(2 * sizeof(bench_light_counts) / sizeof(bench_light_counts[0]))
+
+typedef struct light_bench_t {
+    bool enabled;
+    int phase;
+    int frame;
+    double binning, animation, frame_time;
+    double references;
+} light_bench;
+
+// --bench-jobs culls and transforms JOB_BENCH_OBJECTS bounding spheres on 1 thread and then on every thread count
+// up to the job system's, and runs JOB_BENCH_JOBS empty jobs in batches for the cost of a job
+
+#define JOB_BENCH_OBJECTS (1 << 20)
+#define JOB_BENCH_JOBS 65536
+#define JOB_BENCH_BATCH 1024
+#define JOB_BENCH_RUNS 10
+
+typedef struct job_bench_t {
+    mat4* models;
+    vec4* spheres;
+    vec4* world_spheres;
+    unsigned char* visible;
+    vec4 planes[6];
+} job_bench;
+
+// what the frame graph's passes draw with, filled in before the graph executes. resources are this frame's
+
+#define SKY_CLEAR_COLOR 0.7f, 0.9f, 1.0f, 1.0f
+
+typedef struct frame_passes_t {
+    rhino_scene* scene;
+    rhino_terrain* terrain;
+    rhino_uniforms* uniforms;
+    rhino_shadows* shadows;
+    rhino_point_shadows* point_shadows;
+    rhino_lights* lights;
+    rhino_deferred* deferred;
+    rhino_gpu_timer* render_timer;
+    rhino_resolution* resolution;
+    rhino_post* post;
+    rhino_commands* commands;
+    unsigned int shader_program;
+    float pixels_per_unit;
+
+    // programs the view's recorded commands use, the forward or the g-buffer ones
+
+    unsigned int scene_program, terrain_program;
+
+    // scene targets are this size, the present pass upscales them to the framebuffer
+
+    int render_width, render_height;
+
+    int gbuffer_albedo, gbuffer_normal, gbuffer_baked, gbuffer_depth;
+    int color;
+} frame_passes;
+
+static void sun_shadow_pass(rhino_graph* graph, void* user) {
+    frame_passes* frame = user;
+
+    rhino_shadows_render(frame->shadows, frame->scene, frame->terrain, frame->uniforms);
+}
+
+static void point_shadow_pass(rhino_graph* graph, void* user) {
+    frame_passes* frame = user;
+
+    rhino_point_shadows_render(frame->point_shadows, frame->lights, frame->scene, frame->terrain, frame->uniforms);
+}
+
+// the view's entities and terrain chunks split into parts recorded side by side, the entities' parts first
+
+static void record_view(rhino_command_buffer* buffer, int part, int parts, void* user) {
+    frame_passes* frame = user;
+    int scene_parts = parts / 2;
+
+    if(part < scene_parts) {
+        rhino_command_program(buffer, frame->scene_program);
+        rhino_scene_record(frame->scene, buffer, part, scene_parts, frame->pixels_per_unit);
+    }
+    else {
+        rhino_command_program(buffer, frame->terrain_program);
+        rhino_terrain_record(frame->terrain, buffer, part - scene_parts, parts - scene_parts);
+    }
+}
+
+// two parts of each per thread, so a thread that finished early steals some of the work
+
+static void draw_view(frame_passes* frame, unsigned int scene_program, unsigned int terrain_program) {
+    frame->scene_program = scene_program;
+    frame->terrain_program = terrain_program;
+
+    rhino_commands_record(frame->commands, 4 * rhino.jobs.workers, record_view, frame);
+    rhino_commands_replay(frame->commands, frame->uniforms);
+}
+
+static void forward_pass(rhino_graph* graph, void* user) {
+    frame_passes* frame = user;
+
+    glClearColor(SKY_CLEAR_COLOR);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    rhino_gpu_timer_begin(frame->render_timer);
+
+    draw_view(frame, frame->shader_program, frame->terrain->program);
+
+    rhino_gpu_timer_end(frame->render_timer);
+}
+
+static void gbuffer_pass(rhino_graph* graph, void* user) {
+    frame_passes* frame = user;
+
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    rhino_gpu_timer_begin(frame->render_timer);
+
+    draw_view(frame, frame->deferred->geometry_program, frame->terrain->gbuffer_program);
+}
+
+static void deferred_lighting_pass(rhino_graph* graph, void* user) {
+    frame_passes* frame = user;
+
+    glClearColor(SKY_CLEAR_COLOR);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    rhino_deferred_light(frame->deferred, rhino_graph_texture(graph, frame->gbuffer_albedo), rhino_graph_texture(graph, frame->gbuffer_normal),
+        rhino_graph_texture(graph, frame->gbuffer_depth), rhino_graph_texture(graph, frame->gbuffer_baked));
+
+    rhino_gpu_timer_end(frame->render_timer);
+}
+
+static void present_pass(rhino_graph* graph, void* user) {
+    frame_passes* frame = user;
+
+    rhino_resolution_upscale(frame->resolution, rhino_graph_texture(graph, frame->color));
+}
+
+// both renderers are declared every frame, culling drops whichever one the present pass does not read
+
+static void declare_frame(rhino_graph* graph, frame_passes* frame, rhino_renderer renderer) {
+    int width = frame->render_width, height = frame->render_height;
+
+    rhino_graph_begin(graph);
+
+    int cascades = rhino_graph_import(graph, "sun cascades", frame->shadows->depth);
+    int atlas = rhino_graph_import(graph, "point shadow atlas", frame->point_shadows->depth);
+
+    int pass = rhino_graph_add_pass(graph, "sun shadows", sun_shadow_pass, frame);
+    rhino_graph_write(graph, pass, cascades);
+
+    pass = rhino_graph_add_pass(graph, "point shadows", point_shadow_pass, frame);
+    rhino_graph_write(graph, pass, atlas);
+
+    int forward_color = rhino_graph_create(graph, "forward colour", GL_RGBA16F, width, height);
+    int forward_depth = rhino_graph_create(graph, "forward depth", GL_DEPTH24_STENCIL8, width, height);
+
+    pass = rhino_graph_add_pass(graph, "forward", forward_pass, frame);
+    rhino_graph_read(graph, pass, cascades);
+    rhino_graph_read(graph, pass, atlas);
+    rhino_graph_write_color(graph, pass, forward_color);
+    rhino_graph_write_depth(graph, pass, forward_depth);
+
+    frame->gbuffer_albedo = rhino_graph_create(graph, "g-buffer albedo", RHINO_GBUFFER_ALBEDO_FORMAT, width, height);
+    frame->gbuffer_normal = rhino_graph_create(graph, "g-buffer normal", RHINO_GBUFFER_NORMAL_FORMAT, width, height);
+    frame->gbuffer_baked = rhino_graph_create(graph, "g-buffer baked", RHINO_GBUFFER_BAKED_FORMAT, width, height);
+    frame->gbuffer_depth = rhino_graph_create(graph, "g-buffer depth", RHINO_GBUFFER_DEPTH_FORMAT, width, height);
+
+    pass = rhino_graph_add_pass(graph, "g-buffer", gbuffer_pass, frame);
+    rhino_graph_write_color(graph, pass, frame->gbuffer_albedo);
+    rhino_graph_write_color(graph, pass, frame->gbuffer_normal);
+    rhino_graph_write_color(graph, pass, frame->gbuffer_baked);
+    rhino_graph_write_depth(graph, pass, frame->gbuffer_depth);
+
+    int deferred_color = rhino_graph_create(graph, "deferred colour", GL_RGBA16F, width, height);
+
+    pass = rhino_graph_add_pass(graph, "deferred lighting", deferred_lighting_pass, frame);
+    rhino_graph_read(graph, pass, frame->gbuffer_albedo);
+    rhino_graph_read(graph, pass, frame->gbuffer_normal);
+    rhino_graph_read(graph, pass, frame->gbuffer_baked);
+    rhino_graph_read(graph, pass, frame->gbuffer_depth);
+    rhino_graph_read(graph, pass, cascades);
+    rhino_graph_read(graph, pass, atlas);
+    rhino_graph_write_color(graph, pass, deferred_color);
+
+    frame->color = renderer == RHINO_RENDERER_DEFERRED ? deferred_color : forward_color;
+
+    // post effects over whichever renderer's colour and depth, at the scene's own size
+
+    int depth = renderer == RHINO_RENDERER_DEFERRED ? frame->gbuffer_depth : forward_depth;
+
+    frame->color = rhino_post_declare(frame->post, graph, frame->color, depth, cascades, width, height);
+
+    pass = rhino_graph_add_pass(graph, "present", present_pass, frame);
+    rhino_graph_read(graph, pass, frame->color);
+    rhino_graph_write(graph, pass, RHINO_GRAPH_BACKBUFFER);
+}
+
+// pushes a quality level into every module it has a knob in
+
+static void apply_quality(rhino_quality_level* level, rhino_shadows* shadows, rhino_lights* lights, unsigned int* textures, int texture_count) {
+    rhino_shadows_set_quality(shadows, level->shadow_resolution, level->shadow_cascades);
+
+    rhino.lod.bias = level->lod_bias;
+    lights->light_cap = level->light_cap;
+
+    for(int i = 0; i < texture_count; i++) {
+        if(textures[i] == 0) continue;
+
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, level->mip_bias);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    rhino.resolution.filter = level->post & RHINO_QUALITY_POST_SHARPEN ? RHINO_UPSCALE_SHARPEN : RHINO_UPSCALE_BILINEAR;
+
+    rhino.post.effects[RHINO_POST_BLOOM].allowed = level->post & RHINO_QUALITY_POST_BLOOM;
+    rhino.post.effects[RHINO_POST_SSAO].allowed = level->post & RHINO_QUALITY_POST_SSAO;
+    rhino.post.effects[RHINO_POST_FOG].allowed = level->post & RHINO_QUALITY_POST_FOG;
+}
+
+// scene textures come from the loader thread, whatever uses one samples nothing until its texture is handed over
+
+typedef enum demo_texture_t {
+    DEMO_TEXTURE_PEBBLES,
+    DEMO_TEXTURE_CONTAINER,
+    DEMO_TEXTURE_COUNT
+} demo_texture;
+
+typedef struct demo_textures_t {
+    unsigned int textures[DEMO_TEXTURE_COUNT];
+    rhino_scene* scene;
+    rhino_terrain* terrain;
+} demo_textures;
+
+static void texture_loaded(void* data, int index, unsigned int texture) {
+    demo_textures* textures = data;
+
+    textures->textures[index] = texture;
+
+    // quality changes from here on reach it through apply_quality, the level in use now has to be applied here
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, rhino_quality_current(&rhino.quality)->mip_bias);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if(index == DEMO_TEXTURE_PEBBLES) textures->terrain->texture = texture;
+
+    // every entity of the demo scene wears the crate texture
+
+    if(index == DEMO_TEXTURE_CONTAINER) {
+        for(int i = 0; i < textures->scene->entity_count; i++) textures->scene->entities[i].texture = texture;
+    }
+}
+
+static float random_float(float min, float max) {
+    return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+static void spawn_lights(rhino_lights* lights, int count) {
+    rhino_lights_clear(lights);
+
+    rhino_lights_add(lights, (vec3){ 0.0f, 1.0f, 0.0f }, MAIN_LIGHT_RADIUS, MAIN_LIGHT_COLOR);
+
+    demo_lights = realloc(demo_lights, count * sizeof(demo_light));
+
+    // same layout every run so benchmarks compare
+
+    srand(1);
+
+    for(int i = 0; i < count; i++) {
+        demo_light* demo = &demo_lights[i];
+
+        float x = random_float(-DEMO_LIGHT_AREA * 0.5f, DEMO_LIGHT_AREA * 0.5f);
+        float z = random_float(-DEMO_LIGHT_AREA, 10.0f);
+
+        glm_vec3_copy((vec3){x, rhino_terrain_height(x, z) + random_float(0.5f, 3.0f), z}, demo->base);
+
+        demo->phase = random_float(0.0f, GLM_PIf * 2.0f);
+        demo->speed = random_float(0.3f, 1.5f);
+        demo->orbit = i < DEMO_SHADOW_LIGHTS ? 0.0f : random_float(0.5f, 3.0f);
+
+        vec3 color = { random_float(0.2f, 1.0f), random_float(0.2f, 1.0f), random_float(0.2f, 1.0f) };
+        glm_vec3_scale(color, 4.0f, color);
+
+        rhino_lights_add(lights, demo->base, random_float(3.0f, 8.0f), color);
+    }
+}
+
+// time stays double until it is wrapped into a single turn, so the lights move as smoothly after days as at start
+
+static void animate_lights(rhino_lights* lights, double time) {
+    float t = (float)fmod(time, GLM_PI * 2.0);
+
+    glm_vec3_copy((vec3){cosf(t * 2.0f) - sinf(t * 2.0f), cosf(t) * 2.0f + 0.5f, cosf(t * 2.0f) + sinf(t * 2.0f)}, lights->lights[0].position);
+
+    // lanterns stay put so their shadows stay cached
+
+    for(int i = 0; i < lights->light_count - 1; i++) {
+        demo_light* demo = &demo_lights[i];
+
+        if(demo->orbit == 0.0f) continue;
+
+        float angle = (float)fmod(time * demo->speed + demo->phase, GLM_PI * 2.0);
+
+        glm_vec3_add(demo->base, (vec3){cosf(angle) * demo->orbit, sinf(angle * 2.0f) * 0.5f, sinf(angle) * demo->orbit}, lights->lights[i + 1].position);
+    }
+}
+
+// records one frame of the light benchmark, moves on to the next phase and prints the results once done
+
+static void bench_lights_frame(light_bench* bench, rhino_lights* lights, double animation, double frame_time) {
+    if(bench->frame >= BENCH_WARMUP_FRAMES) {
+        bench->binning += lights->stats.binning_seconds;
+        bench->animation += animation;
+        bench->frame_time += frame_time;
+        bench->references += lights->stats.references;
+    }
+
+    if(++bench->frame < BENCH_WARMUP_FRAMES + BENCH_FRAMES) return;
+
+    printf("\nbench : %6d lights, %d thread%s - binning %.3f ms, animation %.3f ms, frame %.3f ms, %.0f cluster references, %u dropped",
+        lights->light_count, lights->thread_count, lights->thread_count > 1 ? "s" : " ",
+        bench->binning * 1000.0 / BENCH_FRAMES, bench->animation * 1000.0 / BENCH_FRAMES, bench->frame_time * 1000.0 / BENCH_FRAMES,
+        bench->references / BENCH_FRAMES, lights->stats.overflows);
+
+    bench->phase++;
+    bench->frame = 0;
+    bench->binning = bench->animation = bench->frame_time = bench->references = 0.0;
+
+    if(bench->phase == BENCH_PHASES) {
+        glfwSetWindowShouldClose(rhino.window, true);
+        return;
+    }
+
+    lights->thread_count = bench->phase % 2 ? rhino.jobs.thread_count : 1;
+
+    if(bench->phase % 2 == 0) spawn_lights(lights, bench_light_counts[bench->phase / 2]);
+}
+
+static void job_bench_cull(void* data, int begin, int end) {
+    job_bench* bench = data;
+
+    for(int i = begin; i < end; i++) {
+        float* sphere = bench->world_spheres[i];
+
+        glm_mat4_mulv3(bench->models[i], bench->spheres[i], 1.0f, sphere);
+        sphere[3] = bench->spheres[i][3];
+
+        bool visible = true;
+
+        for(int p = 0; p < 6 && visible; p++) visible = glm_vec3_dot(bench->planes[p], sphere) + bench->planes[p][3] >= -sphere[3];
+
+        bench->visible[i] = visible;
+    }
+}
+
+static void job_bench_empty(void* data, int begin, int end) {
+}
+
+// scattered objects under random transforms seen by the demo camera, the same work culling a large scene would be
+
+static void bench_jobs(rhino_jobs* jobs) {
+    job_bench bench;
+
+    bench.models = malloc(JOB_BENCH_OBJECTS * sizeof(mat4));
+    bench.spheres = malloc(JOB_BENCH_OBJECTS * sizeof(vec4));
+    bench.world_spheres = malloc(JOB_BENCH_OBJECTS * sizeof(vec4));
+    bench.visible = malloc(JOB_BENCH_OBJECTS);
+
+    srand(1);
+
+    for(int i = 0; i < JOB_BENCH_OBJECTS; i++) {
+        glm_translate_make(bench.models[i], (vec3){ random_float(-200.0f, 200.0f), random_float(-20.0f, 20.0f), random_float(-200.0f, 200.0f) });
+        glm_rotate(bench.models[i], random_float(0.0f, GLM_PIf * 2.0f), (vec3){ 0.0f, 1.0f, 0.0f });
+
+        glm_vec4_copy((vec4){ random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(0.5f, 2.0f) }, bench.spheres[i]);
+    }
+
+    mat4 projection, view, view_projection;
+    glm_perspective(glm_rad(CAMERA_FOV), 1.0f, CAMERA_NEAR, CAMERA_FAR, projection);
+    glm_lookat((vec3){ 0.0f, 5.0f, 0.0f }, (vec3){ 0.0f, 5.0f, -1.0f }, (vec3){ 0.0f, 1.0f, 0.0f }, view);
+    glm_mat4_mul(projection, view, view_projection);
+    glm_frustum_planes(view_projection, bench.planes);
+
+    int thread_count = jobs->thread_count;
+
+    printf("\n\njob scaling, %d objects culled and transformed, %d runs per thread count", JOB_BENCH_OBJECTS, JOB_BENCH_RUNS);
+    printf("\nthreads |   ms/run | speedup | efficiency | visible | ns/job");
+
+    double single = 0.0;
+
+    for(int threads = 1; threads <= thread_count; threads++) {
+        rhino_jobs_set_active(jobs, threads);
+
+        // warm up once, then time the runs
+
+        rhino_jobs_parallel_for(jobs, JOB_BENCH_OBJECTS, 0, job_bench_cull, &bench);
+
+        double start = glfwGetTime();
+
+        for(int run = 0; run < JOB_BENCH_RUNS; run++) rhino_jobs_parallel_for(jobs, JOB_BENCH_OBJECTS, 0, job_bench_cull, &bench);
+
+        double ms = (glfwGetTime() - start) * 1000.0 / JOB_BENCH_RUNS;
+
+        // job overhead, batches stay well inside a deque
+
+        start = glfwGetTime();
+
+        for(int batch = 0; batch < JOB_BENCH_JOBS / JOB_BENCH_BATCH; batch++) {
+            rhino_job_counter counter = { 0 };
+
+            for(int i = 0; i < JOB_BENCH_BATCH; i++) rhino_jobs_run(jobs, job_bench_empty, NULL, i, i + 1, &counter);
+
+            rhino_jobs_wait(jobs, &counter);
+        }
+
+        double job_ns = (glfwGetTime() - start) * 1e9 / JOB_BENCH_JOBS;
+
+        int visible = 0;
+        for(int i = 0; i < JOB_BENCH_OBJECTS; i++) visible += bench.visible[i];
+
+        if(threads == 1) single = ms;
+
+        printf("\n%7d | %8.3f | %6.2fx | %9.0f%% | %7d | %6.0f", threads, ms, single / ms, 100.0 * single / ms / threads, visible, job_ns);
+    }
+
+    printf("\n");
+    rhino_jobs_set_active(jobs, thread_count);
+    rhino_jobs_print_stats(jobs);
+
+    free(bench.models);
+    free(bench.spheres);
+    free(bench.world_spheres);
+    free(bench.visible);
+}
+
+// window events forwarded by the main thread, applied on the render thread at the start of a frame
+
+static void apply_framebuffer_size(int width, int height) {
     glViewport(0, 0, width, height);
     printf("\nwindow resized to %dx%d", width, height);
     window_width = (float)width;
     window_height = (float)height;
+
+    // minimised windows report 0x0, keep the last projection rather than dividing by zero
+
+    if(width > 0 && height > 0) rhino_camera_set_aspect(&rhino.camera, window_width / window_height);
+
+    // every pooled target is sized from the framebuffer, the next frame reallocates them
+
+    rhino_graph_resize(&rhino.graph, width, height);
 }
 
-void mouse_callback(GLFWwindow* window, double x_pos, double y_pos) {
-    if(!rhino.mouse.unlocked) {
-        double x_delta, y_delta;
-        
-        x_delta = x_pos - rhino.mouse.x_pos;
-        y_delta = y_pos - rhino.mouse.y_pos;
+static void handle_events(void) {
+    rhino_event event;
+    double now = glfwGetTime();
+
+    rhino_input_new_frame(&rhino.input);
 
-        rhino.cam.yaw += x_delta * rhino.mouse.sens;
-        rhino.cam.pitch -= y_delta * rhino.mouse.sens;
+    while(rhino_event_pop(&rhino.events, &event)) {
+        switch(event.type) {
+            case RHINO_EVENT_FRAMEBUFFER_SIZE: apply_framebuffer_size((int)event.x, (int)event.y); break;
+
+            case RHINO_EVENT_WINDOW_SIZE:
+                rhino.mouse.window_width = (int)event.x;
+                rhino.mouse.window_height = (int)event.y;
+                break;
+
+            default: rhino_input_event(&rhino.input, &event, now); break;
+        }
+    }
+}
 
-        // clamp viewing angle
+// requests from the render thread for things only the main thread may do to the window
 
-        if(rhino.cam.pitch > glm_rad(89.0f)) rhino.cam.pitch = glm_rad(89.0f);
-        else if(rhino.cam.pitch < glm_rad(-89.0f)) rhino.cam.pitch = glm_rad(-89.0f);
+static void handle_request(GLFWwindow* window, const GLFWvidmode* mode, rhino_event* request) {
+    switch(request->type) {
+        case RHINO_REQUEST_CURSOR_MODE: glfwSetInputMode(window, GLFW_CURSOR, request->value); break;
 
-        rhino.mouse.x_pos = x_pos;
-        rhino.mouse.y_pos = y_pos;
+        // value is the fullscreen flag before the toggle
 
-        rhino.cam.direction[0] = cos(rhino.cam.yaw) * cos(rhino.cam.pitch);
-        rhino.cam.direction[1] = sin(rhino.cam.pitch);
-        rhino.cam.direction[2] = sin(rhino.cam.yaw) * cos(rhino.cam.pitch);
+        case RHINO_REQUEST_FULLSCREEN:
+            glfwSetWindowMonitor(window, request->value ? glfwGetPrimaryMonitor() : NULL, 0, 0, mode->width, mode->height, GLFW_DONT_CARE);
 
-        glm_normalize(rhino.cam.direction);
+            if(!request->value) {
+                glfwSetWindowSize(window, WINDOW_WIDTH, WINDOW_HEIGHT); 
+                glfwSetWindowPos(window, 200, 200);
+            }
+            break;
 
-        glm_vec3_copy(rhino.cam.direction, rhino.cam.front);
+        default: break;
     }
 }
 
-// program entry
+// everything main parses from the command line and sets up before the window goes to the render thread. done is
+// raised once the render thread let go of the context, result is the exit code
 
-int main(void) {
-    // init opengl, set version and profile (core profile)
+typedef struct demo_settings_t {
+    GLFWwindow* window;
+    int framebuffer_width, framebuffer_height;
 
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    light_bench bench;
+    headless_run headless;
+    bool use_lightmap;
 
-    // init opengl window (fullscreen, change glfwGetPrimaryMonitor to NULL if you so need/desire windowed mode)
+    float target_ms;
+    float fixed_scale;
+    rhino_upscale_filter upscale_filter;
 
-    GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Rhino Framework", NULL, NULL);
+    const char* quality_ladder;
+    const char* quality_level;
 
-    rhino.window = window;
+    const char* post_settings[RHINO_POST_EFFECTS * 2];
+    int post_setting_count;
 
-    window_width = WINDOW_WIDTH;
-    window_height = WINDOW_HEIGHT;
+    rhino_pacing_mode pacing_mode;
+    double target_fps;
+    int refresh_rate;
 
-    if (window == NULL) {
-        printf("\nfailed to create a glfw window.");
-        glfwTerminate();
-        return -1;
-    }
+    bool lights_animated;
+    bool crate_animated;
 
-    // set context to the window just created
+    int frames_in_flight;
 
-    glfwMakeContextCurrent(window);
+    const char* capture_path;
+
+    // hidden window sharing the main one's objects, null when it could not be made
+
+    GLFWwindow* loader_context;
+
+    atomic_bool done;
+    int result;
+} demo_settings;
+
+static void* render_exit(demo_settings* settings, int result) {
+    glfwMakeContextCurrent(NULL);
+
+    settings->result = result;
+    atomic_store(&settings->done, true);
+
+    // the main thread is most likely asleep in glfwWaitEvents
 
-    // callbacks
+    glfwPostEmptyEvent();
 
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
+    return NULL;
+}
+
+// the render thread owns the gl context, sets the scene up and runs the frame loop until the window closes
+
+static void* render_thread(void* arg) {
+    demo_settings* settings = arg;
+    GLFWwindow* window = settings->window;
+
+    light_bench bench = settings->bench;
+    headless_run headless = settings->headless;
+    bool use_lightmap = settings->use_lightmap;
+
+    float target_ms = settings->target_ms;
+    float fixed_scale = settings->fixed_scale;
+    rhino_upscale_filter upscale_filter = settings->upscale_filter;
+
+    const char* quality_ladder = settings->quality_ladder;
+    const char* quality_level = settings->quality_level;
+
+    const char** post_settings = settings->post_settings;
+    int post_setting_count = settings->post_setting_count;
+
+    // when frames start and present, measured against its deadlines in the stats
+
+    rhino_pacing pacing;
+    rhino_pacing_init(&pacing, settings->pacing_mode, settings->target_fps, settings->refresh_rate);
+
+    // the context is current on this thread from here on, jobs queued from it go on a deque of its own
+
+    glfwMakeContextCurrent(window);
+    rhino_jobs_attach(&rhino.jobs);
 
     // input setup
 
     rhino.cam.mov_speed = CAMERA_MOV_SPEED;
     rhino.mouse.sens = CAMERA_SENS;
 
-    // prepare camera
+    // level of detail defaults
+
+    rhino.lod.enabled = true;
+    rhino.lod.crossfade = true;
+    rhino.lod.error_threshold = LOD_ERROR_THRESHOLD;
+
+    // prepare camera, identity orientation looks down -z
 
-    rhino.cam.posititon[2] = 3.0f;
+    rhino_camera_init_perspective(&rhino.camera, glm_rad(CAMERA_FOV), window_width / window_height, CAMERA_NEAR, CAMERA_FAR);
+    rhino_camera_set_position(&rhino.camera, (vec3){0.0f, 0.0f, 3.0f});
 
-    glm_vec3((vec4){0, 0, -1, 0}, rhino.cam.front);
-    glm_vec3((vec4){0, 1, 0, 0}, rhino.cam.up);
+    // the simulation owns camera movement from here on, it starts ticking with the render loop
+
+    rhino_sim_init(&rhino.sim, &rhino.camera, rhino.cam.mov_speed);
+
+    rhino.sim.animate = settings->crate_animated;
+    rhino.sim.redraw = &rhino.redraw;
 
     // init glad (opengl function pointers)
 
     if(!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         printf("\nfailed to init GLAD, could not load process.");
-        return -1;
+        return render_exit(settings, -1);
     }
 
-    glfwSwapInterval(0);
+    rhino_pacing_apply(&pacing);
 
-    // screen details
+    // per frame buffers get a copy per frame in flight, so the frames have to be known before anything creates one
 
-    const GLFWvidmode * mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    rhino_frames_init(&rhino.frames, settings->frames_in_flight);
 
-    // pass dimensions into opengl viewport
+    // uploads move to a thread of their own on the loader's context, or stay on this one without it
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    rhino_loader_init(&rhino.loader, settings->loader_context);
 
-    // capture mouse
+    // render targets are pooled by the frame graph at the framebuffer's size, which can differ from the window's
 
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);  
+    rhino_graph_init(&rhino.graph, settings->framebuffer_width, settings->framebuffer_height);
+
+    // the scene renders at a fraction of that size, moved every few frames towards the target gpu time. --scale
+    // pins it instead
+
+    rhino_resolution_init(&rhino.resolution);
+
+    rhino.resolution.target_ms = target_ms > 0.0f ? target_ms : RHINO_RESOLUTION_TARGET_MS;
+    rhino.resolution.filter = upscale_filter;
+
+    if(fixed_scale > 0.0f) {
+        rhino.resolution.dynamic = false;
+        rhino.resolution.scale = glm_clamp(fixed_scale, RHINO_RESOLUTION_MIN_SCALE, RHINO_RESOLUTION_MAX_SCALE);
+    }
+
+    // pass dimensions into opengl viewport
+
+    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
 
     // ------------ SHADERS ------------ //
@@ -144,163 +745,276 @@ int main(void) {
 
     glUseProgram(shader_program);
 
-    // --- TEXTURES --- //
-    
-    load_texture("pebbles.jpg", 0);
-    load_texture("container.jpg", 1);
+    // per-frame and per-object data live in uniform buffers shared by every program, textures are bound to unit 0
+    // per draw instead of pointing the sampler at a different unit
 
+    rhino_uniforms uniforms;
+    rhino_uniforms_init(&uniforms);
+    rhino_uniforms_bind_program(shader_program);
+    rhino_lights_bind_program(shader_program);
 
-    // ------- CUBE DEFINE, VBO + VAO ------- //
+    glUniform1i(glGetUniformLocation(shader_program, "texture_sample1"), 0);
 
-    // cube primitive as vertex coordinates
+    // ------- MESHES + SCENE ------- //
 
-    float vertices[] = {
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-        0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-        0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+    // rotating crate and the sphere row, rhino_lightbake builds the same scene
 
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-        0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-        0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    rhino_mesh cube_mesh;
+    rhino_mesh sphere_mesh;
 
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    rhino_scene scene;
+    rhino_scene_init(&scene);
 
-        0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    int crate = demo_scene_create(&scene, &cube_mesh, &sphere_mesh, 0);
 
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-        0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-        0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    // frametime and fps counter timer
 
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-        0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
-    };
+    double last_frame_draw = 0.01;
+    float fps_timer_counter = PRINT_FRAME_TIME_PER_SECONDS;
+
+    // cglm
 
-    // create buffer object of gl_array_buffer type and bind to gpu with id
+    glEnable(GL_DEPTH_TEST);
 
-    unsigned int VBO;
 
-    glGenBuffers(1, &VBO);
+    // streamed pebble terrain, chunks are generated on worker threads around the camera
 
-    // generate a vao (vertex array object)
+    rhino_terrain terrain;
+    rhino_terrain_init(&terrain);
+    rhino_lights_bind_program(terrain.program);
 
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    // clustered point lights, the benchmark replaces these with its own counts
 
-    // bind vbo and ebo, allocate memory and copy vertices and indices into gpu memory
+    rhino_lights lights;
+    rhino_lights_init(&lights);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    if(bench.enabled) {
+        lights.thread_count = 1;
+        spawn_lights(&lights, bench_light_counts[0]);
+        printf("\nbenchmarking clustered lighting, %d frames per run", BENCH_FRAMES);
+    }
+    else spawn_lights(&lights, DEMO_LIGHTS);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (GLvoid*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
+    // programs for the deferred path, its g-buffer comes from the frame graph
 
-    // unbind
+    rhino_deferred deferred;
+    rhino_deferred_init(&deferred);
 
-    glBindVertexArray(0);
+    // sun shadows, sampled by every lighting program
 
-    // frametime and fps counter timer
+    rhino_shadows shadows;
+    rhino_shadows_init(&shadows);
+    rhino_shadows_set_sun(&shadows, SUN_DIRECTION, SUN_COLOR);
 
-    float last_frame_draw = 0.01f;
-    float fps_timer_counter = PRINT_FRAME_TIME_PER_SECONDS;
+    rhino_shadows_bind_program(shader_program);
+    rhino_shadows_bind_program(terrain.program);
+    rhino_shadows_bind_program(deferred.lighting_program);
 
-    // cglm
+    // cube shadows for the main light and the lanterns, packed into one atlas
 
-    // prepare model, view and projection matrices
+    rhino_point_shadows point_shadows;
+    rhino_point_shadows_init(&point_shadows);
 
-    mat4 model, view, proj;
+    rhino_point_shadows_bind_program(shader_program);
+    rhino_point_shadows_bind_program(terrain.program);
+    rhino_point_shadows_bind_program(deferred.lighting_program);
 
-    glm_perspective(glm_rad(CAMERA_FOV), window_width/window_height, 0.1f, 100.0f, proj);
+    for(int i = 0; i <= DEMO_SHADOW_LIGHTS && i < lights.light_count; i++) rhino_point_shadows_add(&point_shadows, i);
 
-    unsigned int model_loc, view_loc, proj_loc;
+    // bloom, ssao and fog at fractions of the scene resolution, the fog marches through the sun's cascades
 
-    model_loc = glGetUniformLocation(shader_program, "model");
-    glUniformMatrix4fv(model_loc, 1, GL_FALSE, (float*)model);
+    rhino_post_init(&rhino.post);
+    rhino_shadows_bind_program(rhino.post.fog_program);
+    glm_vec3_copy(FOG_COLOR, rhino.post.fog_color);
 
-    view_loc = glGetUniformLocation(shader_program, "view");
-    glUniformMatrix4fv(view_loc, 1, GL_FALSE, (float*)view);
+    for(int i = 0; i < post_setting_count; i++) {
+        if(!rhino_post_configure(&rhino.post, post_settings[i])) printf("\nunknown post setting %s, expected bloom, ssao or fog:divisor", post_settings[i]);
+    }
 
-    proj_loc = glGetUniformLocation(shader_program, "projection");
-    glUniformMatrix4fv(proj_loc, 1, GL_FALSE, (float*)proj);
+    // sun, sky and bounce light baked by rhino_lightbake for the static entities, they skip the live sun when present
 
-    glEnable(GL_DEPTH_TEST);
+    rhino_lightmap lightmap;
+
+    if(use_lightmap) rhino_lightmap_load(&lightmap, RHINO_LIGHTMAP_FILE, &scene);
+    else memset(&lightmap, 0, sizeof(lightmap));
+
+    rhino_lightmap_bind_program(shader_program);
+    rhino_lightmap_bind_program(terrain.program);
+    rhino_lightmap_bind_program(deferred.geometry_program);
+    rhino_lightmap_bind_program(terrain.gbuffer_program);
+    rhino_lightmap_bind(&lightmap);
+
+    // sh irradiance probes for everything without a lightmap, traced once here and relit as the point lights move
+
+    rhino_probes probes;
+    rhino_probes_init(&probes, PROBE_ORIGIN, (int[3]){ PROBE_SIZE_X, PROBE_SIZE_Y, PROBE_SIZE_Z }, PROBE_SPACING);
+
+    rhino_probe_environment environment;
+    glm_vec3_copy(SUN_DIRECTION, environment.sun_direction);
+    glm_vec3_copy(SUN_COLOR, environment.sun_color);
+    glm_vec3_copy(SKY_ZENITH, environment.sky_zenith);
+    glm_vec3_copy(SKY_HORIZON, environment.sky_horizon);
+    environment.albedo = SURFACE_ALBEDO;
+    environment.terrain_albedo = TERRAIN_ALBEDO;
+
+    rhino_probes_bake(&probes, &scene, &environment);
+
+    rhino_probes_bind_program(shader_program);
+    rhino_probes_bind_program(terrain.program);
+    rhino_probes_bind_program(deferred.geometry_program);
+    rhino_probes_bind_program(terrain.gbuffer_program);
+    rhino_probes_bind(&probes);
+
+    // quality governor sharing the resolution controller's budget, knobs of the starting level are applied up front
+    // so a loaded ladder's best level takes effect too
+
+    rhino_quality_init(&rhino.quality, rhino.resolution.target_ms);
+
+    if(quality_ladder) rhino_quality_load(&rhino.quality, quality_ladder);
+
+    if(quality_level) {
+        int found = -1;
+
+        for(int i = 0; i < rhino.quality.level_count; i++) if(strcmp(rhino.quality.levels[i].name, quality_level) == 0) found = i;
+
+        if(found >= 0) {
+            rhino.quality.enabled = false;
+            rhino_quality_set_level(&rhino.quality, found);
+        }
+        else printf("\nunknown quality level %s, governing from %s", quality_level, rhino.quality.levels[0].name);
+    }
+
+    apply_quality(rhino_quality_current(&rhino.quality), &shadows, &lights, NULL, 0);
+
+    // --- TEXTURES --- //
+
+    // requested once the quality level is known, the loader may hand them over on the spot. headless runs wait for
+    // them so every run draws the same frames
+
+    demo_textures scene_textures = { { 0 }, &scene, &terrain };
+
+    rhino_loader_texture(&rhino.loader, "pebbles.jpg", texture_loaded, &scene_textures, DEMO_TEXTURE_PEBBLES);
+    rhino_loader_texture(&rhino.loader, "container.jpg", texture_loaded, &scene_textures, DEMO_TEXTURE_CONTAINER);
+
+    if(headless.enabled) rhino_loader_finish(&rhino.loader);
+
+    // gpu time of the scene passes, whichever renderer is active
+
+    rhino_gpu_timer render_timer;
+    rhino_gpu_timer_init(&render_timer);
+
+    // the view's draws are recorded on every job thread and replayed here
+
+    rhino_commands commands;
+    rhino_commands_init(&commands);
+
+    // screenshots, and every frame when --capture names a file, read back and encoded without waiting on the gpu
+
+    rhino_capture capture;
+    rhino_capture_init(&capture, settings->capture_path, headless.enabled ? 1.0 / HEADLESS_STEP : settings->target_fps);
 
-    unsigned int light_pos_loc = glGetUniformLocation(shader_program, "light_pos");
-    unsigned int texture_scale_location = glGetUniformLocation(shader_program, "texture_scale");
-    unsigned int texture_sample_loc = glGetUniformLocation(shader_program, "texture_sample1");
+    if(headless.enabled) printf("\nheadless run, %d frames with the %s renderer", headless.frames, rhino.renderer == RHINO_RENDERER_FORWARD ? "forward" : "deferred");
 
     // begin render loop, check input and swap buffers
 
 
+    double last_frame_start = glfwGetTime();
+
+    // headless runs tick the simulation themselves so every run sees the same ticks
+
+    rhino_sim_start(&rhino.sim, !headless.enabled);
+
+    // lights moving every frame keep frames coming, the crate does so through the simulation
+
+    rhino_redraw_set_continuous(&rhino.redraw, RHINO_REDRAW_ANIMATION, settings->lights_animated);
+
     while(!glfwWindowShouldClose(window)) {
+        // when rendering on demand nothing is drawn until something changed
+
+        rhino_redraw_wait(&rhino.redraw);
+
+        // low latency holds the frame back here so input and the simulation are sampled close to the deadline
+
+        rhino_pacing_begin_frame(&pacing);
+
+        double frame_start = glfwGetTime();
+
+        // everything the main thread forwarded since the last frame
+
+        handle_events();
+
+        // wall time since the last frame began, cpu and gpu stalls alike show up in it. time the pacing spent
+        // waiting on purpose and time spent idle are left out so neither ever reads as a slow frame
+
+        float frame_ms = (float)((frame_start - last_frame_start - pacing.last_waited - rhino.redraw.last_idle) * 1000.0);
+        last_frame_start = frame_start;
+
+        if(rhino_quality_frame(&rhino.quality, frame_ms)) apply_quality(rhino_quality_current(&rhino.quality), &shadows, &lights, scene_textures.textures, DEMO_TEXTURE_COUNT);
+
         glUseProgram(shader_program);
 
-        // set blank greenish background and clear screen
-        glClearColor(0.7f, 0.9f, 1.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        memset(&rhino.stats, 0, sizeof(rhino.stats));
 
-        // set up projection
+        // size the scene renders at this frame, everything measured in screen pixels uses it
 
-        glm_mat4_identity(proj);
-        glm_perspective(glm_rad(CAMERA_FOV), window_width/window_height, 0.1f, 100.0f, proj);
-        glUniformMatrix4fv(proj_loc, 1, GL_FALSE, (float*)proj);
+        int render_width, render_height;
+        rhino_resolution_size(&rhino.resolution, rhino.graph.width, rhino.graph.height, &render_width, &render_height);
 
-        // input update callback, f11 fullscreen control hardcoded into engine, not callback
+        // converts lod errors to pixels
 
-        if(glfwGetKey(window, GLFW_KEY_F11) == GLFW_PRESS) {
-            glfwWaitEventsTimeout(1.0);
-            glfwSetWindowMonitor(window, rhino.cam.fullscreen ? glfwGetPrimaryMonitor() : NULL, 0, 0, mode->width, mode->height, GLFW_DONT_CARE);
-            rhino.cam.fullscreen = !rhino.cam.fullscreen;
+        float pixels_per_unit = rhino_camera_pixels_per_unit(&rhino.camera, (float)render_height);
 
-            if(rhino.cam.fullscreen) { 
-                glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-                glfwSetWindowSize(window, WINDOW_WIDTH, WINDOW_HEIGHT); 
-                glfwSetWindowPos(window, 200, 200);
-                window_width = WINDOW_WIDTH;
-                window_height = WINDOW_HEIGHT;
-            }
+        // input update callback, f11 fullscreen control hardcoded into engine, not callback. only the main thread may
+        // touch the monitor, the new framebuffer size comes back as an event and fixes the viewport and aspect
+
+        if(rhino_input_pressed(&rhino.input, RHINO_ACTION_FULLSCREEN)) {
+            rhino_events_request(RHINO_REQUEST_FULLSCREEN, rhino.cam.fullscreen);
+            rhino.cam.fullscreen = !rhino.cam.fullscreen;
         }
 
-        rhino_input_update();
+        if(!headless.enabled) rhino_input_update();
+
+        // the world as of a tick ago, between the last two ticks the simulation published
+
+        double sim_time = headless.enabled ? headless.frame * (double)HEADLESS_STEP : rhino_sim_clock(&rhino.sim);
+
+        rhino_sim_advance(&rhino.sim, sim_time);
+
+        rhino_sim_state sim_state;
+        rhino_sim_interpolate(&rhino.sim, sim_time, &sim_state);
+
+        rhino_camera_set_position(&rhino.camera, sim_state.position);
+        rhino_camera_set_orientation(&rhino.camera, sim_state.orientation);
+
+        // place the crate and refresh world bounds
+
+        rhino_entity* crate_entity = &scene.entities[crate];
 
-        // camera view
+        glm_mat4_identity(crate_entity->model);
+        glm_translate(crate_entity->model, (vec3){0.0f, 1.0f, 0.0f});
+        glm_rotate(crate_entity->model, glm_rad((float)sim_state.crate_angle), (vec3){0.5f, 1.0f, 0.0f});
 
-        glm_mat4_identity(view);
+        rhino_scene_update(&scene);
 
-        // target direction to look at
+        // whatever the loader thread finished uploading, before the terrain asks it for more
 
-        vec3 target;
+        rhino_loader_poll(&rhino.loader);
 
-        glm_vec3_zero(target);
-        glm_vec3_add(rhino.cam.posititon, rhino.cam.front, target);
-        glm_lookat(rhino.cam.posititon, target, rhino.cam.up, view);
+        rhino_terrain_update(&terrain, &rhino.camera);
 
-        glUniformMatrix4fv(view_loc, 1, GL_FALSE, (float*)view);
+        // pick on left click, under the cursor when unlocked or through the screen centre otherwise
+
+        if(!headless.enabled && rhino_input_pressed(&rhino.input, RHINO_ACTION_PICK)) {
+            double pick_start = glfwGetTime();
+
+            rhino_pick_hit hit;
+            bool picked = rhino_pick(&scene, &rhino.camera, (vec4){0, 0, window_width, window_height}, &hit);
+
+            double pick_us = (glfwGetTime() - pick_start) * 1000000.0;
+
+            if(picked) printf("\npicked entity %d, triangle %u at distance %f (%.1f us)", hit.entity, hit.triangle, hit.distance, pick_us);
+            else printf("\npicked nothing (%.1f us)", pick_us);
+        }
 
         // rendering callback
 
@@ -308,76 +1022,443 @@ int main(void) {
 
         // TO BE MOVED INTO RENDER UPDATE
 
-        // lights
+        // per-frame block, uploaded once and read by both programs
+
+        rhino_frame_block frame;
+        memset(&frame, 0, sizeof(frame));
+
+        glm_mat4_copy(rhino_camera_view(&rhino.camera), frame.view);
+        glm_mat4_copy(rhino_camera_projection(&rhino.camera), frame.projection);
+        glm_mat4_copy(rhino_camera_view_proj(&rhino.camera), frame.view_proj);
+        glm_mat4_copy(rhino_camera_inv_view_proj(&rhino.camera), frame.inv_view_proj);
+        glm_vec4(rhino.camera.position, 1.0f, frame.camera_pos);
+
+        // shaders get the time wrapped to an hour, a float still resolves well under a millisecond there
+
+        frame.time[0] = (float)fmod(sim_state.time, 3600.0);
+        frame.time[1] = delta_time;
+
+        // the first per frame buffer is written below, wait for the gpu to be done with this slot's copies. the cpu
+        // work above overlaps with the gpu still running older frames
+
+        int slot = rhino_frames_begin(&rhino.frames, rhino.redraw.last_idle > 0.0);
+
+        // move the point lights, pick their shadow faces and bin them into this frame's clusters
+
+        double animation_start = glfwGetTime();
+        if(settings->lights_animated) animate_lights(&lights, sim_state.time);
+        double animation_seconds = glfwGetTime() - animation_start;
+
+        rhino_point_shadows_update(&point_shadows, &lights, &rhino.camera, (float)render_height, &scene, &terrain);
+        rhino_lights_update(&lights, &rhino.camera, (float)render_width, (float)render_height, &frame);
 
-        vec3 light_pos;
-        glm_vec3((vec4){cos(time * 2) - sin(time * 2), (cos(time) * 2) + 0.5f, cos(time * 2) + sin(time * 2), 1}, light_pos);
+        rhino_shadows_update(&shadows, &rhino.camera, &frame);
 
-        glUniform4f(light_pos_loc, light_pos[0], light_pos[1], light_pos[2], 1.0f);
+        // the benchmark's light counts would turn probe relighting into a light loop of its own, it keeps the
+        // probes as they are
 
-        // draw pebble ground
+        if(!bench.enabled) rhino_probes_update(&probes, &lights);
+        rhino_probes_frame(&probes, &frame);
 
-        glm_mat4_identity(model);
-        glm_translate(model, (vec3){0, -10.5f, 0});
-        glm_scale(model, (vec3){20, 20, 20});
+        rhino_uniforms_begin_frame(&uniforms, &frame, slot);
 
-        glUniformMatrix4fv(model_loc, 1, GL_FALSE, (float*)model);
+        // shadows, the scene through either renderer and the copy to the window, all as passes of the frame graph
 
-        glUniform1f(texture_scale_location, 8);
+        frame_passes passes;
+        memset(&passes, 0, sizeof(passes));
 
-        glBindVertexArray(VAO);
-        glUniform1i(texture_sample_loc, 0);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
+        passes.scene = &scene;
+        passes.terrain = &terrain;
+        passes.uniforms = &uniforms;
+        passes.shadows = &shadows;
+        passes.point_shadows = &point_shadows;
+        passes.lights = &lights;
+        passes.deferred = &deferred;
+        passes.render_timer = &render_timer;
+        passes.resolution = &rhino.resolution;
+        passes.post = &rhino.post;
+        passes.commands = &commands;
+        passes.shader_program = shader_program;
+        passes.pixels_per_unit = pixels_per_unit;
+        passes.render_width = render_width;
+        passes.render_height = render_height;
 
-        // draw rotating crate
+        declare_frame(&rhino.graph, &passes, rhino.renderer);
+        rhino_graph_compile(&rhino.graph);
 
-        glm_mat4_identity(model);
-        glm_translate(model, (vec3){0.0f, 1.0f, 0.0f});
-        glm_rotate(model, glm_rad(-60.0f * time), (vec3){0.5f, 1.0f, 0.0f});
+        rhino_resolution_begin(&rhino.resolution);
+        rhino_graph_execute(&rhino.graph);
 
-        glUniformMatrix4fv(model_loc, 1, GL_FALSE, (float*)model);
+        // work spread over frames and transitions in flight need the frames after this one too
 
-        glBindVertexArray(VAO);
-        glUniform1f(texture_scale_location, 1);
-        glUniform1i(glGetUniformLocation(shader_program, "texture_sample1"), 1);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
+        if(rhino.stats.lod_fades) rhino_redraw_request(&rhino.redraw, RHINO_REDRAW_ANIMATION);
+        if(probes.stale_count || point_shadows.stats.faces_waiting) rhino_redraw_request(&rhino.redraw, RHINO_REDRAW_PROGRESSIVE);
+        rhino_resolution_end(&rhino.resolution);
+
+        // the finished frame is in the back buffer
+
+        if(!headless.enabled && rhino_input_pressed(&rhino.input, RHINO_ACTION_SCREENSHOT)) rhino_capture_screenshot(&capture);
+
+        rhino_capture_frame(&capture, rhino.graph.width, rhino.graph.height);
 
         // display
 
+        rhino_pacing_present(&pacing);
         glfwSwapBuffers(window);
-        glfwPollEvents();
+        rhino_frames_end(&rhino.frames);
+        rhino_pacing_presented(&pacing);
+
+        // benchmark frames wait for the gpu so the frame time covers the shading cost too
+
+        if(bench.enabled) {
+            glFinish();
+            bench_lights_frame(&bench, &lights, animation_seconds, glfwGetTime() - frame_start);
+        }
+
+        // headless frames wait on their own timer so every frame is counted, and advance time by a fixed step
+
+        rhino_gpu_timer_poll(&render_timer, headless.enabled);
+        rhino_resolution_update(&rhino.resolution, headless.enabled);
+        rhino_post_update(&rhino.post);
+
+        if(headless.enabled) {
+            headless.cpu_seconds += glfwGetTime() - frame_start;
+            headless.gpu_ms += render_timer.last_ms;
+
+            if(++headless.frame >= headless.frames) {
+                int frames = headless.frames > 0 ? headless.frames : 1;
+
+                printf("\nheadless : %d frames, %s renderer - cpu %.3f ms, gpu %.3f ms per frame, resolution scale %.2f averaging %.2f over the last %d frames",
+                    headless.frame, rhino.renderer == RHINO_RENDERER_FORWARD ? "forward" : "deferred",
+                    headless.cpu_seconds * 1000.0 / frames, headless.gpu_ms / frames,
+                    rhino.resolution.scale, rhino_resolution_average(&rhino.resolution), rhino.resolution.stats.count);
+
+                printf("\nheadless : quality %s after %u changes, frame time p50 %.2f p95 %.2f p99 %.2f ms", rhino_quality_current(&rhino.quality)->name,
+                    rhino.quality.stats.changes, rhino.quality.stats.p50, rhino.quality.stats.p95, rhino.quality.stats.p99);
+
+                glfwSetWindowShouldClose(window, true);
+            }
+        }
 
-        // get time for shaders and also frametime counter
+        // get time for the frametime counter
 
-        time = glfwGetTime();
+        if(headless.enabled) elapsed_time = headless.frame * HEADLESS_STEP;
+        else elapsed_time = glfwGetTime();
 
         // frame time counters, print frametime counter every N seconds as specified in define at top
 
-        delta_time = time - last_frame_draw;
+        delta_time = elapsed_time - last_frame_draw;
         fps_timer_counter -= delta_time;
 
         if(fps_timer_counter <= 0) {
             // reset timer
             fps_timer_counter = PRINT_FRAME_TIME_PER_SECONDS;
             printf("\nfps : %f - frametime : %f\n", 1.0f / delta_time, delta_time);
+            printf("triangles : %u (lod %s, %u at full detail) - draw calls : %u\n", rhino.stats.triangles, rhino.lod.enabled ? "on" : "off", rhino.stats.triangles_full_detail, rhino.stats.draw_calls);
+            rhino_terrain_print_stats(&terrain, PRINT_FRAME_TIME_PER_SECONDS);
+            printf("point lights : %d (%d shaded), %u cluster references (max %u in a cluster, %u dropped), binning %.3f ms on %d threads\n", lights.light_count, lights.shaded_count, lights.stats.references, lights.stats.max_per_cluster, lights.stats.overflows, lights.stats.binning_seconds * 1000.0, lights.thread_count);
+            rhino_shadows_print_stats(&shadows);
+            rhino_point_shadows_print_stats(&point_shadows);
+            rhino_probes_print_stats(&probes);
+            rhino_graph_print_stats(&rhino.graph);
+            rhino_resolution_print_stats(&rhino.resolution, rhino.graph.width, rhino.graph.height);
+            rhino_quality_print_stats(&rhino.quality);
+            rhino_post_print_stats(&rhino.post);
+            rhino_jobs_print_stats(&rhino.jobs);
+            rhino_sim_print_stats(&rhino.sim, PRINT_FRAME_TIME_PER_SECONDS);
+            rhino_input_print_stats(&rhino.input);
+            rhino_pacing_print_stats(&pacing);
+            rhino_redraw_print_stats(&rhino.redraw);
+            rhino_frames_print_stats(&rhino.frames);
+            rhino_commands_print_stats(&commands);
+            rhino_capture_print_stats(&capture);
+            rhino_loader_print_stats(&rhino.loader);
+            printf("renderer : %s - gpu %.3f ms\n", rhino.renderer == RHINO_RENDERER_FORWARD ? "forward" : "deferred", render_timer.smoothed_ms);
         }
 
-        last_frame_draw = time;
+        last_frame_draw = elapsed_time;
 
         rhino.delta_time = delta_time;
     }
 
     // exit program, if havent exited manually
 
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    rhino_sim_destroy(&rhino.sim);
+    rhino_loader_destroy(&rhino.loader);
+    rhino_terrain_destroy(&terrain);
+    rhino_scene_destroy(&scene);
+    rhino_mesh_destroy(&cube_mesh);
+    rhino_mesh_destroy(&sphere_mesh);
+    rhino_uniforms_destroy(&uniforms);
+    rhino_commands_destroy(&commands);
+    rhino_capture_destroy(&capture);
+    rhino_lights_destroy(&lights);
+    rhino_deferred_destroy(&deferred);
+    rhino_shadows_destroy(&shadows);
+    rhino_point_shadows_destroy(&point_shadows);
+    rhino_lightmap_destroy(&lightmap);
+    rhino_probes_destroy(&probes);
+    rhino_graph_destroy(&rhino.graph);
+    rhino_resolution_destroy(&rhino.resolution);
+    rhino_post_destroy(&rhino.post);
+    rhino_gpu_timer_destroy(&render_timer);
+    rhino_frames_destroy(&rhino.frames);
+    free(demo_lights);
     glDeleteProgram(shader_program);
 
+    return render_exit(settings, 0);
+}
+
+// program entry
+
+int main(int argc, char** argv) {
+    light_bench bench;
+    memset(&bench, 0, sizeof(bench));
+
+    headless_run headless;
+    memset(&headless, 0, sizeof(headless));
+    headless.frames = HEADLESS_FRAMES;
+
+    rhino.renderer = RHINO_RENDERER_FORWARD;
+
+    bool use_lightmap = true;
+
+    // dynamic resolution settings from the command line, applied once the controller exists
+
+    float target_ms = RHINO_RESOLUTION_TARGET_MS;
+    float fixed_scale = 0.0f;
+    rhino_upscale_filter upscale_filter = RHINO_UPSCALE_SHARPEN;
+
+    // quality ladder to govern with instead of the built in one, or a level to hold without governing
+
+    const char* quality_ladder = NULL;
+    const char* quality_level = NULL;
+
+    // post effect divisors as name:divisor, 0 switches one off
+
+    const char* post_settings[RHINO_POST_EFFECTS * 2];
+    int post_setting_count = 0;
+
+    // job system threads, 0 for one per core
+
+    int job_threads = 0;
+    bool jobs_benchmark = false;
+
+    // frame pacing, unlimited presents as fast as the gpu allows like before
+
+    rhino_pacing_mode pacing_mode = RHINO_PACING_UNLIMITED;
+    double target_fps = RHINO_PACING_TARGET_FPS;
+
+    // unaccelerated mouse motion for looking around, where the platform has it
+
+    bool raw_mouse = false;
+
+    // render on demand, continuous animations are then opted into one system at a time
+
+    bool on_demand = false;
+
+    // the most frames the gpu may run behind the cpu
+
+    int frames_in_flight = RHINO_FRAMES_DEFAULT;
+    bool lights_animated = false, crate_animated = false;
+
+    // file every frame is captured to, a .y4m video or the prefix of numbered pngs
+
+    const char* capture_path = NULL;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--bench-lights") == 0) bench.enabled = true;
+        else if(strcmp(argv[i], "--bench-jobs") == 0) jobs_benchmark = true;
+        else if(strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) job_threads = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--no-lightmap") == 0) use_lightmap = false;
+        else if(strcmp(argv[i], "--raw-mouse") == 0) raw_mouse = true;
+        else if(strcmp(argv[i], "--on-demand") == 0) on_demand = true;
+        else if(strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc) frames_in_flight = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--capture") == 0 && i + 1 < argc) capture_path = argv[++i];
+        else if(strcmp(argv[i], "--animate") == 0 && i + 1 < argc) {
+            i++;
+
+            if(strcmp(argv[i], "lights") == 0) lights_animated = true;
+            else if(strcmp(argv[i], "crate") == 0) crate_animated = true;
+            else printf("\nunknown animation %s, expected lights or crate", argv[i]);
+        }
+        else if(strcmp(argv[i], "--fps") == 0 && i + 1 < argc) target_fps = atof(argv[++i]);
+        else if(strcmp(argv[i], "--pacing") == 0 && i + 1 < argc) {
+            i++;
+
+            if(!rhino_pacing_mode_from_name(argv[i], &pacing_mode)) printf("\nunknown pacing mode %s, using unlimited", argv[i]);
+        }
+        else if(strcmp(argv[i], "--headless") == 0) headless.enabled = true;
+        else if(strcmp(argv[i], "--frames") == 0 && i + 1 < argc) headless.frames = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--target-ms") == 0 && i + 1 < argc) target_ms = (float)atof(argv[++i]);
+        else if(strcmp(argv[i], "--scale") == 0 && i + 1 < argc) fixed_scale = (float)atof(argv[++i]);
+        else if(strcmp(argv[i], "--quality-ladder") == 0 && i + 1 < argc) quality_ladder = argv[++i];
+        else if(strcmp(argv[i], "--quality") == 0 && i + 1 < argc) quality_level = argv[++i];
+        else if(strcmp(argv[i], "--post") == 0 && i + 1 < argc) {
+            i++;
+
+            if(post_setting_count < RHINO_POST_EFFECTS * 2) post_settings[post_setting_count++] = argv[i];
+        }
+        else if(strcmp(argv[i], "--upscale") == 0 && i + 1 < argc) {
+            i++;
+
+            if(strcmp(argv[i], "bilinear") == 0) upscale_filter = RHINO_UPSCALE_BILINEAR;
+            else if(strcmp(argv[i], "sharpen") == 0) upscale_filter = RHINO_UPSCALE_SHARPEN;
+            else printf("\nunknown upscale filter %s, using sharpen", argv[i]);
+        }
+        else if(strcmp(argv[i], "--renderer") == 0 && i + 1 < argc) {
+            i++;
+
+            if(strcmp(argv[i], "deferred") == 0) rhino.renderer = RHINO_RENDERER_DEFERRED;
+            else if(strcmp(argv[i], "forward") == 0) rhino.renderer = RHINO_RENDERER_FORWARD;
+            else printf("\nunknown renderer %s, using forward", argv[i]);
+        }
+    }
+
+    // init opengl, set version and profile (core profile)
+
+    glfwInit();
+
+    // job system before anything that spreads work over it, the benchmark needs nothing else
+
+    rhino_jobs_init(&rhino.jobs, job_threads);
+
+    if(jobs_benchmark) {
+        bench_jobs(&rhino.jobs);
+
+        rhino_jobs_destroy(&rhino.jobs);
+        glfwTerminate();
+
+        return 0;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    // headless runs still need a context, the window is just never shown
+
+    if(headless.enabled) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    // init opengl window (fullscreen, change glfwGetPrimaryMonitor to NULL if you so need/desire windowed mode)
+
+    GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Rhino Framework", NULL, NULL);
+
+    rhino.window = window;
+
+    window_width = WINDOW_WIDTH;
+    window_height = WINDOW_HEIGHT;
+
+    if (window == NULL) {
+        printf("\nfailed to create a glfw window.");
+        glfwTerminate();
+        return -1;
+    }
+
+    // events go through rhino.events to the render thread, requests come back through rhino.requests
+
+    rhino_event_queue_init(&rhino.events);
+    rhino_event_queue_init(&rhino.requests);
+    rhino_events_install(window);
+    rhino_input_init(&rhino.input);
+
+    // headless runs and the benchmark draw every frame, they are measuring it
+
+    on_demand = on_demand && !headless.enabled && !bench.enabled;
+
+    rhino_redraw_init(&rhino.redraw, on_demand);
+
+    // uploads run on a hidden window's context sharing objects with this one, made here since only the main thread
+    // may create windows and before the render thread makes the main context current
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* loader_context = glfwCreateWindow(1, 1, "Rhino Loader", NULL, window);
+
+    if(!loader_context) printf("\nfailed to create the loader's shared context, uploads stay on the render thread");
+
+    // sizes the render thread starts from, later changes arrive as events
+
+    static demo_settings settings;
+
+    settings.window = window;
+    glfwGetFramebufferSize(window, &settings.framebuffer_width, &settings.framebuffer_height);
+    glfwGetWindowSize(window, &rhino.mouse.window_width, &rhino.mouse.window_height);
+
+    settings.bench = bench;
+    settings.headless = headless;
+    settings.use_lightmap = use_lightmap;
+    settings.target_ms = target_ms;
+    settings.fixed_scale = fixed_scale;
+    settings.upscale_filter = upscale_filter;
+    settings.quality_ladder = quality_ladder;
+    settings.quality_level = quality_level;
+    settings.post_setting_count = post_setting_count;
+
+    for(int i = 0; i < post_setting_count; i++) settings.post_settings[i] = post_settings[i];
+
+    atomic_init(&settings.done, false);
+
+    // screen details
+
+    const GLFWvidmode * mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+
+    // headless runs and the light benchmark measure how fast frames can go, they are never paced
+
+    settings.pacing_mode = headless.enabled || bench.enabled ? RHINO_PACING_UNLIMITED : pacing_mode;
+
+    // without on demand rendering everything animates like before
+
+    settings.lights_animated = !on_demand || lights_animated;
+    settings.crate_animated = !on_demand || crate_animated;
+    settings.frames_in_flight = frames_in_flight;
+    settings.capture_path = capture_path;
+    settings.loader_context = loader_context;
+    settings.target_fps = target_fps;
+    settings.refresh_rate = mode ? mode->refreshRate : 0;
+
+    // capture mouse
+
+    if(!headless.enabled) glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);  
+
+    // raw motion only applies while the cursor is disabled, glfw switches it along with the cursor mode
+
+    if(raw_mouse) {
+        if(glfwRawMouseMotionSupported()) glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+        else printf("\nraw mouse motion is not supported here, using the accelerated cursor");
+    }
+
+    // rendering moves to a thread of its own so a window being dragged or resized never stalls a frame. this thread
+    // only waits on window events and carries out the render thread's requests until it is done
+
+    pthread_t renderer;
+    pthread_create(&renderer, NULL, render_thread, &settings);
+
+    while(!atomic_load(&settings.done)) {
+        glfwWaitEvents();
+
+        rhino_event request;
+
+        while(rhino_event_pop(&rhino.requests, &request)) handle_request(window, mode, &request);
+    }
+
+    pthread_join(renderer, NULL);
+
+    if(loader_context) glfwDestroyWindow(loader_context);
+
+    unsigned int dropped = atomic_load(&rhino.events.dropped);
+
+    if(dropped) printf("\n%u window events dropped, the render thread fell behind", dropped);
+
+    rhino_redraw_destroy(&rhino.redraw);
+    rhino_jobs_destroy(&rhino.jobs);
     glfwTerminate();
 
+    if(settings.result != 0) return settings.result;
+
     printf("\nexited program successfully");
 
     return 0;
-}
\ No newline at end of file
+}
+
+
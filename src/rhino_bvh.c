@@ -0,0 +1,733 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_bvh.h"
+
+// deeper subtrees are forced into a leaf, keeps the fixed traversal stack safe
+
+#define MAX_DEPTH 60
+#define STACK_SIZE (MAX_DEPTH + 4)
+
+// sah will not keep a leaf bigger than this even when splitting looks more expensive
+
+#define MAX_SAH_LEAF_SIZE 16
+
+typedef struct build_task_t {
+    unsigned int node;
+    unsigned int first;
+    unsigned int count;
+    unsigned int depth;
+} build_task;
+
+typedef struct bin_t {
+    float min[3];
+    float max[3];
+    unsigned int count;
+} bin;
+
+static void bounds_reset(float* min, float* max) {
+    for(int i = 0; i < 3; i++) {
+        min[i] = FLT_MAX;
+        max[i] = -FLT_MAX;
+    }
+}
+
+static void bounds_grow(float* min, float* max, const float* other_min, const float* other_max) {
+    for(int i = 0; i < 3; i++) {
+        if(other_min[i] < min[i]) min[i] = other_min[i];
+        if(other_max[i] > max[i]) max[i] = other_max[i];
+    }
+}
+
+static float bounds_area(const float* min, const float* max) {
+    float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+
+    if(dx < 0.0f || dy < 0.0f || dz < 0.0f) return 0.0f;
+
+    return dx * dy + dy * dz + dz * dx;
+}
+
+void rhino_bvh_build(rhino_bvh* bvh, const float* bounds, unsigned int count) {
+    memset(bvh, 0, sizeof(rhino_bvh));
+
+    if(count == 0) return;
+
+    bvh->primitive_count = count;
+    bvh->primitives = malloc(count * sizeof(unsigned int));
+    bvh->nodes = malloc((2 * count - 1) * sizeof(rhino_bvh_node));
+
+    float* centroids = malloc(count * 3 * sizeof(float));
+
+    for(unsigned int i = 0; i < count; i++) {
+        bvh->primitives[i] = i;
+
+        for(int k = 0; k < 3; k++) centroids[i * 3 + k] = (bounds[i * 6 + k] + bounds[i * 6 + 3 + k]) * 0.5f;
+    }
+
+    // depth first with an explicit stack, children are always allocated as a consecutive pair
+
+    build_task* tasks = malloc((count + 1) * sizeof(build_task));
+    unsigned int task_count = 0;
+
+    tasks[task_count++] = (build_task){ 0, 0, count, 0 };
+    bvh->node_count = 1;
+
+    while(task_count > 0) {
+        build_task task = tasks[--task_count];
+        rhino_bvh_node* node = &bvh->nodes[task.node];
+
+        float centroid_min[3], centroid_max[3];
+
+        bounds_reset(node->min, node->max);
+        bounds_reset(centroid_min, centroid_max);
+
+        for(unsigned int i = task.first; i < task.first + task.count; i++) {
+            unsigned int p = bvh->primitives[i];
+
+            bounds_grow(node->min, node->max, &bounds[p * 6], &bounds[p * 6 + 3]);
+            bounds_grow(centroid_min, centroid_max, &centroids[p * 3], &centroids[p * 3]);
+        }
+
+        node->first = task.first;
+        node->count = task.count;
+
+        if(task.count <= RHINO_BVH_MAX_LEAF_SIZE || task.depth >= MAX_DEPTH) continue;
+
+        // split along the widest centroid axis
+
+        int axis = 0;
+
+        for(int k = 1; k < 3; k++) {
+            if(centroid_max[k] - centroid_min[k] > centroid_max[axis] - centroid_min[axis]) axis = k;
+        }
+
+        float extent = centroid_max[axis] - centroid_min[axis];
+        unsigned int split = task.first + task.count / 2;
+
+        if(extent > 0.0f) {
+            bin bins[RHINO_BVH_BINS];
+
+            for(int b = 0; b < RHINO_BVH_BINS; b++) {
+                bounds_reset(bins[b].min, bins[b].max);
+                bins[b].count = 0;
+            }
+
+            float scale = RHINO_BVH_BINS / extent;
+
+            for(unsigned int i = task.first; i < task.first + task.count; i++) {
+                unsigned int p = bvh->primitives[i];
+                int b = (int)((centroids[p * 3 + axis] - centroid_min[axis]) * scale);
+
+                if(b >= RHINO_BVH_BINS) b = RHINO_BVH_BINS - 1;
+
+                bins[b].count++;
+                bounds_grow(bins[b].min, bins[b].max, &bounds[p * 6], &bounds[p * 6 + 3]);
+            }
+
+            // sweep from the right so every split plane knows its right hand cost
+
+            float right_area[RHINO_BVH_BINS];
+            unsigned int right_count[RHINO_BVH_BINS];
+            float sweep_min[3], sweep_max[3];
+            unsigned int sweep_count = 0;
+
+            bounds_reset(sweep_min, sweep_max);
+
+            for(int b = RHINO_BVH_BINS - 1; b > 0; b--) {
+                bounds_grow(sweep_min, sweep_max, bins[b].min, bins[b].max);
+                sweep_count += bins[b].count;
+                right_area[b] = bounds_area(sweep_min, sweep_max);
+                right_count[b] = sweep_count;
+            }
+
+            float best_cost = FLT_MAX;
+            int best_bin = -1;
+
+            bounds_reset(sweep_min, sweep_max);
+            sweep_count = 0;
+
+            for(int b = 1; b < RHINO_BVH_BINS; b++) {
+                bounds_grow(sweep_min, sweep_max, bins[b - 1].min, bins[b - 1].max);
+                sweep_count += bins[b - 1].count;
+
+                if(sweep_count == 0 || right_count[b] == 0) continue;
+
+                float cost = bounds_area(sweep_min, sweep_max) * sweep_count + right_area[b] * right_count[b];
+
+                if(cost < best_cost) {
+                    best_cost = cost;
+                    best_bin = b;
+                }
+            }
+
+            // splitting costs one extra box test, compare against intersecting everything in place
+
+            float leaf_cost = bounds_area(node->min, node->max) * task.count;
+
+            if(best_bin < 0 || (best_cost + bounds_area(node->min, node->max) >= leaf_cost && task.count <= MAX_SAH_LEAF_SIZE)) continue;
+
+            // partition primitives around the chosen bin boundary
+
+            unsigned int i = task.first;
+            unsigned int j = task.first + task.count;
+
+            while(i < j) {
+                unsigned int p = bvh->primitives[i];
+                int b = (int)((centroids[p * 3 + axis] - centroid_min[axis]) * scale);
+
+                if(b >= RHINO_BVH_BINS) b = RHINO_BVH_BINS - 1;
+
+                if(b < best_bin) {
+                    i++;
+                }
+                else {
+                    bvh->primitives[i] = bvh->primitives[--j];
+                    bvh->primitives[j] = p;
+                }
+            }
+
+            if(i != task.first && i != task.first + task.count) split = i;
+        }
+        else if(task.count <= MAX_SAH_LEAF_SIZE) {
+            // all centroids coincide, nothing to gain from splitting a small set
+            continue;
+        }
+
+        unsigned int left = bvh->node_count;
+
+        bvh->node_count += 2;
+
+        node->first = left;
+        node->count = 0;
+
+        tasks[task_count++] = (build_task){ left + 1, split, task.first + task.count - split, task.depth + 1 };
+        tasks[task_count++] = (build_task){ left, task.first, split - task.first, task.depth + 1 };
+    }
+
+    free(tasks);
+    free(centroids);
+}
+
+void rhino_bvh_build_triangles(rhino_bvh* bvh, const float* positions, unsigned int stride, const unsigned int* indices, unsigned int triangle_count) {
+    float* bounds = malloc(triangle_count * 6 * sizeof(float));
+
+    for(unsigned int i = 0; i < triangle_count; i++) {
+        float* b = &bounds[i * 6];
+
+        bounds_reset(b, b + 3);
+
+        for(int k = 0; k < 3; k++) {
+            const float* p = &positions[indices[i * 3 + k] * stride];
+            bounds_grow(b, b + 3, p, p);
+        }
+    }
+
+    rhino_bvh_build(bvh, bounds, triangle_count);
+
+    free(bounds);
+}
+
+// slab test, returns the entry distance or FLT_MAX when the box is missed or further than max_t
+
+static float ray_box(const rhino_bvh_node* node, const float* origin, const float* inv_direction, float max_t) {
+    float t_min = 0.0f, t_max = max_t;
+
+    for(int k = 0; k < 3; k++) {
+        float t0 = (node->min[k] - origin[k]) * inv_direction[k];
+        float t1 = (node->max[k] - origin[k]) * inv_direction[k];
+
+        if(t0 > t1) {
+            float swap = t0;
+            t0 = t1;
+            t1 = swap;
+        }
+
+        if(t0 > t_min) t_min = t0;
+        if(t1 < t_max) t_max = t1;
+
+        if(t_min > t_max) return FLT_MAX;
+    }
+
+    return t_min;
+}
+
+typedef struct triangle_context_t {
+    const float* positions;
+    unsigned int stride;
+    const unsigned int* indices;
+} triangle_context;
+
+static bool triangle_hit(void* user, unsigned int primitive, vec3 origin, vec3 direction, float* t) {
+    triangle_context* context = user;
+
+    const unsigned int* tri = &context->indices[primitive * 3];
+    const float* positions = context->positions;
+
+    float d;
+
+    if(!glm_ray_triangle(origin, direction, (float*)&positions[tri[0] * context->stride], (float*)&positions[tri[1] * context->stride], (float*)&positions[tri[2] * context->stride], &d)) return false;
+
+    if(d >= *t) return false;
+
+    *t = d;
+
+    return true;
+}
+
+bool rhino_bvh_intersect(rhino_bvh* bvh, vec3 origin, vec3 direction, float* t, unsigned int* hit, rhino_bvh_hit_fn fn, void* user) {
+    if(bvh->node_count == 0) return false;
+
+    vec3 inv_direction = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+
+    if(ray_box(&bvh->nodes[0], origin, inv_direction, *t) == FLT_MAX) return false;
+
+    unsigned int stack[STACK_SIZE];
+    unsigned int stack_count = 0;
+    bool found = false;
+
+    stack[stack_count++] = 0;
+
+    // visit the nearer child first so the closest hit so far rejects as many boxes as possible
+
+    while(stack_count > 0) {
+        rhino_bvh_node* node = &bvh->nodes[stack[--stack_count]];
+
+        if(node->count > 0) {
+            for(unsigned int i = node->first; i < node->first + node->count; i++) {
+                if(fn(user, bvh->primitives[i], origin, direction, t)) {
+                    *hit = bvh->primitives[i];
+                    found = true;
+                }
+            }
+
+            continue;
+        }
+
+        float t_near = ray_box(&bvh->nodes[node->first], origin, inv_direction, *t);
+        float t_far = ray_box(&bvh->nodes[node->first + 1], origin, inv_direction, *t);
+
+        unsigned int near = node->first, far = node->first + 1;
+
+        if(t_far < t_near) {
+            float swap = t_near;
+            t_near = t_far;
+            t_far = swap;
+            near = node->first + 1;
+            far = node->first;
+        }
+
+        if(t_far != FLT_MAX) stack[stack_count++] = far;
+        if(t_near != FLT_MAX) stack[stack_count++] = near;
+    }
+
+    return found;
+}
+
+bool rhino_bvh_intersect_triangles(rhino_bvh* bvh, const float* positions, unsigned int stride, const unsigned int* indices, vec3 origin, vec3 direction, float* t, unsigned int* hit) {
+    triangle_context context = { positions, stride, indices };
+
+    return rhino_bvh_intersect(bvh, origin, direction, t, hit, triangle_hit, &context);
+}
+
+void rhino_bvh_destroy(rhino_bvh* bvh) {
+    free(bvh->nodes);
+    free(bvh->primitives);
+
+    memset(bvh, 0, sizeof(rhino_bvh));
+}
+
+// ---- four wide bvh ---- //
+
+typedef struct collapse_task_t {
+    unsigned int node;
+    unsigned int wide;
+} collapse_task;
+
+static void fill_packets(rhino_bvh4* wide, const rhino_bvh* bvh, const rhino_bvh_node* leaf, const float* positions, unsigned int stride, const unsigned int* indices) {
+    for(unsigned int i = 0; i < leaf->count; i += 4) {
+        rhino_bvh4_packet* packet = &wide->packets[wide->packet_count++];
+
+        memset(packet, 0, sizeof(rhino_bvh4_packet));
+
+        for(unsigned int lane = 0; lane < 4; lane++) {
+            if(i + lane >= leaf->count) {
+                packet->primitive[lane] = RHINO_BVH4_EMPTY;
+                continue;
+            }
+
+            unsigned int primitive = bvh->primitives[leaf->first + i + lane];
+            const float* a = &positions[indices[primitive * 3] * stride];
+            const float* b = &positions[indices[primitive * 3 + 1] * stride];
+            const float* c = &positions[indices[primitive * 3 + 2] * stride];
+
+            for(int k = 0; k < 3; k++) {
+                packet->v0[k][lane] = a[k];
+                packet->edge1[k][lane] = b[k] - a[k];
+                packet->edge2[k][lane] = c[k] - a[k];
+            }
+
+            packet->primitive[lane] = primitive;
+        }
+    }
+}
+
+void rhino_bvh4_build_triangles(rhino_bvh4* wide, const float* positions, unsigned int stride, const unsigned int* indices, unsigned int triangle_count) {
+    memset(wide, 0, sizeof(rhino_bvh4));
+
+    if(triangle_count == 0) return;
+
+    rhino_bvh bvh;
+    rhino_bvh_build_triangles(&bvh, positions, stride, indices, triangle_count);
+
+    // every wide node swallows at least one binary interior node, every leaf fills at least one packet
+
+    wide->nodes = malloc(bvh.node_count * sizeof(rhino_bvh4_node));
+    wide->packets = malloc(triangle_count * sizeof(rhino_bvh4_packet));
+
+    collapse_task* tasks = malloc(bvh.node_count * sizeof(collapse_task));
+    unsigned int task_count = 0;
+
+    tasks[task_count++] = (collapse_task){ 0, wide->node_count++ };
+
+    while(task_count > 0) {
+        collapse_task task = tasks[--task_count];
+
+        // open up the biggest interior child until there are four, a binary leaf at the root stays a single child
+
+        unsigned int children[4];
+        int child_count = 0;
+
+        rhino_bvh_node* node = &bvh.nodes[task.node];
+
+        if(node->count > 0) children[child_count++] = task.node;
+        else {
+            children[child_count++] = node->first;
+            children[child_count++] = node->first + 1;
+        }
+
+        while(child_count < 4) {
+            int best = -1;
+            float best_area = -1.0f;
+
+            for(int i = 0; i < child_count; i++) {
+                rhino_bvh_node* child = &bvh.nodes[children[i]];
+                float area = bounds_area(child->min, child->max);
+
+                if(child->count == 0 && area > best_area) {
+                    best = i;
+                    best_area = area;
+                }
+            }
+
+            if(best < 0) break;
+
+            unsigned int opened = children[best];
+
+            children[best] = bvh.nodes[opened].first;
+            children[child_count++] = bvh.nodes[opened].first + 1;
+        }
+
+        rhino_bvh4_node* out = &wide->nodes[task.wide];
+
+        for(int lane = 0; lane < 4; lane++) {
+            if(lane >= child_count) {
+                // inverted box, fails the slab test from any direction
+
+                for(int k = 0; k < 3; k++) {
+                    out->bounds[k][lane] = FLT_MAX;
+                    out->bounds[k + 3][lane] = -FLT_MAX;
+                }
+
+                out->child[lane] = RHINO_BVH4_EMPTY;
+                out->count[lane] = 0;
+
+                continue;
+            }
+
+            rhino_bvh_node* child = &bvh.nodes[children[lane]];
+
+            for(int k = 0; k < 3; k++) {
+                out->bounds[k][lane] = child->min[k];
+                out->bounds[k + 3][lane] = child->max[k];
+            }
+
+            if(child->count > 0) {
+                out->child[lane] = wide->packet_count;
+                fill_packets(wide, &bvh, child, positions, stride, indices);
+                out->count[lane] = wide->packet_count - out->child[lane];
+            }
+            else {
+                out->child[lane] = wide->node_count++;
+                out->count[lane] = 0;
+
+                tasks[task_count++] = (collapse_task){ children[lane], out->child[lane] };
+            }
+        }
+    }
+
+    free(tasks);
+    rhino_bvh_destroy(&bvh);
+}
+
+// per ray constants, near and far pick the box planes the ray enters and leaves through on each axis so an
+// inverted (empty) box can never pass
+
+typedef struct wide_ray_t {
+    float origin[3];
+    float direction[3];
+    float inv_direction[3];
+    int near[3];
+    int far[3];
+} wide_ray;
+
+static void wide_ray_setup(wide_ray* ray, vec3 origin, vec3 direction) {
+    for(int k = 0; k < 3; k++) {
+        ray->origin[k] = origin[k];
+        ray->direction[k] = direction[k];
+        ray->inv_direction[k] = 1.0f / direction[k];
+        ray->near[k] = ray->inv_direction[k] < 0.0f ? k + 3 : k;
+        ray->far[k] = ray->inv_direction[k] < 0.0f ? k : k + 3;
+    }
+}
+
+// entry distance of each child box in t_near, returns a mask of the boxes hit before max_t
+
+static int wide_boxes(const rhino_bvh4_node* node, const wide_ray* ray, float max_t, float* t_near) {
+#if defined(__SSE2__)
+    __m128 t_min = _mm_setzero_ps();
+    __m128 t_max = _mm_set1_ps(max_t);
+
+    for(int k = 0; k < 3; k++) {
+        __m128 origin = _mm_set1_ps(ray->origin[k]);
+        __m128 inv = _mm_set1_ps(ray->inv_direction[k]);
+
+        t_min = _mm_max_ps(t_min, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->bounds[ray->near[k]]), origin), inv));
+        t_max = _mm_min_ps(t_max, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->bounds[ray->far[k]]), origin), inv));
+    }
+
+    _mm_storeu_ps(t_near, t_min);
+
+    return _mm_movemask_ps(_mm_cmple_ps(t_min, t_max));
+#else
+    int mask = 0;
+
+    for(int lane = 0; lane < 4; lane++) {
+        float t_min = 0.0f, t_max = max_t;
+
+        for(int k = 0; k < 3; k++) {
+            float t0 = (node->bounds[ray->near[k]][lane] - ray->origin[k]) * ray->inv_direction[k];
+            float t1 = (node->bounds[ray->far[k]][lane] - ray->origin[k]) * ray->inv_direction[k];
+
+            if(t0 > t_min) t_min = t0;
+            if(t1 < t_max) t_max = t1;
+        }
+
+        t_near[lane] = t_min;
+
+        if(t_min <= t_max) mask |= 1 << lane;
+    }
+
+    return mask;
+#endif
+}
+
+// distance to each triangle of the packet, returns a mask of the ones hit closer than max_t
+
+static int wide_triangles(const rhino_bvh4_packet* packet, const wide_ray* ray, float max_t, float* t_hit) {
+#if defined(__SSE2__)
+    __m128 dx = _mm_set1_ps(ray->direction[0]), dy = _mm_set1_ps(ray->direction[1]), dz = _mm_set1_ps(ray->direction[2]);
+
+    __m128 e1x = _mm_loadu_ps(packet->edge1[0]), e1y = _mm_loadu_ps(packet->edge1[1]), e1z = _mm_loadu_ps(packet->edge1[2]);
+    __m128 e2x = _mm_loadu_ps(packet->edge2[0]), e2y = _mm_loadu_ps(packet->edge2[1]), e2z = _mm_loadu_ps(packet->edge2[2]);
+
+    // p = d x e2, det = e1 . p
+
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+    // degenerate lanes divide by zero, every comparison against the resulting inf / nan fails
+
+    __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+    __m128 sx = _mm_sub_ps(_mm_set1_ps(ray->origin[0]), _mm_loadu_ps(packet->v0[0]));
+    __m128 sy = _mm_sub_ps(_mm_set1_ps(ray->origin[1]), _mm_loadu_ps(packet->v0[1]));
+    __m128 sz = _mm_sub_ps(_mm_set1_ps(ray->origin[2]), _mm_loadu_ps(packet->v0[2]));
+
+    __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv_det);
+
+    // q = s x e1
+
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+    __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv_det);
+    __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv_det);
+
+    __m128 zero = _mm_setzero_ps();
+
+    __m128 hit = _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+    hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, _mm_set1_ps(max_t))));
+
+    _mm_storeu_ps(t_hit, t);
+
+    return _mm_movemask_ps(hit);
+#else
+    int mask = 0;
+
+    for(int lane = 0; lane < 4; lane++) {
+        vec3 e1 = { packet->edge1[0][lane], packet->edge1[1][lane], packet->edge1[2][lane] };
+        vec3 e2 = { packet->edge2[0][lane], packet->edge2[1][lane], packet->edge2[2][lane] };
+        vec3 s = { ray->origin[0] - packet->v0[0][lane], ray->origin[1] - packet->v0[1][lane], ray->origin[2] - packet->v0[2][lane] };
+        vec3 p, q;
+
+        glm_vec3_cross((float*)ray->direction, e2, p);
+
+        float det = glm_vec3_dot(e1, p);
+
+        if(det == 0.0f) continue;
+
+        float inv_det = 1.0f / det;
+        float u = glm_vec3_dot(s, p) * inv_det;
+
+        glm_vec3_cross(s, e1, q);
+
+        float v = glm_vec3_dot((float*)ray->direction, q) * inv_det;
+        float t = glm_vec3_dot(e2, q) * inv_det;
+
+        t_hit[lane] = t;
+
+        if(u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > 0.0f && t < max_t) mask |= 1 << lane;
+    }
+
+    return mask;
+#endif
+}
+
+bool rhino_bvh4_intersect(rhino_bvh4* bvh, vec3 origin, vec3 direction, float* t, unsigned int* hit) {
+    if(bvh->node_count == 0) return false;
+
+    wide_ray ray;
+    wide_ray_setup(&ray, origin, direction);
+
+    unsigned int stack[STACK_SIZE * 3];
+    unsigned int stack_count = 0;
+    bool found = false;
+
+    stack[stack_count++] = 0;
+
+    while(stack_count > 0) {
+        rhino_bvh4_node* node = &bvh->nodes[stack[--stack_count]];
+
+        float t_near[4];
+        int mask = wide_boxes(node, &ray, *t, t_near);
+
+        // leaves are tested on the spot, interior children go on the stack furthest first
+
+        unsigned int order[4];
+        float order_t[4];
+        int order_count = 0;
+
+        while(mask) {
+            int lane = __builtin_ctz(mask);
+            mask &= mask - 1;
+
+            if(node->count[lane] > 0) {
+                for(unsigned int p = node->child[lane]; p < node->child[lane] + node->count[lane]; p++) {
+                    rhino_bvh4_packet* packet = &bvh->packets[p];
+
+                    float t_hit[4];
+                    int hits = wide_triangles(packet, &ray, *t, t_hit);
+
+                    while(hits) {
+                        int h = __builtin_ctz(hits);
+                        hits &= hits - 1;
+
+                        if(t_hit[h] < *t) {
+                            *t = t_hit[h];
+                            *hit = packet->primitive[h];
+                            found = true;
+                        }
+                    }
+                }
+
+                continue;
+            }
+
+            int i = order_count++;
+
+            while(i > 0 && order_t[i - 1] < t_near[lane]) {
+                order[i] = order[i - 1];
+                order_t[i] = order_t[i - 1];
+                i--;
+            }
+
+            order[i] = node->child[lane];
+            order_t[i] = t_near[lane];
+        }
+
+        for(int i = 0; i < order_count; i++) {
+            if(order_t[i] < *t) stack[stack_count++] = order[i];
+        }
+    }
+
+    return found;
+}
+
+bool rhino_bvh4_occluded(rhino_bvh4* bvh, vec3 origin, vec3 direction, float max_t) {
+    if(bvh->node_count == 0) return false;
+
+    wide_ray ray;
+    wide_ray_setup(&ray, origin, direction);
+
+    unsigned int stack[STACK_SIZE * 3];
+    unsigned int stack_count = 0;
+
+    stack[stack_count++] = 0;
+
+    while(stack_count > 0) {
+        rhino_bvh4_node* node = &bvh->nodes[stack[--stack_count]];
+
+        float t_near[4];
+        int mask = wide_boxes(node, &ray, max_t, t_near);
+
+        while(mask) {
+            int lane = __builtin_ctz(mask);
+            mask &= mask - 1;
+
+            if(node->count[lane] == 0) {
+                stack[stack_count++] = node->child[lane];
+                continue;
+            }
+
+            for(unsigned int p = node->child[lane]; p < node->child[lane] + node->count[lane]; p++) {
+                float t_hit[4];
+
+                if(wide_triangles(&bvh->packets[p], &ray, max_t, t_hit)) return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void rhino_bvh4_destroy(rhino_bvh4* bvh) {
+    free(bvh->nodes);
+    free(bvh->packets);
+
+    memset(bvh, 0, sizeof(rhino_bvh4));
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+// leaves hold at most this many primitives, sah may stop splitting earlier
+
+#define RHINO_BVH_MAX_LEAF_SIZE 4
+#define RHINO_BVH_BINS 12
+
+// 32 byte node, interior nodes have count 0 and their children at first and first + 1,
+// leaves reference primitives[first .. first + count)
+
+typedef struct rhino_bvh_node_t {
+    float min[3];
+    unsigned int first;
+    float max[3];
+    unsigned int count;
+} rhino_bvh_node;
+
+typedef struct rhino_bvh_t {
+    rhino_bvh_node* nodes;
+    unsigned int node_count;
+    unsigned int* primitives;
+    unsigned int primitive_count;
+} rhino_bvh;
+
+// called for every primitive in a leaf the ray reaches, returns true and writes t if the primitive is hit closer than *t
+
+typedef bool (*rhino_bvh_hit_fn)(void* user, unsigned int primitive, vec3 origin, vec3 direction, float* t);
+
+// builds from primitive bounds, 6 floats per primitive (min xyz then max xyz)
+
+void rhino_bvh_build(rhino_bvh* bvh, const float* bounds, unsigned int count);
+
+// builds over an indexed triangle list, primitive i is triangle i. stride is in floats between positions
+
+void rhino_bvh_build_triangles(rhino_bvh* bvh, const float* positions, unsigned int stride, const unsigned int* indices, unsigned int triangle_count);
+
+// closest hit along origin + direction * t for t < *t, returns the primitive index through hit
+
+bool rhino_bvh_intersect(rhino_bvh* bvh, vec3 origin, vec3 direction, float* t, unsigned int* hit, rhino_bvh_hit_fn fn, void* user);
+
+// same as above with an exact glm_ray_triangle test, for bvhs built by rhino_bvh_build_triangles
+
+bool rhino_bvh_intersect_triangles(rhino_bvh* bvh, const float* positions, unsigned int stride, const unsigned int* indices, vec3 origin, vec3 direction, float* t, unsigned int* hit);
+
+void rhino_bvh_destroy(rhino_bvh* bvh);
+
+// four wide bvh for tracing lots of rays, collapsed from the binary one. a node keeps its children's boxes side by
+// side so one simd test covers all four, leaves keep their triangles in packets of four tested together
+
+#define RHINO_BVH4_EMPTY 0xffffffffu
+
+// bounds are min xyz then max xyz, each across the four children. child is a node index, the first packet of a
+// leaf or RHINO_BVH4_EMPTY, count is the leaf's packet count and 0 for interior children
+
+typedef struct rhino_bvh4_node_t {
+    float bounds[6][4];
+    unsigned int child[4];
+    unsigned int count[4];
+} rhino_bvh4_node;
+
+// moller-trumbore ready triangles, unused lanes are degenerate and never hit
+
+typedef struct rhino_bvh4_packet_t {
+    float v0[3][4];
+    float edge1[3][4];
+    float edge2[3][4];
+    unsigned int primitive[4];
+} rhino_bvh4_packet;
+
+typedef struct rhino_bvh4_t {
+    rhino_bvh4_node* nodes;
+    unsigned int node_count;
+    rhino_bvh4_packet* packets;
+    unsigned int packet_count;
+} rhino_bvh4;
+
+// same inputs as rhino_bvh_build_triangles, the triangles are copied into the packets so positions can go away
+
+void rhino_bvh4_build_triangles(rhino_bvh4* bvh, const float* positions, unsigned int stride, const unsigned int* indices, unsigned int triangle_count);
+
+// closest triangle along origin + direction * t for t < *t
+
+bool rhino_bvh4_intersect(rhino_bvh4* bvh, vec3 origin, vec3 direction, float* t, unsigned int* hit);
+
+// true as soon as anything is hit before max_t, for shadow rays
+
+bool rhino_bvh4_occluded(rhino_bvh4* bvh, vec3 origin, vec3 direction, float max_t);
+
+void rhino_bvh4_destroy(rhino_bvh4* bvh);
@@ -23,55 +23,86 @@ void rhino_start() {
 
 void rhino_input_update() {
     // quick escape
-    if(glfwGetKey(rhino.window, GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(rhino.window, true);
+    if(rhino_input_down(&rhino.input, RHINO_ACTION_QUIT)) glfwSetWindowShouldClose(rhino.window, true);
 
-    if(glfwGetKey(rhino.window, GLFW_KEY_LEFT_SHIFT)) rhino.cam.mov_speed = CAMERA_MOV_SPEED * 2;
-    else rhino.cam.mov_speed = CAMERA_MOV_SPEED;
+    // movement keys go to the simulation, which moves the camera at its own tick rate
 
-    // side movement
+    unsigned int buttons = 0;
 
-    vec3 delta_time_vec;
-    glm_vec3((vec4){rhino.cam.mov_speed * rhino.delta_time, rhino.cam.mov_speed * rhino.delta_time, rhino.cam.mov_speed * rhino.delta_time, 1.0f}, delta_time_vec);
+    if(rhino_input_down(&rhino.input, RHINO_ACTION_FORWARD)) buttons |= RHINO_SIM_FORWARD;
+    if(rhino_input_down(&rhino.input, RHINO_ACTION_BACK)) buttons |= RHINO_SIM_BACK;
+    if(rhino_input_down(&rhino.input, RHINO_ACTION_LEFT)) buttons |= RHINO_SIM_LEFT;
+    if(rhino_input_down(&rhino.input, RHINO_ACTION_RIGHT)) buttons |= RHINO_SIM_RIGHT;
+    if(rhino_input_down(&rhino.input, RHINO_ACTION_UP)) buttons |= RHINO_SIM_UP;
+    if(rhino_input_down(&rhino.input, RHINO_ACTION_DOWN)) buttons |= RHINO_SIM_DOWN;
+    if(rhino_input_down(&rhino.input, RHINO_ACTION_FAST)) buttons |= RHINO_SIM_FAST;
 
-    vec3 cam_cross;
-    glm_cross(rhino.cam.direction, rhino.cam.up, cam_cross);
-    glm_normalize(cam_cross);
-    
-    vec3 to_apply_side;
-    glm_vec3_mul(delta_time_vec, cam_cross, to_apply_side);
+    rhino_sim_input(&rhino.sim, buttons);
+
+    // mouse look, the cursor's movement over the whole frame goes to the simulation at once. picking uses the
+    // cursor while it is unlocked
 
-    // in and out movement
+    double x_delta, y_delta;
+    rhino_input_mouse_delta(&rhino.input, &x_delta, &y_delta);
 
-    vec3 to_apply_in_out;
-    glm_vec3_mul(delta_time_vec, rhino.cam.front, to_apply_in_out);
+    if(!rhino.mouse.unlocked) rhino_sim_look(&rhino.sim, x_delta * rhino.mouse.sens, -y_delta * rhino.mouse.sens);
 
-    vec3 to_apply_up_down;
-    glm_vec3_mul(delta_time_vec, rhino.cam.up, to_apply_up_down);
+    rhino.mouse.x_pos = rhino.input.cursor_x;
+    rhino.mouse.y_pos = rhino.input.cursor_y;
 
-    if(glfwGetKey(rhino.window, GLFW_KEY_W)) 
-        glm_vec3_add(rhino.cam.posititon, to_apply_in_out, rhino.cam.posititon);
-    else if(glfwGetKey(rhino.window, GLFW_KEY_S)) 
-        glm_vec3_sub(rhino.cam.posititon, to_apply_in_out, rhino.cam.posititon);
+    // level of detail toggles, l for lod selection and k for dithered cross-fades
 
-    if(glfwGetKey(rhino.window, GLFW_KEY_D)) 
-        glm_vec3_add(rhino.cam.posititon, to_apply_side, rhino.cam.posititon);
-    else if(glfwGetKey(rhino.window, GLFW_KEY_A)) 
-        glm_vec3_sub(rhino.cam.posititon, to_apply_side, rhino.cam.posititon);
+    if(rhino_input_pressed(&rhino.input, RHINO_ACTION_TOGGLE_LOD)) {
+        rhino.lod.enabled = !rhino.lod.enabled;
+        printf("\nlod %s", rhino.lod.enabled ? "on" : "off");
+    }
 
-    if(glfwGetKey(rhino.window, GLFW_KEY_SPACE)) 
-        glm_vec3_add(rhino.cam.posititon, to_apply_up_down, rhino.cam.posititon);
-    else if(glfwGetKey(rhino.window, GLFW_KEY_LEFT_CONTROL)) 
-        glm_vec3_sub(rhino.cam.posititon, to_apply_up_down, rhino.cam.posititon);
+    if(rhino_input_pressed(&rhino.input, RHINO_ACTION_TOGGLE_CROSSFADE)) {
+        rhino.lod.crossfade = !rhino.lod.crossfade;
+        printf("\nlod cross-fade %s", rhino.lod.crossfade ? "on" : "off");
+    }
 
-    // unlock or lock mouse
+    // r switches between forward and deferred shading
 
-    if(glfwGetKey(rhino.window, GLFW_KEY_U) == GLFW_PRESS) {
-        rhino.mouse.unlocked = !rhino.mouse.unlocked;
+    if(rhino_input_pressed(&rhino.input, RHINO_ACTION_TOGGLE_RENDERER)) {
+        rhino.renderer = rhino.renderer == RHINO_RENDERER_FORWARD ? RHINO_RENDERER_DEFERRED : RHINO_RENDERER_FORWARD;
+        printf("\nrenderer %s", rhino.renderer == RHINO_RENDERER_FORWARD ? "forward" : "deferred");
+    }
+
+    // v switches between dynamic resolution and full resolution, b between the sharpening and bilinear upscale
+
+    if(rhino_input_pressed(&rhino.input, RHINO_ACTION_TOGGLE_RESOLUTION)) {
+        rhino.resolution.dynamic = !rhino.resolution.dynamic;
+
+        if(!rhino.resolution.dynamic) rhino.resolution.scale = RHINO_RESOLUTION_MAX_SCALE;
+
+        printf("\ndynamic resolution %s", rhino.resolution.dynamic ? "on" : "off");
+    }
 
-        glfwWaitEventsTimeout(0.5);
+    if(rhino_input_pressed(&rhino.input, RHINO_ACTION_TOGGLE_UPSCALE)) {
+        rhino.resolution.filter = rhino.resolution.filter == RHINO_UPSCALE_SHARPEN ? RHINO_UPSCALE_BILINEAR : RHINO_UPSCALE_SHARPEN;
+        printf("\nupscale %s", rhino.resolution.filter == RHINO_UPSCALE_SHARPEN ? "sharpened" : "bilinear");
+    }
+
+    // g stops the quality governor where it is or hands control back to it
+
+    if(rhino_input_pressed(&rhino.input, RHINO_ACTION_TOGGLE_GOVERNOR)) {
+        rhino.quality.enabled = !rhino.quality.enabled;
+        printf("\nquality governor %s at %s", rhino.quality.enabled ? "on" : "off", rhino_quality_current(&rhino.quality)->name);
+    }
+
+    // 1, 2 and 3 switch bloom, ssao and fog on and off
+
+    for(int i = 0; i < RHINO_POST_EFFECTS; i++) {
+        if(rhino_input_pressed(&rhino.input, RHINO_ACTION_TOGGLE_BLOOM + i)) rhino_post_toggle(&rhino.post, (rhino_post_effect_id)i);
+    }
+
+    // unlock or lock mouse, the cursor mode belongs to the main thread so it is asked to switch it
+
+    if(rhino_input_pressed(&rhino.input, RHINO_ACTION_UNLOCK_MOUSE)) {
+        rhino.mouse.unlocked = !rhino.mouse.unlocked;
 
-        if(rhino.mouse.unlocked) glfwSetInputMode(rhino.window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);  
-        else glfwSetInputMode(rhino.window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);  
+        rhino_events_request(RHINO_REQUEST_CURSOR_MODE, rhino.mouse.unlocked ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
     }
 }
 
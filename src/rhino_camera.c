@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_camera.h"
+
+// moving or turning the camera leaves the projection alone, everything derived from the view goes stale
+
+#define VIEW_CHANGED (RHINO_CAMERA_VIEW_DIRTY | RHINO_CAMERA_VIEW_PROJ_DIRTY | RHINO_CAMERA_INVERSE_DIRTY | RHINO_CAMERA_FRUSTUM_DIRTY)
+#define PROJECTION_CHANGED (RHINO_CAMERA_PROJECTION_DIRTY | RHINO_CAMERA_VIEW_PROJ_DIRTY | RHINO_CAMERA_INVERSE_DIRTY | RHINO_CAMERA_FRUSTUM_DIRTY)
+
+static void camera_init(rhino_camera* camera, float near_plane, float far_plane) {
+    memset(camera, 0, sizeof(rhino_camera));
+
+    glm_quat_identity(camera->orientation);
+
+    camera->near_plane = near_plane;
+    camera->far_plane = far_plane;
+    camera->dirty = RHINO_CAMERA_ALL_DIRTY;
+}
+
+void rhino_camera_init_perspective(rhino_camera* camera, float fov, float aspect, float near_plane, float far_plane) {
+    camera_init(camera, near_plane, far_plane);
+
+    camera->fov = fov;
+    camera->aspect = aspect;
+}
+
+void rhino_camera_init_orthographic(rhino_camera* camera, float left, float right, float bottom, float top, float near_plane, float far_plane) {
+    camera_init(camera, near_plane, far_plane);
+
+    camera->orthographic = true;
+    camera->left = left;
+    camera->right = right;
+    camera->bottom = bottom;
+    camera->top = top;
+}
+
+void rhino_camera_set_aspect(rhino_camera* camera, float aspect) {
+    if(aspect == camera->aspect) return;
+
+    camera->aspect = aspect;
+    camera->dirty |= PROJECTION_CHANGED;
+}
+
+void rhino_camera_set_fov(rhino_camera* camera, float fov) {
+    if(fov == camera->fov) return;
+
+    camera->fov = fov;
+    camera->dirty |= PROJECTION_CHANGED;
+}
+
+void rhino_camera_set_orthographic(rhino_camera* camera, float left, float right, float bottom, float top, float near_plane, float far_plane) {
+    if(left == camera->left && right == camera->right && bottom == camera->bottom && top == camera->top && near_plane == camera->near_plane && far_plane == camera->far_plane) return;
+
+    camera->left = left;
+    camera->right = right;
+    camera->bottom = bottom;
+    camera->top = top;
+    camera->near_plane = near_plane;
+    camera->far_plane = far_plane;
+    camera->dirty |= PROJECTION_CHANGED;
+}
+
+void rhino_camera_set_position(rhino_camera* camera, vec3 position) {
+    glm_vec3_copy(position, camera->position);
+    camera->dirty |= VIEW_CHANGED;
+}
+
+void rhino_camera_move(rhino_camera* camera, vec3 offset) {
+    glm_vec3_add(camera->position, offset, camera->position);
+    camera->dirty |= VIEW_CHANGED;
+}
+
+void rhino_camera_set_orientation(rhino_camera* camera, versor orientation) {
+    glm_quat_copy(orientation, camera->orientation);
+    glm_quat_normalize(camera->orientation);
+    camera->dirty |= VIEW_CHANGED;
+}
+
+void rhino_camera_look_at(rhino_camera* camera, vec3 target, vec3 up) {
+    vec3 direction;
+    glm_vec3_sub(target, camera->position, direction);
+
+    glm_quat_for(direction, up, camera->orientation);
+    camera->dirty |= VIEW_CHANGED;
+}
+
+void rhino_camera_rotate(rhino_camera* camera, float yaw, float pitch) {
+    // clamp against the current pitch, read back from the front vector
+
+    vec3 front;
+    rhino_camera_front(camera, front);
+
+    float current_pitch = asinf(glm_clamp(front[1], -1.0f, 1.0f));
+    float max_pitch = glm_rad(RHINO_CAMERA_MAX_PITCH);
+
+    pitch = glm_clamp(current_pitch + pitch, -max_pitch, max_pitch) - current_pitch;
+
+    // yaw in world space (left multiply), pitch in camera space (right multiply)
+
+    versor yaw_rotation, pitch_rotation;
+
+    glm_quatv(yaw_rotation, -yaw, (vec3){0.0f, 1.0f, 0.0f});
+    glm_quatv(pitch_rotation, pitch, (vec3){1.0f, 0.0f, 0.0f});
+
+    versor yawed;
+
+    glm_quat_mul(yaw_rotation, camera->orientation, yawed);
+    glm_quat_mul(yawed, pitch_rotation, camera->orientation);
+    glm_quat_normalize(camera->orientation);
+
+    camera->dirty |= VIEW_CHANGED;
+}
+
+void rhino_camera_front(rhino_camera* camera, vec3 dest) {
+    glm_quat_rotatev(camera->orientation, (vec3){0.0f, 0.0f, -1.0f}, dest);
+}
+
+void rhino_camera_right(rhino_camera* camera, vec3 dest) {
+    glm_quat_rotatev(camera->orientation, (vec3){1.0f, 0.0f, 0.0f}, dest);
+}
+
+void rhino_camera_up(rhino_camera* camera, vec3 dest) {
+    glm_quat_rotatev(camera->orientation, (vec3){0.0f, 1.0f, 0.0f}, dest);
+}
+
+vec4* rhino_camera_view(rhino_camera* camera) {
+    if(camera->dirty & RHINO_CAMERA_VIEW_DIRTY) {
+        glm_quat_look(camera->position, camera->orientation, camera->view);
+        camera->dirty &= ~RHINO_CAMERA_VIEW_DIRTY;
+    }
+
+    return camera->view;
+}
+
+vec4* rhino_camera_projection(rhino_camera* camera) {
+    if(camera->dirty & RHINO_CAMERA_PROJECTION_DIRTY) {
+        if(camera->orthographic) glm_ortho(camera->left, camera->right, camera->bottom, camera->top, camera->near_plane, camera->far_plane, camera->projection);
+        else glm_perspective(camera->fov, camera->aspect, camera->near_plane, camera->far_plane, camera->projection);
+
+        camera->dirty &= ~RHINO_CAMERA_PROJECTION_DIRTY;
+    }
+
+    return camera->projection;
+}
+
+vec4* rhino_camera_view_proj(rhino_camera* camera) {
+    if(camera->dirty & RHINO_CAMERA_VIEW_PROJ_DIRTY) {
+        glm_mat4_mul(rhino_camera_projection(camera), rhino_camera_view(camera), camera->view_proj);
+        camera->dirty &= ~RHINO_CAMERA_VIEW_PROJ_DIRTY;
+    }
+
+    return camera->view_proj;
+}
+
+vec4* rhino_camera_inv_view_proj(rhino_camera* camera) {
+    if(camera->dirty & RHINO_CAMERA_INVERSE_DIRTY) {
+        glm_mat4_inv(rhino_camera_view_proj(camera), camera->inv_view_proj);
+        camera->dirty &= ~RHINO_CAMERA_INVERSE_DIRTY;
+    }
+
+    return camera->inv_view_proj;
+}
+
+vec4* rhino_camera_frustum(rhino_camera* camera) {
+    if(camera->dirty & RHINO_CAMERA_FRUSTUM_DIRTY) {
+        glm_frustum_planes(rhino_camera_view_proj(camera), camera->planes);
+        camera->dirty &= ~RHINO_CAMERA_FRUSTUM_DIRTY;
+    }
+
+    return camera->planes;
+}
+
+float rhino_camera_pixels_per_unit(rhino_camera* camera, float viewport_height) {
+    return viewport_height / (2.0f * tanf(camera->fov * 0.5f));
+}
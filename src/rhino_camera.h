@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+// which cached products are stale, setters mark them and the getters rebuild only what they need
+
+#define RHINO_CAMERA_VIEW_DIRTY (1 << 0)
+#define RHINO_CAMERA_PROJECTION_DIRTY (1 << 1)
+#define RHINO_CAMERA_VIEW_PROJ_DIRTY (1 << 2)
+#define RHINO_CAMERA_INVERSE_DIRTY (1 << 3)
+#define RHINO_CAMERA_FRUSTUM_DIRTY (1 << 4)
+
+#define RHINO_CAMERA_ALL_DIRTY 0x1f
+
+// pitch is kept this far away from straight up or down so the view never flips
+
+#define RHINO_CAMERA_MAX_PITCH 89.0f
+
+// a view into the world, the main view, shadow views, probes and split screen views are all one of these.
+// orientation maps the camera's local axes (looking down -z, +y up) into world space
+
+typedef struct rhino_camera_t {
+    vec3 position;
+    versor orientation;
+
+    // perspective uses fov (radians) and aspect, orthographic uses the extents
+
+    bool orthographic;
+    float fov, aspect;
+    float left, right, bottom, top;
+    float near_plane, far_plane;
+
+    // cached, only valid through the getters below
+
+    mat4 view;
+    mat4 projection;
+    mat4 view_proj;
+    mat4 inv_view_proj;
+    vec4 planes[6];
+    int dirty;
+} rhino_camera;
+
+void rhino_camera_init_perspective(rhino_camera* camera, float fov, float aspect, float near_plane, float far_plane);
+
+void rhino_camera_init_orthographic(rhino_camera* camera, float left, float right, float bottom, float top, float near_plane, float far_plane);
+
+// projection setters only dirty the camera when the value actually changed
+
+void rhino_camera_set_aspect(rhino_camera* camera, float aspect);
+
+void rhino_camera_set_fov(rhino_camera* camera, float fov);
+
+// new extents for an orthographic camera, shadow cascades refit these every frame
+
+void rhino_camera_set_orthographic(rhino_camera* camera, float left, float right, float bottom, float top, float near_plane, float far_plane);
+
+void rhino_camera_set_position(rhino_camera* camera, vec3 position);
+
+void rhino_camera_move(rhino_camera* camera, vec3 offset);
+
+void rhino_camera_set_orientation(rhino_camera* camera, versor orientation);
+
+void rhino_camera_look_at(rhino_camera* camera, vec3 target, vec3 up);
+
+// fps style rotation, yaw turns right around world up and pitch looks up around the local right axis
+
+void rhino_camera_rotate(rhino_camera* camera, float yaw, float pitch);
+
+// world space basis vectors of the camera
+
+void rhino_camera_front(rhino_camera* camera, vec3 dest);
+
+void rhino_camera_right(rhino_camera* camera, vec3 dest);
+
+void rhino_camera_up(rhino_camera* camera, vec3 dest);
+
+// cached matrices and frustum planes (glm_frustum_planes order), rebuilt on demand
+
+vec4* rhino_camera_view(rhino_camera* camera);
+
+vec4* rhino_camera_projection(rhino_camera* camera);
+
+vec4* rhino_camera_view_proj(rhino_camera* camera);
+
+vec4* rhino_camera_inv_view_proj(rhino_camera* camera);
+
+vec4* rhino_camera_frustum(rhino_camera* camera);
+
+// screen height in pixels of a unit sized object one unit away, converts object space errors to pixels.
+// perspective cameras only
+
+float rhino_camera_pixels_per_unit(rhino_camera* camera, float viewport_height);
@@ -0,0 +1,561 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// rhino headers
+
+#include "rhino_capture.h"
+#include "rhino_global.h"
+
+// stored deflate blocks hold at most this many bytes, the pngs are not compressed so encoding stays cheap enough
+// for every frame
+
+#define STORED_BLOCK 65535
+
+// longest a numbered png adds to the prefix, an unsigned frame number at most ten digits
+
+#define PNG_SUFFIX "_0000000000.png"
+
+static unsigned int crc_table[256];
+
+static void build_crc_table(void) {
+    for(unsigned int n = 0; n < 256; n++) {
+        unsigned int c = n;
+
+        for(int k = 0; k < 8; k++) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+
+        crc_table[n] = c;
+    }
+}
+
+static unsigned int crc(unsigned int c, const unsigned char* data, size_t size) {
+    for(size_t i = 0; i < size; i++) c = crc_table[(c ^ data[i]) & 0xff] ^ (c >> 8);
+
+    return c;
+}
+
+static unsigned int adler32(const unsigned char* data, size_t size) {
+    unsigned int a = 1, b = 0;
+
+    // 5552 bytes is the most that can be summed before b could overflow
+
+    while(size > 0) {
+        size_t run = size < 5552 ? size : 5552;
+
+        for(size_t i = 0; i < run; i++) {
+            a += data[i];
+            b += a;
+        }
+
+        a %= 65521;
+        b %= 65521;
+
+        data += run;
+        size -= run;
+    }
+
+    return (b << 16) | a;
+}
+
+static void put_u32(unsigned char* p, unsigned int value) {
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+}
+
+static size_t write_chunk(FILE* file, const char* type, const unsigned char* data, size_t size) {
+    unsigned char header[8], footer[4];
+
+    put_u32(header, (unsigned int)size);
+    memcpy(&header[4], type, 4);
+
+    put_u32(footer, crc(crc(0xffffffffu, &header[4], 4), data, size) ^ 0xffffffffu);
+
+    fwrite(header, 1, sizeof(header), file);
+    if(size) fwrite(data, 1, size, file);
+    fwrite(footer, 1, sizeof(footer), file);
+
+    return size + 12;
+}
+
+// rgb png of a bottom up rgba readback, returns the bytes written
+
+static size_t write_png(const char* path, const unsigned char* pixels, int width, int height) {
+    FILE* file = fopen(path, "wb");
+
+    if(!file) {
+        printf("\ncould not write %s", path);
+        return 0;
+    }
+
+    // rows flipped to top down, each behind its filter byte (none)
+
+    size_t row = 1 + (size_t)width * 3;
+    size_t raw_size = row * height;
+    unsigned char* raw = malloc(raw_size);
+
+    for(int y = 0; y < height; y++) {
+        const unsigned char* source = &pixels[(size_t)(height - 1 - y) * width * 4];
+        unsigned char* dest = &raw[row * y];
+
+        *dest++ = 0;
+
+        for(int x = 0; x < width; x++) {
+            *dest++ = source[x * 4];
+            *dest++ = source[x * 4 + 1];
+            *dest++ = source[x * 4 + 2];
+        }
+    }
+
+    // zlib stream of stored blocks
+
+    size_t blocks = raw_size ? (raw_size + STORED_BLOCK - 1) / STORED_BLOCK : 1;
+    size_t zlib_size = 2 + blocks * 5 + raw_size + 4;
+    unsigned char* zlib = malloc(zlib_size);
+    unsigned char* out = zlib;
+
+    *out++ = 0x78;
+    *out++ = 0x01;
+
+    for(size_t offset = 0, block = 0; block < blocks; block++) {
+        size_t size = raw_size - offset < STORED_BLOCK ? raw_size - offset : STORED_BLOCK;
+
+        *out++ = block == blocks - 1 ? 1 : 0;
+        *out++ = (unsigned char)size;
+        *out++ = (unsigned char)(size >> 8);
+        *out++ = (unsigned char)~size;
+        *out++ = (unsigned char)(~size >> 8);
+
+        memcpy(out, &raw[offset], size);
+
+        out += size;
+        offset += size;
+    }
+
+    put_u32(out, adler32(raw, raw_size));
+
+    unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    unsigned char header[13] = { 0 };
+
+    put_u32(&header[0], (unsigned int)width);
+    put_u32(&header[4], (unsigned int)height);
+    header[8] = 8;
+    header[9] = 2;
+
+    fwrite(signature, 1, sizeof(signature), file);
+
+    size_t bytes = sizeof(signature);
+
+    bytes += write_chunk(file, "IHDR", header, sizeof(header));
+    bytes += write_chunk(file, "IDAT", zlib, zlib_size);
+    bytes += write_chunk(file, "IEND", NULL, 0);
+
+    fclose(file);
+    free(raw);
+    free(zlib);
+
+    return bytes;
+}
+
+static size_t yuv_size(int width, int height) {
+    return (size_t)width * height + 2 * (size_t)((width + 1) / 2) * ((height + 1) / 2);
+}
+
+static unsigned char clamp_byte(int value) {
+    return value < 0 ? 0 : value > 255 ? 255 : (unsigned char)value;
+}
+
+// full range bt.601 4:2:0, what the C420jpeg tag says. chroma is taken from the average of each 2x2 block
+
+static void convert_yuv(const unsigned char* pixels, int width, int height, unsigned char* yuv) {
+    int chroma_width = (width + 1) / 2, chroma_height = (height + 1) / 2;
+
+    unsigned char* luma = yuv;
+    unsigned char* cb = &yuv[(size_t)width * height];
+    unsigned char* cr = &cb[(size_t)chroma_width * chroma_height];
+
+    for(int y = 0; y < height; y++) {
+        const unsigned char* source = &pixels[(size_t)(height - 1 - y) * width * 4];
+
+        for(int x = 0; x < width; x++) {
+            const unsigned char* p = &source[x * 4];
+
+            luma[(size_t)y * width + x] = (unsigned char)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+        }
+    }
+
+    for(int y = 0; y < chroma_height; y++) {
+        for(int x = 0; x < chroma_width; x++) {
+            int r = 0, g = 0, b = 0;
+
+            for(int k = 0; k < 4; k++) {
+                int sx = x * 2 + (k & 1), sy = y * 2 + (k >> 1);
+
+                if(sx >= width) sx = width - 1;
+                if(sy >= height) sy = height - 1;
+
+                const unsigned char* p = &pixels[((size_t)(height - 1 - sy) * width + sx) * 4];
+
+                r += p[0];
+                g += p[1];
+                b += p[2];
+            }
+
+            r /= 4; g /= 4; b /= 4;
+
+            cb[(size_t)y * chroma_width + x] = clamp_byte((-43 * r - 85 * g + 128 * b + 32896) >> 8);
+            cr[(size_t)y * chroma_width + x] = clamp_byte((128 * r - 107 * g - 21 * b + 32896) >> 8);
+        }
+    }
+}
+
+void rhino_capture_init(rhino_capture* capture, const char* path, double fps) {
+    memset(capture, 0, sizeof(rhino_capture));
+
+    build_crc_table();
+
+    pthread_mutex_init(&capture->lock, NULL);
+    atomic_init(&capture->encoding.value, 0);
+
+    capture->fps = fps > 0.0 ? fps : 60.0;
+
+    for(int i = 0; i < RHINO_CAPTURE_RING; i++) {
+        rhino_capture_slot* slot = &capture->slots[i];
+
+        slot->capture = capture;
+        atomic_init(&slot->state, RHINO_CAPTURE_FREE);
+
+        glGenBuffers(1, &slot->pbo);
+    }
+
+    if(!path) return;
+
+    size_t length = strlen(path);
+    rhino_capture_format format = length > 4 && strcmp(&path[length - 4], ".y4m") == 0 ? RHINO_CAPTURE_Y4M : RHINO_CAPTURE_PNG;
+
+    // a cut short name could land on some other file, or every frame on the same one
+
+    size_t room = format == RHINO_CAPTURE_PNG ? sizeof(capture->slots[0].path) - strlen(PNG_SUFFIX) : sizeof(capture->path);
+
+    if(length >= room) {
+        printf("\ncapture path %s is too long, capturing nothing", path);
+        return;
+    }
+
+    capture->format = format;
+    snprintf(capture->path, sizeof(capture->path), "%s", path);
+
+    if(capture->format == RHINO_CAPTURE_Y4M) printf("\ncapturing every frame to %s at %.0f fps", path, capture->fps);
+    else printf("\ncapturing every frame to %s_N.png", path);
+}
+
+void rhino_capture_screenshot(rhino_capture* capture) {
+    capture->screenshot = true;
+}
+
+// writes every converted video frame whose turn has come, the lock is held
+
+static void write_video(rhino_capture* capture) {
+    bool wrote = true;
+
+    while(wrote) {
+        wrote = false;
+
+        for(int i = 0; i < RHINO_CAPTURE_RING; i++) {
+            rhino_capture_slot* slot = &capture->slots[i];
+
+            if(!slot->converted || slot->frame != capture->next_write) continue;
+
+            fputs("FRAME\n", capture->video);
+            fwrite(slot->yuv, 1, yuv_size(slot->width, slot->height), capture->video);
+
+            capture->stats.bytes += 6 + yuv_size(slot->width, slot->height);
+            capture->next_write++;
+
+            slot->converted = false;
+            atomic_store(&slot->state, RHINO_CAPTURE_FREE);
+
+            wrote = true;
+        }
+    }
+}
+
+static void encode_job(void* data, int begin, int end) {
+    rhino_capture_slot* slot = data;
+    rhino_capture* capture = slot->capture;
+
+    double start = glfwGetTime();
+    size_t bytes = 0;
+
+    if(slot->path[0]) bytes = write_png(slot->path, slot->pixels, slot->width, slot->height);
+    if(slot->video) convert_yuv(slot->pixels, slot->width, slot->height, slot->yuv);
+
+    pthread_mutex_lock(&capture->lock);
+
+    capture->stats.written++;
+    capture->stats.encode_seconds += glfwGetTime() - start;
+    capture->stats.bytes += bytes;
+
+    // frames finish out of order on the workers, the video takes them in order
+
+    if(slot->video) {
+        slot->converted = true;
+        write_video(capture);
+    }
+    else atomic_store(&slot->state, RHINO_CAPTURE_FREE);
+
+    pthread_mutex_unlock(&capture->lock);
+}
+
+// copies a readback whose fence passed out of its buffer and queues its encode
+
+static void finish_readback(rhino_capture* capture, rhino_capture_slot* slot) {
+    size_t size = (size_t)slot->width * slot->height * 4;
+
+    if(slot->pixels_size < size) {
+        slot->pixels = realloc(slot->pixels, size);
+        slot->yuv = realloc(slot->yuv, size);
+        slot->pixels_size = size;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+
+    void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+
+    // a failed map still has to reach the video so the frames after it are not held back, as black
+
+    if(mapped) {
+        memcpy(slot->pixels, mapped, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else {
+        printf("\ncapture could not map the readback of frame %u", slot->frame);
+        memset(slot->pixels, 0, size);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glDeleteSync(slot->fence);
+    slot->fence = NULL;
+
+    atomic_store(&slot->state, RHINO_CAPTURE_ENCODING);
+
+    rhino_jobs_run_background(&rhino.jobs, encode_job, slot, 0, 1, &capture->encoding);
+
+    // without workers the render thread encodes itself
+
+    if(atomic_load(&rhino.jobs.thread_count) < 2) rhino_jobs_wait(&rhino.jobs, &capture->encoding);
+}
+
+static void read_back(rhino_capture* capture, int width, int height) {
+    bool streaming = capture->format != RHINO_CAPTURE_NONE;
+
+    if(streaming) capture->stats.frames++;
+
+    rhino_capture_slot* slot = NULL;
+
+    for(int i = 0; i < RHINO_CAPTURE_RING && !slot; i++) {
+        if(atomic_load(&capture->slots[i].state) == RHINO_CAPTURE_FREE) slot = &capture->slots[i];
+    }
+
+    // every buffer is still on the gpu or with the encoders, a screenshot waits for the next frame
+
+    if(!slot) {
+        if(streaming) capture->stats.dropped++;
+        return;
+    }
+
+    // the video is opened with the first frame, it keeps that size
+
+    bool video = capture->format == RHINO_CAPTURE_Y4M;
+
+    if(video && !capture->video) {
+        capture->video = fopen(capture->path, "wb");
+
+        if(!capture->video) {
+            printf("\ncould not write %s, capture stopped", capture->path);
+            capture->format = RHINO_CAPTURE_NONE;
+            return;
+        }
+
+        capture->video_width = width;
+        capture->video_height = height;
+
+        fprintf(capture->video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, (int)lround(capture->fps));
+    }
+
+    if(video && (width != capture->video_width || height != capture->video_height)) {
+        if(!capture->screenshot) {
+            capture->stats.dropped++;
+            return;
+        }
+
+        video = false;
+    }
+
+    slot->path[0] = '\0';
+
+    // pngs are numbered by the frames seen while capturing, a dropped one leaves a gap
+
+    if(capture->format == RHINO_CAPTURE_PNG) {
+        unsigned int frame = capture->stats.frames + capture->totals.frames - 1;
+
+        if(snprintf(slot->path, sizeof(slot->path), "%s_%06u.png", capture->path, frame) >= (int)sizeof(slot->path)) {
+            printf("\ncapture file name for frame %u does not fit, frame skipped", frame);
+            capture->stats.dropped++;
+            return;
+        }
+    }
+
+    if(capture->screenshot) {
+        if(slot->path[0]) printf("\nscreenshot is %s", slot->path);
+        else {
+            snprintf(slot->path, sizeof(slot->path), "screenshot_%03u.png", capture->screenshots++);
+            printf("\nscreenshot saved to %s", slot->path);
+        }
+
+        capture->screenshot = false;
+    }
+
+    slot->width = width;
+    slot->height = height;
+    slot->video = video;
+    slot->age = 0;
+    slot->late = false;
+
+    if(video) slot->frame = capture->frames++;
+
+    // the copy lands in the buffer whenever the gpu gets to it, nothing waits for it here
+
+    size_t size = (size_t)width * height * 4;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+
+    if(slot->pbo_size != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        slot->pbo_size = size;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)0);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    atomic_store(&slot->state, RHINO_CAPTURE_READING);
+
+    capture->stats.captured++;
+}
+
+void rhino_capture_frame(rhino_capture* capture, int width, int height) {
+    double start = glfwGetTime();
+    bool reading = false;
+
+    // readbacks that landed since the last frame go to the workers first, they may free a buffer for this one
+
+    for(int i = 0; i < RHINO_CAPTURE_RING; i++) {
+        rhino_capture_slot* slot = &capture->slots[i];
+
+        if(atomic_load(&slot->state) != RHINO_CAPTURE_READING) continue;
+
+        if(glClientWaitSync(slot->fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            if(++slot->age > RHINO_CAPTURE_LATE_FRAMES && !slot->late) {
+                slot->late = true;
+                capture->stats.late++;
+            }
+
+            reading = true;
+            continue;
+        }
+
+        finish_readback(capture, slot);
+    }
+
+    if(capture->format != RHINO_CAPTURE_NONE || capture->screenshot) {
+        read_back(capture, width, height);
+        reading = true;
+    }
+
+    // readbacks still out need frames to be polled from when rendering on demand
+
+    if(reading) rhino_redraw_request(&rhino.redraw, RHINO_REDRAW_PROGRESSIVE);
+
+    capture->stats.readback_seconds += glfwGetTime() - start;
+}
+
+static void add_stats(rhino_capture_stats* totals, rhino_capture_stats* stats) {
+    totals->frames += stats->frames;
+    totals->captured += stats->captured;
+    totals->written += stats->written;
+    totals->dropped += stats->dropped;
+    totals->late += stats->late;
+    totals->readback_seconds += stats->readback_seconds;
+    totals->encode_seconds += stats->encode_seconds;
+    totals->bytes += stats->bytes;
+}
+
+void rhino_capture_print_stats(rhino_capture* capture) {
+    pthread_mutex_lock(&capture->lock);
+
+    rhino_capture_stats stats = capture->stats;
+
+    add_stats(&capture->totals, &capture->stats);
+    memset(&capture->stats, 0, sizeof(rhino_capture_stats));
+
+    pthread_mutex_unlock(&capture->lock);
+
+    if(capture->format == RHINO_CAPTURE_NONE && stats.captured == 0) return;
+
+    unsigned int frames = stats.frames ? stats.frames : 1;
+    unsigned int written = stats.written ? stats.written : 1;
+
+    printf("capture : %u of %u frames read back, %u dropped with the ring full, %u stalled on the gpu, %u written (%.1f MB) - render thread %.3f ms per frame, encoding %.2f ms per frame on workers\n",
+        stats.captured, stats.frames, stats.dropped, stats.late, stats.written, stats.bytes / (1024.0 * 1024.0),
+        stats.readback_seconds * 1000.0 / frames, stats.encode_seconds * 1000.0 / written);
+}
+
+void rhino_capture_destroy(rhino_capture* capture) {
+    // the last few frames are still on their way, wait for them this once
+
+    for(int i = 0; i < RHINO_CAPTURE_RING; i++) {
+        rhino_capture_slot* slot = &capture->slots[i];
+
+        if(atomic_load(&slot->state) != RHINO_CAPTURE_READING) continue;
+
+        while(glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+
+        finish_readback(capture, slot);
+    }
+
+    rhino_jobs_wait(&rhino.jobs, &capture->encoding);
+
+    add_stats(&capture->totals, &capture->stats);
+
+    rhino_capture_stats* totals = &capture->totals;
+
+    if(capture->format != RHINO_CAPTURE_NONE) {
+        printf("\ncapture : %u of %u frames written to %s, %u dropped with the ring full, %u stalled on the gpu, %.1f MB",
+            totals->written, totals->frames, capture->path, totals->dropped, totals->late, totals->bytes / (1024.0 * 1024.0));
+    }
+
+    if(capture->video) fclose(capture->video);
+
+    for(int i = 0; i < RHINO_CAPTURE_RING; i++) {
+        rhino_capture_slot* slot = &capture->slots[i];
+
+        glDeleteBuffers(1, &slot->pbo);
+        free(slot->pixels);
+        free(slot->yuv);
+    }
+
+    pthread_mutex_destroy(&capture->lock);
+
+    memset(capture, 0, sizeof(rhino_capture));
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "rhino_jobs.h"
+
+// framebuffer capture without stalling the frame. each captured frame is read into a pixel pack buffer of a ring,
+// which is mapped frames later once its fence passed, and encoded to png or y4m on the job system's workers. a
+// frame that finds every buffer of the ring still in use is dropped rather than waited for
+
+#define RHINO_CAPTURE_RING 6
+
+// a readback whose fence has not passed after this many frames counts as stalled
+
+#define RHINO_CAPTURE_LATE_FRAMES 3
+
+#define RHINO_CAPTURE_PATH 256
+
+// png writes a numbered file per frame, y4m streams every frame into one 4:2:0 video
+
+typedef enum rhino_capture_format_t {
+    RHINO_CAPTURE_NONE,
+    RHINO_CAPTURE_PNG,
+    RHINO_CAPTURE_Y4M
+} rhino_capture_format;
+
+typedef enum rhino_capture_state_t {
+    RHINO_CAPTURE_FREE,
+    RHINO_CAPTURE_READING,
+    RHINO_CAPTURE_ENCODING
+} rhino_capture_state;
+
+// path is the png to write, empty when the frame only goes to the video. frame orders the video's frames, a
+// converted one waits in its slot until every frame before it is written
+
+typedef struct rhino_capture_slot_t {
+    struct rhino_capture_t* capture;
+
+    unsigned int pbo;
+    size_t pbo_size;
+    GLsync fence;
+    int age;
+    bool late;
+
+    atomic_int state;
+
+    unsigned int frame;
+    int width, height;
+    bool video;
+    bool converted;
+    char path[RHINO_CAPTURE_PATH];
+
+    unsigned char* pixels;
+    unsigned char* yuv;
+    size_t pixels_size;
+} rhino_capture_slot;
+
+// taken and reset by rhino_capture_print_stats. readback is the render thread's own cost of capturing, encode the
+// workers'. dropped frames found the ring full, late ones sat on the gpu past RHINO_CAPTURE_LATE_FRAMES
+
+typedef struct rhino_capture_stats_t {
+    unsigned int frames;
+    unsigned int captured;
+    unsigned int written;
+    unsigned int dropped;
+    unsigned int late;
+    double readback_seconds;
+    double encode_seconds;
+    size_t bytes;
+} rhino_capture_stats;
+
+typedef struct rhino_capture_t {
+    rhino_capture_format format;
+    char path[RHINO_CAPTURE_PATH];
+
+    // the video keeps the size it started with, frames of any other size are dropped
+
+    FILE* video;
+    int video_width, video_height;
+    double fps;
+
+    // frames numbered for the stream so far and the next one the video is waiting on
+
+    unsigned int frames;
+    unsigned int next_write;
+
+    unsigned int screenshots;
+    bool screenshot;
+
+    rhino_capture_slot slots[RHINO_CAPTURE_RING];
+
+    // guards the stats the workers add to and the video's write order
+
+    pthread_mutex_t lock;
+    rhino_job_counter encoding;
+
+    rhino_capture_stats stats;
+    rhino_capture_stats totals;
+} rhino_capture;
+
+// path ending in .y4m streams a video at fps, any other path is the prefix of numbered pngs. null only takes
+// screenshots
+
+void rhino_capture_init(rhino_capture* capture, const char* path, double fps);
+
+// the next captured frame is also saved as screenshot_N.png
+
+void rhino_capture_screenshot(rhino_capture* capture);
+
+// call once the frame is in the back buffer, before the swap. hands finished readbacks to the workers and starts
+// reading this frame back when it is captured
+
+void rhino_capture_frame(rhino_capture* capture, int width, int height);
+
+void rhino_capture_print_stats(rhino_capture* capture);
+
+// waits for every readback and encode still out, closes the video and reports the whole capture
+
+void rhino_capture_destroy(rhino_capture* capture);
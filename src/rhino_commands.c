@@ -0,0 +1,234 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// rhino headers
+
+#include "rhino_commands.h"
+#include "rhino_global.h"
+
+#define INITIAL_COMMANDS 256
+#define INITIAL_BLOCKS 64
+
+void rhino_commands_init(rhino_commands* commands) {
+    memset(commands, 0, sizeof(rhino_commands));
+}
+
+static void record_job(void* data, int begin, int end) {
+    rhino_commands* commands = data;
+
+    for(int i = begin; i < end; i++) {
+        rhino_command_buffer* buffer = &commands->buffers[i];
+
+        double start = glfwGetTime();
+        commands->recorder(buffer, i, commands->count, commands->data);
+        buffer->record_seconds = glfwGetTime() - start;
+    }
+}
+
+void rhino_commands_record(rhino_commands* commands, int parts, rhino_command_recorder recorder, void* data) {
+    if(parts < 1) parts = 1;
+    if(parts > RHINO_COMMANDS_MAX_BUFFERS) parts = RHINO_COMMANDS_MAX_BUFFERS;
+
+    for(int i = 0; i < parts; i++) {
+        rhino_command_buffer* buffer = &commands->buffers[i];
+
+        buffer->count = 0;
+        buffer->block_count = 0;
+        buffer->record_seconds = 0.0;
+        memset(&buffer->counters, 0, sizeof(rhino_command_counters));
+    }
+
+    commands->count = parts;
+    commands->recorder = recorder;
+    commands->data = data;
+
+    double start = glfwGetTime();
+
+    rhino_jobs_parallel_for(&rhino.jobs, parts, 1, record_job, commands);
+
+    commands->stats.record_seconds += glfwGetTime() - start;
+
+    for(int i = 0; i < parts; i++) commands->stats.record_work_seconds += commands->buffers[i].record_seconds;
+}
+
+// unit -1 and ~0 names match nothing a command binds
+
+static void reset_cache(rhino_command_cache* cache) {
+    memset(cache, 0xff, sizeof(rhino_command_cache));
+}
+
+static void bind_texture(rhino_command_cache* cache, unsigned int unit, unsigned int texture, unsigned int* dropped) {
+    bool tracked = unit < RHINO_COMMANDS_TEXTURE_UNITS;
+
+    if(tracked && cache->textures[unit] == texture) {
+        (*dropped)++;
+        return;
+    }
+
+    if(cache->unit != (int)unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        cache->unit = (int)unit;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    if(tracked) cache->textures[unit] = texture;
+}
+
+void rhino_commands_replay(rhino_commands* commands, rhino_uniforms* uniforms) {
+    double start = glfwGetTime();
+
+    // every buffer's blocks land in one contiguous range each, a single flush uploads them all
+
+    unsigned int bases[RHINO_COMMANDS_MAX_BUFFERS];
+
+    for(int i = 0; i < commands->count; i++) {
+        rhino_command_buffer* buffer = &commands->buffers[i];
+
+        bases[i] = 0;
+
+        for(int j = 0; j < buffer->block_count; j++) {
+            unsigned int offset = rhino_uniforms_push(uniforms, &buffer->blocks[j]);
+
+            if(j == 0) bases[i] = offset;
+        }
+    }
+
+    rhino_uniforms_flush(uniforms);
+
+    rhino_command_cache* cache = &commands->cache;
+    reset_cache(cache);
+
+    unsigned int dropped = 0;
+    unsigned int issued = 0;
+
+    for(int i = 0; i < commands->count; i++) {
+        rhino_command_buffer* buffer = &commands->buffers[i];
+
+        for(int j = 0; j < buffer->count; j++) {
+            rhino_command* command = &buffer->commands[j];
+
+            switch(command->type) {
+                case RHINO_COMMAND_PROGRAM:
+                    if(cache->program == command->program.program) dropped++;
+                    else {
+                        glUseProgram(command->program.program);
+                        cache->program = command->program.program;
+                    }
+                    break;
+
+                case RHINO_COMMAND_TEXTURE:
+                    bind_texture(cache, command->texture.unit, command->texture.texture, &dropped);
+                    break;
+
+                case RHINO_COMMAND_OBJECT: {
+                    unsigned int offset = bases[i] + command->object.block * uniforms->stride;
+
+                    if(cache->object == offset) dropped++;
+                    else {
+                        rhino_uniforms_bind_object(uniforms, offset);
+                        cache->object = offset;
+                    }
+                    break;
+                }
+
+                case RHINO_COMMAND_DRAW:
+                    if(cache->vao != command->draw.vao) {
+                        glBindVertexArray(command->draw.vao);
+                        cache->vao = command->draw.vao;
+                    }
+
+                    glDrawElements(GL_TRIANGLES, command->draw.count, GL_UNSIGNED_INT, (GLvoid*)(command->draw.first * sizeof(unsigned int)));
+                    break;
+            }
+        }
+
+        issued += buffer->count;
+
+        rhino.stats.triangles += buffer->counters.triangles;
+        rhino.stats.triangles_full_detail += buffer->counters.triangles_full_detail;
+        rhino.stats.draw_calls += buffer->counters.draw_calls;
+        rhino.stats.lod_fades += buffer->counters.lod_fades;
+    }
+
+    // leave the state the way immediate drawing did
+
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+
+    commands->stats.passes++;
+    commands->stats.buffers += commands->count;
+    commands->stats.commands += issued;
+    commands->stats.dropped += dropped;
+    commands->stats.replay_seconds += glfwGetTime() - start;
+}
+
+static rhino_command* add_command(rhino_command_buffer* buffer, rhino_command_type type) {
+    if(buffer->count == buffer->capacity) {
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : INITIAL_COMMANDS;
+        buffer->commands = realloc(buffer->commands, buffer->capacity * sizeof(rhino_command));
+    }
+
+    rhino_command* command = &buffer->commands[buffer->count++];
+    command->type = type;
+
+    return command;
+}
+
+void rhino_command_program(rhino_command_buffer* buffer, unsigned int program) {
+    add_command(buffer, RHINO_COMMAND_PROGRAM)->program.program = program;
+}
+
+void rhino_command_texture(rhino_command_buffer* buffer, unsigned int unit, unsigned int texture) {
+    rhino_command* command = add_command(buffer, RHINO_COMMAND_TEXTURE);
+
+    command->texture.unit = unit;
+    command->texture.texture = texture;
+}
+
+void rhino_command_object(rhino_command_buffer* buffer, rhino_object_block* block) {
+    if(buffer->block_count == buffer->block_capacity) {
+        buffer->block_capacity = buffer->block_capacity ? buffer->block_capacity * 2 : INITIAL_BLOCKS;
+        buffer->blocks = realloc(buffer->blocks, buffer->block_capacity * sizeof(rhino_object_block));
+    }
+
+    buffer->blocks[buffer->block_count] = *block;
+
+    add_command(buffer, RHINO_COMMAND_OBJECT)->object.block = buffer->block_count++;
+}
+
+void rhino_command_draw(rhino_command_buffer* buffer, unsigned int vao, unsigned int count, unsigned int first) {
+    rhino_command* command = add_command(buffer, RHINO_COMMAND_DRAW);
+
+    command->draw.vao = vao;
+    command->draw.count = count;
+    command->draw.first = first;
+
+    buffer->counters.triangles += count / 3;
+    buffer->counters.draw_calls++;
+}
+
+void rhino_commands_print_stats(rhino_commands* commands) {
+    rhino_commands_stats* stats = &commands->stats;
+
+    if(stats->passes == 0) return;
+
+    printf("commands : %.1f buffers and %.1f commands per pass, %.0f%% redundant state dropped - recorded in %.3f ms (%.3f ms of work across threads) replayed in %.3f ms per pass\n",
+        (double)stats->buffers / stats->passes, (double)stats->commands / stats->passes, stats->commands ? stats->dropped * 100.0 / stats->commands : 0.0,
+        stats->record_seconds * 1000.0 / stats->passes, stats->record_work_seconds * 1000.0 / stats->passes, stats->replay_seconds * 1000.0 / stats->passes);
+
+    memset(stats, 0, sizeof(rhino_commands_stats));
+}
+
+void rhino_commands_destroy(rhino_commands* commands) {
+    for(int i = 0; i < RHINO_COMMANDS_MAX_BUFFERS; i++) {
+        free(commands->buffers[i].commands);
+        free(commands->buffers[i].blocks);
+    }
+
+    memset(commands, 0, sizeof(rhino_commands));
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "rhino_uniforms.h"
+#include "rhino_jobs.h"
+
+// command buffers. gl calls can only be made on the render thread, so workers record what a pass draws into
+// buffers of engine commands instead, a part of the scene each, and the render thread replays them one after the
+// other in part order. the order never depends on which worker finished first, so neither does the frame
+
+#define RHINO_COMMANDS_MAX_BUFFERS 32
+
+// texture units the replay keeps track of, units past it are always bound
+
+#define RHINO_COMMANDS_TEXTURE_UNITS 8
+
+typedef enum rhino_command_type_t {
+    RHINO_COMMAND_PROGRAM,
+    RHINO_COMMAND_TEXTURE,
+    RHINO_COMMAND_OBJECT,
+    RHINO_COMMAND_DRAW
+} rhino_command_type;
+
+// object is the index of a block recorded into the same buffer, draw takes indices from the vao's element buffer
+
+typedef struct rhino_command_t {
+    rhino_command_type type;
+
+    union {
+        struct { unsigned int program; } program;
+        struct { unsigned int unit, texture; } texture;
+        struct { unsigned int block; } object;
+        struct { unsigned int vao, count, first; } draw;
+    };
+} rhino_command;
+
+// what the draws of a buffer add to rhino.stats, recording never touches it so workers do not race on it
+
+typedef struct rhino_command_counters_t {
+    unsigned int triangles;
+    unsigned int triangles_full_detail;
+    unsigned int draw_calls;
+    unsigned int lod_fades;
+} rhino_command_counters;
+
+// object blocks travel with the commands and go into the uniform buffer when the buffer is replayed
+
+typedef struct rhino_command_buffer_t {
+    rhino_command* commands;
+    int count, capacity;
+
+    rhino_object_block* blocks;
+    int block_count, block_capacity;
+
+    rhino_command_counters counters;
+    double record_seconds;
+} rhino_command_buffer;
+
+// records part of parts of a pass into buffer, on whichever thread the job runs
+
+typedef void (*rhino_command_recorder)(rhino_command_buffer* buffer, int part, int parts, void* data);
+
+// what the render thread last bound through a replay, commands that would bind the same thing again are dropped.
+// reset at the start of every replay since anything outside it may have changed the state
+
+typedef struct rhino_command_cache_t {
+    unsigned int program;
+    unsigned int vao;
+    unsigned int object;
+    int unit;
+    unsigned int textures[RHINO_COMMANDS_TEXTURE_UNITS];
+} rhino_command_cache;
+
+// taken and reset by rhino_commands_print_stats. record is the wall time of the parallel recording, record_work
+// the time every buffer took added up, replay the render thread's time going through the commands
+
+typedef struct rhino_commands_stats_t {
+    unsigned int passes;
+    unsigned int buffers;
+    unsigned int commands;
+    unsigned int dropped;
+    double record_seconds;
+    double record_work_seconds;
+    double replay_seconds;
+} rhino_commands_stats;
+
+typedef struct rhino_commands_t {
+    rhino_command_buffer buffers[RHINO_COMMANDS_MAX_BUFFERS];
+    int count;
+
+    // the recording in progress
+
+    rhino_command_recorder recorder;
+    void* data;
+
+    rhino_command_cache cache;
+    rhino_commands_stats stats;
+} rhino_commands;
+
+void rhino_commands_init(rhino_commands* commands);
+
+// records parts buffers (at most RHINO_COMMANDS_MAX_BUFFERS) on the job system and waits for all of them
+
+void rhino_commands_record(rhino_commands* commands, int parts, rhino_command_recorder recorder, void* data);
+
+// render thread only, uploads the recorded object blocks in one go and issues the buffers' commands in order
+
+void rhino_commands_replay(rhino_commands* commands, rhino_uniforms* uniforms);
+
+// recording, any thread as long as each buffer is only recorded by one
+
+void rhino_command_program(rhino_command_buffer* buffer, unsigned int program);
+
+void rhino_command_texture(rhino_command_buffer* buffer, unsigned int unit, unsigned int texture);
+
+// copies the block into the buffer and selects it for the following draws
+
+void rhino_command_object(rhino_command_buffer* buffer, rhino_object_block* block);
+
+void rhino_command_draw(rhino_command_buffer* buffer, unsigned int vao, unsigned int count, unsigned int first);
+
+void rhino_commands_print_stats(rhino_commands* commands);
+
+void rhino_commands_destroy(rhino_commands* commands);
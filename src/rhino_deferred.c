@@ -0,0 +1,69 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+// rhino headers
+
+#include "rhino_deferred.h"
+#include "rhino_uniforms.h"
+#include "rhino_lights.h"
+#include "shaders.h"
+
+void rhino_deferred_init(rhino_deferred* deferred) {
+    memset(deferred, 0, sizeof(rhino_deferred));
+
+    deferred->geometry_program = link_and_compile_shaders("vertex_shader.glsl", "gbuffer_fragment_shader.glsl");
+
+    glUseProgram(deferred->geometry_program);
+    glUniform1i(glGetUniformLocation(deferred->geometry_program, "texture_sample1"), 0);
+    rhino_uniforms_bind_program(deferred->geometry_program);
+
+    deferred->lighting_program = link_and_compile_shaders("deferred_vertex_shader.glsl", "deferred_lighting_shader.glsl");
+
+    glUseProgram(deferred->lighting_program);
+    glUniform1i(glGetUniformLocation(deferred->lighting_program, "gbuffer_albedo"), RHINO_GBUFFER_ALBEDO_UNIT);
+    glUniform1i(glGetUniformLocation(deferred->lighting_program, "gbuffer_normal"), RHINO_GBUFFER_NORMAL_UNIT);
+    glUniform1i(glGetUniformLocation(deferred->lighting_program, "gbuffer_depth"), RHINO_GBUFFER_DEPTH_UNIT);
+    glUniform1i(glGetUniformLocation(deferred->lighting_program, "gbuffer_baked"), RHINO_GBUFFER_BAKED_UNIT);
+    rhino_uniforms_bind_program(deferred->lighting_program);
+    rhino_lights_bind_program(deferred->lighting_program);
+
+    // core profile refuses to draw without a vao bound, even with no attributes
+
+    glGenVertexArrays(1, &deferred->vao);
+}
+
+void rhino_deferred_light(rhino_deferred* deferred, unsigned int albedo, unsigned int normal, unsigned int depth, unsigned int baked) {
+    glActiveTexture(GL_TEXTURE0 + RHINO_GBUFFER_ALBEDO_UNIT);
+    glBindTexture(GL_TEXTURE_2D, albedo);
+    glActiveTexture(GL_TEXTURE0 + RHINO_GBUFFER_NORMAL_UNIT);
+    glBindTexture(GL_TEXTURE_2D, normal);
+    glActiveTexture(GL_TEXTURE0 + RHINO_GBUFFER_DEPTH_UNIT);
+    glBindTexture(GL_TEXTURE_2D, depth);
+    glActiveTexture(GL_TEXTURE0 + RHINO_GBUFFER_BAKED_UNIT);
+    glBindTexture(GL_TEXTURE_2D, baked);
+    glActiveTexture(GL_TEXTURE0);
+
+    // every covered pixel walks its cluster's light list once, empty pixels discard and keep the sky
+
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+
+    glUseProgram(deferred->lighting_program);
+    glBindVertexArray(deferred->vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void rhino_deferred_destroy(rhino_deferred* deferred) {
+    glDeleteProgram(deferred->geometry_program);
+    glDeleteProgram(deferred->lighting_program);
+    glDeleteVertexArrays(1, &deferred->vao);
+
+    memset(deferred, 0, sizeof(rhino_deferred));
+}
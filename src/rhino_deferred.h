@@ -0,0 +1,38 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+// texture units the g-buffer is read from during the lighting pass
+
+#define RHINO_GBUFFER_ALBEDO_UNIT 0
+#define RHINO_GBUFFER_NORMAL_UNIT 1
+#define RHINO_GBUFFER_DEPTH_UNIT 2
+#define RHINO_GBUFFER_BAKED_UNIT 3
+
+// g-buffer layout, rgba8 albedo, rg16f octahedral normal, rgba16f baked light (alpha set where a lightmap was
+// sampled) and a depth-stencil texture that positions are rebuilt from. the targets are transients of the frame
+// graph, the geometry pass writes them as colour attachments 0, 1 and 2 plus depth
+
+#define RHINO_GBUFFER_ALBEDO_FORMAT GL_RGBA8
+#define RHINO_GBUFFER_NORMAL_FORMAT GL_RG16F
+#define RHINO_GBUFFER_BAKED_FORMAT GL_RGBA16F
+#define RHINO_GBUFFER_DEPTH_FORMAT GL_DEPTH24_STENCIL8
+
+typedef struct rhino_deferred_t {
+    // geometry program for scene meshes, the lighting program draws one fullscreen triangle
+
+    unsigned int geometry_program;
+    unsigned int lighting_program;
+    unsigned int vao;
+} rhino_deferred;
+
+void rhino_deferred_init(rhino_deferred* deferred);
+
+// lights the g-buffer into whatever framebuffer is bound, pixels nothing was drawn to are left alone
+
+void rhino_deferred_light(rhino_deferred* deferred, unsigned int albedo, unsigned int normal, unsigned int depth, unsigned int baked);
+
+void rhino_deferred_destroy(rhino_deferred* deferred);
@@ -0,0 +1,104 @@
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+
+// rhino headers
+
+#include "rhino_events.h"
+#include "rhino_global.h"
+
+#define QUEUE_MASK (RHINO_EVENT_QUEUE_SIZE - 1)
+
+void rhino_event_queue_init(rhino_event_queue* queue) {
+    memset(queue, 0, sizeof(rhino_event_queue));
+}
+
+bool rhino_event_push(rhino_event_queue* queue, rhino_event* event) {
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    if(head - tail >= RHINO_EVENT_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+
+    queue->events[head & QUEUE_MASK] = *event;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+bool rhino_event_pop(rhino_event_queue* queue, rhino_event* event) {
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if(tail == head) return false;
+
+    *event = queue->events[tail & QUEUE_MASK];
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+// ---- glfw callbacks, run on the main thread inside glfwWaitEvents ---- //
+
+static void forward(rhino_event event) {
+    event.time = glfwGetTime();
+    rhino_event_push(&rhino.events, &event);
+
+    bool window = event.type == RHINO_EVENT_FRAMEBUFFER_SIZE || event.type == RHINO_EVENT_WINDOW_SIZE;
+
+    rhino_redraw_request(&rhino.redraw, window ? RHINO_REDRAW_WINDOW : RHINO_REDRAW_INPUT);
+}
+
+static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    forward((rhino_event){ .type = RHINO_EVENT_KEY, .key = key, .action = action, .mods = mods });
+}
+
+static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    forward((rhino_event){ .type = RHINO_EVENT_MOUSE_BUTTON, .key = button, .action = action, .mods = mods });
+}
+
+static void cursor_callback(GLFWwindow* window, double x_pos, double y_pos) {
+    forward((rhino_event){ .type = RHINO_EVENT_CURSOR, .x = x_pos, .y = y_pos });
+}
+
+static void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    forward((rhino_event){ .type = RHINO_EVENT_FRAMEBUFFER_SIZE, .x = width, .y = height });
+}
+
+static void window_size_callback(GLFWwindow* window, int width, int height) {
+    forward((rhino_event){ .type = RHINO_EVENT_WINDOW_SIZE, .x = width, .y = height });
+}
+
+// nothing to forward, but a render thread asleep on demand has to see the close or redraw the damaged window
+
+static void close_callback(GLFWwindow* window) {
+    rhino_redraw_request(&rhino.redraw, RHINO_REDRAW_WINDOW);
+}
+
+static void refresh_callback(GLFWwindow* window) {
+    rhino_redraw_request(&rhino.redraw, RHINO_REDRAW_WINDOW);
+}
+
+void rhino_events_install(GLFWwindow* window) {
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetCursorPosCallback(window, cursor_callback);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowSizeCallback(window, window_size_callback);
+    glfwSetWindowCloseCallback(window, close_callback);
+    glfwSetWindowRefreshCallback(window, refresh_callback);
+}
+
+void rhino_events_request(rhino_event_type type, int value) {
+    rhino_event event = { .type = type, .time = glfwGetTime(), .value = value };
+
+    rhino_event_push(&rhino.requests, &event);
+
+    // glfwPostEmptyEvent is the one wake up glfw allows from any thread
+
+    glfwPostEmptyEvent();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// window events cross between threads here. glfw delivers events on the main thread only, which does nothing but
+// wait for them and forward them to the render thread through a single producer single consumer ring. window
+// changes only the main thread may make travel back the same way as requests
+
+// entries per queue, a power of two. a full queue drops the event and counts it
+
+#define RHINO_EVENT_QUEUE_SIZE 4096
+
+typedef enum rhino_event_type_t {
+    // main thread to render thread
+
+    RHINO_EVENT_KEY,
+    RHINO_EVENT_MOUSE_BUTTON,
+    RHINO_EVENT_CURSOR,
+    RHINO_EVENT_FRAMEBUFFER_SIZE,
+    RHINO_EVENT_WINDOW_SIZE,
+
+    // render thread to main thread, value is the cursor mode or whether to go fullscreen
+
+    RHINO_REQUEST_CURSOR_MODE,
+    RHINO_REQUEST_FULLSCREEN
+} rhino_event_type;
+
+// key, action and mods follow glfw's callback arguments, x and y carry the cursor or the new size. time is the
+// glfw clock when the event thread saw it
+
+typedef struct rhino_event_t {
+    rhino_event_type type;
+    double time;
+    int key, action, mods;
+    double x, y;
+    int value;
+} rhino_event;
+
+// head is only written by the producer and tail by the consumer
+
+typedef struct rhino_event_queue_t {
+    rhino_event events[RHINO_EVENT_QUEUE_SIZE];
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint dropped;
+} rhino_event_queue;
+
+void rhino_event_queue_init(rhino_event_queue* queue);
+
+bool rhino_event_push(rhino_event_queue* queue, rhino_event* event);
+
+bool rhino_event_pop(rhino_event_queue* queue, rhino_event* event);
+
+// points the window's callbacks at rhino.events, main thread only
+
+void rhino_events_install(GLFWwindow* window);
+
+// queues a request for the main thread and wakes it
+
+void rhino_events_request(rhino_event_type type, int value);
@@ -0,0 +1,121 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+// rhino headers
+
+#include "rhino_frames.h"
+
+void rhino_frames_init(rhino_frames* frames, int count) {
+    memset(frames, 0, sizeof(rhino_frames));
+
+    if(count < 1) count = 1;
+    if(count > RHINO_FRAMES_MAX) count = RHINO_FRAMES_MAX;
+
+    frames->count = count;
+    frames->slot = count - 1;
+
+    glGenQueries(RHINO_FRAMES_MAX * 2, &frames->queries[0][0]);
+
+    printf("\n%d frames in flight", count);
+}
+
+// the slot's timestamps are done once its fence passed, a frame following an idle stretch only gives its end
+
+static void read_timestamps(rhino_frames* frames, int slot) {
+    if(!frames->timed[slot]) return;
+
+    GLuint64 start, end;
+
+    glGetQueryObjectui64v(frames->queries[slot][0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(frames->queries[slot][1], GL_QUERY_RESULT, &end);
+
+    if(frames->last_end && !frames->resumed[slot]) {
+        frames->stats.gpu_samples++;
+
+        if(start > frames->last_end) frames->stats.gpu_idle_seconds += (double)(start - frames->last_end) / 1e9;
+    }
+
+    frames->last_end = end;
+    frames->timed[slot] = false;
+}
+
+int rhino_frames_begin(rhino_frames* frames, bool resumed) {
+    frames->slot = (frames->slot + 1) % frames->count;
+
+    int slot = frames->slot;
+
+    if(frames->fences[slot]) {
+        // a fence that has not signalled on the first look is a frame the cpu got too far ahead of the gpu on
+
+        double start = glfwGetTime();
+        GLenum status = glClientWaitSync(frames->fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+        if(status == GL_TIMEOUT_EXPIRED) {
+            while(status == GL_TIMEOUT_EXPIRED) status = glClientWaitSync(frames->fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+            frames->stats.waits++;
+            frames->stats.wait_seconds += glfwGetTime() - start;
+        }
+
+        glDeleteSync(frames->fences[slot]);
+        frames->fences[slot] = NULL;
+
+        read_timestamps(frames, slot);
+    }
+
+    glQueryCounter(frames->queries[slot][0], GL_TIMESTAMP);
+    frames->resumed[slot] = resumed;
+
+    frames->stats.frames++;
+
+    return slot;
+}
+
+void rhino_frames_end(rhino_frames* frames) {
+    int slot = frames->slot;
+
+    glQueryCounter(frames->queries[slot][1], GL_TIMESTAMP);
+    frames->timed[slot] = true;
+
+    frames->fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void rhino_frames_write(GLenum target, unsigned int buffer, size_t offset, size_t size, const void* data) {
+    if(size == 0) return;
+
+    glBindBuffer(target, buffer);
+
+    void* mapped = glMapBufferRange(target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+    if(mapped) {
+        memcpy(mapped, data, size);
+        glUnmapBuffer(target);
+    }
+    else glBufferSubData(target, offset, size, data);
+
+    glBindBuffer(target, 0);
+}
+
+void rhino_frames_print_stats(rhino_frames* frames) {
+    rhino_frames_stats* stats = &frames->stats;
+    unsigned int count = stats->frames ? stats->frames : 1;
+
+    printf("frames in flight : %d, cpu waited on a fence in %u of %u frames, %.3f ms per frame - gpu idle %.3f ms per frame\n",
+        frames->count, stats->waits, stats->frames, stats->wait_seconds * 1000.0 / count,
+        stats->gpu_samples ? stats->gpu_idle_seconds * 1000.0 / stats->gpu_samples : 0.0);
+
+    memset(stats, 0, sizeof(rhino_frames_stats));
+}
+
+void rhino_frames_destroy(rhino_frames* frames) {
+    for(int i = 0; i < RHINO_FRAMES_MAX; i++) {
+        if(frames->fences[i]) glDeleteSync(frames->fences[i]);
+    }
+
+    glDeleteQueries(RHINO_FRAMES_MAX * 2, &frames->queries[0][0]);
+
+    memset(frames, 0, sizeof(rhino_frames));
+}
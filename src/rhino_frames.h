@@ -0,0 +1,63 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+// frames in flight. the cpu builds a frame while the gpu still runs up to count - 1 older ones, so neither waits
+// on the other around the swap. every buffer written per frame has a copy per slot and a slot is only written again
+// once the fence its last frame ended with has signalled, which is what lets those writes skip synchronisation
+
+#define RHINO_FRAMES_MAX 4
+#define RHINO_FRAMES_DEFAULT 2
+
+// taken and reset by rhino_frames_print_stats. wait is the cpu blocked on a fence, gpu idle the gap between one
+// frame's last command and the next one's first on the gpu's clock
+
+typedef struct rhino_frames_stats_t {
+    unsigned int frames;
+    unsigned int waits;
+    double wait_seconds;
+    unsigned int gpu_samples;
+    double gpu_idle_seconds;
+} rhino_frames_stats;
+
+typedef struct rhino_frames_t {
+    int count;
+    int slot;
+
+    GLsync fences[RHINO_FRAMES_MAX];
+
+    // gpu timestamps where each slot's frame started and ended, read once its fence passed. last_end is where the
+    // frame before the one read last ended. the gap before a frame resumed after an idle stretch is not idle time
+    // the pipeline caused
+
+    unsigned int queries[RHINO_FRAMES_MAX][2];
+    bool timed[RHINO_FRAMES_MAX];
+    bool resumed[RHINO_FRAMES_MAX];
+    GLuint64 last_end;
+
+    rhino_frames_stats stats;
+} rhino_frames;
+
+// count is the most frames the gpu may be behind by, 1 waits for every frame to finish before starting the next
+
+void rhino_frames_init(rhino_frames* frames, int count);
+
+// waits until the next slot's previous frame is done on the gpu and returns the slot. call before the frame writes
+// its first per frame buffer, resumed when it follows a stretch of not rendering
+
+int rhino_frames_begin(rhino_frames* frames, bool resumed);
+
+// fences the frame, call after its last command (the swap)
+
+void rhino_frames_end(rhino_frames* frames);
+
+// writes into a per frame buffer without the driver synchronising, only for the current slot's copy
+
+void rhino_frames_write(GLenum target, unsigned int buffer, size_t offset, size_t size, const void* data);
+
+void rhino_frames_print_stats(rhino_frames* frames);
+
+void rhino_frames_destroy(rhino_frames* frames);
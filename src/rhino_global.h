@@ -1,31 +1,125 @@
+#pragma once
+
 #include "libs/cglm/cglm.h"
 #include <GLFW/glfw3.h>
 
+#include "rhino_camera.h"
+#include "rhino_graph.h"
+#include "rhino_resolution.h"
+#include "rhino_quality.h"
+#include "rhino_post.h"
+#include "rhino_jobs.h"
+#include "rhino_sim.h"
+#include "rhino_events.h"
+#include "rhino_input.h"
+#include "rhino_redraw.h"
+#include "rhino_frames.h"
+#include "rhino_loader.h"
+
 // camera stuff for allowing the navigation of 3d space
 
 #define CAMERA_MOV_SPEED 3.0f
 #define CAMERA_SENS 0.004f
 #define CAMERA_FOV 60.0f
+#define CAMERA_NEAR 0.1f
+#define CAMERA_FAR 500.0f
 
 typedef struct camera_transform_t {
-    vec3 posititon;
-    vec3 front;
-    vec3 up;
-    vec3 direction;
     float mov_speed;
-    float yaw, pitch;
     bool fullscreen;
 } camera_transform;
 
+// window size is the one the cursor position is relative to, which can differ from the framebuffer's
+
 typedef struct mouse_cursor_t {
     double x_pos, y_pos;
     float sens;
     bool unlocked;
+    int window_width, window_height;
 } mouse_cursor;
 
+// level of detail selection, error threshold is in pixels of projected geometric error
+
+#define LOD_ERROR_THRESHOLD 1.0f
+
+typedef struct lod_settings_t {
+    bool enabled;
+    bool crossfade;
+    float error_threshold;
+    int bias;
+} lod_settings;
+
+// per-frame counters, reset at the start of every frame
+
+typedef struct render_stats_t {
+    unsigned int triangles;
+    unsigned int triangles_full_detail;
+    unsigned int draw_calls;
+    unsigned int lod_fades;
+} render_stats;
+
+// which path shades the scene, r toggles between them at runtime
+
+typedef enum rhino_renderer_t {
+    RHINO_RENDERER_FORWARD,
+    RHINO_RENDERER_DEFERRED
+} rhino_renderer;
+
 typedef struct rhino_state_t {
     mouse_cursor mouse;
     camera_transform cam;
+
+    // main view, anything else that renders the scene (shadows, probes, split screen) owns its own rhino_camera
+
+    rhino_camera camera;
+    lod_settings lod;
+    render_stats stats;
+    rhino_renderer renderer;
+
+    // frame graph every pass of a frame is declared into, resized from the framebuffer size callback
+
+    rhino_graph graph;
+
+    // scale the scene renders at and the controller moving it, v toggles it and b the upscale filter
+
+    rhino_resolution resolution;
+
+    // ladder of quality levels stepped through under load, g toggles the governor
+
+    rhino_quality quality;
+
+    // post effect stack, 1, 2 and 3 toggle bloom, ssao and fog
+
+    rhino_post post;
+
+    // work stealing job system, one thread per core with the main thread as slot 0
+
+    rhino_jobs jobs;
+
+    // fixed timestep simulation of the camera and the demo's animation, rendering reads it interpolated
+
+    rhino_sim sim;
+
+    // window events from the main thread to the render thread, and requests the other way
+
+    rhino_event_queue events;
+    rhino_event_queue requests;
+
+    // keys, mouse buttons and cursor movement as of this frame, asked for by action
+
+    rhino_input input;
+
+    // what asked for the next frame, the render thread sleeps while nothing has when rendering on demand
+
+    rhino_redraw redraw;
+
+    // frames the gpu may run behind the cpu, per frame buffers use the copy of the current slot
+
+    rhino_frames frames;
+
+    // texture and buffer uploads on a context shared with the render thread's, handed over once fenced
+
+    rhino_loader loader;
     GLFWwindow* window;
     float delta_time;
 } rhino_state;
@@ -0,0 +1,518 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// rhino headers
+
+#include "rhino_graph.h"
+
+static bool is_depth_format(GLenum format) {
+    return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F;
+}
+
+// upload format, type and size per texel of the sized formats the graph hands out
+
+static bool format_info(GLenum format, GLenum* base, GLenum* type, size_t* texel_bytes) {
+    switch(format) {
+        case GL_R8: *base = GL_RED; *type = GL_UNSIGNED_BYTE; *texel_bytes = 1; return true;
+        case GL_RGBA8: *base = GL_RGBA; *type = GL_UNSIGNED_BYTE; *texel_bytes = 4; return true;
+        case GL_R16F: *base = GL_RED; *type = GL_FLOAT; *texel_bytes = 2; return true;
+        case GL_R32F: *base = GL_RED; *type = GL_FLOAT; *texel_bytes = 4; return true;
+        case GL_RG16F: *base = GL_RG; *type = GL_FLOAT; *texel_bytes = 4; return true;
+        case GL_RGBA16F: *base = GL_RGBA; *type = GL_FLOAT; *texel_bytes = 8; return true;
+        case GL_R11F_G11F_B10F: *base = GL_RGB; *type = GL_FLOAT; *texel_bytes = 4; return true;
+        case GL_DEPTH24_STENCIL8: *base = GL_DEPTH_STENCIL; *type = GL_UNSIGNED_INT_24_8; *texel_bytes = 4; return true;
+        case GL_DEPTH_COMPONENT24: *base = GL_DEPTH_COMPONENT; *type = GL_UNSIGNED_INT; *texel_bytes = 4; return true;
+        case GL_DEPTH_COMPONENT32F: *base = GL_DEPTH_COMPONENT; *type = GL_FLOAT; *texel_bytes = 4; return true;
+        default: return false;
+    }
+}
+
+static size_t resource_bytes(rhino_graph_resource* resource) {
+    GLenum base, type;
+    size_t texel_bytes = 0;
+
+    format_info(resource->format, &base, &type, &texel_bytes);
+
+    return (size_t)resource->width * resource->height * texel_bytes;
+}
+
+// ---- pool ---- //
+
+static void delete_framebuffers_using(rhino_graph* graph, unsigned int texture) {
+    for(int i = 0; i < graph->framebuffer_count; i++) {
+        rhino_graph_framebuffer* framebuffer = &graph->framebuffers[i];
+        bool uses = false;
+
+        for(int k = 0; k <= RHINO_GRAPH_MAX_COLORS; k++) uses |= framebuffer->attachments[k] == texture;
+
+        if(!uses) continue;
+
+        glDeleteFramebuffers(1, &framebuffer->fbo);
+        graph->framebuffers[i--] = graph->framebuffers[--graph->framebuffer_count];
+    }
+}
+
+static void delete_texture(rhino_graph* graph, int index) {
+    rhino_graph_target* texture = &graph->textures[index];
+
+    delete_framebuffers_using(graph, texture->texture);
+    glDeleteTextures(1, &texture->texture);
+
+    graph->textures[index] = graph->textures[--graph->texture_count];
+}
+
+// a free pooled texture of the resource's format and size, created when there is none
+
+static int acquire_texture(rhino_graph* graph, rhino_graph_resource* resource, int pass) {
+    for(int i = 0; i < graph->texture_count; i++) {
+        rhino_graph_target* texture = &graph->textures[i];
+
+        if(texture->busy_until >= pass || texture->format != resource->format) continue;
+        if(texture->width != resource->width || texture->height != resource->height) continue;
+
+        return i;
+    }
+
+    if(graph->texture_count >= RHINO_GRAPH_MAX_TEXTURES) {
+        printf("\nrender graph : texture pool full, %s gets no texture", resource->name);
+        return -1;
+    }
+
+    GLenum base, type;
+    size_t texel_bytes;
+
+    if(!format_info(resource->format, &base, &type, &texel_bytes)) {
+        printf("\nrender graph : unsupported format 0x%x for %s", resource->format, resource->name);
+        return -1;
+    }
+
+    rhino_graph_target* texture = &graph->textures[graph->texture_count];
+    memset(texture, 0, sizeof(*texture));
+
+    texture->format = resource->format;
+    texture->width = resource->width;
+    texture->height = resource->height;
+    texture->bytes = (size_t)resource->width * resource->height * texel_bytes;
+    texture->busy_until = -1;
+
+    // colour targets filter so they can be resampled, depth is only ever fetched
+
+    GLenum filter = is_depth_format(resource->format) ? GL_NEAREST : GL_LINEAR;
+
+    glGenTextures(1, &texture->texture);
+    glBindTexture(GL_TEXTURE_2D, texture->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, resource->format, resource->width, resource->height, 0, base, type, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    graph->stats.textures_created++;
+
+    return graph->texture_count++;
+}
+
+// framebuffer with exactly these attachments, colours first then depth
+
+static unsigned int get_framebuffer(rhino_graph* graph, unsigned int* attachments, int color_count, GLenum depth_format) {
+    for(int i = 0; i < graph->framebuffer_count; i++) {
+        rhino_graph_framebuffer* framebuffer = &graph->framebuffers[i];
+
+        if(memcmp(framebuffer->attachments, attachments, sizeof(framebuffer->attachments)) != 0) continue;
+
+        framebuffer->last_frame = graph->frame;
+
+        return framebuffer->fbo;
+    }
+
+    // full cache, the least recently used one makes room
+
+    if(graph->framebuffer_count >= RHINO_GRAPH_MAX_FRAMEBUFFERS) {
+        int oldest = 0;
+
+        for(int i = 1; i < graph->framebuffer_count; i++) {
+            if(graph->framebuffers[i].last_frame < graph->framebuffers[oldest].last_frame) oldest = i;
+        }
+
+        glDeleteFramebuffers(1, &graph->framebuffers[oldest].fbo);
+        graph->framebuffers[oldest] = graph->framebuffers[--graph->framebuffer_count];
+    }
+
+    rhino_graph_framebuffer* framebuffer = &graph->framebuffers[graph->framebuffer_count++];
+
+    memcpy(framebuffer->attachments, attachments, sizeof(framebuffer->attachments));
+    framebuffer->last_frame = graph->frame;
+
+    glGenFramebuffers(1, &framebuffer->fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->fbo);
+
+    GLenum buffers[RHINO_GRAPH_MAX_COLORS];
+
+    for(int k = 0; k < color_count; k++) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + k, GL_TEXTURE_2D, attachments[k], 0);
+        buffers[k] = GL_COLOR_ATTACHMENT0 + k;
+    }
+
+    unsigned int depth = attachments[RHINO_GRAPH_MAX_COLORS];
+
+    if(depth) {
+        GLenum point = depth_format == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        glFramebufferTexture2D(GL_FRAMEBUFFER, point, GL_TEXTURE_2D, depth, 0);
+    }
+
+    if(color_count > 0) glDrawBuffers(color_count, buffers);
+    else {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) printf("\nrender graph : framebuffer incomplete (%d colours%s)", color_count, depth ? " and depth" : "");
+
+    return framebuffer->fbo;
+}
+
+static void evict(rhino_graph* graph) {
+    for(int i = 0; i < graph->texture_count; i++) {
+        if(graph->frame - graph->textures[i].last_frame > RHINO_GRAPH_EVICT_FRAMES) delete_texture(graph, i--);
+    }
+
+    for(int i = 0; i < graph->framebuffer_count; i++) {
+        if(graph->frame - graph->framebuffers[i].last_frame <= RHINO_GRAPH_EVICT_FRAMES) continue;
+
+        glDeleteFramebuffers(1, &graph->framebuffers[i].fbo);
+        graph->framebuffers[i--] = graph->framebuffers[--graph->framebuffer_count];
+    }
+}
+
+// ---- declaring ---- //
+
+static int add_resource(rhino_graph* graph, const char* name) {
+    if(graph->resource_count >= RHINO_GRAPH_MAX_RESOURCES) {
+        printf("\nrender graph : too many resources, %s dropped", name);
+        return -1;
+    }
+
+    rhino_graph_resource* resource = &graph->resources[graph->resource_count];
+    memset(resource, 0, sizeof(*resource));
+
+    resource->name = name;
+    resource->first = -1;
+    resource->last = -1;
+
+    return graph->resource_count++;
+}
+
+static void add_reference(int* list, int* count, int max, int resource, const char* pass) {
+    if(resource < 0) return;
+
+    if(*count >= max) {
+        printf("\nrender graph : pass %s declares too many resources", pass);
+        return;
+    }
+
+    list[(*count)++] = resource;
+}
+
+void rhino_graph_init(rhino_graph* graph, int width, int height) {
+    memset(graph, 0, sizeof(rhino_graph));
+
+    graph->width = width;
+    graph->height = height;
+}
+
+void rhino_graph_resize(rhino_graph* graph, int width, int height) {
+    if(width <= 0 || height <= 0) return;
+    if(width == graph->width && height == graph->height) return;
+
+    while(graph->texture_count > 0) delete_texture(graph, graph->texture_count - 1);
+
+    for(int i = 0; i < graph->framebuffer_count; i++) glDeleteFramebuffers(1, &graph->framebuffers[i].fbo);
+    graph->framebuffer_count = 0;
+
+    graph->width = width;
+    graph->height = height;
+}
+
+void rhino_graph_begin(rhino_graph* graph) {
+    graph->pass_count = 0;
+    graph->resource_count = 0;
+    graph->compiled = false;
+    graph->frame++;
+
+    int backbuffer = add_resource(graph, "backbuffer");
+
+    graph->resources[backbuffer].imported = true;
+    graph->resources[backbuffer].width = graph->width;
+    graph->resources[backbuffer].height = graph->height;
+}
+
+int rhino_graph_create(rhino_graph* graph, const char* name, GLenum format, int width, int height) {
+    int index = add_resource(graph, name);
+    if(index < 0) return -1;
+
+    rhino_graph_resource* resource = &graph->resources[index];
+
+    resource->format = format;
+    resource->width = width > 1 ? width : 1;
+    resource->height = height > 1 ? height : 1;
+
+    return index;
+}
+
+int rhino_graph_import(rhino_graph* graph, const char* name, unsigned int texture) {
+    int index = add_resource(graph, name);
+    if(index < 0) return -1;
+
+    graph->resources[index].imported = true;
+    graph->resources[index].texture = texture;
+
+    return index;
+}
+
+int rhino_graph_add_pass(rhino_graph* graph, const char* name, rhino_graph_execute_fn execute, void* user) {
+    if(graph->pass_count >= RHINO_GRAPH_MAX_PASSES) {
+        printf("\nrender graph : too many passes, %s dropped", name);
+        return -1;
+    }
+
+    rhino_graph_pass* pass = &graph->passes[graph->pass_count];
+    memset(pass, 0, sizeof(*pass));
+
+    pass->name = name;
+    pass->execute = execute;
+    pass->user = user;
+    pass->depth = -1;
+
+    return graph->pass_count++;
+}
+
+void rhino_graph_read(rhino_graph* graph, int pass, int resource) {
+    if(pass < 0) return;
+
+    rhino_graph_pass* p = &graph->passes[pass];
+    add_reference(p->reads, &p->read_count, RHINO_GRAPH_MAX_READS, resource, p->name);
+}
+
+void rhino_graph_write_color(rhino_graph* graph, int pass, int resource) {
+    if(pass < 0) return;
+
+    rhino_graph_pass* p = &graph->passes[pass];
+    add_reference(p->colors, &p->color_count, RHINO_GRAPH_MAX_COLORS, resource, p->name);
+}
+
+void rhino_graph_write_depth(rhino_graph* graph, int pass, int resource) {
+    if(pass < 0) return;
+
+    graph->passes[pass].depth = resource;
+}
+
+void rhino_graph_write(rhino_graph* graph, int pass, int resource) {
+    if(pass < 0) return;
+
+    rhino_graph_pass* p = &graph->passes[pass];
+    add_reference(p->writes, &p->write_count, RHINO_GRAPH_MAX_WRITES, resource, p->name);
+}
+
+void rhino_graph_side_effect(rhino_graph* graph, int pass) {
+    if(pass >= 0) graph->passes[pass].side_effect = true;
+}
+
+// ---- compiling ---- //
+
+// every resource a pass writes, attachments and otherwise
+
+static int pass_outputs(rhino_graph_pass* pass, int* outputs) {
+    int count = 0;
+
+    for(int k = 0; k < pass->color_count; k++) outputs[count++] = pass->colors[k];
+    for(int k = 0; k < pass->write_count; k++) outputs[count++] = pass->writes[k];
+    if(pass->depth >= 0) outputs[count++] = pass->depth;
+
+    return count;
+}
+
+static void touch(rhino_graph* graph, int resource, int pass) {
+    rhino_graph_resource* r = &graph->resources[resource];
+
+    if(r->first < 0) r->first = pass;
+    r->last = pass;
+}
+
+void rhino_graph_compile(rhino_graph* graph) {
+    rhino_graph_stats* stats = &graph->stats;
+
+    stats->passes = graph->pass_count;
+    stats->culled = 0;
+    stats->transients = 0;
+    stats->textures = 0;
+    stats->textures_created = 0;
+    stats->bytes_unaliased = 0;
+    stats->bytes_aliased = 0;
+    stats->bytes_pooled = 0;
+
+    // imported resources outlive the frame so they are always wanted. walking backwards, a pass lives if it has a
+    // side effect or writes something wanted, and a live pass wants everything it reads
+
+    for(int i = 0; i < graph->resource_count; i++) graph->resources[i].wanted = graph->resources[i].imported;
+
+    for(int p = graph->pass_count - 1; p >= 0; p--) {
+        rhino_graph_pass* pass = &graph->passes[p];
+        int outputs[RHINO_GRAPH_MAX_COLORS + RHINO_GRAPH_MAX_WRITES + 1];
+        int output_count = pass_outputs(pass, outputs);
+
+        bool live = pass->side_effect;
+        for(int k = 0; k < output_count; k++) live |= graph->resources[outputs[k]].wanted;
+
+        pass->culled = !live;
+
+        if(!live) {
+            stats->culled++;
+            continue;
+        }
+
+        for(int k = 0; k < pass->read_count; k++) graph->resources[pass->reads[k]].wanted = true;
+    }
+
+    // lifetimes over the live passes
+
+    for(int p = 0; p < graph->pass_count; p++) {
+        rhino_graph_pass* pass = &graph->passes[p];
+
+        if(pass->culled) continue;
+
+        int outputs[RHINO_GRAPH_MAX_COLORS + RHINO_GRAPH_MAX_WRITES + 1];
+        int output_count = pass_outputs(pass, outputs);
+
+        for(int k = 0; k < output_count; k++) {
+            touch(graph, outputs[k], p);
+            graph->resources[outputs[k]].writers++;
+        }
+
+        for(int k = 0; k < pass->read_count; k++) {
+            rhino_graph_resource* resource = &graph->resources[pass->reads[k]];
+
+            if(!resource->imported && resource->writers == 0) printf("\nrender graph : %s reads %s before anything wrote it", pass->name, resource->name);
+
+            touch(graph, pass->reads[k], p);
+        }
+    }
+
+    // transients take a pooled texture at their first pass and hold it through their last, in pass order so a
+    // texture freed by one resource can go straight to the next
+
+    for(int i = 0; i < graph->texture_count; i++) graph->textures[i].busy_until = -1;
+
+    for(int p = 0; p < graph->pass_count; p++) {
+        for(int i = 0; i < graph->resource_count; i++) {
+            rhino_graph_resource* resource = &graph->resources[i];
+
+            if(resource->imported || resource->first != p) continue;
+
+            int index = acquire_texture(graph, resource, p);
+            if(index < 0) continue;
+
+            rhino_graph_target* texture = &graph->textures[index];
+
+            if(texture->last_frame != graph->frame) {
+                stats->textures++;
+                stats->bytes_aliased += texture->bytes;
+            }
+
+            texture->busy_until = resource->last;
+            texture->last_frame = graph->frame;
+            resource->texture = texture->texture;
+
+            stats->transients++;
+            stats->bytes_unaliased += resource_bytes(resource);
+        }
+    }
+
+    for(int i = 0; i < graph->texture_count; i++) stats->bytes_pooled += graph->textures[i].bytes;
+
+    graph->compiled = true;
+}
+
+void rhino_graph_execute(rhino_graph* graph) {
+    if(!graph->compiled) rhino_graph_compile(graph);
+
+    for(int p = 0; p < graph->pass_count; p++) {
+        rhino_graph_pass* pass = &graph->passes[p];
+
+        if(pass->culled) continue;
+
+        if(pass->color_count > 0 || pass->depth >= 0) {
+            unsigned int attachments[RHINO_GRAPH_MAX_COLORS + 1];
+            memset(attachments, 0, sizeof(attachments));
+
+            rhino_graph_resource* size = pass->color_count > 0 ? &graph->resources[pass->colors[0]] : &graph->resources[pass->depth];
+            GLenum depth_format = 0;
+
+            for(int k = 0; k < pass->color_count; k++) attachments[k] = graph->resources[pass->colors[k]].texture;
+
+            if(pass->depth >= 0) {
+                attachments[RHINO_GRAPH_MAX_COLORS] = graph->resources[pass->depth].texture;
+                depth_format = graph->resources[pass->depth].format;
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER, get_framebuffer(graph, attachments, pass->color_count, depth_format));
+            glViewport(0, 0, size->width, size->height);
+        }
+        else {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, graph->width, graph->height);
+        }
+
+        if(pass->execute) pass->execute(graph, pass->user);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, graph->width, graph->height);
+
+    evict(graph);
+}
+
+unsigned int rhino_graph_texture(rhino_graph* graph, int resource) {
+    if(resource < 0 || resource >= graph->resource_count) return 0;
+
+    return graph->resources[resource].texture;
+}
+
+void rhino_graph_blit(rhino_graph* graph, int resource, GLenum filter) {
+    rhino_graph_resource* source = &graph->resources[resource];
+
+    unsigned int attachments[RHINO_GRAPH_MAX_COLORS + 1];
+    memset(attachments, 0, sizeof(attachments));
+    attachments[0] = source->texture;
+
+    int draw;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw);
+
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, get_framebuffer(graph, attachments, 1, 0));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw);
+    glBlitFramebuffer(0, 0, source->width, source->height, viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3], GL_COLOR_BUFFER_BIT, filter);
+    glBindFramebuffer(GL_FRAMEBUFFER, draw);
+}
+
+void rhino_graph_print_stats(rhino_graph* graph) {
+    rhino_graph_stats* stats = &graph->stats;
+
+    printf("render graph : %d passes (%d culled), %d transients in %d textures - %.2f MB aliased vs %.2f MB unaliased, %.2f MB pooled\n",
+        stats->passes - stats->culled, stats->culled, stats->transients, stats->textures,
+        stats->bytes_aliased / (1024.0 * 1024.0), stats->bytes_unaliased / (1024.0 * 1024.0), stats->bytes_pooled / (1024.0 * 1024.0));
+}
+
+void rhino_graph_destroy(rhino_graph* graph) {
+    while(graph->texture_count > 0) delete_texture(graph, graph->texture_count - 1);
+
+    for(int i = 0; i < graph->framebuffer_count; i++) glDeleteFramebuffers(1, &graph->framebuffers[i].fbo);
+
+    memset(graph, 0, sizeof(rhino_graph));
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// frame graph, rebuilt every frame. passes declare what they read and write, compiling culls the passes nothing
+// depends on and hands transient textures out of a pool keyed by format and size, so two resources whose
+// lifetimes do not overlap share one texture
+
+#define RHINO_GRAPH_MAX_PASSES 32
+#define RHINO_GRAPH_MAX_RESOURCES 64
+#define RHINO_GRAPH_MAX_READS 16
+#define RHINO_GRAPH_MAX_WRITES 4
+#define RHINO_GRAPH_MAX_COLORS 4
+
+#define RHINO_GRAPH_MAX_TEXTURES 64
+#define RHINO_GRAPH_MAX_FRAMEBUFFERS 32
+
+// pooled textures and framebuffers no frame asked for in this long are deleted
+
+#define RHINO_GRAPH_EVICT_FRAMES 120
+
+// resource 0 of every frame is the default framebuffer
+
+#define RHINO_GRAPH_BACKBUFFER 0
+
+struct rhino_graph_t;
+
+typedef void (*rhino_graph_execute_fn)(struct rhino_graph_t* graph, void* user);
+
+// imported resources belong to someone else and outlive the frame, so writing one keeps a pass alive. transients
+// get their texture from the pool for the live passes between first and last
+
+typedef struct rhino_graph_resource_t {
+    const char* name;
+    GLenum format;
+    int width, height;
+    bool imported;
+    unsigned int texture;
+    int writers;
+    int first, last;
+    bool wanted;
+} rhino_graph_resource;
+
+// colors and depth become the pass framebuffer's attachments, writes are resources the pass renders to itself.
+// a pass with no attachments runs with the default framebuffer bound
+
+typedef struct rhino_graph_pass_t {
+    const char* name;
+    rhino_graph_execute_fn execute;
+    void* user;
+
+    int reads[RHINO_GRAPH_MAX_READS];
+    int read_count;
+    int writes[RHINO_GRAPH_MAX_WRITES];
+    int write_count;
+    int colors[RHINO_GRAPH_MAX_COLORS];
+    int color_count;
+    int depth;
+
+    bool side_effect;
+    bool culled;
+} rhino_graph_pass;
+
+// busy_until is the last pass of the resource holding the texture this frame, -1 while it is free
+
+typedef struct rhino_graph_target_t {
+    unsigned int texture;
+    GLenum format;
+    int width, height;
+    size_t bytes;
+    int busy_until;
+    unsigned int last_frame;
+} rhino_graph_target;
+
+// attachments are colors in order then depth, zero where unused
+
+typedef struct rhino_graph_framebuffer_t {
+    unsigned int fbo;
+    unsigned int attachments[RHINO_GRAPH_MAX_COLORS + 1];
+    unsigned int last_frame;
+} rhino_graph_framebuffer;
+
+// bytes_unaliased is what the frame's transients would take with a texture each, bytes_aliased what the textures
+// they were given take, bytes_pooled everything the pool holds including textures idle this frame
+
+typedef struct rhino_graph_stats_t {
+    int passes;
+    int culled;
+    int transients;
+    int textures;
+    int textures_created;
+    size_t bytes_unaliased;
+    size_t bytes_aliased;
+    size_t bytes_pooled;
+} rhino_graph_stats;
+
+typedef struct rhino_graph_t {
+    int width, height;
+
+    rhino_graph_pass passes[RHINO_GRAPH_MAX_PASSES];
+    int pass_count;
+    rhino_graph_resource resources[RHINO_GRAPH_MAX_RESOURCES];
+    int resource_count;
+
+    rhino_graph_target textures[RHINO_GRAPH_MAX_TEXTURES];
+    int texture_count;
+    rhino_graph_framebuffer framebuffers[RHINO_GRAPH_MAX_FRAMEBUFFERS];
+    int framebuffer_count;
+
+    unsigned int frame;
+    bool compiled;
+
+    rhino_graph_stats stats;
+} rhino_graph;
+
+// width and height are the default framebuffer's
+
+void rhino_graph_init(rhino_graph* graph, int width, int height);
+
+// drops every pooled texture and framebuffer, the next frame allocates them at the new size. call from the
+// framebuffer size callback, zero sizes (minimised windows) are ignored
+
+void rhino_graph_resize(rhino_graph* graph, int width, int height);
+
+// starts declaring a frame, only the backbuffer resource exists afterwards
+
+void rhino_graph_begin(rhino_graph* graph);
+
+// a transient texture of a sized internal format, graph->width and height are the backbuffer size
+
+int rhino_graph_create(rhino_graph* graph, const char* name, GLenum format, int width, int height);
+
+// a texture owned outside the graph, so passes can depend on it
+
+int rhino_graph_import(rhino_graph* graph, const char* name, unsigned int texture);
+
+int rhino_graph_add_pass(rhino_graph* graph, const char* name, rhino_graph_execute_fn execute, void* user);
+
+void rhino_graph_read(rhino_graph* graph, int pass, int resource);
+
+// colour attachments are bound in the order they are added, fragment output n goes to the nth
+
+void rhino_graph_write_color(rhino_graph* graph, int pass, int resource);
+
+void rhino_graph_write_depth(rhino_graph* graph, int pass, int resource);
+
+// a resource the pass renders to through its own framebuffer, the backbuffer or an imported texture
+
+void rhino_graph_write(rhino_graph* graph, int pass, int resource);
+
+// keeps a pass even when nothing reads what it writes
+
+void rhino_graph_side_effect(rhino_graph* graph, int pass);
+
+// culls, works out lifetimes and assigns pooled textures, creating any the pool is missing
+
+void rhino_graph_compile(rhino_graph* graph);
+
+// runs the live passes in declaration order, each with its framebuffer and viewport bound
+
+void rhino_graph_execute(rhino_graph* graph);
+
+// the texture behind a resource, transient ones only between compile and the end of execute
+
+unsigned int rhino_graph_texture(rhino_graph* graph, int resource);
+
+// blits a transient colour resource over the whole of the bound draw framebuffer's viewport
+
+void rhino_graph_blit(rhino_graph* graph, int resource, GLenum filter);
+
+void rhino_graph_print_stats(rhino_graph* graph);
+
+void rhino_graph_destroy(rhino_graph* graph);
@@ -0,0 +1,119 @@
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+// rhino headers
+
+#include "rhino_input.h"
+
+void rhino_input_init(rhino_input* input) {
+    memset(input, 0, sizeof(rhino_input));
+
+    rhino_input_bind(input, RHINO_ACTION_FORWARD, RHINO_INPUT_KEY, GLFW_KEY_W);
+    rhino_input_bind(input, RHINO_ACTION_BACK, RHINO_INPUT_KEY, GLFW_KEY_S);
+    rhino_input_bind(input, RHINO_ACTION_LEFT, RHINO_INPUT_KEY, GLFW_KEY_A);
+    rhino_input_bind(input, RHINO_ACTION_RIGHT, RHINO_INPUT_KEY, GLFW_KEY_D);
+    rhino_input_bind(input, RHINO_ACTION_UP, RHINO_INPUT_KEY, GLFW_KEY_SPACE);
+    rhino_input_bind(input, RHINO_ACTION_DOWN, RHINO_INPUT_KEY, GLFW_KEY_LEFT_CONTROL);
+    rhino_input_bind(input, RHINO_ACTION_FAST, RHINO_INPUT_KEY, GLFW_KEY_LEFT_SHIFT);
+    rhino_input_bind(input, RHINO_ACTION_QUIT, RHINO_INPUT_KEY, GLFW_KEY_ESCAPE);
+    rhino_input_bind(input, RHINO_ACTION_TOGGLE_LOD, RHINO_INPUT_KEY, GLFW_KEY_L);
+    rhino_input_bind(input, RHINO_ACTION_TOGGLE_CROSSFADE, RHINO_INPUT_KEY, GLFW_KEY_K);
+    rhino_input_bind(input, RHINO_ACTION_TOGGLE_RENDERER, RHINO_INPUT_KEY, GLFW_KEY_R);
+    rhino_input_bind(input, RHINO_ACTION_TOGGLE_RESOLUTION, RHINO_INPUT_KEY, GLFW_KEY_V);
+    rhino_input_bind(input, RHINO_ACTION_TOGGLE_UPSCALE, RHINO_INPUT_KEY, GLFW_KEY_B);
+    rhino_input_bind(input, RHINO_ACTION_TOGGLE_GOVERNOR, RHINO_INPUT_KEY, GLFW_KEY_G);
+    rhino_input_bind(input, RHINO_ACTION_TOGGLE_BLOOM, RHINO_INPUT_KEY, GLFW_KEY_1);
+    rhino_input_bind(input, RHINO_ACTION_TOGGLE_SSAO, RHINO_INPUT_KEY, GLFW_KEY_2);
+    rhino_input_bind(input, RHINO_ACTION_TOGGLE_FOG, RHINO_INPUT_KEY, GLFW_KEY_3);
+    rhino_input_bind(input, RHINO_ACTION_UNLOCK_MOUSE, RHINO_INPUT_KEY, GLFW_KEY_U);
+    rhino_input_bind(input, RHINO_ACTION_FULLSCREEN, RHINO_INPUT_KEY, GLFW_KEY_F11);
+    rhino_input_bind(input, RHINO_ACTION_SCREENSHOT, RHINO_INPUT_KEY, GLFW_KEY_F12);
+    rhino_input_bind(input, RHINO_ACTION_PICK, RHINO_INPUT_MOUSE_BUTTON, GLFW_MOUSE_BUTTON_LEFT);
+}
+
+void rhino_input_bind(rhino_input* input, rhino_action action, rhino_input_device device, int code) {
+    input->bindings[action] = (rhino_binding){ device, code };
+}
+
+void rhino_input_new_frame(rhino_input* input) {
+    for(int i = 0; i <= GLFW_KEY_LAST; i++) input->keys[i] &= RHINO_INPUT_DOWN;
+    for(int i = 0; i <= GLFW_MOUSE_BUTTON_LAST; i++) input->buttons[i] &= RHINO_INPUT_DOWN;
+
+    input->delta_x = input->delta_y = 0.0;
+}
+
+// repeats keep a key down without crossing an edge
+
+static void set_state(unsigned char* state, int action) {
+    if(action == GLFW_PRESS && !(*state & RHINO_INPUT_DOWN)) *state |= RHINO_INPUT_DOWN | RHINO_INPUT_PRESSED;
+    else if(action == GLFW_RELEASE && (*state & RHINO_INPUT_DOWN)) *state = (*state & ~RHINO_INPUT_DOWN) | RHINO_INPUT_RELEASED;
+}
+
+void rhino_input_event(rhino_input* input, rhino_event* event, double time) {
+    switch(event->type) {
+        case RHINO_EVENT_KEY:
+            if(event->key >= 0 && event->key <= GLFW_KEY_LAST) set_state(&input->keys[event->key], event->action);
+            break;
+
+        case RHINO_EVENT_MOUSE_BUTTON:
+            if(event->key >= 0 && event->key <= GLFW_MOUSE_BUTTON_LAST) set_state(&input->buttons[event->key], event->action);
+            break;
+
+        case RHINO_EVENT_CURSOR:
+            if(input->cursor_seen) {
+                input->delta_x += event->x - input->cursor_x;
+                input->delta_y += event->y - input->cursor_y;
+            }
+
+            input->cursor_x = event->x;
+            input->cursor_y = event->y;
+            input->cursor_seen = true;
+            break;
+
+        default: return;
+    }
+
+    double age = time - event->time;
+
+    input->stats.events++;
+    input->stats.age_total += age;
+
+    if(age > input->stats.age_max) input->stats.age_max = age;
+}
+
+static unsigned char action_state(rhino_input* input, rhino_action action) {
+    rhino_binding* binding = &input->bindings[action];
+
+    switch(binding->device) {
+        case RHINO_INPUT_KEY: return binding->code >= 0 && binding->code <= GLFW_KEY_LAST ? input->keys[binding->code] : 0;
+        case RHINO_INPUT_MOUSE_BUTTON: return binding->code >= 0 && binding->code <= GLFW_MOUSE_BUTTON_LAST ? input->buttons[binding->code] : 0;
+        default: return 0;
+    }
+}
+
+bool rhino_input_down(rhino_input* input, rhino_action action) {
+    return action_state(input, action) & RHINO_INPUT_DOWN;
+}
+
+bool rhino_input_pressed(rhino_input* input, rhino_action action) {
+    return action_state(input, action) & RHINO_INPUT_PRESSED;
+}
+
+bool rhino_input_released(rhino_input* input, rhino_action action) {
+    return action_state(input, action) & RHINO_INPUT_RELEASED;
+}
+
+void rhino_input_mouse_delta(rhino_input* input, double* x, double* y) {
+    *x = input->delta_x;
+    *y = input->delta_y;
+}
+
+void rhino_input_print_stats(rhino_input* input) {
+    rhino_input_stats* stats = &input->stats;
+
+    printf("input : %u events, %.2f ms average wait for a frame, %.2f ms at most\n", stats->events, stats->events ? stats->age_total * 1000.0 / stats->events : 0.0, stats->age_max * 1000.0);
+
+    memset(stats, 0, sizeof(rhino_input_stats));
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "rhino_events.h"
+
+// input layer, built from the timestamped events the main thread forwards. keys and mouse buttons keep whether
+// they are down along with the edges they crossed this frame, so a tap shorter than a frame still registers. the
+// demo asks for actions rather than keys, each bound to a key or a mouse button, and the cursor's movement is
+// summed up over the frame
+
+// device an action is bound to
+
+typedef enum rhino_input_device_t {
+    RHINO_INPUT_NONE,
+    RHINO_INPUT_KEY,
+    RHINO_INPUT_MOUSE_BUTTON
+} rhino_input_device;
+
+// the toggles for bloom, ssao and fog follow rhino_post_effect_id's order
+
+typedef enum rhino_action_t {
+    RHINO_ACTION_FORWARD,
+    RHINO_ACTION_BACK,
+    RHINO_ACTION_LEFT,
+    RHINO_ACTION_RIGHT,
+    RHINO_ACTION_UP,
+    RHINO_ACTION_DOWN,
+    RHINO_ACTION_FAST,
+    RHINO_ACTION_QUIT,
+    RHINO_ACTION_TOGGLE_LOD,
+    RHINO_ACTION_TOGGLE_CROSSFADE,
+    RHINO_ACTION_TOGGLE_RENDERER,
+    RHINO_ACTION_TOGGLE_RESOLUTION,
+    RHINO_ACTION_TOGGLE_UPSCALE,
+    RHINO_ACTION_TOGGLE_GOVERNOR,
+    RHINO_ACTION_TOGGLE_BLOOM,
+    RHINO_ACTION_TOGGLE_SSAO,
+    RHINO_ACTION_TOGGLE_FOG,
+    RHINO_ACTION_UNLOCK_MOUSE,
+    RHINO_ACTION_FULLSCREEN,
+    RHINO_ACTION_PICK,
+    RHINO_ACTION_SCREENSHOT,
+    RHINO_ACTIONS
+} rhino_action;
+
+// state bits per key and mouse button, pressed and released are cleared when the next frame starts
+
+#define RHINO_INPUT_DOWN (1 << 0)
+#define RHINO_INPUT_PRESSED (1 << 1)
+#define RHINO_INPUT_RELEASED (1 << 2)
+
+typedef struct rhino_binding_t {
+    rhino_input_device device;
+    int code;
+} rhino_binding;
+
+// how long events waited between the main thread seeing them and a frame taking them, taken and reset by
+// rhino_input_print_stats
+
+typedef struct rhino_input_stats_t {
+    unsigned int events;
+    double age_total;
+    double age_max;
+} rhino_input_stats;
+
+typedef struct rhino_input_t {
+    unsigned char keys[GLFW_KEY_LAST + 1];
+    unsigned char buttons[GLFW_MOUSE_BUTTON_LAST + 1];
+
+    rhino_binding bindings[RHINO_ACTIONS];
+
+    // cursor in window coordinates and how far it moved since the frame started, the first position only sets
+    // where movement is measured from
+
+    double cursor_x, cursor_y;
+    bool cursor_seen;
+    double delta_x, delta_y;
+
+    rhino_input_stats stats;
+} rhino_input;
+
+// clears all state and binds the demo's default keys
+
+void rhino_input_init(rhino_input* input);
+
+void rhino_input_bind(rhino_input* input, rhino_action action, rhino_input_device device, int code);
+
+// drops the last frame's edges and cursor movement, call before handing the frame's events over
+
+void rhino_input_new_frame(rhino_input* input);
+
+// takes a key, mouse button or cursor event, time is the clock the frame took it at
+
+void rhino_input_event(rhino_input* input, rhino_event* event, double time);
+
+bool rhino_input_down(rhino_input* input, rhino_action action);
+
+// true on the frame the action's key went down, a key pressed and let go within one frame still counts
+
+bool rhino_input_pressed(rhino_input* input, rhino_action action);
+
+// true on the frame the action's key came back up
+
+bool rhino_input_released(rhino_input* input, rhino_action action);
+
+// cursor movement this frame in window coordinates
+
+void rhino_input_mouse_delta(rhino_input* input, double* x, double* y);
+
+void rhino_input_print_stats(rhino_input* input);
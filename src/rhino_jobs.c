@@ -0,0 +1,537 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+// rhino headers
+
+#include "rhino_jobs.h"
+
+#define DEQUE_MASK (RHINO_JOBS_DEQUE_SIZE - 1)
+
+// the calling thread's slot, NULL for threads that never attached
+
+static _Thread_local rhino_job_thread* current_thread;
+
+// ---- chase-lev deque, orderings follow le, pop, cohen and zappa nardelli's c11 version ---- //
+
+static bool deque_push(rhino_job_deque* deque, rhino_job* job) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+    if(bottom - top >= RHINO_JOBS_DEQUE_SIZE) return false;
+
+    atomic_store_explicit(&deque->slots[bottom & DEQUE_MASK], job, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+
+    return true;
+}
+
+static rhino_job* deque_pop(rhino_job_deque* deque) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if(top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    rhino_job* job = atomic_load_explicit(&deque->slots[bottom & DEQUE_MASK], memory_order_relaxed);
+
+    // last job left, a thief may be after it too
+
+    if(top == bottom) {
+        if(!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) job = NULL;
+
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+
+    return job;
+}
+
+static rhino_job* deque_steal(rhino_job_deque* deque) {
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if(top >= bottom) return NULL;
+
+    rhino_job* job = atomic_load_explicit(&deque->slots[top & DEQUE_MASK], memory_order_relaxed);
+
+    // lost to the owner or another thief
+
+    if(!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) return NULL;
+
+    return job;
+}
+
+// ---- running jobs ---- //
+
+static void push_job(rhino_jobs* jobs, rhino_job* job);
+
+static void finish_job(rhino_jobs* jobs, rhino_job_counter* counter) {
+    if(!counter) return;
+
+    // only the last one out takes the lock. it swaps the continuations out before the count reaches zero, a waiter
+    // may free the counter the moment it does. run_after adds them under the same lock
+
+    while(true) {
+        int value = atomic_load(&counter->value);
+
+        if(value > 1) {
+            if(atomic_compare_exchange_weak(&counter->value, &value, value - 1)) return;
+            continue;
+        }
+
+        pthread_mutex_lock(&jobs->lock);
+
+        rhino_job* job = counter->continuations;
+        counter->continuations = NULL;
+
+        // a job added to the counter in the meantime, put them back and go round again
+
+        if(!atomic_compare_exchange_strong(&counter->value, &value, 0)) {
+            counter->continuations = job;
+            pthread_mutex_unlock(&jobs->lock);
+            continue;
+        }
+
+        pthread_mutex_unlock(&jobs->lock);
+
+        while(job) {
+            rhino_job* next = job->next;
+            push_job(jobs, job);
+            job = next;
+        }
+
+        return;
+    }
+}
+
+static void execute_job(rhino_jobs* jobs, rhino_job* job) {
+    rhino_job_counter* counter = job->counter;
+
+    job->function(job->data, job->begin, job->end);
+
+    // the owner may carve a new job from the slot from here on, the counter was read before
+
+    atomic_store_explicit(&job->busy, false, memory_order_release);
+
+    if(current_thread) atomic_fetch_add_explicit(&current_thread->executed, 1, memory_order_relaxed);
+
+    finish_job(jobs, counter);
+}
+
+// the ring comes round to a job again after RHINO_JOBS_DEQUE_SIZE more. background jobs and continuations can
+// still be queued by then, so slots whose job has not run are skipped. null once every slot is taken, the caller
+// then runs the job itself. only the owner allocates, so nothing else can take the slot between check and claim
+
+static rhino_job* allocate_job(rhino_job_thread* thread, rhino_job_function function, void* data, int begin, int end, rhino_job_counter* counter) {
+    rhino_job* job = NULL;
+
+    for(int i = 0; i < RHINO_JOBS_DEQUE_SIZE && !job; i++) {
+        rhino_job* slot = &thread->ring[thread->ring_head++ & DEQUE_MASK];
+
+        if(!atomic_load_explicit(&slot->busy, memory_order_acquire)) job = slot;
+    }
+
+    if(!job) return NULL;
+
+    atomic_store_explicit(&job->busy, true, memory_order_relaxed);
+
+    job->function = function;
+    job->data = data;
+    job->begin = begin;
+    job->end = end;
+    job->counter = counter;
+    job->next = NULL;
+
+    return job;
+}
+
+static void wake_worker(rhino_jobs* jobs) {
+    if(atomic_load(&jobs->sleeping) == 0) return;
+
+    pthread_mutex_lock(&jobs->lock);
+    pthread_cond_signal(&jobs->wake);
+    pthread_mutex_unlock(&jobs->lock);
+}
+
+static void push_job(rhino_jobs* jobs, rhino_job* job) {
+    rhino_job_thread* thread = current_thread;
+
+    if(!thread || thread->jobs != jobs || !deque_push(thread->deque, job)) {
+        execute_job(jobs, job);
+        return;
+    }
+
+    atomic_fetch_add(&jobs->queued, 1);
+    wake_worker(jobs);
+}
+
+static unsigned int next_random(rhino_job_thread* thread) {
+    unsigned int x = thread->random;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    return thread->random = x;
+}
+
+// own deque first, then one pass over everyone else's starting somewhere random, then the background queue
+
+static rhino_job* find_job(rhino_jobs* jobs, rhino_job_thread* thread, bool background) {
+    rhino_job* job = deque_pop(thread->deque);
+
+    if(job) {
+        atomic_fetch_sub(&jobs->queued, 1);
+        return job;
+    }
+
+    int count = atomic_load_explicit(&jobs->thread_count, memory_order_acquire);
+    int start = next_random(thread) % count;
+
+    for(int i = 0; i < count; i++) {
+        rhino_job_thread* victim = &jobs->threads[(start + i) % count];
+
+        if(victim == thread) continue;
+
+        job = deque_steal(victim->deque);
+
+        if(job) {
+            atomic_fetch_sub(&jobs->queued, 1);
+            atomic_fetch_add_explicit(&thread->stolen, 1, memory_order_relaxed);
+            return job;
+        }
+    }
+
+    if(!background || atomic_load(&jobs->background_count) == 0) return NULL;
+
+    pthread_mutex_lock(&jobs->lock);
+
+    job = jobs->background_head;
+
+    if(job) {
+        jobs->background_head = job->next;
+        if(!jobs->background_head) jobs->background_tail = NULL;
+
+        atomic_fetch_sub(&jobs->background_count, 1);
+        atomic_fetch_sub(&jobs->queued, 1);
+    }
+
+    pthread_mutex_unlock(&jobs->lock);
+
+    return job;
+}
+
+static void* job_worker_thread(void* arg) {
+    rhino_job_thread* thread = arg;
+    rhino_jobs* jobs = thread->jobs;
+
+    current_thread = thread;
+
+    int spins = 0;
+
+    while(!atomic_load(&jobs->quit)) {
+        // sat out, only set_active or quitting wakes it. waits on sat_out and is not counted as sleeping, so pushes
+        // never signal for it
+
+        if(thread->index >= atomic_load(&jobs->active)) {
+            pthread_mutex_lock(&jobs->lock);
+
+            while(!atomic_load(&jobs->quit) && thread->index >= atomic_load(&jobs->active)) pthread_cond_wait(&jobs->sat_out, &jobs->lock);
+
+            pthread_mutex_unlock(&jobs->lock);
+            continue;
+        }
+
+        rhino_job* job = find_job(jobs, thread, true);
+
+        if(job) {
+            execute_job(jobs, job);
+            spins = 0;
+            continue;
+        }
+
+        if(++spins < RHINO_JOBS_SPIN) {
+            sched_yield();
+            continue;
+        }
+
+        // nothing left anywhere, sleep until a push says otherwise
+
+        spins = 0;
+
+        pthread_mutex_lock(&jobs->lock);
+        atomic_fetch_add(&jobs->sleeping, 1);
+
+        while(!atomic_load(&jobs->quit) && atomic_load(&jobs->queued) == 0 && thread->index < atomic_load(&jobs->active)) pthread_cond_wait(&jobs->wake, &jobs->lock);
+
+        atomic_fetch_sub(&jobs->sleeping, 1);
+        pthread_mutex_unlock(&jobs->lock);
+    }
+
+    return NULL;
+}
+
+static void setup_thread(rhino_jobs* jobs, rhino_job_thread* thread, int index) {
+    thread->jobs = jobs;
+    thread->index = index;
+    thread->deque = calloc(1, sizeof(rhino_job_deque));
+    thread->ring = calloc(RHINO_JOBS_DEQUE_SIZE, sizeof(rhino_job));
+    thread->random = 2463534242u + index * 2654435761u;
+}
+
+static int default_threads(void) {
+#if defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if(count > 0) return count < RHINO_JOBS_MAX_THREADS ? (int)count : RHINO_JOBS_MAX_THREADS;
+#endif
+
+    return 4;
+}
+
+void rhino_jobs_init(rhino_jobs* jobs, int threads) {
+    memset(jobs, 0, sizeof(rhino_jobs));
+
+    if(threads <= 0) threads = default_threads();
+    if(threads > RHINO_JOBS_MAX_THREADS) threads = RHINO_JOBS_MAX_THREADS;
+
+    pthread_mutex_init(&jobs->lock, NULL);
+    pthread_cond_init(&jobs->wake, NULL);
+    pthread_cond_init(&jobs->sat_out, NULL);
+
+    for(int i = 0; i < threads; i++) setup_thread(jobs, &jobs->threads[i], i);
+
+    jobs->workers = threads;
+
+    atomic_store(&jobs->thread_count, threads);
+    atomic_store(&jobs->active, threads);
+
+    current_thread = &jobs->threads[0];
+
+    for(int i = 1; i < threads; i++) pthread_create(&jobs->threads[i].thread, NULL, job_worker_thread, &jobs->threads[i]);
+
+    printf("\njob system, %d threads", threads);
+}
+
+bool rhino_jobs_attach(rhino_jobs* jobs) {
+    if(current_thread && current_thread->jobs == jobs) return true;
+
+    pthread_mutex_lock(&jobs->lock);
+
+    int index = atomic_load(&jobs->thread_count);
+    bool attached = index > 0 && index < RHINO_JOBS_MAX_THREADS;
+
+    // the slot is complete before thieves can see it
+
+    if(attached) {
+        setup_thread(jobs, &jobs->threads[index], index);
+        current_thread = &jobs->threads[index];
+
+        atomic_store_explicit(&jobs->thread_count, index + 1, memory_order_release);
+    }
+
+    pthread_mutex_unlock(&jobs->lock);
+
+    return attached;
+}
+
+void rhino_jobs_run(rhino_jobs* jobs, rhino_job_function function, void* data, int begin, int end, rhino_job_counter* counter) {
+    if(counter) atomic_fetch_add(&counter->value, 1);
+
+    rhino_job_thread* thread = current_thread;
+
+    if(!thread || thread->jobs != jobs) {
+        function(data, begin, end);
+        finish_job(jobs, counter);
+        return;
+    }
+
+    rhino_job* job = allocate_job(thread, function, data, begin, end, counter);
+
+    if(!job) {
+        function(data, begin, end);
+        finish_job(jobs, counter);
+        return;
+    }
+
+    push_job(jobs, job);
+}
+
+void rhino_jobs_run_after(rhino_jobs* jobs, rhino_job_counter* after, rhino_job_function function, void* data, int begin, int end, rhino_job_counter* counter) {
+    rhino_job_thread* thread = current_thread;
+
+    if(!thread || thread->jobs != jobs) {
+        rhino_jobs_wait(jobs, after);
+        rhino_jobs_run(jobs, function, data, begin, end, counter);
+        return;
+    }
+
+    if(counter) atomic_fetch_add(&counter->value, 1);
+
+    rhino_job* job = allocate_job(thread, function, data, begin, end, counter);
+
+    // no slot to hold it back in, wait for after here instead
+
+    if(!job) {
+        rhino_jobs_wait(jobs, after);
+        function(data, begin, end);
+        finish_job(jobs, counter);
+        return;
+    }
+
+    // the last job on after takes the lock before it looks at the continuations, so either it sees this one or
+    // this sees the count already at zero
+
+    pthread_mutex_lock(&jobs->lock);
+
+    bool ready = atomic_load(&after->value) == 0;
+
+    if(!ready) {
+        job->next = after->continuations;
+        after->continuations = job;
+    }
+
+    pthread_mutex_unlock(&jobs->lock);
+
+    if(ready) push_job(jobs, job);
+}
+
+void rhino_jobs_run_background(rhino_jobs* jobs, rhino_job_function function, void* data, int begin, int end, rhino_job_counter* counter) {
+    // without workers nothing would ever get to it
+
+    if(atomic_load(&jobs->thread_count) < 2 || !current_thread || current_thread->jobs != jobs) {
+        rhino_jobs_run(jobs, function, data, begin, end, counter);
+        return;
+    }
+
+    if(counter) atomic_fetch_add(&counter->value, 1);
+
+    rhino_job* job = allocate_job(current_thread, function, data, begin, end, counter);
+
+    if(!job) {
+        function(data, begin, end);
+        finish_job(jobs, counter);
+        return;
+    }
+
+    pthread_mutex_lock(&jobs->lock);
+
+    if(jobs->background_tail) jobs->background_tail->next = job;
+    else jobs->background_head = job;
+
+    jobs->background_tail = job;
+
+    atomic_fetch_add(&jobs->background_count, 1);
+    atomic_fetch_add(&jobs->queued, 1);
+    pthread_cond_signal(&jobs->wake);
+    pthread_mutex_unlock(&jobs->lock);
+}
+
+void rhino_jobs_wait(rhino_jobs* jobs, rhino_job_counter* counter) {
+    rhino_job_thread* thread = current_thread;
+
+    if(thread && thread->jobs != jobs) thread = NULL;
+
+    while(atomic_load(&counter->value) > 0) {
+        rhino_job* job = thread ? find_job(jobs, thread, false) : NULL;
+
+        if(job) execute_job(jobs, job);
+        else sched_yield();
+    }
+}
+
+void rhino_jobs_parallel_for(rhino_jobs* jobs, int count, int grain, rhino_job_function function, void* data) {
+    if(count <= 0) return;
+
+    int threads = atomic_load(&jobs->active);
+    int thread_count = atomic_load(&jobs->thread_count);
+
+    if(threads > thread_count) threads = thread_count;
+
+    if(grain <= 0) {
+        int ranges = threads * RHINO_JOBS_SPLIT;
+        grain = ranges > 0 ? (count + ranges - 1) / ranges : count;
+    }
+
+    if(threads <= 1 || count <= grain || !current_thread || current_thread->jobs != jobs) {
+        function(data, 0, count);
+        return;
+    }
+
+    rhino_job_counter counter;
+    atomic_init(&counter.value, 0);
+    counter.continuations = NULL;
+
+    // the first range is ours, queued ranges get stolen from the far end meanwhile
+
+    for(int begin = grain; begin < count; begin += grain) {
+        int end = begin + grain < count ? begin + grain : count;
+
+        rhino_jobs_run(jobs, function, data, begin, end, &counter);
+    }
+
+    function(data, 0, grain);
+    atomic_fetch_add_explicit(&current_thread->executed, 1, memory_order_relaxed);
+
+    rhino_jobs_wait(jobs, &counter);
+}
+
+void rhino_jobs_set_active(rhino_jobs* jobs, int threads) {
+    int count = atomic_load(&jobs->thread_count);
+
+    if(threads < 1) threads = 1;
+    if(threads > count) threads = count;
+
+    pthread_mutex_lock(&jobs->lock);
+    atomic_store(&jobs->active, threads);
+    pthread_cond_broadcast(&jobs->wake);
+    pthread_cond_broadcast(&jobs->sat_out);
+    pthread_mutex_unlock(&jobs->lock);
+}
+
+void rhino_jobs_print_stats(rhino_jobs* jobs) {
+    int count = atomic_load(&jobs->thread_count);
+    unsigned int executed = 0, stolen = 0;
+
+    for(int i = 0; i < count; i++) {
+        executed += atomic_exchange(&jobs->threads[i].executed, 0);
+        stolen += atomic_exchange(&jobs->threads[i].stolen, 0);
+    }
+
+    printf("jobs : %d threads, %u jobs run, %u stolen (%.0f%%), %d queued\n", count, executed, stolen, executed ? 100.0 * stolen / executed : 0.0, atomic_load(&jobs->queued));
+}
+
+void rhino_jobs_destroy(rhino_jobs* jobs) {
+    int count = atomic_load(&jobs->thread_count);
+
+    pthread_mutex_lock(&jobs->lock);
+    atomic_store(&jobs->quit, true);
+    pthread_cond_broadcast(&jobs->wake);
+    pthread_cond_broadcast(&jobs->sat_out);
+    pthread_mutex_unlock(&jobs->lock);
+
+    for(int i = 1; i < jobs->workers; i++) pthread_join(jobs->threads[i].thread, NULL);
+
+    for(int i = 0; i < count; i++) {
+        free(jobs->threads[i].deque);
+        free(jobs->threads[i].ring);
+    }
+
+    if(current_thread && current_thread->jobs == jobs) current_thread = NULL;
+
+    pthread_mutex_destroy(&jobs->lock);
+    pthread_cond_destroy(&jobs->wake);
+    pthread_cond_destroy(&jobs->sat_out);
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// job system, one worker thread per spare core each owning a chase-lev deque. a thread pushes and pops jobs at the
+// bottom of its own deque, idle threads steal from the top of someone else's. threads waiting on a counter run jobs
+// in the meantime instead of blocking
+
+#define RHINO_JOBS_MAX_THREADS 16
+
+// jobs in flight per submitting thread, a power of two. a full deque or ring runs the job on the spot
+
+#define RHINO_JOBS_DEQUE_SIZE 4096
+
+// parallel for splits into about this many ranges per thread so stealing can even out uneven ranges
+
+#define RHINO_JOBS_SPLIT 4
+
+// failed steal rounds before a worker goes to sleep
+
+#define RHINO_JOBS_SPIN 64
+
+typedef void (*rhino_job_function)(void* data, int begin, int end);
+
+struct rhino_job_t;
+
+// counts jobs still to finish. continuations are jobs held back until the count reaches zero
+
+typedef struct rhino_job_counter_t {
+    atomic_int value;
+    struct rhino_job_t* continuations;
+} rhino_job_counter;
+
+typedef struct rhino_job_t {
+    rhino_job_function function;
+    void* data;
+    int begin, end;
+    rhino_job_counter* counter;
+    struct rhino_job_t* next;
+
+    // set from allocation until the job ran, its ring slot is not handed out again before
+
+    atomic_bool busy;
+} rhino_job;
+
+// top is where thieves take from, bottom where the owner pushes and pops
+
+typedef struct rhino_job_deque_t {
+    atomic_long top;
+    atomic_long bottom;
+    rhino_job* _Atomic slots[RHINO_JOBS_DEQUE_SIZE];
+} rhino_job_deque;
+
+// one per thread that runs jobs, slot 0 is the thread that called rhino_jobs_init. jobs are carved from a ring
+// the same size as the deque, skipping slots whose job has not run yet
+
+typedef struct rhino_job_thread_t {
+    struct rhino_jobs_t* jobs;
+    int index;
+    pthread_t thread;
+
+    rhino_job_deque* deque;
+    rhino_job* ring;
+    unsigned int ring_head;
+    unsigned int random;
+
+    // written by the owner only, summed up for the stats
+
+    atomic_uint executed;
+    atomic_uint stolen;
+} rhino_job_thread;
+
+// background jobs are long running work such as terrain generation. they wait in a first in first out queue that
+// only workers with nothing else to do take from, so a thread waiting on a frame's counter never picks one up
+
+typedef struct rhino_jobs_t {
+    rhino_job_thread threads[RHINO_JOBS_MAX_THREADS];
+    atomic_int thread_count;
+
+    // slots 1 to workers - 1 are the threads rhino_jobs_init started, attached threads come after them
+
+    int workers;
+
+    // threads past active sit out, the benchmark uses it to measure scaling
+
+    atomic_int active;
+
+    rhino_job* background_head;
+    rhino_job* background_tail;
+    atomic_int background_count;
+
+    // sleeping workers, queued counts jobs pushed and not yet taken so a worker can tell whether to sleep. workers
+    // sat out wait on a cond of their own, a push signalling one of them would wake nobody who can take the job
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t sat_out;
+    atomic_int sleeping;
+    atomic_int queued;
+    atomic_bool quit;
+} rhino_jobs;
+
+// starts a worker per core past the calling thread, 0 picks the count from the machine
+
+void rhino_jobs_init(rhino_jobs* jobs, int threads);
+
+// gives the calling thread a deque so it can submit and wait, the thread that called rhino_jobs_init already has
+// one. false once every slot is taken, the thread's jobs then run on the spot
+
+bool rhino_jobs_attach(rhino_jobs* jobs);
+
+// adds one to counter (if any) and queues function over [begin, end), counter drops back once it ran
+
+void rhino_jobs_run(rhino_jobs* jobs, rhino_job_function function, void* data, int begin, int end, rhino_job_counter* counter);
+
+// queues the job once after reaches zero, or right away if it already has
+
+void rhino_jobs_run_after(rhino_jobs* jobs, rhino_job_counter* after, rhino_job_function function, void* data, int begin, int end, rhino_job_counter* counter);
+
+// queues long running work behind everything else, see rhino_jobs
+
+void rhino_jobs_run_background(rhino_jobs* jobs, rhino_job_function function, void* data, int begin, int end, rhino_job_counter* counter);
+
+// runs jobs until counter reaches zero
+
+void rhino_jobs_wait(rhino_jobs* jobs, rhino_job_counter* counter);
+
+// splits [0, count) into ranges of at least grain and waits for all of them, grain 0 picks one from the thread count.
+// runs on the calling thread alone when there is nothing to split
+
+void rhino_jobs_parallel_for(rhino_jobs* jobs, int count, int grain, rhino_job_function function, void* data);
+
+// threads the next jobs may run on, 1 up to thread_count
+
+void rhino_jobs_set_active(rhino_jobs* jobs, int threads);
+
+void rhino_jobs_print_stats(rhino_jobs* jobs);
+
+void rhino_jobs_destroy(rhino_jobs* jobs);
@@ -0,0 +1,820 @@
+// rhino_lightbake, bakes sun, sky and bounce light for the demo's static entities into RHINO_LIGHTMAP_FILE.
+// meshes upload to the gpu on creation so a hidden window is still opened, everything else runs on the cpu
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_global.h"
+#include "rhino_mesh.h"
+#include "rhino_scene.h"
+#include "rhino_bvh.h"
+#include "rhino_terrain.h"
+#include "rhino_lightmap.h"
+#include "demo_scene.h"
+
+// mesh drawing counts into this, the baker never draws
+
+rhino_state rhino;
+
+// lightmap texels per world unit, paths per texel and bounces per path
+
+#define BAKE_TEXELS_PER_UNIT 24.0f
+#define BAKE_SAMPLES 64
+#define BAKE_BOUNCES 2
+
+// the sun is a small disc so its shadows soften with distance
+
+#define BAKE_SUN_SPREAD 0.02f
+
+// terrain around the baked entities that still shadows and bounces onto them
+
+#define BAKE_TERRAIN_MARGIN 40.0f
+#define BAKE_TERRAIN_STEP 1.0f
+
+// rays start this far off the surface, and give up after this distance
+
+#define BAKE_RAY_OFFSET 0.002f
+#define BAKE_RAY_MAX 1000.0f
+
+// entity rects are shelf packed into an atlas at most this wide
+
+#define BAKE_ATLAS_WIDTH 2048
+
+// texels a worker takes at a time, and samples per texel for the --scaling runs
+
+#define BAKE_BLOCK 64
+#define BAKE_SCALING_SAMPLES 8
+
+#define BAKE_MAX_THREADS 64
+#define BAKE_MAX_MESHES 32
+
+// every triangle the rays can hit, in world space
+
+typedef struct bake_world_t {
+    float* positions;
+    unsigned int* indices;
+    unsigned int vertex_count;
+    unsigned int triangle_count;
+    vec3* normals;
+    float* albedo;
+    rhino_bvh4 bvh;
+} bake_world;
+
+typedef struct bake_texel_t {
+    unsigned int index;
+    vec3 position;
+    vec3 normal;
+} bake_texel;
+
+// texels are handed out BAKE_BLOCK at a time from next, rays are summed per worker and added at the end
+
+typedef struct bake_job_t {
+    bake_world* world;
+    bake_texel* texels;
+    unsigned int texel_count;
+    vec3* output;
+    int samples;
+    int bounces;
+
+    pthread_mutex_t lock;
+    unsigned int next;
+} bake_job;
+
+typedef struct bake_worker_t {
+    bake_job* job;
+    pthread_t thread;
+    unsigned long long rays;
+} bake_worker;
+
+typedef struct bake_settings_t {
+    int samples;
+    int bounces;
+    int threads;
+    float texels_per_unit;
+    bool scaling;
+    const char* output;
+} bake_settings;
+
+// ---- random numbers, seeded per texel so the result does not depend on which thread baked it ---- //
+
+static unsigned int hash(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+
+    return x;
+}
+
+static float random_float(unsigned int* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return (*state >> 8) * (1.0f / 16777216.0f);
+}
+
+static void tangent_frame(vec3 normal, vec3 tangent, vec3 bitangent) {
+    vec3 helper = { 1.0f, 0.0f, 0.0f };
+
+    if(fabsf(normal[0]) > 0.9f) glm_vec3_copy((vec3){ 0.0f, 1.0f, 0.0f }, helper);
+
+    glm_vec3_cross(normal, helper, tangent);
+    glm_vec3_normalize(tangent);
+    glm_vec3_cross(normal, tangent, bitangent);
+}
+
+// cosine weighted, so the estimator for irradiance is just pi times the mean radiance
+
+static void cosine_direction(vec3 normal, unsigned int* state, vec3 direction) {
+    float phi = 2.0f * GLM_PIf * random_float(state);
+    float r2 = random_float(state);
+    float r = sqrtf(r2);
+
+    vec3 tangent, bitangent;
+    tangent_frame(normal, tangent, bitangent);
+
+    glm_vec3_scale(normal, sqrtf(1.0f - r2), direction);
+    glm_vec3_muladds(tangent, cosf(phi) * r, direction);
+    glm_vec3_muladds(bitangent, sinf(phi) * r, direction);
+}
+
+// ---- light ---- //
+
+static void sky_radiance(vec3 direction, vec3 radiance) {
+    float up = direction[1] > 0.0f ? direction[1] : 0.0f;
+
+    glm_vec3_lerp(SKY_HORIZON, SKY_ZENITH, up, radiance);
+}
+
+// irradiance from the sun at a point, one shadow ray towards a random spot on its disc
+
+static void sun_irradiance(bake_world* world, vec3 position, vec3 normal, unsigned int* state, unsigned long long* rays, vec3 irradiance) {
+    glm_vec3_zero(irradiance);
+
+    vec3 to_sun;
+    glm_vec3_negate_to(SUN_DIRECTION, to_sun);
+    glm_vec3_normalize(to_sun);
+
+    vec3 tangent, bitangent;
+    tangent_frame(to_sun, tangent, bitangent);
+
+    glm_vec3_muladds(tangent, (random_float(state) * 2.0f - 1.0f) * BAKE_SUN_SPREAD, to_sun);
+    glm_vec3_muladds(bitangent, (random_float(state) * 2.0f - 1.0f) * BAKE_SUN_SPREAD, to_sun);
+    glm_vec3_normalize(to_sun);
+
+    float cosine = glm_vec3_dot(normal, to_sun);
+
+    if(cosine <= 0.0f) return;
+
+    vec3 origin;
+    glm_vec3_copy(position, origin);
+    glm_vec3_muladds(normal, BAKE_RAY_OFFSET, origin);
+
+    (*rays)++;
+
+    if(rhino_bvh4_occluded(&world->bvh, origin, to_sun, BAKE_RAY_MAX)) return;
+
+    glm_vec3_scale(SUN_COLOR, cosine, irradiance);
+}
+
+// one path, direct sun at the texel plus everything a cosine sampled ray brings back over a few diffuse bounces.
+// at a hit the outgoing radiance is albedo / pi times its irradiance, the pi cancels against the estimator
+
+static void sample_irradiance(bake_world* world, vec3 position, vec3 normal, int bounces, unsigned int* state, unsigned long long* rays, vec3 irradiance) {
+    sun_irradiance(world, position, normal, state, rays, irradiance);
+
+    vec3 throughput = { 1.0f, 1.0f, 1.0f };
+    vec3 origin, surface_normal;
+
+    glm_vec3_copy(position, origin);
+    glm_vec3_copy(normal, surface_normal);
+
+    for(int bounce = 0; bounce <= bounces; bounce++) {
+        vec3 direction, ray_origin;
+
+        cosine_direction(surface_normal, state, direction);
+
+        glm_vec3_copy(origin, ray_origin);
+        glm_vec3_muladds(surface_normal, BAKE_RAY_OFFSET, ray_origin);
+
+        float t = BAKE_RAY_MAX;
+        unsigned int triangle;
+
+        (*rays)++;
+
+        if(!rhino_bvh4_intersect(&world->bvh, ray_origin, direction, &t, &triangle)) {
+            vec3 sky;
+            sky_radiance(direction, sky);
+            glm_vec3_scale(sky, GLM_PIf, sky);
+
+            glm_vec3_muladd(throughput, sky, irradiance);
+
+            return;
+        }
+
+        // last bounce only tells us the sky was blocked
+
+        if(bounce == bounces) return;
+
+        glm_vec3_copy(ray_origin, origin);
+        glm_vec3_muladds(direction, t, origin);
+        glm_vec3_copy(world->normals[triangle], surface_normal);
+
+        if(glm_vec3_dot(surface_normal, direction) > 0.0f) glm_vec3_negate(surface_normal);
+
+        glm_vec3_scale(throughput, world->albedo[triangle], throughput);
+
+        vec3 sun;
+        sun_irradiance(world, origin, surface_normal, state, rays, sun);
+        glm_vec3_muladd(throughput, sun, irradiance);
+    }
+}
+
+static void* bake_worker_thread(void* arg) {
+    bake_worker* worker = arg;
+    bake_job* job = worker->job;
+
+    while(true) {
+        pthread_mutex_lock(&job->lock);
+        unsigned int first = job->next;
+        job->next += BAKE_BLOCK;
+        pthread_mutex_unlock(&job->lock);
+
+        if(first >= job->texel_count) break;
+
+        unsigned int last = first + BAKE_BLOCK < job->texel_count ? first + BAKE_BLOCK : job->texel_count;
+
+        for(unsigned int i = first; i < last; i++) {
+            bake_texel* texel = &job->texels[i];
+            unsigned int state = hash(texel->index * 9781u + 1u) | 1u;
+
+            vec3 sum = { 0.0f, 0.0f, 0.0f };
+
+            for(int s = 0; s < job->samples; s++) {
+                vec3 irradiance;
+                sample_irradiance(job->world, texel->position, texel->normal, job->bounces, &state, &worker->rays, irradiance);
+                glm_vec3_add(sum, irradiance, sum);
+            }
+
+            glm_vec3_scale(sum, 1.0f / job->samples, job->output[i]);
+        }
+    }
+
+    return NULL;
+}
+
+// bakes every texel on thread_count threads, returns the rays traced and the wall time through seconds
+
+static unsigned long long bake(bake_world* world, bake_texel* texels, unsigned int texel_count, vec3* output, int samples, int bounces, int thread_count, double* seconds) {
+    bake_job job;
+    memset(&job, 0, sizeof(job));
+
+    job.world = world;
+    job.texels = texels;
+    job.texel_count = texel_count;
+    job.output = output;
+    job.samples = samples;
+    job.bounces = bounces;
+
+    pthread_mutex_init(&job.lock, NULL);
+
+    bake_worker workers[BAKE_MAX_THREADS];
+
+    double start = glfwGetTime();
+
+    for(int i = 0; i < thread_count; i++) {
+        workers[i].job = &job;
+        workers[i].rays = 0;
+
+        pthread_create(&workers[i].thread, NULL, bake_worker_thread, &workers[i]);
+    }
+
+    unsigned long long rays = 0;
+
+    for(int i = 0; i < thread_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+        rays += workers[i].rays;
+    }
+
+    *seconds = glfwGetTime() - start;
+
+    pthread_mutex_destroy(&job.lock);
+
+    return rays;
+}
+
+// ---- scene ---- //
+
+static void world_add(bake_world* world, const float* positions, unsigned int stride, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count, mat4 model, float albedo) {
+    unsigned int base = world->vertex_count;
+
+    world->positions = realloc(world->positions, (world->vertex_count + vertex_count) * 3 * sizeof(float));
+    world->indices = realloc(world->indices, (world->triangle_count * 3 + index_count) * sizeof(unsigned int));
+    world->normals = realloc(world->normals, (world->triangle_count + index_count / 3) * sizeof(vec3));
+    world->albedo = realloc(world->albedo, (world->triangle_count + index_count / 3) * sizeof(float));
+
+    for(unsigned int i = 0; i < vertex_count; i++) glm_mat4_mulv3(model, (float*)&positions[i * stride], 1.0f, &world->positions[(base + i) * 3]);
+
+    for(unsigned int i = 0; i < index_count / 3; i++) {
+        unsigned int* triangle = &world->indices[(world->triangle_count + i) * 3];
+        vec3 edge1, edge2;
+
+        for(int k = 0; k < 3; k++) triangle[k] = base + indices[i * 3 + k];
+
+        glm_vec3_sub(&world->positions[triangle[1] * 3], &world->positions[triangle[0] * 3], edge1);
+        glm_vec3_sub(&world->positions[triangle[2] * 3], &world->positions[triangle[0] * 3], edge2);
+        glm_vec3_cross(edge1, edge2, world->normals[world->triangle_count + i]);
+        glm_vec3_normalize(world->normals[world->triangle_count + i]);
+
+        world->albedo[world->triangle_count + i] = albedo;
+    }
+
+    world->vertex_count += vertex_count;
+    world->triangle_count += index_count / 3;
+}
+
+// heightfield patch under box, the streamed terrain is generated from the same function
+
+static void world_add_terrain(bake_world* world, vec3 box[2]) {
+    int columns = (int)ceilf((box[1][0] - box[0][0] + 2.0f * BAKE_TERRAIN_MARGIN) / BAKE_TERRAIN_STEP) + 1;
+    int rows = (int)ceilf((box[1][2] - box[0][2] + 2.0f * BAKE_TERRAIN_MARGIN) / BAKE_TERRAIN_STEP) + 1;
+
+    float* positions = malloc(columns * rows * 3 * sizeof(float));
+    unsigned int* indices = malloc((columns - 1) * (rows - 1) * 6 * sizeof(unsigned int));
+    unsigned int index_count = 0;
+
+    for(int j = 0; j < rows; j++) {
+        for(int i = 0; i < columns; i++) {
+            float* p = &positions[(j * columns + i) * 3];
+
+            p[0] = box[0][0] - BAKE_TERRAIN_MARGIN + i * BAKE_TERRAIN_STEP;
+            p[2] = box[0][2] - BAKE_TERRAIN_MARGIN + j * BAKE_TERRAIN_STEP;
+            p[1] = rhino_terrain_height(p[0], p[2]);
+        }
+    }
+
+    for(int j = 0; j < rows - 1; j++) {
+        for(int i = 0; i < columns - 1; i++) {
+            unsigned int a = j * columns + i;
+
+            indices[index_count++] = a;
+            indices[index_count++] = a + columns;
+            indices[index_count++] = a + 1;
+            indices[index_count++] = a + 1;
+            indices[index_count++] = a + columns;
+            indices[index_count++] = a + columns + 1;
+        }
+    }
+
+    mat4 identity = GLM_MAT4_IDENTITY_INIT;
+    world_add(world, positions, 3, columns * rows, indices, index_count, identity, TERRAIN_ALBEDO);
+
+    free(positions);
+    free(indices);
+}
+
+// area weighted vertex normals, averaged over vertices sharing a position so chart borders stay smooth
+
+static const rhino_vertex* sort_vertices;
+
+static int compare_position(const void* a, const void* b) {
+    return memcmp(sort_vertices[*(const unsigned int*)a].position, sort_vertices[*(const unsigned int*)b].position, 3 * sizeof(float));
+}
+
+static vec3* smooth_normals(rhino_lightmap_unwrap* unwrap) {
+    vec3* normals = calloc(unwrap->vertex_count, sizeof(vec3));
+
+    for(unsigned int t = 0; t < unwrap->index_count / 3; t++) {
+        unsigned int* triangle = &unwrap->indices[t * 3];
+        vec3 edge1, edge2, normal;
+
+        glm_vec3_sub(unwrap->vertices[triangle[1]].position, unwrap->vertices[triangle[0]].position, edge1);
+        glm_vec3_sub(unwrap->vertices[triangle[2]].position, unwrap->vertices[triangle[0]].position, edge2);
+        glm_vec3_cross(edge1, edge2, normal);
+
+        for(int k = 0; k < 3; k++) glm_vec3_add(normals[triangle[k]], normal, normals[triangle[k]]);
+    }
+
+    unsigned int* order = malloc(unwrap->vertex_count * sizeof(unsigned int));
+
+    for(unsigned int i = 0; i < unwrap->vertex_count; i++) order[i] = i;
+
+    sort_vertices = unwrap->vertices;
+    qsort(order, unwrap->vertex_count, sizeof(unsigned int), compare_position);
+
+    for(unsigned int first = 0; first < unwrap->vertex_count;) {
+        unsigned int last = first + 1;
+        vec3 sum;
+
+        glm_vec3_copy(normals[order[first]], sum);
+
+        while(last < unwrap->vertex_count && compare_position(&order[first], &order[last]) == 0) glm_vec3_add(sum, normals[order[last++]], sum);
+
+        glm_vec3_normalize(sum);
+
+        for(unsigned int i = first; i < last; i++) glm_vec3_copy(sum, normals[order[i]]);
+
+        first = last;
+    }
+
+    free(order);
+
+    return normals;
+}
+
+// every texel whose centre a triangle covers, in the entity's rect at (x, y)
+
+static unsigned int rasterize(rhino_lightmap_unwrap* unwrap, vec3* normals, mat4 model, int x, int y, int atlas_width, bool* covered, bake_texel* texels, unsigned int texel_count) {
+    mat4 inverse;
+    mat3 normal_matrix;
+
+    glm_mat4_inv(model, inverse);
+    glm_mat4_transpose(inverse);
+    glm_mat4_pick3(inverse, normal_matrix);
+
+    for(unsigned int t = 0; t < unwrap->index_count / 3; t++) {
+        rhino_vertex* v[3];
+        vec2 p[3];
+
+        for(int k = 0; k < 3; k++) {
+            v[k] = &unwrap->vertices[unwrap->indices[t * 3 + k]];
+            p[k][0] = v[k]->lightmap_uv[0] * unwrap->width;
+            p[k][1] = v[k]->lightmap_uv[1] * unwrap->height;
+        }
+
+        float area = (p[1][0] - p[0][0]) * (p[2][1] - p[0][1]) - (p[2][0] - p[0][0]) * (p[1][1] - p[0][1]);
+
+        if(fabsf(area) < 1e-12f) continue;
+
+        int x0 = (int)floorf(glm_min(p[0][0], glm_min(p[1][0], p[2][0])));
+        int x1 = (int)ceilf(glm_max(p[0][0], glm_max(p[1][0], p[2][0])));
+        int y0 = (int)floorf(glm_min(p[0][1], glm_min(p[1][1], p[2][1])));
+        int y1 = (int)ceilf(glm_max(p[0][1], glm_max(p[1][1], p[2][1])));
+
+        for(int ty = y0; ty < y1; ty++) {
+            for(int tx = x0; tx < x1; tx++) {
+                float cx = tx + 0.5f, cy = ty + 0.5f;
+
+                // barycentrics of the texel centre, a hair of slack so shared edges never leave a gap
+
+                float b1 = ((cx - p[0][0]) * (p[2][1] - p[0][1]) - (p[2][0] - p[0][0]) * (cy - p[0][1])) / area;
+                float b2 = ((p[1][0] - p[0][0]) * (cy - p[0][1]) - (cx - p[0][0]) * (p[1][1] - p[0][1])) / area;
+                float b0 = 1.0f - b1 - b2;
+
+                if(b0 < -1e-4f || b1 < -1e-4f || b2 < -1e-4f) continue;
+
+                unsigned int index = (y + ty) * atlas_width + x + tx;
+
+                if(covered[index]) continue;
+
+                covered[index] = true;
+
+                bake_texel* texel = &texels[texel_count++];
+                vec3 position = { 0.0f, 0.0f, 0.0f }, normal = { 0.0f, 0.0f, 0.0f };
+
+                glm_vec3_muladds(v[0]->position, b0, position);
+                glm_vec3_muladds(v[1]->position, b1, position);
+                glm_vec3_muladds(v[2]->position, b2, position);
+
+                glm_vec3_muladds(normals[unwrap->indices[t * 3]], b0, normal);
+                glm_vec3_muladds(normals[unwrap->indices[t * 3 + 1]], b1, normal);
+                glm_vec3_muladds(normals[unwrap->indices[t * 3 + 2]], b2, normal);
+
+                texel->index = index;
+                glm_mat4_mulv3(model, position, 1.0f, texel->position);
+                glm_mat3_mulv(normal_matrix, normal, texel->normal);
+                glm_vec3_normalize(texel->normal);
+            }
+        }
+    }
+
+    return texel_count;
+}
+
+// grows baked texels into the empty padding around charts, one texel per pass
+
+static void dilate(vec3* atlas, bool* covered, int width, int height, int passes) {
+    bool* next = malloc((size_t)width * height * sizeof(bool));
+
+    for(int pass = 0; pass < passes; pass++) {
+        memcpy(next, covered, (size_t)width * height * sizeof(bool));
+
+        for(int y = 0; y < height; y++) {
+            for(int x = 0; x < width; x++) {
+                if(covered[y * width + x]) continue;
+
+                vec3 sum = { 0.0f, 0.0f, 0.0f };
+                int count = 0;
+
+                for(int dy = -1; dy <= 1; dy++) {
+                    for(int dx = -1; dx <= 1; dx++) {
+                        int nx = x + dx, ny = y + dy;
+
+                        if(nx < 0 || ny < 0 || nx >= width || ny >= height || !covered[ny * width + nx]) continue;
+
+                        glm_vec3_add(sum, atlas[ny * width + nx], sum);
+                        count++;
+                    }
+                }
+
+                if(count == 0) continue;
+
+                glm_vec3_scale(sum, 1.0f / count, atlas[y * width + x]);
+                next[y * width + x] = true;
+            }
+        }
+
+        memcpy(covered, next, (size_t)width * height * sizeof(bool));
+    }
+
+    free(next);
+}
+
+static int default_threads(void) {
+#if defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if(count > 0) return count < BAKE_MAX_THREADS ? (int)count : BAKE_MAX_THREADS;
+#endif
+
+    return 4;
+}
+
+int main(int argc, char** argv) {
+    bake_settings settings = { BAKE_SAMPLES, BAKE_BOUNCES, default_threads(), BAKE_TEXELS_PER_UNIT, false, RHINO_LIGHTMAP_FILE };
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--samples") == 0 && i + 1 < argc) settings.samples = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--bounces") == 0 && i + 1 < argc) settings.bounces = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) settings.threads = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--density") == 0 && i + 1 < argc) settings.texels_per_unit = (float)atof(argv[++i]);
+        else if(strcmp(argv[i], "--output") == 0 && i + 1 < argc) settings.output = argv[++i];
+        else if(strcmp(argv[i], "--scaling") == 0) settings.scaling = true;
+        else printf("\nunknown option %s", argv[i]);
+    }
+
+    if(settings.samples < 1) settings.samples = 1;
+    if(settings.bounces < 0) settings.bounces = 0;
+    if(settings.threads < 1) settings.threads = 1;
+    if(settings.threads > BAKE_MAX_THREADS) settings.threads = BAKE_MAX_THREADS;
+
+    // hidden window, only there because meshes upload on creation
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "rhino_lightbake", NULL, NULL);
+
+    if(window == NULL) {
+        printf("\nfailed to create a glfw window.");
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        printf("\nfailed to init GLAD, could not load process.");
+        return -1;
+    }
+
+    rhino_mesh cube_mesh;
+    rhino_mesh sphere_mesh;
+
+    rhino_scene scene;
+    rhino_scene_init(&scene);
+
+    demo_scene_create(&scene, &cube_mesh, &sphere_mesh, 0);
+
+    double start = glfwGetTime();
+
+    // unwrap each mesh once, sized for the biggest static instance of it
+
+    rhino_mesh* meshes[BAKE_MAX_MESHES];
+    float mesh_scales[BAKE_MAX_MESHES];
+    int mesh_count = 0;
+
+    int* entity_mesh = malloc(scene.entity_count * sizeof(int));
+    int baked_count = 0;
+
+    for(int i = 0; i < scene.entity_count; i++) {
+        rhino_entity* entity = &scene.entities[i];
+
+        entity_mesh[i] = -1;
+
+        if(entity->dynamic) continue;
+
+        vec3 scale;
+        glm_decompose_scalev(entity->model, scale);
+
+        float largest = glm_max(scale[0], glm_max(scale[1], scale[2]));
+        int slot = 0;
+
+        while(slot < mesh_count && meshes[slot] != entity->mesh) slot++;
+
+        if(slot == mesh_count) {
+            if(mesh_count == BAKE_MAX_MESHES) continue;
+
+            meshes[mesh_count] = entity->mesh;
+            mesh_scales[mesh_count++] = 0.0f;
+        }
+
+        mesh_scales[slot] = glm_max(mesh_scales[slot], largest);
+        entity_mesh[i] = slot;
+        baked_count++;
+    }
+
+    rhino_lightmap_unwrap* unwraps = malloc(mesh_count * sizeof(rhino_lightmap_unwrap));
+
+    for(int i = 0; i < mesh_count; i++) {
+        rhino_lightmap_unwrap_mesh(&unwraps[i], meshes[i], settings.texels_per_unit * mesh_scales[i]);
+
+        printf("\nunwrapped mesh %d : %u triangles into %d charts, %dx%d texels, %u vertices (was %u)", i, unwraps[i].index_count / 3, unwraps[i].chart_count, unwraps[i].width, unwraps[i].height, unwraps[i].vertex_count, meshes[i]->vertex_count);
+    }
+
+    // shelf pack one rect per baked entity, the mesh layouts already carry their padding
+
+    rhino_lightmap_entity* records = malloc(baked_count * sizeof(rhino_lightmap_entity));
+    int* rect_x = malloc(baked_count * sizeof(int));
+    int* rect_y = malloc(baked_count * sizeof(int));
+    int* record_entity = malloc(baked_count * sizeof(int));
+
+    int atlas_width = 0, atlas_height = 0;
+    int x = 0, y = 0, shelf_height = 0;
+    int record_count = 0;
+
+    for(int i = 0; i < scene.entity_count; i++) {
+        if(entity_mesh[i] < 0) continue;
+
+        rhino_lightmap_unwrap* unwrap = &unwraps[entity_mesh[i]];
+
+        if(x > 0 && x + unwrap->width > BAKE_ATLAS_WIDTH) {
+            x = 0;
+            y += shelf_height;
+            shelf_height = 0;
+        }
+
+        rect_x[record_count] = x;
+        rect_y[record_count] = y;
+        record_entity[record_count] = i;
+
+        x += unwrap->width;
+        shelf_height = unwrap->height > shelf_height ? unwrap->height : shelf_height;
+        atlas_width = x > atlas_width ? x : atlas_width;
+
+        record_count++;
+    }
+
+    atlas_height = y + shelf_height;
+
+    for(int r = 0; r < record_count; r++) {
+        rhino_lightmap_unwrap* unwrap = &unwraps[entity_mesh[record_entity[r]]];
+
+        records[r].entity = record_entity[r];
+        records[r].mesh = entity_mesh[record_entity[r]];
+        records[r].scale_offset[0] = (float)unwrap->width / atlas_width;
+        records[r].scale_offset[1] = (float)unwrap->height / atlas_height;
+        records[r].scale_offset[2] = (float)rect_x[r] / atlas_width;
+        records[r].scale_offset[3] = (float)rect_y[r] / atlas_height;
+    }
+
+    if(record_count == 0) {
+        printf("\nno static entities to bake");
+        glfwTerminate();
+        return -1;
+    }
+
+    // world the rays see, the static entities at full detail and the terrain around them
+
+    bake_world world;
+    memset(&world, 0, sizeof(world));
+
+    vec3 box[2];
+    glm_aabb_invalidate(box);
+
+    for(int r = 0; r < record_count; r++) {
+        rhino_entity* entity = &scene.entities[record_entity[r]];
+        rhino_mesh* mesh = entity->mesh;
+
+        world_add(&world, (float*)mesh->vertices, sizeof(rhino_vertex) / sizeof(float), mesh->vertex_count, mesh->indices, mesh->index_count, entity->model, SURFACE_ALBEDO);
+        glm_aabb_merge(box, entity->world_bounds, box);
+    }
+
+    world_add_terrain(&world, box);
+
+    rhino_bvh4_build_triangles(&world.bvh, world.positions, 3, world.indices, world.triangle_count);
+
+    // texels to bake
+
+    bool* covered = calloc((size_t)atlas_width * atlas_height, sizeof(bool));
+    bake_texel* texels = malloc((size_t)atlas_width * atlas_height * sizeof(bake_texel));
+    unsigned int texel_count = 0;
+
+    vec3** normals = malloc(mesh_count * sizeof(vec3*));
+
+    for(int i = 0; i < mesh_count; i++) normals[i] = smooth_normals(&unwraps[i]);
+
+    for(int r = 0; r < record_count; r++) {
+        int slot = entity_mesh[record_entity[r]];
+
+        texel_count = rasterize(&unwraps[slot], normals[slot], scene.entities[record_entity[r]].model, rect_x[r], rect_y[r], atlas_width, covered, texels, texel_count);
+    }
+
+    printf("\n\nbaking %d entities : %dx%d atlas, %u texels, %u triangles, %d samples, %d bounces", record_count, atlas_width, atlas_height, texel_count, world.triangle_count, settings.samples, settings.bounces);
+    printf("\nscene prepared in %.2f s", glfwGetTime() - start);
+
+    vec3* output = malloc(texel_count * sizeof(vec3));
+    double seconds;
+
+    // same texels at a low sample count on more and more threads, rays per second should grow with them
+
+    if(settings.scaling) {
+        printf("\n\nthread scaling, %d samples per texel", BAKE_SCALING_SAMPLES);
+        printf("\nthreads |  seconds |  mrays/s | speedup | efficiency");
+
+        double single = 0.0;
+
+        for(int threads = 1;; threads *= 2) {
+            if(threads > settings.threads) threads = settings.threads;
+
+            unsigned long long rays = bake(&world, texels, texel_count, output, BAKE_SCALING_SAMPLES, settings.bounces, threads, &seconds);
+            double rate = rays / seconds;
+
+            if(threads == 1) single = rate;
+
+            printf("\n%7d | %8.3f | %8.2f | %6.2fx | %9.0f%%", threads, seconds, rate / 1e6, rate / single, 100.0 * rate / single / threads);
+
+            if(threads == settings.threads) break;
+        }
+    }
+
+    unsigned long long rays = bake(&world, texels, texel_count, output, settings.samples, settings.bounces, settings.threads, &seconds);
+
+    printf("\n\nbaked in %.2f s on %d threads : %llu rays, %.2f mrays/s (%.2f per thread)", seconds, settings.threads, rays, rays / seconds / 1e6, rays / seconds / 1e6 / settings.threads);
+
+    // scatter into the atlas, fill the chart padding and pack
+
+    vec3* atlas = calloc((size_t)atlas_width * atlas_height, sizeof(vec3));
+
+    for(unsigned int i = 0; i < texel_count; i++) glm_vec3_copy(output[i], atlas[texels[i].index]);
+
+    dilate(atlas, covered, atlas_width, atlas_height, RHINO_LIGHTMAP_PADDING);
+
+    unsigned int* packed = malloc((size_t)atlas_width * atlas_height * sizeof(unsigned int));
+
+    for(int i = 0; i < atlas_width * atlas_height; i++) packed[i] = rhino_lightmap_pack_rgb9e5(atlas[i]);
+
+    if(rhino_lightmap_save(settings.output, atlas_width, atlas_height, packed, unwraps, mesh_count, records, record_count)) {
+        printf("\nwrote %s, %.2f mb", settings.output, (atlas_width * atlas_height * 4.0) / (1024.0 * 1024.0));
+    }
+
+    printf("\ntotal %.2f s\n", glfwGetTime() - start);
+
+    for(int i = 0; i < mesh_count; i++) {
+        rhino_lightmap_unwrap_destroy(&unwraps[i]);
+        free(normals[i]);
+    }
+
+    free(unwraps);
+    free(normals);
+    free(entity_mesh);
+    free(records);
+    free(rect_x);
+    free(rect_y);
+    free(record_entity);
+    free(covered);
+    free(texels);
+    free(output);
+    free(atlas);
+    free(packed);
+    free(world.positions);
+    free(world.indices);
+    free(world.normals);
+    free(world.albedo);
+    rhino_bvh4_destroy(&world.bvh);
+
+    rhino_scene_destroy(&scene);
+    rhino_mesh_destroy(&cube_mesh);
+    rhino_mesh_destroy(&sphere_mesh);
+
+    glfwTerminate();
+
+    return 0;
+}
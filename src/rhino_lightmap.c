@@ -0,0 +1,476 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_lightmap.h"
+
+typedef struct unwrap_chart_t {
+    int axis;
+    float min[2], max[2];
+    int width, height;
+    int x, y;
+} unwrap_chart;
+
+typedef struct unwrap_edge_t {
+    unsigned int a, b;
+    unsigned int triangle;
+} unwrap_edge;
+
+static const rhino_vertex* sort_vertices;
+
+static int compare_position(const void* a, const void* b) {
+    return memcmp(sort_vertices[*(const unsigned int*)a].position, sort_vertices[*(const unsigned int*)b].position, 3 * sizeof(float));
+}
+
+static int compare_edge(const void* a, const void* b) {
+    const unwrap_edge* x = a;
+    const unwrap_edge* y = b;
+
+    if(x->a != y->a) return x->a < y->a ? -1 : 1;
+    if(x->b != y->b) return x->b < y->b ? -1 : 1;
+
+    return 0;
+}
+
+static unwrap_chart* sort_charts;
+
+static int compare_chart_height(const void* a, const void* b) {
+    return sort_charts[*(const int*)b].height - sort_charts[*(const int*)a].height;
+}
+
+static unsigned int find_root(unsigned int* parents, unsigned int i) {
+    while(parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+
+    return i;
+}
+
+void rhino_lightmap_unwrap_mesh(rhino_lightmap_unwrap* unwrap, rhino_mesh* mesh, float texels_per_unit) {
+    memset(unwrap, 0, sizeof(rhino_lightmap_unwrap));
+
+    unwrap->source_vertex_count = mesh->vertex_count;
+    unwrap->source_index_count = mesh->index_count;
+
+    unsigned int triangle_count = mesh->index_count / 3;
+
+    // weld by position so charts grow across the texture seams of the source mesh
+
+    unsigned int* order = malloc(mesh->vertex_count * sizeof(unsigned int));
+    unsigned int* welded = malloc(mesh->vertex_count * sizeof(unsigned int));
+
+    for(unsigned int i = 0; i < mesh->vertex_count; i++) order[i] = i;
+
+    sort_vertices = mesh->vertices;
+    qsort(order, mesh->vertex_count, sizeof(unsigned int), compare_position);
+
+    for(unsigned int i = 0; i < mesh->vertex_count; i++) {
+        welded[order[i]] = i > 0 && compare_position(&order[i - 1], &order[i]) == 0 ? welded[order[i - 1]] : order[i];
+    }
+
+    // each triangle faces the axis its normal leans towards the most, sign included
+
+    int* axes = malloc(triangle_count * sizeof(int));
+
+    for(unsigned int t = 0; t < triangle_count; t++) {
+        vec3 edge1, edge2, normal;
+
+        glm_vec3_sub(mesh->vertices[mesh->indices[t * 3 + 1]].position, mesh->vertices[mesh->indices[t * 3]].position, edge1);
+        glm_vec3_sub(mesh->vertices[mesh->indices[t * 3 + 2]].position, mesh->vertices[mesh->indices[t * 3]].position, edge2);
+        glm_vec3_cross(edge1, edge2, normal);
+
+        int axis = 0;
+
+        for(int k = 1; k < 3; k++) {
+            if(fabsf(normal[k]) > fabsf(normal[axis])) axis = k;
+        }
+
+        axes[t] = axis * 2 + (normal[axis] < 0.0f ? 1 : 0);
+    }
+
+    // triangles sharing an edge and an axis end up in the same chart
+
+    unwrap_edge* edges = malloc(mesh->index_count * sizeof(unwrap_edge));
+
+    for(unsigned int t = 0; t < triangle_count; t++) {
+        for(int k = 0; k < 3; k++) {
+            unsigned int a = welded[mesh->indices[t * 3 + k]];
+            unsigned int b = welded[mesh->indices[t * 3 + (k + 1) % 3]];
+
+            edges[t * 3 + k] = (unwrap_edge){ a < b ? a : b, a < b ? b : a, t };
+        }
+    }
+
+    qsort(edges, mesh->index_count, sizeof(unwrap_edge), compare_edge);
+
+    unsigned int* parents = malloc(triangle_count * sizeof(unsigned int));
+
+    for(unsigned int t = 0; t < triangle_count; t++) parents[t] = t;
+
+    for(unsigned int first = 0; first < mesh->index_count;) {
+        unsigned int last = first + 1;
+
+        while(last < mesh->index_count && compare_edge(&edges[first], &edges[last]) == 0) last++;
+
+        for(unsigned int i = first; i < last; i++) {
+            for(unsigned int j = first; j < i; j++) {
+                if(axes[edges[i].triangle] != axes[edges[j].triangle]) continue;
+
+                parents[find_root(parents, edges[i].triangle)] = find_root(parents, edges[j].triangle);
+            }
+        }
+
+        first = last;
+    }
+
+    // number the charts and project them onto their axis plane, in texels
+
+    int* charts_of = malloc(triangle_count * sizeof(int));
+    int* chart_ids = malloc(triangle_count * sizeof(int));
+    unwrap_chart* charts = malloc(triangle_count * sizeof(unwrap_chart));
+
+    for(unsigned int t = 0; t < triangle_count; t++) chart_ids[t] = -1;
+
+    for(unsigned int t = 0; t < triangle_count; t++) {
+        unsigned int root = find_root(parents, t);
+
+        if(chart_ids[root] < 0) {
+            unwrap_chart* chart = &charts[unwrap->chart_count];
+
+            chart->axis = axes[t] / 2;
+            chart->min[0] = chart->min[1] = FLT_MAX;
+            chart->max[0] = chart->max[1] = -FLT_MAX;
+
+            chart_ids[root] = unwrap->chart_count++;
+        }
+
+        charts_of[t] = chart_ids[root];
+
+        unwrap_chart* chart = &charts[charts_of[t]];
+
+        for(int k = 0; k < 3; k++) {
+            float* position = mesh->vertices[mesh->indices[t * 3 + k]].position;
+
+            for(int c = 0; c < 2; c++) {
+                float value = position[(chart->axis + 1 + c) % 3] * texels_per_unit;
+
+                if(value < chart->min[c]) chart->min[c] = value;
+                if(value > chart->max[c]) chart->max[c] = value;
+            }
+        }
+    }
+
+    // shelf pack, tallest first, into a roughly square layout. padding sits below and left of every chart and once
+    // more along the top and right of the layout
+
+    int* chart_order = malloc(unwrap->chart_count * sizeof(int));
+    float area = 0.0f;
+    int widest = 0;
+
+    for(int i = 0; i < unwrap->chart_count; i++) {
+        unwrap_chart* chart = &charts[i];
+
+        chart->width = (int)ceilf(chart->max[0] - chart->min[0]) + 1 + RHINO_LIGHTMAP_PADDING;
+        chart->height = (int)ceilf(chart->max[1] - chart->min[1]) + 1 + RHINO_LIGHTMAP_PADDING;
+
+        area += (float)chart->width * chart->height;
+        widest = chart->width > widest ? chart->width : widest;
+
+        chart_order[i] = i;
+    }
+
+    sort_charts = charts;
+    qsort(chart_order, unwrap->chart_count, sizeof(int), compare_chart_height);
+
+    int shelf_width = (int)ceilf(sqrtf(area * 1.15f));
+    if(shelf_width < widest) shelf_width = widest;
+
+    int x = 0, y = 0, shelf_height = 0;
+
+    for(int i = 0; i < unwrap->chart_count; i++) {
+        unwrap_chart* chart = &charts[chart_order[i]];
+
+        if(x + chart->width > shelf_width) {
+            x = 0;
+            y += shelf_height;
+            shelf_height = 0;
+        }
+
+        chart->x = x;
+        chart->y = y;
+
+        x += chart->width;
+        shelf_height = chart->height > shelf_height ? chart->height : shelf_height;
+
+        if(x > unwrap->width) unwrap->width = x;
+    }
+
+    unwrap->width += RHINO_LIGHTMAP_PADDING;
+    unwrap->height = y + shelf_height + RHINO_LIGHTMAP_PADDING;
+
+    // one output vertex per source vertex and chart, stamp tells which chart last wrote remap
+
+    unwrap->vertices = malloc(mesh->index_count * sizeof(rhino_vertex));
+    unwrap->indices = malloc(mesh->index_count * sizeof(unsigned int));
+    unwrap->index_count = mesh->index_count;
+
+    int* stamp = malloc(mesh->vertex_count * sizeof(int));
+    unsigned int* remap = malloc(mesh->vertex_count * sizeof(unsigned int));
+
+    for(unsigned int i = 0; i < mesh->vertex_count; i++) stamp[i] = -1;
+
+    for(unsigned int t = 0; t < triangle_count; t++) {
+        unwrap_chart* chart = &charts[charts_of[t]];
+
+        for(int k = 0; k < 3; k++) {
+            unsigned int source = mesh->indices[t * 3 + k];
+
+            if(stamp[source] != charts_of[t]) {
+                rhino_vertex* vertex = &unwrap->vertices[unwrap->vertex_count];
+
+                *vertex = mesh->vertices[source];
+
+                vertex->lightmap_uv[0] = (chart->x + RHINO_LIGHTMAP_PADDING + 0.5f + vertex->position[(chart->axis + 1) % 3] * texels_per_unit - chart->min[0]) / unwrap->width;
+                vertex->lightmap_uv[1] = (chart->y + RHINO_LIGHTMAP_PADDING + 0.5f + vertex->position[(chart->axis + 2) % 3] * texels_per_unit - chart->min[1]) / unwrap->height;
+
+                stamp[source] = charts_of[t];
+                remap[source] = unwrap->vertex_count++;
+            }
+
+            unwrap->indices[t * 3 + k] = remap[source];
+        }
+    }
+
+    unwrap->vertices = realloc(unwrap->vertices, unwrap->vertex_count * sizeof(rhino_vertex));
+
+    free(order);
+    free(welded);
+    free(axes);
+    free(edges);
+    free(parents);
+    free(charts_of);
+    free(chart_ids);
+    free(charts);
+    free(chart_order);
+    free(stamp);
+    free(remap);
+}
+
+void rhino_lightmap_unwrap_destroy(rhino_lightmap_unwrap* unwrap) {
+    free(unwrap->vertices);
+    free(unwrap->indices);
+
+    memset(unwrap, 0, sizeof(rhino_lightmap_unwrap));
+}
+
+// as laid out in EXT_texture_shared_exponent, 9 bit mantissas sharing a 5 bit exponent biased by 15
+
+unsigned int rhino_lightmap_pack_rgb9e5(vec3 color) {
+    const float max_value = (511.0f / 512.0f) * 65536.0f;
+
+    float rgb[3];
+
+    for(int k = 0; k < 3; k++) rgb[k] = color[k] > 0.0f ? (color[k] < max_value ? color[k] : max_value) : 0.0f;
+
+    float max_component = glm_max(rgb[0], glm_max(rgb[1], rgb[2]));
+
+    int exponent = (max_component > 0.0f ? (int)floorf(log2f(max_component)) : -16);
+    exponent = (exponent < -16 ? -16 : exponent) + 16;
+
+    float denominator = exp2f((float)(exponent - 15 - 9));
+
+    if((int)floorf(max_component / denominator + 0.5f) == 512) {
+        denominator *= 2.0f;
+        exponent++;
+    }
+
+    unsigned int packed = (unsigned int)exponent << 27;
+
+    for(int k = 0; k < 3; k++) packed |= (unsigned int)floorf(rgb[k] / denominator + 0.5f) << (9 * k);
+
+    return packed;
+}
+
+bool rhino_lightmap_save(const char* path, int width, int height, const unsigned int* texels, rhino_lightmap_unwrap* meshes, int mesh_count, rhino_lightmap_entity* entities, int entity_count) {
+    FILE* file = fopen(path, "wb");
+
+    if(file == NULL) {
+        printf("\nfailed to write lightmap %s", path);
+        return false;
+    }
+
+    rhino_lightmap_header header;
+    memcpy(header.magic, RHINO_LIGHTMAP_MAGIC, 4);
+    header.version = RHINO_LIGHTMAP_VERSION;
+    header.width = width;
+    header.height = height;
+    header.mesh_count = mesh_count;
+    header.entity_count = entity_count;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(texels, sizeof(unsigned int), (size_t)width * height, file);
+
+    for(int i = 0; i < mesh_count; i++) {
+        rhino_lightmap_unwrap* unwrap = &meshes[i];
+
+        rhino_lightmap_mesh_header mesh_header = { unwrap->source_vertex_count, unwrap->source_index_count, unwrap->vertex_count, unwrap->index_count };
+
+        fwrite(&mesh_header, sizeof(mesh_header), 1, file);
+        fwrite(unwrap->vertices, sizeof(rhino_vertex), unwrap->vertex_count, file);
+        fwrite(unwrap->indices, sizeof(unsigned int), unwrap->index_count, file);
+    }
+
+    fwrite(entities, sizeof(rhino_lightmap_entity), entity_count, file);
+
+    bool ok = ferror(file) == 0;
+
+    fclose(file);
+
+    return ok;
+}
+
+void rhino_lightmap_bind_program(unsigned int program) {
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "lightmap"), RHINO_LIGHTMAP_UNIT);
+}
+
+bool rhino_lightmap_load(rhino_lightmap* lightmap, const char* path, rhino_scene* scene) {
+    memset(lightmap, 0, sizeof(rhino_lightmap));
+
+    FILE* file = fopen(path, "rb");
+
+    if(file == NULL) {
+        printf("\nno baked lightmap at %s, run rhino_lightbake to make one", path);
+        return false;
+    }
+
+    rhino_lightmap_header header;
+
+    if(fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, RHINO_LIGHTMAP_MAGIC, 4) != 0 || header.version != RHINO_LIGHTMAP_VERSION) {
+        printf("\n%s is not a version %d lightmap", path, RHINO_LIGHTMAP_VERSION);
+        fclose(file);
+        return false;
+    }
+
+    unsigned int* texels = malloc((size_t)header.width * header.height * sizeof(unsigned int));
+    rhino_lightmap_mesh_header* mesh_headers = malloc(header.mesh_count * sizeof(rhino_lightmap_mesh_header));
+    rhino_vertex** vertices = calloc(header.mesh_count, sizeof(rhino_vertex*));
+    unsigned int** indices = calloc(header.mesh_count, sizeof(unsigned int*));
+    rhino_lightmap_entity* entities = malloc(header.entity_count * sizeof(rhino_lightmap_entity));
+
+    bool ok = fread(texels, sizeof(unsigned int), (size_t)header.width * header.height, file) == (size_t)header.width * header.height;
+
+    for(unsigned int i = 0; ok && i < header.mesh_count; i++) {
+        ok = fread(&mesh_headers[i], sizeof(rhino_lightmap_mesh_header), 1, file) == 1;
+
+        if(!ok) break;
+
+        vertices[i] = malloc(mesh_headers[i].vertex_count * sizeof(rhino_vertex));
+        indices[i] = malloc(mesh_headers[i].index_count * sizeof(unsigned int));
+
+        ok = fread(vertices[i], sizeof(rhino_vertex), mesh_headers[i].vertex_count, file) == mesh_headers[i].vertex_count;
+        ok = ok && fread(indices[i], sizeof(unsigned int), mesh_headers[i].index_count, file) == mesh_headers[i].index_count;
+    }
+
+    ok = ok && fread(entities, sizeof(rhino_lightmap_entity), header.entity_count, file) == header.entity_count;
+
+    fclose(file);
+
+    // every record has to point at an entity drawing the same mesh the bake unwrapped
+
+    for(unsigned int i = 0; ok && i < header.entity_count; i++) {
+        rhino_lightmap_entity* record = &entities[i];
+
+        ok = record->entity < (unsigned int)scene->entity_count && record->mesh < header.mesh_count;
+
+        if(!ok) break;
+
+        rhino_mesh* mesh = scene->entities[record->entity].mesh;
+
+        ok = mesh->vertex_count == mesh_headers[record->mesh].source_vertex_count && mesh->index_count == mesh_headers[record->mesh].source_index_count;
+    }
+
+    if(!ok) printf("\n%s is damaged or was baked from a different scene, rebake it", path);
+
+    if(ok) {
+        // swap each baked mesh for its unwrapped version once, the entities keep pointing at the same rhino_mesh
+
+        bool* replaced = calloc(header.mesh_count, sizeof(bool));
+
+        for(unsigned int i = 0; i < header.entity_count; i++) {
+            rhino_lightmap_entity* record = &entities[i];
+            rhino_entity* entity = &scene->entities[record->entity];
+
+            if(!replaced[record->mesh]) {
+                rhino_mesh_destroy(entity->mesh);
+                rhino_mesh_create(entity->mesh, vertices[record->mesh], mesh_headers[record->mesh].vertex_count, indices[record->mesh], mesh_headers[record->mesh].index_count);
+
+                replaced[record->mesh] = true;
+            }
+
+            glm_vec4_copy(record->scale_offset, entity->lightmap);
+
+            // the lod chain may have a different length now
+
+            entity->lod.lod = 0;
+            entity->lod.prev_lod = -1;
+            entity->lod.fade = 1.0f;
+        }
+
+        free(replaced);
+
+        glGenTextures(1, &lightmap->texture);
+        glBindTexture(GL_TEXTURE_2D, lightmap->texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB9_E5, header.width, header.height, 0, GL_RGB, GL_UNSIGNED_INT_5_9_9_9_REV, texels);
+
+        // no mips, charts are only padded for the full resolution
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        lightmap->width = header.width;
+        lightmap->height = header.height;
+        lightmap->entity_count = header.entity_count;
+        lightmap->loaded = true;
+
+        printf("\nlightmap loaded : %ux%u, %u entities from %u meshes", header.width, header.height, header.entity_count, header.mesh_count);
+    }
+
+    for(unsigned int i = 0; i < header.mesh_count; i++) {
+        free(vertices[i]);
+        free(indices[i]);
+    }
+
+    free(texels);
+    free(mesh_headers);
+    free(vertices);
+    free(indices);
+    free(entities);
+
+    return lightmap->loaded;
+}
+
+void rhino_lightmap_bind(rhino_lightmap* lightmap) {
+    glActiveTexture(GL_TEXTURE0 + RHINO_LIGHTMAP_UNIT);
+    glBindTexture(GL_TEXTURE_2D, lightmap->texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void rhino_lightmap_destroy(rhino_lightmap* lightmap) {
+    if(lightmap->texture) glDeleteTextures(1, &lightmap->texture);
+
+    memset(lightmap, 0, sizeof(rhino_lightmap));
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_mesh.h"
+#include "rhino_scene.h"
+
+// baked lighting for static entities, written by the rhino_lightbake tool and loaded by the demo. one rgb9e5 atlas
+// holds every baked entity, an entity samples it once per fragment at its lightmap uv times scale plus offset
+
+#define RHINO_LIGHTMAP_FILE "scene.lightmap"
+#define RHINO_LIGHTMAP_MAGIC "RLMP"
+#define RHINO_LIGHTMAP_VERSION 1
+
+#define RHINO_LIGHTMAP_UNIT 10
+
+// empty texels between charts, filled by dilation so bilinear filtering at a chart edge never reads another chart
+
+#define RHINO_LIGHTMAP_PADDING 3
+
+// file layout : header, width * height packed texels, per mesh a mesh header then its vertices and indices, then
+// the entity records. source counts identify the mesh the unwrap was made from
+
+typedef struct rhino_lightmap_header_t {
+    char magic[4];
+    unsigned int version;
+    unsigned int width, height;
+    unsigned int mesh_count;
+    unsigned int entity_count;
+} rhino_lightmap_header;
+
+typedef struct rhino_lightmap_mesh_header_t {
+    unsigned int source_vertex_count;
+    unsigned int source_index_count;
+    unsigned int vertex_count;
+    unsigned int index_count;
+} rhino_lightmap_mesh_header;
+
+// scale_offset maps the mesh's lightmap uvs into the entity's rect of the atlas
+
+typedef struct rhino_lightmap_entity_t {
+    unsigned int entity;
+    unsigned int mesh;
+    float scale_offset[4];
+} rhino_lightmap_entity;
+
+// a mesh split into charts, vertices on chart borders are duplicated. lightmap uvs span the whole width x height
+// texel layout, which every entity using the mesh gets a copy of. source counts are those of the mesh unwrapped
+
+typedef struct rhino_lightmap_unwrap_t {
+    unsigned int source_vertex_count;
+    unsigned int source_index_count;
+    rhino_vertex* vertices;
+    unsigned int vertex_count;
+    unsigned int* indices;
+    unsigned int index_count;
+    int width, height;
+    int chart_count;
+} rhino_lightmap_unwrap;
+
+typedef struct rhino_lightmap_t {
+    unsigned int texture;
+    int width, height;
+    int entity_count;
+    bool loaded;
+} rhino_lightmap;
+
+// ---- baking ---- //
+
+// groups connected triangles facing the same axis into charts, projects each chart onto its axis plane and packs
+// them at texels_per_unit (in mesh units) with RHINO_LIGHTMAP_PADDING between them
+
+void rhino_lightmap_unwrap_mesh(rhino_lightmap_unwrap* unwrap, rhino_mesh* mesh, float texels_per_unit);
+
+void rhino_lightmap_unwrap_destroy(rhino_lightmap_unwrap* unwrap);
+
+// shared exponent hdr texel, what GL_RGB9_E5 expects
+
+unsigned int rhino_lightmap_pack_rgb9e5(vec3 color);
+
+bool rhino_lightmap_save(const char* path, int width, int height, const unsigned int* texels, rhino_lightmap_unwrap* meshes, int mesh_count, rhino_lightmap_entity* entities, int entity_count);
+
+// ---- runtime ---- //
+
+// uploads the atlas, swaps the baked meshes for their unwrapped versions and gives the baked entities their rects.
+// returns false and leaves the scene alone when the file is missing or was baked from a different scene
+
+bool rhino_lightmap_load(rhino_lightmap* lightmap, const char* path, rhino_scene* scene);
+
+// points the lightmap sampler of a program at RHINO_LIGHTMAP_UNIT
+
+void rhino_lightmap_bind_program(unsigned int program);
+
+void rhino_lightmap_bind(rhino_lightmap* lightmap);
+
+void rhino_lightmap_destroy(rhino_lightmap* lightmap);
@@ -0,0 +1,414 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_global.h"
+#include "rhino_lights.h"
+
+// bounds arrays are padded so the last simd load of a row never reads past the end
+
+#define BOUNDS_SIZE (RHINO_CLUSTER_COUNT + 4)
+
+static int cluster_slice(rhino_lights* lights, float depth) {
+    int slice = (int)floorf(logf(depth / lights->bounds_near) / logf(lights->bounds_far / lights->bounds_near) * RHINO_CLUSTER_Z);
+
+    return slice < 0 ? 0 : (slice >= RHINO_CLUSTER_Z ? RHINO_CLUSTER_Z - 1 : slice);
+}
+
+static int cluster_tile(float ndc, int tiles) {
+    int tile = (int)floorf((ndc * 0.5f + 0.5f) * tiles);
+
+    return tile < 0 ? 0 : (tile >= tiles ? tiles - 1 : tile);
+}
+
+static void build_cluster_bounds(rhino_lights* lights) {
+    float tan_y = tanf(lights->bounds_fov * 0.5f);
+    float tan_x = tan_y * lights->bounds_aspect;
+    float ratio = lights->bounds_far / lights->bounds_near;
+
+    for(int z = 0; z < RHINO_CLUSTER_Z; z++) {
+        float near_depth = lights->bounds_near * powf(ratio, (float)z / RHINO_CLUSTER_Z);
+        float far_depth = lights->bounds_near * powf(ratio, (float)(z + 1) / RHINO_CLUSTER_Z);
+
+        for(int y = 0; y < RHINO_CLUSTER_Y; y++) {
+            float ndc_y[2] = { -1.0f + 2.0f * y / RHINO_CLUSTER_Y, -1.0f + 2.0f * (y + 1) / RHINO_CLUSTER_Y };
+
+            for(int x = 0; x < RHINO_CLUSTER_X; x++) {
+                float ndc_x[2] = { -1.0f + 2.0f * x / RHINO_CLUSTER_X, -1.0f + 2.0f * (x + 1) / RHINO_CLUSTER_X };
+
+                int cluster = x + RHINO_CLUSTER_X * (y + RHINO_CLUSTER_Y * z);
+
+                // tile edges spread out with depth, the box has to cover both the near and far face
+
+                float min_x = ndc_x[0] * tan_x * (ndc_x[0] < 0.0f ? far_depth : near_depth);
+                float max_x = ndc_x[1] * tan_x * (ndc_x[1] > 0.0f ? far_depth : near_depth);
+                float min_y = ndc_y[0] * tan_y * (ndc_y[0] < 0.0f ? far_depth : near_depth);
+                float max_y = ndc_y[1] * tan_y * (ndc_y[1] > 0.0f ? far_depth : near_depth);
+
+                lights->cluster_min[0][cluster] = min_x;
+                lights->cluster_min[1][cluster] = min_y;
+                lights->cluster_min[2][cluster] = -far_depth;
+                lights->cluster_max[0][cluster] = max_x;
+                lights->cluster_max[1][cluster] = max_y;
+                lights->cluster_max[2][cluster] = -near_depth;
+            }
+        }
+    }
+}
+
+static void add_to_cluster(rhino_lights* lights, int cluster, unsigned int light) {
+    unsigned int count = lights->cluster_counts[cluster]++;
+
+    // keep counting past the limit so the overflow can be reported
+
+    if(count < RHINO_CLUSTER_MAX_LIGHTS) lights->cluster_lists[cluster * RHINO_CLUSTER_MAX_LIGHTS + count] = light;
+}
+
+// sphere against every cluster of one row from x0 to x1 inclusive
+
+static void bin_row(rhino_lights* lights, int row, int x0, int x1, float* sphere, unsigned int light) {
+#if defined(__SSE2__)
+    __m128 center_x = _mm_set1_ps(sphere[0]);
+    __m128 center_y = _mm_set1_ps(sphere[1]);
+    __m128 center_z = _mm_set1_ps(sphere[2]);
+    __m128 radius_squared = _mm_set1_ps(sphere[3] * sphere[3]);
+    __m128 zero = _mm_setzero_ps();
+
+    for(int x = x0; x <= x1; x += 4) {
+        int cluster = row + x;
+
+        // distance from the centre to each box, per axis it is how far the centre sits outside the slab
+
+        __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&lights->cluster_min[0][cluster]), center_x), _mm_sub_ps(center_x, _mm_loadu_ps(&lights->cluster_max[0][cluster]))), zero);
+        __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&lights->cluster_min[1][cluster]), center_y), _mm_sub_ps(center_y, _mm_loadu_ps(&lights->cluster_max[1][cluster]))), zero);
+        __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&lights->cluster_min[2][cluster]), center_z), _mm_sub_ps(center_z, _mm_loadu_ps(&lights->cluster_max[2][cluster]))), zero);
+
+        __m128 distance_squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+        int mask = _mm_movemask_ps(_mm_cmple_ps(distance_squared, radius_squared));
+
+        // lanes past x1 belong to the next tiles or the padding
+
+        int lanes = x1 - x + 1;
+        if(lanes < 4) mask &= (1 << lanes) - 1;
+
+        while(mask) {
+            int lane = __builtin_ctz(mask);
+            mask &= mask - 1;
+
+            add_to_cluster(lights, cluster + lane, light);
+        }
+    }
+#else
+    float radius_squared = sphere[3] * sphere[3];
+
+    for(int x = x0; x <= x1; x++) {
+        int cluster = row + x;
+        float distance_squared = 0.0f;
+
+        for(int axis = 0; axis < 3; axis++) {
+            float d = fmaxf(fmaxf(lights->cluster_min[axis][cluster] - sphere[axis], sphere[axis] - lights->cluster_max[axis][cluster]), 0.0f);
+            distance_squared += d * d;
+        }
+
+        if(distance_squared <= radius_squared) add_to_cluster(lights, cluster, light);
+    }
+#endif
+}
+
+// bins every light into the clusters of slices [slice_begin, slice_end), only touches those clusters so
+// partitions can run in parallel
+
+static void bin_slices(rhino_lights* lights, int slice_begin, int slice_end) {
+    float tan_y = tanf(lights->bounds_fov * 0.5f);
+    float tan_x = tan_y * lights->bounds_aspect;
+
+    for(int i = slice_begin * RHINO_CLUSTER_X * RHINO_CLUSTER_Y; i < slice_end * RHINO_CLUSTER_X * RHINO_CLUSTER_Y; i++) lights->cluster_counts[i] = 0;
+
+    for(int i = 0; i < lights->shaded_count; i++) {
+        float* sphere = &lights->view_lights[i * 4];
+        float depth = -sphere[2];
+        float radius = sphere[3];
+
+        if(depth + radius < lights->bounds_near || depth - radius > lights->bounds_far) continue;
+
+        float near_depth = fmaxf(depth - radius, lights->bounds_near);
+        float far_depth = fminf(depth + radius, lights->bounds_far);
+
+        int slice0 = cluster_slice(lights, near_depth);
+        int slice1 = cluster_slice(lights, far_depth);
+
+        if(slice0 < slice_begin) slice0 = slice_begin;
+        if(slice1 >= slice_end) slice1 = slice_end - 1;
+        if(slice0 > slice1) continue;
+
+        // conservative tile rectangle, the sphere's box projected at its nearest and farthest depth
+
+        float ndc_x[4] = {
+            (sphere[0] - radius) / (near_depth * tan_x), (sphere[0] - radius) / (far_depth * tan_x),
+            (sphere[0] + radius) / (near_depth * tan_x), (sphere[0] + radius) / (far_depth * tan_x)
+        };
+
+        float ndc_y[4] = {
+            (sphere[1] - radius) / (near_depth * tan_y), (sphere[1] - radius) / (far_depth * tan_y),
+            (sphere[1] + radius) / (near_depth * tan_y), (sphere[1] + radius) / (far_depth * tan_y)
+        };
+
+        float min_x = fminf(fminf(ndc_x[0], ndc_x[1]), fminf(ndc_x[2], ndc_x[3]));
+        float max_x = fmaxf(fmaxf(ndc_x[0], ndc_x[1]), fmaxf(ndc_x[2], ndc_x[3]));
+        float min_y = fminf(fminf(ndc_y[0], ndc_y[1]), fminf(ndc_y[2], ndc_y[3]));
+        float max_y = fmaxf(fmaxf(ndc_y[0], ndc_y[1]), fmaxf(ndc_y[2], ndc_y[3]));
+
+        if(min_x > 1.0f || max_x < -1.0f || min_y > 1.0f || max_y < -1.0f) continue;
+
+        int x0 = cluster_tile(min_x, RHINO_CLUSTER_X), x1 = cluster_tile(max_x, RHINO_CLUSTER_X);
+        int y0 = cluster_tile(min_y, RHINO_CLUSTER_Y), y1 = cluster_tile(max_y, RHINO_CLUSTER_Y);
+
+        for(int z = slice0; z <= slice1; z++) {
+            for(int y = y0; y <= y1; y++) bin_row(lights, RHINO_CLUSTER_X * (y + RHINO_CLUSTER_Y * z), x0, x1, sphere, i);
+        }
+    }
+}
+
+// job over a range of partitions, each a run of z slices
+
+static void bin_partitions(void* data, int begin, int end) {
+    rhino_lights* lights = data;
+
+    for(int partition = begin; partition < end; partition++) {
+        bin_slices(lights, partition * RHINO_CLUSTER_Z / lights->thread_count, (partition + 1) * RHINO_CLUSTER_Z / lights->thread_count);
+    }
+}
+
+// empty buffers keep a few bytes so the texture stays complete
+
+static void create_texture_buffer(rhino_light_buffer* buffer, GLenum format) {
+    glGenBuffers(RHINO_FRAMES_MAX, buffer->buffers);
+    glGenTextures(RHINO_FRAMES_MAX, buffer->textures);
+
+    for(int i = 0; i < RHINO_FRAMES_MAX; i++) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer->buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_DYNAMIC_DRAW);
+        buffer->capacities[i] = 16;
+
+        glBindTexture(GL_TEXTURE_BUFFER, buffer->textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer->buffers[i]);
+    }
+}
+
+// the slot's copy is free once its fence passed, it is written in place unless it has to grow
+
+static void upload_texture_buffer(rhino_light_buffer* buffer, int slot, size_t size, void* data) {
+    if(size > buffer->capacities[slot]) {
+        size_t capacity = buffer->capacities[slot];
+
+        while(capacity < size) capacity *= 2;
+
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer->buffers[slot]);
+        glBufferData(GL_TEXTURE_BUFFER, capacity, NULL, GL_DYNAMIC_DRAW);
+        buffer->capacities[slot] = capacity;
+    }
+
+    rhino_frames_write(GL_TEXTURE_BUFFER, buffer->buffers[slot], 0, size, data);
+}
+
+static void destroy_texture_buffer(rhino_light_buffer* buffer) {
+    glDeleteBuffers(RHINO_FRAMES_MAX, buffer->buffers);
+    glDeleteTextures(RHINO_FRAMES_MAX, buffer->textures);
+}
+
+void rhino_lights_init(rhino_lights* lights) {
+    memset(lights, 0, sizeof(rhino_lights));
+
+    lights->thread_count = rhino.jobs.thread_count > 0 ? rhino.jobs.thread_count : 1;
+
+    for(int axis = 0; axis < 3; axis++) {
+        lights->cluster_min[axis] = calloc(BOUNDS_SIZE, sizeof(float));
+        lights->cluster_max[axis] = calloc(BOUNDS_SIZE, sizeof(float));
+    }
+
+    lights->cluster_lists = malloc(RHINO_CLUSTER_COUNT * RHINO_CLUSTER_MAX_LIGHTS * sizeof(unsigned int));
+
+    int max_texels;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+
+    lights->max_lights = max_texels / 2;
+
+    printf("\nclustered lighting, %dx%dx%d clusters, up to %d point lights", RHINO_CLUSTER_X, RHINO_CLUSTER_Y, RHINO_CLUSTER_Z, lights->max_lights);
+
+    create_texture_buffer(&lights->light_data, GL_RGBA32F);
+    create_texture_buffer(&lights->grid_data, GL_RG32UI);
+    create_texture_buffer(&lights->index_data, GL_R32UI);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void rhino_lights_bind_program(unsigned int program) {
+    glUseProgram(program);
+
+    glUniform1i(glGetUniformLocation(program, "light_data"), RHINO_LIGHT_DATA_UNIT);
+    glUniform1i(glGetUniformLocation(program, "cluster_grid"), RHINO_CLUSTER_GRID_UNIT);
+    glUniform1i(glGetUniformLocation(program, "light_indices"), RHINO_LIGHT_INDEX_UNIT);
+}
+
+int rhino_lights_add(rhino_lights* lights, vec3 position, float radius, vec3 color) {
+    if(lights->light_count >= lights->max_lights) return -1;
+
+    if(lights->light_count == lights->light_capacity) {
+        lights->light_capacity = lights->light_capacity ? lights->light_capacity * 2 : 256;
+        lights->lights = realloc(lights->lights, lights->light_capacity * sizeof(rhino_point_light));
+        lights->view_lights = realloc(lights->view_lights, lights->light_capacity * 4 * sizeof(float));
+    }
+
+    rhino_point_light* light = &lights->lights[lights->light_count];
+
+    glm_vec3_copy(position, light->position);
+    glm_vec3_copy(color, light->color);
+    light->radius = radius;
+    light->shadow = -1.0f;
+
+    return lights->light_count++;
+}
+
+void rhino_lights_clear(rhino_lights* lights) {
+    lights->light_count = 0;
+}
+
+void rhino_lights_update(rhino_lights* lights, rhino_camera* camera, float viewport_width, float viewport_height, rhino_frame_block* frame) {
+    double start = glfwGetTime();
+
+    // cluster boxes only depend on the projection
+
+    if(camera->fov != lights->bounds_fov || camera->aspect != lights->bounds_aspect || camera->near_plane != lights->bounds_near || camera->far_plane != lights->bounds_far) {
+        lights->bounds_fov = camera->fov;
+        lights->bounds_aspect = camera->aspect;
+        lights->bounds_near = camera->near_plane;
+        lights->bounds_far = camera->far_plane;
+
+        build_cluster_bounds(lights);
+    }
+
+    lights->shaded_count = lights->light_cap > 0 && lights->light_cap < lights->light_count ? lights->light_cap : lights->light_count;
+
+    // light spheres into view space
+
+    vec4* view = rhino_camera_view(camera);
+
+    for(int i = 0; i < lights->shaded_count; i++) {
+        rhino_point_light* light = &lights->lights[i];
+
+        glm_mat4_mulv3(view, light->position, 1.0f, &lights->view_lights[i * 4]);
+        lights->view_lights[i * 4 + 3] = light->radius;
+    }
+
+    // one partition per job, this thread bins alongside the workers until all of them are done
+
+    if(lights->thread_count < 1) lights->thread_count = 1;
+    if(lights->thread_count > RHINO_CLUSTER_Z) lights->thread_count = RHINO_CLUSTER_Z;
+
+    rhino_jobs_parallel_for(&rhino.jobs, lights->thread_count, 1, bin_partitions, lights);
+
+    // compact the fixed size lists into one index list, grid holds (offset, count) per cluster
+
+    unsigned int total = 0;
+
+    lights->stats.overflows = 0;
+    lights->stats.max_per_cluster = 0;
+
+    for(int i = 0; i < RHINO_CLUSTER_COUNT; i++) {
+        unsigned int count = lights->cluster_counts[i];
+
+        if(count > lights->stats.max_per_cluster) lights->stats.max_per_cluster = count;
+
+        if(count > RHINO_CLUSTER_MAX_LIGHTS) {
+            lights->stats.overflows += count - RHINO_CLUSTER_MAX_LIGHTS;
+            count = RHINO_CLUSTER_MAX_LIGHTS;
+        }
+
+        lights->cluster_counts[i] = count;
+        total += count;
+    }
+
+    if(total > lights->index_capacity) {
+        lights->index_capacity = total * 2;
+        lights->indices = realloc(lights->indices, lights->index_capacity * sizeof(unsigned int));
+    }
+
+    unsigned int offset = 0;
+
+    for(int i = 0; i < RHINO_CLUSTER_COUNT; i++) {
+        unsigned int count = lights->cluster_counts[i];
+
+        memcpy(&lights->indices[offset], &lights->cluster_lists[i * RHINO_CLUSTER_MAX_LIGHTS], count * sizeof(unsigned int));
+
+        lights->grid[i * 2] = offset;
+        lights->grid[i * 2 + 1] = count;
+
+        offset += count;
+    }
+
+    lights->stats.references = total;
+    lights->stats.binning_seconds = glfwGetTime() - start;
+
+    // upload and bind this frame's copies of the texture buffers
+
+    int slot = rhino.frames.slot;
+
+    upload_texture_buffer(&lights->light_data, slot, lights->shaded_count * sizeof(rhino_point_light), lights->lights);
+    upload_texture_buffer(&lights->grid_data, slot, sizeof(lights->grid), lights->grid);
+    upload_texture_buffer(&lights->index_data, slot, total * sizeof(unsigned int), lights->indices);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glActiveTexture(GL_TEXTURE0 + RHINO_LIGHT_DATA_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, lights->light_data.textures[slot]);
+    glActiveTexture(GL_TEXTURE0 + RHINO_CLUSTER_GRID_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, lights->grid_data.textures[slot]);
+    glActiveTexture(GL_TEXTURE0 + RHINO_LIGHT_INDEX_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, lights->index_data.textures[slot]);
+    glActiveTexture(GL_TEXTURE0);
+
+    // shader side slice lookup is log(depth) * scale - bias
+
+    float log_ratio = logf(lights->bounds_far / lights->bounds_near);
+
+    frame->cluster_params[0] = RHINO_CLUSTER_Z / log_ratio;
+    frame->cluster_params[1] = RHINO_CLUSTER_Z * logf(lights->bounds_near) / log_ratio;
+    frame->cluster_params[2] = viewport_width / RHINO_CLUSTER_X;
+    frame->cluster_params[3] = viewport_height / RHINO_CLUSTER_Y;
+
+    frame->cluster_size[0] = RHINO_CLUSTER_X;
+    frame->cluster_size[1] = RHINO_CLUSTER_Y;
+    frame->cluster_size[2] = RHINO_CLUSTER_Z;
+    frame->cluster_size[3] = lights->shaded_count;
+}
+
+void rhino_lights_destroy(rhino_lights* lights) {
+    destroy_texture_buffer(&lights->light_data);
+    destroy_texture_buffer(&lights->grid_data);
+    destroy_texture_buffer(&lights->index_data);
+
+    for(int axis = 0; axis < 3; axis++) {
+        free(lights->cluster_min[axis]);
+        free(lights->cluster_max[axis]);
+    }
+
+    free(lights->cluster_lists);
+    free(lights->indices);
+    free(lights->lights);
+    free(lights->view_lights);
+
+    memset(lights, 0, sizeof(rhino_lights));
+}
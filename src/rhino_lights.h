@@ -0,0 +1,119 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_camera.h"
+#include "rhino_uniforms.h"
+
+// cluster grid, X x Y screen tiles times Z slices spaced exponentially between the camera's near and far planes
+
+#define RHINO_CLUSTER_X 16
+#define RHINO_CLUSTER_Y 9
+#define RHINO_CLUSTER_Z 24
+#define RHINO_CLUSTER_COUNT (RHINO_CLUSTER_X * RHINO_CLUSTER_Y * RHINO_CLUSTER_Z)
+
+// lights past this many in a single cluster are dropped (and counted in stats.overflows)
+
+#define RHINO_CLUSTER_MAX_LIGHTS 256
+
+// texture units the light texture buffers live on, unit 0 is the albedo texture
+
+#define RHINO_LIGHT_DATA_UNIT 4
+#define RHINO_CLUSTER_GRID_UNIT 5
+#define RHINO_LIGHT_INDEX_UNIT 6
+
+// matches the light_data texture buffer, two rgba32f texels per light. shadow is the light's slot in the point
+// shadow atlas, -1 while it has no usable shadow
+
+typedef struct rhino_point_light_t {
+    vec3 position;
+    float radius;
+    vec3 color;
+    float shadow;
+} rhino_point_light;
+
+typedef struct rhino_light_stats_t {
+    double binning_seconds;
+    unsigned int references;
+    unsigned int overflows;
+    unsigned int max_per_cluster;
+} rhino_light_stats;
+
+// a texture buffer with a copy per frame in flight, each grows to fit and never shrinks
+
+typedef struct rhino_light_buffer_t {
+    unsigned int buffers[RHINO_FRAMES_MAX];
+    unsigned int textures[RHINO_FRAMES_MAX];
+    size_t capacities[RHINO_FRAMES_MAX];
+} rhino_light_buffer;
+
+typedef struct rhino_lights_t {
+    rhino_point_light* lights;
+    int light_count;
+    int light_capacity;
+
+    // two light_data texels per light must fit in GL_MAX_TEXTURE_BUFFER_SIZE
+
+    int max_lights;
+
+    // only the first light_cap lights are binned and shaded, 0 for all of them. shaded_count is how many that
+    // came to on the last update
+
+    int light_cap;
+    int shaded_count;
+
+    // z slices are split into this many ranges for the job system to bin in parallel, 1 bins on the calling thread
+    // only. starts at the job system's thread count
+
+    int thread_count;
+
+    // view space cluster bounds as separate arrays so four neighbouring clusters load into one simd register.
+    // rebuilt only when the camera projection changes
+
+    float* cluster_min[3];
+    float* cluster_max[3];
+    float bounds_fov, bounds_aspect, bounds_near, bounds_far;
+
+    // view space light spheres for the current frame
+
+    float* view_lights;
+
+    // per cluster fixed size lists written by the binning threads, compacted into indices afterwards
+
+    unsigned int* cluster_lists;
+    unsigned int cluster_counts[RHINO_CLUSTER_COUNT];
+    unsigned int grid[RHINO_CLUSTER_COUNT * 2];
+    unsigned int* indices;
+    unsigned int index_capacity;
+
+    // texture buffers
+
+    rhino_light_buffer light_data;
+    rhino_light_buffer grid_data;
+    rhino_light_buffer index_data;
+
+    rhino_light_stats stats;
+} rhino_lights;
+
+void rhino_lights_init(rhino_lights* lights);
+
+// points a program's light samplers at the light texture units
+
+void rhino_lights_bind_program(unsigned int program);
+
+// returns the light index, lights stay valid until rhino_lights_clear. -1 once max_lights is reached
+
+int rhino_lights_add(rhino_lights* lights, vec3 position, float radius, vec3 color);
+
+void rhino_lights_clear(rhino_lights* lights);
+
+// bins every light into the camera's clusters, uploads the texture buffers and fills the cluster fields of frame
+
+void rhino_lights_update(rhino_lights* lights, rhino_camera* camera, float viewport_width, float viewport_height, rhino_frame_block* frame);
+
+void rhino_lights_destroy(rhino_lights* lights);
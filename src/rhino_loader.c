@@ -0,0 +1,306 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// rhino headers
+
+#include "rhino_loader.h"
+#include "rhino_global.h"
+#include "textures.h"
+
+// gl work of a load on whichever context is current, returns the bytes it put on the gpu
+
+static size_t upload(rhino_load* load) {
+    if(load->type == RHINO_LOAD_TEXTURE) {
+        load->object = load_texture(load->path, 0);
+
+        // load_texture leaves it bound, size it the way it ended up with its mips
+
+        int width = 0, height = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        return (size_t)width * height * 3 * 4 / 3;
+    }
+
+    // the copy target is bound by nothing else, so the upload leaves every real binding alone
+
+    glGenBuffers(1, &load->object);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, load->object);
+    glBufferData(GL_COPY_WRITE_BUFFER, load->size, load->data, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    free(load->data);
+    load->data = NULL;
+
+    return load->size;
+}
+
+static void count_upload(rhino_loader_stats* stats, rhino_load* load, size_t bytes, double seconds) {
+    if(load->type == RHINO_LOAD_TEXTURE) stats->textures++;
+    else stats->buffers++;
+
+    stats->bytes += bytes;
+    stats->upload_seconds += seconds;
+}
+
+static void* loader_thread(void* data) {
+    rhino_loader* loader = data;
+
+    glfwMakeContextCurrent(loader->context);
+
+    pthread_mutex_lock(&loader->lock);
+
+    while(true) {
+        while(!loader->queued && !loader->quit) pthread_cond_wait(&loader->wake, &loader->lock);
+
+        // requests still queued are freed by destroy
+
+        if(loader->quit) break;
+
+        rhino_load* load = loader->queued;
+        loader->queued = load->next;
+
+        if(!loader->queued) loader->queued_tail = NULL;
+
+        pthread_mutex_unlock(&loader->lock);
+
+        double start = glfwGetTime();
+
+        size_t bytes = upload(load);
+
+        // flushed right away, a fence the render thread waits on has to reach the gpu from this context
+
+        load->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        double seconds = glfwGetTime() - start;
+
+        pthread_mutex_lock(&loader->lock);
+
+        count_upload(&loader->stats, load, bytes, seconds);
+
+        load->next = loader->fenced;
+        loader->fenced = load;
+
+        // the render thread may be asleep rendering on demand, it polls on its next frame
+
+        rhino_redraw_request(&rhino.redraw, RHINO_REDRAW_STREAMING);
+    }
+
+    pthread_mutex_unlock(&loader->lock);
+
+    glfwMakeContextCurrent(NULL);
+
+    return NULL;
+}
+
+void rhino_loader_init(rhino_loader* loader, GLFWwindow* context) {
+    memset(loader, 0, sizeof(rhino_loader));
+
+    loader->context = context;
+
+    pthread_mutex_init(&loader->lock, NULL);
+    pthread_cond_init(&loader->wake, NULL);
+
+    if(!context) return;
+
+    loader->running = pthread_create(&loader->thread, NULL, loader_thread, loader) == 0;
+
+    if(!loader->running) printf("\nfailed to start the loader thread, uploads stay on the render thread");
+}
+
+static void hand_over(rhino_loader* loader, rhino_load* load) {
+    loader->stats.handed++;
+    loader->stats.latency_seconds += glfwGetTime() - load->queued;
+    loader->outstanding--;
+
+    load->done(load->done_data, load->index, load->object);
+
+    free(load);
+}
+
+static void request(rhino_loader* loader, rhino_load* load) {
+    load->queued = glfwGetTime();
+    loader->outstanding++;
+
+    // no loader thread, the render thread pays for it right here
+
+    if(!loader->running) {
+        double start = glfwGetTime();
+        size_t bytes = upload(load);
+
+        count_upload(&loader->stats, load, bytes, glfwGetTime() - start);
+        hand_over(loader, load);
+
+        return;
+    }
+
+    load->next = NULL;
+
+    pthread_mutex_lock(&loader->lock);
+
+    if(loader->queued_tail) loader->queued_tail->next = load;
+    else loader->queued = load;
+
+    loader->queued_tail = load;
+
+    pthread_cond_signal(&loader->wake);
+    pthread_mutex_unlock(&loader->lock);
+}
+
+void rhino_loader_texture(rhino_loader* loader, const char* path, rhino_load_done done, void* done_data, int index) {
+    rhino_load* load = calloc(1, sizeof(rhino_load));
+
+    load->type = RHINO_LOAD_TEXTURE;
+    snprintf(load->path, RHINO_LOADER_PATH, "%s", path);
+    load->done = done;
+    load->done_data = done_data;
+    load->index = index;
+
+    request(loader, load);
+}
+
+void rhino_loader_buffer(rhino_loader* loader, void* data, size_t size, rhino_load_done done, void* done_data, int index) {
+    rhino_load* load = calloc(1, sizeof(rhino_load));
+
+    load->type = RHINO_LOAD_BUFFER;
+    load->data = data;
+    load->size = size;
+    load->done = done;
+    load->done_data = done_data;
+    load->index = index;
+
+    request(loader, load);
+}
+
+void rhino_loader_poll(rhino_loader* loader) {
+    if(loader->outstanding == 0) return;
+
+    double start = glfwGetTime();
+
+    // the loader pushes to the front, reversed what it fenced goes behind the loads already waiting so the list
+    // stays oldest first
+
+    pthread_mutex_lock(&loader->lock);
+
+    rhino_load* fenced = loader->fenced;
+    loader->fenced = NULL;
+
+    pthread_mutex_unlock(&loader->lock);
+
+    rhino_load* oldest = NULL;
+
+    while(fenced) {
+        rhino_load* next = fenced->next;
+
+        fenced->next = oldest;
+        oldest = fenced;
+        fenced = next;
+    }
+
+    rhino_load** link = &loader->waiting;
+
+    while(*link) link = &(*link)->next;
+
+    *link = oldest;
+
+    // a zero timeout only asks, waiting here would be the stall the loader is there to avoid. no flush bit either,
+    // it would flush this context and the fence is the loader's
+
+    link = &loader->waiting;
+
+    while(*link) {
+        rhino_load* load = *link;
+        GLenum status = glClientWaitSync(load->fence, 0, 0);
+
+        if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            link = &load->next;
+            continue;
+        }
+
+        *link = load->next;
+
+        glDeleteSync(load->fence);
+        hand_over(loader, load);
+    }
+
+    loader->stats.poll_seconds += glfwGetTime() - start;
+
+    // fenced loads still on the gpu are only seen by the next frame's poll
+
+    if(loader->waiting) rhino_redraw_request(&rhino.redraw, RHINO_REDRAW_PROGRESSIVE);
+}
+
+void rhino_loader_finish(rhino_loader* loader) {
+    while(true) {
+        rhino_loader_poll(loader);
+
+        if(loader->outstanding == 0) return;
+
+        nanosleep(&(struct timespec){ 0, 1000000 }, NULL);
+    }
+}
+
+void rhino_loader_print_stats(rhino_loader* loader) {
+    pthread_mutex_lock(&loader->lock);
+
+    rhino_loader_stats stats = loader->stats;
+    memset(&loader->stats, 0, sizeof(rhino_loader_stats));
+
+    pthread_mutex_unlock(&loader->lock);
+
+    if(stats.textures + stats.buffers == 0) return;
+
+    printf("loader : %u textures and %u buffers uploaded (%.2f MB) in %.3f ms %s, handed over %.3f ms after the request on average - %.3f ms polling\n",
+        stats.textures, stats.buffers, stats.bytes / (1024.0 * 1024.0), stats.upload_seconds * 1000.0, loader->running ? "on the loader thread" : "on the render thread",
+        stats.handed ? stats.latency_seconds * 1000.0 / stats.handed : 0.0, stats.poll_seconds * 1000.0);
+}
+
+static void delete_load(rhino_load* load) {
+    if(load->fence) glDeleteSync(load->fence);
+
+    if(load->object && load->type == RHINO_LOAD_TEXTURE) glDeleteTextures(1, &load->object);
+    else if(load->object) glDeleteBuffers(1, &load->object);
+
+    free(load->data);
+    free(load);
+}
+
+void rhino_loader_destroy(rhino_loader* loader) {
+    if(loader->running) {
+        pthread_mutex_lock(&loader->lock);
+
+        loader->quit = true;
+
+        pthread_cond_signal(&loader->wake);
+        pthread_mutex_unlock(&loader->lock);
+
+        pthread_join(loader->thread, NULL);
+    }
+
+    // the objects are shared, deleting them from this context frees them for both
+
+    rhino_load* lists[] = { loader->queued, loader->fenced, loader->waiting };
+
+    for(int i = 0; i < 3; i++) {
+        rhino_load* load = lists[i];
+
+        while(load) {
+            rhino_load* next = load->next;
+
+            delete_load(load);
+            load = next;
+        }
+    }
+
+    pthread_mutex_destroy(&loader->lock);
+    pthread_cond_destroy(&loader->wake);
+
+    memset(loader, 0, sizeof(rhino_loader));
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// background uploads. a hidden window's context shares objects with the render thread's and is current on a loader
+// thread, which decodes textures, fills buffers and builds mips there. every finished object is fenced and only
+// handed to the render thread once its fence passed, so the render thread never waits on an upload or touches an
+// object the loader is still writing. vertex arrays are not shared between contexts, those stay the receiver's to
+// build around a handed over buffer
+
+#define RHINO_LOADER_PATH 256
+
+// called on the render thread from rhino_loader_poll with the finished object, index is whatever the request passed
+
+typedef void (*rhino_load_done)(void* data, int index, unsigned int object);
+
+typedef enum rhino_load_type_t {
+    RHINO_LOAD_TEXTURE,
+    RHINO_LOAD_BUFFER
+} rhino_load_type;
+
+typedef struct rhino_load_t {
+    rhino_load_type type;
+
+    char path[RHINO_LOADER_PATH];
+    void* data;
+    size_t size;
+
+    unsigned int object;
+    GLsync fence;
+    double queued;
+
+    rhino_load_done done;
+    void* done_data;
+    int index;
+
+    struct rhino_load_t* next;
+} rhino_load;
+
+// taken and reset by rhino_loader_print_stats. upload is the loader thread's time on the loads, latency from a
+// request to its handover, poll the render thread's own cost of taking them
+
+typedef struct rhino_loader_stats_t {
+    unsigned int textures;
+    unsigned int buffers;
+    size_t bytes;
+    double upload_seconds;
+
+    unsigned int handed;
+    double latency_seconds;
+    double poll_seconds;
+} rhino_loader_stats;
+
+typedef struct rhino_loader_t {
+    GLFWwindow* context;
+    pthread_t thread;
+    bool running;
+
+    // requests waiting for the loader thread and loads it fenced, both under lock. fenced moves to the render
+    // thread's waiting list on every poll
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool quit;
+
+    rhino_load* queued;
+    rhino_load* queued_tail;
+    rhino_load* fenced;
+
+    // render thread only, loads whose fence has not passed yet and everything requested but not handed over
+
+    rhino_load* waiting;
+    int outstanding;
+
+    rhino_loader_stats stats;
+} rhino_loader;
+
+// render thread, after glad is loaded. context is a window sharing objects with the current one, made current on
+// the loader thread. null loads everything on the spot on the render thread instead
+
+void rhino_loader_init(rhino_loader* loader, GLFWwindow* context);
+
+// loads the image at path into a mipmapped texture
+
+void rhino_loader_texture(rhino_loader* loader, const char* path, rhino_load_done done, void* done_data, int index);
+
+// uploads size bytes of data into a static buffer, data is malloc'd and the loader frees it
+
+void rhino_loader_buffer(rhino_loader* loader, void* data, size_t size, rhino_load_done done, void* done_data, int index);
+
+// hands over every load whose fence passed, once per frame on the render thread
+
+void rhino_loader_poll(rhino_loader* loader);
+
+// waits until everything requested so far is handed over
+
+void rhino_loader_finish(rhino_loader* loader);
+
+void rhino_loader_print_stats(rhino_loader* loader);
+
+// stops the loader thread, objects never handed over are deleted without their callback
+
+void rhino_loader_destroy(rhino_loader* loader);
@@ -0,0 +1,522 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_lod.h"
+#include "rhino_mesh.h"
+#include "rhino_global.h"
+
+// garland & heckbert quadric, symmetric 4x4 matrix stored as the upper triangle. w is the accumulated area so
+// the error can be normalised back into squared object-space distance
+
+typedef struct quadric_t {
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+    double w;
+} quadric;
+
+typedef struct collapse_t {
+    unsigned int from, to;
+    double cost;
+} collapse;
+
+typedef struct edge_t {
+    unsigned int a, b;
+} edge;
+
+typedef struct sorted_position_t {
+    float p[3];
+    unsigned int id;
+} sorted_position;
+
+// boundary edges get a perpendicular plane this many times heavier than a face, keeps open borders in place
+
+#define BOUNDARY_WEIGHT 10.0
+
+// give up on a level after this many passes over the edge list
+
+#define MAX_PASSES 64
+
+static void quadric_from_plane(quadric* q, double nx, double ny, double nz, double d, double w) {
+    q->a00 = nx * nx * w; q->a01 = nx * ny * w; q->a02 = nx * nz * w;
+    q->a11 = ny * ny * w; q->a12 = ny * nz * w;
+    q->a22 = nz * nz * w;
+    q->b0 = nx * d * w; q->b1 = ny * d * w; q->b2 = nz * d * w;
+    q->c = d * d * w;
+    q->w = w;
+}
+
+static void quadric_add(quadric* dst, const quadric* src) {
+    dst->a00 += src->a00; dst->a01 += src->a01; dst->a02 += src->a02;
+    dst->a11 += src->a11; dst->a12 += src->a12;
+    dst->a22 += src->a22;
+    dst->b0 += src->b0; dst->b1 += src->b1; dst->b2 += src->b2;
+    dst->c += src->c;
+    dst->w += src->w;
+}
+
+// mean squared distance of p to the planes accumulated in q (and q2 if not null)
+
+static double quadric_error(const quadric* q, const quadric* q2, const float* p) {
+    quadric s = *q;
+
+    if(q2) quadric_add(&s, q2);
+
+    double x = p[0], y = p[1], z = p[2];
+
+    double e = s.a00 * x * x + 2.0 * s.a01 * x * y + 2.0 * s.a02 * x * z
+             + s.a11 * y * y + 2.0 * s.a12 * y * z
+             + s.a22 * z * z
+             + 2.0 * (s.b0 * x + s.b1 * y + s.b2 * z)
+             + s.c;
+
+    if(e < 0.0) e = 0.0;
+
+    return s.w > 0.0 ? e / s.w : e;
+}
+
+static void triangle_normal(const float* p0, const float* p1, const float* p2, double* n) {
+    double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+static int compare_positions(const void* a, const void* b) {
+    const sorted_position* pa = a;
+    const sorted_position* pb = b;
+
+    for(int i = 0; i < 3; i++) {
+        if(pa->p[i] < pb->p[i]) return -1;
+        if(pa->p[i] > pb->p[i]) return 1;
+    }
+
+    return 0;
+}
+
+static int compare_edges(const void* a, const void* b) {
+    const edge* ea = a;
+    const edge* eb = b;
+
+    if(ea->a != eb->a) return ea->a < eb->a ? -1 : 1;
+    if(ea->b != eb->b) return ea->b < eb->b ? -1 : 1;
+    return 0;
+}
+
+static int compare_collapses(const void* a, const void* b) {
+    const collapse* ca = a;
+    const collapse* cb = b;
+
+    if(ca->cost < cb->cost) return -1;
+    if(ca->cost > cb->cost) return 1;
+    return 0;
+}
+
+// sorted unique (min, max) edges of the triangle list, counts[i] receives how many triangles use edge i
+
+static unsigned int collect_edges(const unsigned int* indices, unsigned int index_count, edge* edges, unsigned int* counts) {
+    unsigned int raw_count = 0;
+
+    for(unsigned int i = 0; i < index_count; i += 3) {
+        for(int k = 0; k < 3; k++) {
+            unsigned int a = indices[i + k];
+            unsigned int b = indices[i + (k + 1) % 3];
+
+            edges[raw_count].a = a < b ? a : b;
+            edges[raw_count].b = a < b ? b : a;
+            raw_count++;
+        }
+    }
+
+    qsort(edges, raw_count, sizeof(edge), compare_edges);
+
+    unsigned int unique_count = 0;
+
+    for(unsigned int i = 0; i < raw_count; i++) {
+        if(unique_count > 0 && compare_edges(&edges[unique_count - 1], &edges[i]) == 0) {
+            counts[unique_count - 1]++;
+            continue;
+        }
+
+        edges[unique_count] = edges[i];
+        counts[unique_count] = 1;
+        unique_count++;
+    }
+
+    return unique_count;
+}
+
+// a collapse is rejected if any surviving triangle around from would flip or become degenerate
+
+static bool collapse_flips(const rhino_vertex* vertices, const unsigned int* indices, const unsigned int* adjacency_offsets, const unsigned int* adjacency, unsigned int from, unsigned int to) {
+    for(unsigned int i = adjacency_offsets[from]; i < adjacency_offsets[from + 1]; i++) {
+        const unsigned int* tri = &indices[adjacency[i] * 3];
+
+        if(tri[0] == to || tri[1] == to || tri[2] == to) continue;
+
+        const float* before[3];
+        const float* after[3];
+
+        for(int k = 0; k < 3; k++) {
+            before[k] = vertices[tri[k]].position;
+            after[k] = tri[k] == from ? vertices[to].position : vertices[tri[k]].position;
+        }
+
+        double n0[3], n1[3];
+
+        triangle_normal(before[0], before[1], before[2], n0);
+        triangle_normal(after[0], after[1], after[2], n1);
+
+        double len0 = sqrt(n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]);
+        double len1 = sqrt(n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]);
+
+        if(len1 <= 1e-12 * (len0 + 1e-12)) return true;
+
+        if(n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= 0.2 * len0 * len1) return true;
+    }
+
+    return false;
+}
+
+unsigned int rhino_lod_simplify(const rhino_vertex* vertices, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count, unsigned int target_index_count, unsigned int* dest, float* error) {
+    memcpy(dest, indices, index_count * sizeof(unsigned int));
+
+    double max_error = 0.0;
+
+    quadric* quadrics = calloc(vertex_count, sizeof(quadric));
+    unsigned int* remap = malloc(vertex_count * sizeof(unsigned int));
+    bool* locked = calloc(vertex_count, sizeof(bool));
+    bool* touched = malloc(vertex_count * sizeof(bool));
+    edge* edges = malloc(index_count * sizeof(edge));
+    unsigned int* edge_counts = malloc(index_count * sizeof(unsigned int));
+    collapse* collapses = malloc(index_count * sizeof(collapse));
+    unsigned int* adjacency_offsets = malloc((vertex_count + 1) * sizeof(unsigned int));
+    unsigned int* adjacency = malloc(index_count * sizeof(unsigned int));
+
+    for(unsigned int i = 0; i < vertex_count; i++) remap[i] = i;
+
+    // vertices that share a position with another vertex sit on a uv seam, moving them would tear the mesh open
+
+    sorted_position* sorted = malloc(vertex_count * sizeof(sorted_position));
+
+    for(unsigned int i = 0; i < vertex_count; i++) {
+        memcpy(sorted[i].p, vertices[i].position, sizeof(sorted[i].p));
+        sorted[i].id = i;
+    }
+
+    qsort(sorted, vertex_count, sizeof(sorted_position), compare_positions);
+
+    for(unsigned int i = 1; i < vertex_count; i++) {
+        if(compare_positions(&sorted[i - 1], &sorted[i]) == 0) {
+            locked[sorted[i - 1].id] = true;
+            locked[sorted[i].id] = true;
+        }
+    }
+
+    free(sorted);
+
+    // accumulate area weighted face planes per vertex
+
+    for(unsigned int i = 0; i < index_count; i += 3) {
+        const float* p0 = vertices[dest[i]].position;
+        const float* p1 = vertices[dest[i + 1]].position;
+        const float* p2 = vertices[dest[i + 2]].position;
+
+        double n[3];
+        triangle_normal(p0, p1, p2, n);
+
+        double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        if(len <= 0.0) continue;
+
+        n[0] /= len; n[1] /= len; n[2] /= len;
+
+        quadric q;
+        quadric_from_plane(&q, n[0], n[1], n[2], -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]), len * 0.5);
+
+        for(int k = 0; k < 3; k++) quadric_add(&quadrics[dest[i + k]], &q);
+    }
+
+    // constrain open borders with planes perpendicular to their only face
+
+    unsigned int edge_count = collect_edges(dest, index_count, edges, edge_counts);
+
+    for(unsigned int i = 0; i < index_count; i += 3) {
+        const float* p[3] = { vertices[dest[i]].position, vertices[dest[i + 1]].position, vertices[dest[i + 2]].position };
+
+        double n[3];
+        triangle_normal(p[0], p[1], p[2], n);
+
+        for(int k = 0; k < 3; k++) {
+            unsigned int a = dest[i + k];
+            unsigned int b = dest[i + (k + 1) % 3];
+
+            edge key = { a < b ? a : b, a < b ? b : a };
+            edge* found = bsearch(&key, edges, edge_count, sizeof(edge), compare_edges);
+
+            if(!found || edge_counts[found - edges] != 1) continue;
+
+            const float* pa = p[k];
+            const float* pb = p[(k + 1) % 3];
+
+            double e[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+            double bn[3] = { e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0] };
+            double len = sqrt(bn[0] * bn[0] + bn[1] * bn[1] + bn[2] * bn[2]);
+
+            if(len <= 0.0) continue;
+
+            bn[0] /= len; bn[1] /= len; bn[2] /= len;
+
+            double edge_length_sq = e[0] * e[0] + e[1] * e[1] + e[2] * e[2];
+
+            quadric q;
+            quadric_from_plane(&q, bn[0], bn[1], bn[2], -(bn[0] * pa[0] + bn[1] * pa[1] + bn[2] * pa[2]), BOUNDARY_WEIGHT * edge_length_sq);
+
+            // boundary planes constrain position but should not dilute the area used to normalise the error
+
+            q.w = 0.0;
+
+            quadric_add(&quadrics[a], &q);
+            quadric_add(&quadrics[b], &q);
+        }
+    }
+
+    // greedy passes, each pass collapses the cheapest independent edges then compacts the index list
+
+    for(int pass = 0; pass < MAX_PASSES && index_count > target_index_count; pass++) {
+        edge_count = collect_edges(dest, index_count, edges, edge_counts);
+
+        unsigned int collapse_count = 0;
+
+        for(unsigned int i = 0; i < edge_count; i++) {
+            unsigned int a = edges[i].a, b = edges[i].b;
+
+            if(locked[a] && locked[b]) continue;
+
+            double cost_ab = locked[a] ? INFINITY : quadric_error(&quadrics[a], &quadrics[b], vertices[b].position);
+            double cost_ba = locked[b] ? INFINITY : quadric_error(&quadrics[a], &quadrics[b], vertices[a].position);
+
+            collapses[collapse_count].from = cost_ab <= cost_ba ? a : b;
+            collapses[collapse_count].to = cost_ab <= cost_ba ? b : a;
+            collapses[collapse_count].cost = cost_ab <= cost_ba ? cost_ab : cost_ba;
+            collapse_count++;
+        }
+
+        if(collapse_count == 0) break;
+
+        qsort(collapses, collapse_count, sizeof(collapse), compare_collapses);
+
+        // vertex -> triangle adjacency for the flip test
+
+        memset(adjacency_offsets, 0, (vertex_count + 1) * sizeof(unsigned int));
+
+        for(unsigned int i = 0; i < index_count; i++) adjacency_offsets[dest[i] + 1]++;
+        for(unsigned int i = 0; i < vertex_count; i++) adjacency_offsets[i + 1] += adjacency_offsets[i];
+
+        for(unsigned int i = 0; i < index_count; i++) adjacency[adjacency_offsets[dest[i]]++] = i / 3;
+        for(unsigned int i = vertex_count; i > 0; i--) adjacency_offsets[i] = adjacency_offsets[i - 1];
+
+        adjacency_offsets[0] = 0;
+
+        memset(touched, 0, vertex_count * sizeof(bool));
+
+        // every collapse removes about two triangles, stop once the target is reached
+
+        unsigned int triangles_to_remove = (index_count - target_index_count) / 3;
+        unsigned int triangles_removed = 0;
+        unsigned int applied = 0;
+
+        for(unsigned int i = 0; i < collapse_count && triangles_removed < triangles_to_remove; i++) {
+            collapse* c = &collapses[i];
+
+            if(touched[c->from] || touched[c->to]) continue;
+
+            if(collapse_flips(vertices, dest, adjacency_offsets, adjacency, c->from, c->to)) continue;
+
+            // lock the whole neighbourhood of the removed vertex for the rest of this pass
+
+            for(unsigned int j = adjacency_offsets[c->from]; j < adjacency_offsets[c->from + 1]; j++) {
+                const unsigned int* tri = &dest[adjacency[j] * 3];
+
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+
+                if(tri[0] == c->to || tri[1] == c->to || tri[2] == c->to) triangles_removed++;
+            }
+
+            remap[c->from] = c->to;
+            quadric_add(&quadrics[c->to], &quadrics[c->from]);
+
+            if(c->cost > max_error) max_error = c->cost;
+
+            applied++;
+        }
+
+        if(applied == 0) break;
+
+        // apply remap and drop collapsed triangles
+
+        unsigned int write = 0;
+
+        for(unsigned int i = 0; i < index_count; i += 3) {
+            unsigned int a = remap[dest[i]], b = remap[dest[i + 1]], c = remap[dest[i + 2]];
+
+            if(a == b || b == c || a == c) continue;
+
+            dest[write++] = a;
+            dest[write++] = b;
+            dest[write++] = c;
+        }
+
+        index_count = write;
+    }
+
+    free(quadrics);
+    free(remap);
+    free(locked);
+    free(touched);
+    free(edges);
+    free(edge_counts);
+    free(collapses);
+    free(adjacency_offsets);
+    free(adjacency);
+
+    if(error) *error = (float)sqrt(max_error);
+
+    return index_count;
+}
+
+unsigned int* rhino_lod_build_chain(rhino_mesh* mesh, unsigned int* total_index_count) {
+    // worst case every lod is as large as the source
+
+    unsigned int* chain = malloc(mesh->index_count * RHINO_MESH_MAX_LODS * sizeof(unsigned int));
+
+    memcpy(chain, mesh->indices, mesh->index_count * sizeof(unsigned int));
+
+    mesh->lods[0].index_offset = 0;
+    mesh->lods[0].index_count = mesh->index_count;
+    mesh->lods[0].error = 0.0f;
+    mesh->lod_count = 1;
+
+    unsigned int total = mesh->index_count;
+
+    while(mesh->lod_count < RHINO_MESH_MAX_LODS) {
+        rhino_mesh_lod* prev = &mesh->lods[mesh->lod_count - 1];
+
+        unsigned int target = (unsigned int)(prev->index_count * RHINO_LOD_REDUCTION) / 3 * 3;
+
+        if(target < RHINO_LOD_MIN_TRIANGLES * 3) break;
+
+        float error;
+        unsigned int count = rhino_lod_simplify(mesh->vertices, mesh->vertex_count, &chain[prev->index_offset], prev->index_count, target, &chain[total], &error);
+
+        // not worth a level if it barely removed anything
+
+        if(count == 0 || count > prev->index_count * 0.9f) break;
+
+        rhino_mesh_lod* lod = &mesh->lods[mesh->lod_count++];
+
+        lod->index_offset = total;
+        lod->index_count = count;
+        lod->error = glm_max(error, prev->error);
+
+        total += count;
+    }
+
+    *total_index_count = total;
+
+    return chain;
+}
+
+int rhino_lod_select(rhino_mesh* mesh, mat4 model, vec3 eye, float pixels_per_unit, float threshold, int bias) {
+    // world space bounding sphere, errors scale with the largest axis of the model matrix
+
+    vec3 center;
+    glm_mat4_mulv3(model, mesh->sphere, 1.0f, center);
+
+    float scale = glm_max(glm_vec3_norm(model[0]), glm_max(glm_vec3_norm(model[1]), glm_vec3_norm(model[2])));
+    float distance = glm_vec3_distance(center, eye) - mesh->sphere[3] * scale;
+
+    if(distance < 0.001f) distance = 0.001f;
+
+    int lod = 0;
+
+    for(int i = 1; i < mesh->lod_count; i++) {
+        float projected = mesh->lods[i].error * scale * pixels_per_unit / distance;
+
+        if(projected > threshold) break;
+
+        lod = i;
+    }
+
+    lod += bias;
+
+    if(lod < 0) lod = 0;
+    if(lod >= mesh->lod_count) lod = mesh->lod_count - 1;
+
+    return lod;
+}
+
+void rhino_lod_update(rhino_lod_state* state, int target_lod, float delta_time, bool crossfade) {
+    if(target_lod != state->lod) {
+        state->prev_lod = crossfade ? state->lod : -1;
+        state->lod = target_lod;
+        state->fade = crossfade ? 0.0f : 1.0f;
+        return;
+    }
+
+    if(state->prev_lod >= 0) {
+        state->fade += delta_time / RHINO_LOD_FADE_TIME;
+
+        if(state->fade >= 1.0f || !crossfade) {
+            state->fade = 1.0f;
+            state->prev_lod = -1;
+        }
+    }
+}
+
+void rhino_lod_fades(rhino_lod_state* state, float fades[2]) {
+    // complementary dither patterns, positive fade keeps cells below it and negative keeps the rest
+
+    fades[0] = state->prev_lod < 0 ? 0.0f : state->fade;
+    fades[1] = -state->fade;
+}
+
+void rhino_lod_record(rhino_mesh* mesh, rhino_lod_state* state, rhino_command_buffer* buffer, rhino_object_block* block) {
+    float fades[2];
+    rhino_lod_fades(state, fades);
+
+    buffer->counters.triangles_full_detail += mesh->lods[0].index_count / 3;
+
+    if(state->prev_lod < 0 || state->fade > 0.0f) {
+        block->params[1] = fades[0];
+
+        rhino_command_object(buffer, block);
+        rhino_mesh_record(mesh, state->lod, buffer);
+    }
+
+    if(state->prev_lod < 0) return;
+
+    block->params[1] = fades[1];
+
+    rhino_command_object(buffer, block);
+    rhino_mesh_record(mesh, state->prev_lod, buffer);
+
+    buffer->counters.lod_fades++;
+}
+
+void rhino_lod_submit(rhino_mesh* mesh, rhino_lod_state* state, mat4 model, float pixels_per_unit) {
+    int target = 0;
+
+    if(rhino.lod.enabled) target = rhino_lod_select(mesh, model, rhino.camera.position, pixels_per_unit, rhino.lod.error_threshold, rhino.lod.bias);
+
+    rhino_lod_update(state, target, rhino.delta_time, rhino.lod.crossfade);
+}
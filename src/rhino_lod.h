@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_mesh.h"
+#include "rhino_uniforms.h"
+#include "rhino_commands.h"
+
+// each lod aims for this fraction of the previous lod's triangles, chain stops early when simplification stalls
+
+#define RHINO_LOD_REDUCTION 0.5f
+#define RHINO_LOD_MIN_TRIANGLES 8
+
+// seconds taken to dither between two lods when cross-fading is enabled
+
+#define RHINO_LOD_FADE_TIME 0.3f
+
+// per-object selection state, needed to cross-fade from the previously drawn lod
+
+typedef struct rhino_lod_state_t {
+    int lod;
+    int prev_lod;
+    float fade;
+} rhino_lod_state;
+
+// quadric error metric simplification of an indexed triangle list down to roughly target_index_count indices.
+// writes the new index list to dest (same capacity as indices) and returns its length. vertices are never moved,
+// collapses snap to an existing endpoint so uvs stay valid. error receives the object-space deviation introduced
+
+unsigned int rhino_lod_simplify(const rhino_vertex* vertices, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count, unsigned int target_index_count, unsigned int* dest, float* error);
+
+// fills mesh->lods from mesh->indices, returns the concatenated index buffer of every lod (caller frees)
+
+unsigned int* rhino_lod_build_chain(rhino_mesh* mesh, unsigned int* total_index_count);
+
+// picks the coarsest lod whose error projects to less than threshold pixels on screen.
+// pixels_per_unit is the screen height in pixels of a 1 unit object 1 unit away from the camera
+
+int rhino_lod_select(rhino_mesh* mesh, mat4 model, vec3 eye, float pixels_per_unit, float threshold, int bias);
+
+// advance the state towards target_lod, starting a cross-fade when the selection changes
+
+void rhino_lod_update(rhino_lod_state* state, int target_lod, float delta_time, bool crossfade);
+
+// lod_fade values for the object blocks of the current lod (fades[0]) and the outgoing lod (fades[1])
+
+void rhino_lod_fades(rhino_lod_state* state, float fades[2]);
+
+// records the draws of the mesh for the given state, block is the object's block and gets the fade value of each
+// draw. a second draw with the outgoing lod only while cross-fading
+
+void rhino_lod_record(rhino_mesh* mesh, rhino_lod_state* state, rhino_command_buffer* buffer, rhino_object_block* block);
+
+// selects (using rhino.lod settings) and updates the state, call once per frame before drawing. only touches the
+// state, so entities can be submitted from several threads at once
+
+void rhino_lod_submit(rhino_mesh* mesh, rhino_lod_state* state, mat4 model, float pixels_per_unit);
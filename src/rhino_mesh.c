@@ -0,0 +1,197 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_mesh.h"
+#include "rhino_lod.h"
+#include "rhino_global.h"
+
+void rhino_mesh_create(rhino_mesh* mesh, const rhino_vertex* vertices, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count) {
+    memset(mesh, 0, sizeof(rhino_mesh));
+
+    mesh->vertex_count = vertex_count;
+    mesh->vertices = malloc(vertex_count * sizeof(rhino_vertex));
+    memcpy(mesh->vertices, vertices, vertex_count * sizeof(rhino_vertex));
+
+    mesh->index_count = index_count;
+    mesh->indices = malloc(index_count * sizeof(unsigned int));
+    memcpy(mesh->indices, indices, index_count * sizeof(unsigned int));
+
+    // bounds, used for lod selection and culling
+
+    glm_aabb_invalidate(mesh->bounds);
+
+    for(unsigned int i = 0; i < vertex_count; i++) {
+        glm_vec3_minv(mesh->bounds[0], (float*)vertices[i].position, mesh->bounds[0]);
+        glm_vec3_maxv(mesh->bounds[1], (float*)vertices[i].position, mesh->bounds[1]);
+    }
+
+    glm_aabb_center(mesh->bounds, mesh->sphere);
+    mesh->sphere[3] = glm_aabb_radius(mesh->bounds);
+
+    // object space triangle bvh of the full detail mesh, picking never uses the simplified lods
+
+    rhino_bvh_build_triangles(&mesh->bvh, (float*)mesh->vertices, sizeof(rhino_vertex) / sizeof(float), mesh->indices, index_count / 3);
+
+    // simplify once at load time, every lod lives in the same index buffer
+
+    unsigned int chain_count;
+    unsigned int* chain = rhino_lod_build_chain(mesh, &chain_count);
+
+    printf("\nmesh created : %u triangles, %d lods (", index_count / 3, mesh->lod_count);
+
+    for(int i = 0; i < mesh->lod_count; i++) printf(i ? ", %u" : "%u", mesh->lods[i].index_count / 3);
+
+    printf(")");
+
+    glGenVertexArrays(1, &mesh->vao);
+    glGenBuffers(1, &mesh->vbo);
+    glGenBuffers(1, &mesh->ebo);
+
+    glBindVertexArray(mesh->vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(rhino_vertex), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, chain_count * sizeof(unsigned int), chain, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(rhino_vertex), (GLvoid*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(rhino_vertex), (GLvoid*)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(rhino_vertex), (GLvoid*)(5 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(2);
+
+    // unbind vao first so the element buffer binding stays recorded in it
+
+    glBindVertexArray(0);
+
+    free(chain);
+}
+
+void rhino_mesh_create_from_array(rhino_mesh* mesh, const float* vertex_data, unsigned int vertex_count) {
+    rhino_vertex* vertices = malloc(vertex_count * sizeof(rhino_vertex));
+    unsigned int* indices = malloc(vertex_count * sizeof(unsigned int));
+
+    unsigned int unique_count = 0;
+
+    // merge exact duplicates, inputs are small primitives so a linear search is fine
+
+    for(unsigned int i = 0; i < vertex_count; i++) {
+        rhino_vertex v;
+        memset(&v, 0, sizeof(rhino_vertex));
+        memcpy(&v, &vertex_data[i * 5], 5 * sizeof(float));
+
+        unsigned int found = unique_count;
+
+        for(unsigned int j = 0; j < unique_count; j++) {
+            if(memcmp(&vertices[j], &v, sizeof(rhino_vertex)) == 0) {
+                found = j;
+                break;
+            }
+        }
+
+        if(found == unique_count) vertices[unique_count++] = v;
+
+        indices[i] = found;
+    }
+
+    rhino_mesh_create(mesh, vertices, unique_count, indices, vertex_count);
+
+    free(vertices);
+    free(indices);
+}
+
+void rhino_mesh_create_sphere(rhino_mesh* mesh, int rings, int segments) {
+    unsigned int vertex_count = (rings + 1) * (segments + 1);
+
+    rhino_vertex* vertices = malloc(vertex_count * sizeof(rhino_vertex));
+    unsigned int* indices = malloc(rings * segments * 6 * sizeof(unsigned int));
+
+    for(int r = 0; r <= rings; r++) {
+        float v = (float)r / rings;
+        float phi = v * GLM_PIf;
+
+        for(int s = 0; s <= segments; s++) {
+            float u = (float)s / segments;
+            float theta = u * 2.0f * GLM_PIf;
+
+            rhino_vertex* vert = &vertices[r * (segments + 1) + s];
+
+            vert->position[0] = cosf(theta) * sinf(phi) * 0.5f;
+            vert->position[1] = cosf(phi) * 0.5f;
+            vert->position[2] = sinf(theta) * sinf(phi) * 0.5f;
+            vert->uv[0] = u;
+            vert->uv[1] = 1.0f - v;
+            vert->lightmap_uv[0] = 0.0f;
+            vert->lightmap_uv[1] = 0.0f;
+        }
+    }
+
+    // pole rows only need one triangle per quad, the other would be degenerate
+
+    unsigned int index_count = 0;
+
+    for(int r = 0; r < rings; r++) {
+        for(int s = 0; s < segments; s++) {
+            unsigned int a = r * (segments + 1) + s;
+            unsigned int b = a + segments + 1;
+
+            if(r != 0) {
+                indices[index_count++] = a;
+                indices[index_count++] = a + 1;
+                indices[index_count++] = b;
+            }
+
+            if(r != rings - 1) {
+                indices[index_count++] = a + 1;
+                indices[index_count++] = b + 1;
+                indices[index_count++] = b;
+            }
+        }
+    }
+
+    rhino_mesh_create(mesh, vertices, vertex_count, indices, index_count);
+
+    free(vertices);
+    free(indices);
+}
+
+void rhino_mesh_draw(rhino_mesh* mesh, int lod) {
+    rhino_mesh_lod* range = &mesh->lods[lod];
+
+    glBindVertexArray(mesh->vao);
+    glDrawElements(GL_TRIANGLES, range->index_count, GL_UNSIGNED_INT, (GLvoid*)(range->index_offset * sizeof(unsigned int)));
+    glBindVertexArray(0);
+
+    rhino.stats.triangles += range->index_count / 3;
+    rhino.stats.draw_calls++;
+}
+
+void rhino_mesh_record(rhino_mesh* mesh, int lod, rhino_command_buffer* buffer) {
+    rhino_mesh_lod* range = &mesh->lods[lod];
+
+    rhino_command_draw(buffer, mesh->vao, range->index_count, range->index_offset);
+}
+
+void rhino_mesh_destroy(rhino_mesh* mesh) {
+    glDeleteVertexArrays(1, &mesh->vao);
+    glDeleteBuffers(1, &mesh->vbo);
+    glDeleteBuffers(1, &mesh->ebo);
+
+    free(mesh->vertices);
+    free(mesh->indices);
+
+    rhino_bvh_destroy(&mesh->bvh);
+
+    memset(mesh, 0, sizeof(rhino_mesh));
+}
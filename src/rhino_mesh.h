@@ -0,0 +1,69 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_bvh.h"
+#include "rhino_commands.h"
+
+// maximum number of detail levels generated per mesh, lod 0 is always the source mesh
+
+#define RHINO_MESH_MAX_LODS 4
+
+// interleaved vertex layout shared by every mesh, matches attribute location 0 (position), 1 (uv) and 2 (lightmap
+// uv). lightmap uvs are zero until a baked lightmap unwrapped the mesh, see rhino_lightmap.h
+
+typedef struct rhino_vertex_t {
+    float position[3];
+    float uv[2];
+    float lightmap_uv[2];
+} rhino_vertex;
+
+// a range of the mesh index buffer and the object-space error it introduces vs the source mesh
+
+typedef struct rhino_mesh_lod_t {
+    unsigned int index_offset;
+    unsigned int index_count;
+    float error;
+} rhino_mesh_lod;
+
+// indexed mesh with its lod chain, cpu copies of the data and a triangle bvh are kept for picking and other queries
+
+typedef struct rhino_mesh_t {
+    unsigned int vao, vbo, ebo;
+    rhino_vertex* vertices;
+    unsigned int vertex_count;
+    unsigned int* indices;
+    unsigned int index_count;
+    rhino_mesh_lod lods[RHINO_MESH_MAX_LODS];
+    int lod_count;
+    vec3 bounds[2];
+    vec4 sphere;
+    rhino_bvh bvh;
+} rhino_mesh;
+
+// builds the lod chain and uploads vertices + all lod index ranges to the gpu
+
+void rhino_mesh_create(rhino_mesh* mesh, const rhino_vertex* vertices, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count);
+
+// same as above from a non-indexed array of 5 floats per vertex (x, y, z, u, v), identical vertices are merged
+
+void rhino_mesh_create_from_array(rhino_mesh* mesh, const float* vertex_data, unsigned int vertex_count);
+
+// uv sphere of radius 0.5 centered on the origin
+
+void rhino_mesh_create_sphere(rhino_mesh* mesh, int rings, int segments);
+
+// draws one lod of the mesh, counts submitted triangles into rhino.stats
+
+void rhino_mesh_draw(rhino_mesh* mesh, int lod);
+
+// the same draw into a command buffer, counted into the buffer's counters
+
+void rhino_mesh_record(rhino_mesh* mesh, int lod, rhino_command_buffer* buffer);
+
+void rhino_mesh_destroy(rhino_mesh* mesh);
@@ -0,0 +1,200 @@
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// rhino headers
+
+#include "rhino_pacing.h"
+
+static const char* mode_names[] = { "unlimited", "vsync", "adaptive", "limit", "low-latency" };
+
+void rhino_pacing_init(rhino_pacing* pacing, rhino_pacing_mode mode, double fps, int refresh_rate) {
+    memset(pacing, 0, sizeof(rhino_pacing));
+
+    pacing->mode = mode;
+    pacing->period = 1.0 / (fps > 0.0 ? fps : RHINO_PACING_TARGET_FPS);
+    pacing->refresh_period = refresh_rate > 0 ? 1.0 / refresh_rate : 0.0;
+    pacing->oversleep = RHINO_PACING_MAX_SPIN * 0.25;
+}
+
+bool rhino_pacing_mode_from_name(const char* name, rhino_pacing_mode* mode) {
+    for(int i = 0; i < (int)(sizeof(mode_names) / sizeof(mode_names[0])); i++) {
+        if(strcmp(name, mode_names[i]) == 0) {
+            *mode = (rhino_pacing_mode)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* rhino_pacing_mode_name(rhino_pacing_mode mode) {
+    return mode_names[mode];
+}
+
+void rhino_pacing_apply(rhino_pacing* pacing) {
+    int interval = 0;
+
+    if(pacing->mode == RHINO_PACING_ADAPTIVE) {
+        // a negative interval lets a late frame tear instead of waiting a whole refresh, only with the extension
+
+        if(glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear")) interval = -1;
+        else {
+            printf("\nadaptive vsync is not supported by the driver, using vsync");
+            pacing->mode = RHINO_PACING_VSYNC;
+        }
+    }
+
+    if(pacing->mode == RHINO_PACING_VSYNC) interval = 1;
+
+    glfwSwapInterval(interval);
+
+    if(pacing->mode == RHINO_PACING_LIMIT || pacing->mode == RHINO_PACING_LOW_LATENCY) printf("\nframe pacing %s at %.1f fps", mode_names[pacing->mode], 1.0 / pacing->period);
+    else printf("\nframe pacing %s", mode_names[pacing->mode]);
+}
+
+double rhino_pacing_clock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// sleeps until the spin window before deadline, then spins the rest. returns the seconds waited
+
+static double wait_until(rhino_pacing* pacing, double deadline) {
+    double start = rhino_pacing_clock();
+    double now = start;
+
+    double spin = pacing->oversleep * 2.0;
+
+    if(spin < RHINO_PACING_MIN_SPIN) spin = RHINO_PACING_MIN_SPIN;
+    if(spin > RHINO_PACING_MAX_SPIN) spin = RHINO_PACING_MAX_SPIN;
+
+    while(deadline - now > spin) {
+        double sleep = deadline - now - spin;
+        struct timespec duration = { (time_t)sleep, (long)((sleep - (time_t)sleep) * 1e9) };
+
+        nanosleep(&duration, NULL);
+
+        double woke = rhino_pacing_clock();
+        double over = woke - now - sleep;
+
+        // a late wake up widens the window at once, it only narrows again slowly
+
+        if(over > pacing->oversleep) pacing->oversleep = over;
+        else pacing->oversleep += (over - pacing->oversleep) * 0.05;
+
+        pacing->stats.slept += woke - now;
+        now = woke;
+    }
+
+    double spin_start = now;
+
+    while(now < deadline) now = rhino_pacing_clock();
+
+    pacing->stats.spun += now - spin_start;
+    pacing->waited += now - start;
+
+    return now - start;
+}
+
+static bool limited(rhino_pacing* pacing) {
+    return pacing->mode == RHINO_PACING_LIMIT || pacing->mode == RHINO_PACING_LOW_LATENCY;
+}
+
+void rhino_pacing_begin_frame(rhino_pacing* pacing) {
+    // start just early enough for the frame to be ready at its deadline, the spread covers frames costing more
+    // than usual
+
+    if(pacing->mode == RHINO_PACING_LOW_LATENCY && pacing->deadline > 0.0) {
+        wait_until(pacing, pacing->deadline - pacing->work - 2.0 * pacing->work_spread - RHINO_PACING_LATENCY_MARGIN);
+    }
+
+    pacing->frame_start = rhino_pacing_clock();
+    pacing->last_waited = pacing->waited;
+    pacing->waited = 0.0;
+}
+
+void rhino_pacing_present(rhino_pacing* pacing) {
+    if(limited(pacing) && pacing->deadline > 0.0) wait_until(pacing, pacing->deadline);
+
+    pacing->swap_start = rhino_pacing_clock();
+}
+
+void rhino_pacing_presented(rhino_pacing* pacing) {
+    rhino_pacing_stats* stats = &pacing->stats;
+    double now = rhino_pacing_clock();
+
+    // vsync blocks the swap until the refresh, as much a wait on purpose as the limiter's. otherwise every frame
+    // reads as a full refresh period and the governor never sees the headroom to step quality back up
+
+    if(pacing->mode == RHINO_PACING_VSYNC || pacing->mode == RHINO_PACING_ADAPTIVE) pacing->waited += now - pacing->swap_start;
+
+    // the frame's cost leaves out the wait for its deadline, low latency plans the next start with it
+
+    double work = now - pacing->frame_start - pacing->waited;
+
+    pacing->work += (work - pacing->work) * 0.1;
+    pacing->work_spread += (fabs(work - pacing->work) - pacing->work_spread) * 0.1;
+
+    stats->frames++;
+    stats->latency_total += now - pacing->frame_start;
+
+    double interval = pacing->last_present > 0.0 ? now - pacing->last_present : 0.0;
+
+    if(interval > 0.0) {
+        stats->intervals++;
+        stats->interval_total += interval;
+        stats->interval_squares += interval * interval;
+    }
+
+    pacing->last_present = now;
+
+    // the limiter measures against its deadline, vsync against the refresh period and unlimited against nothing
+
+    bool measured = true;
+    double error = 0.0;
+
+    if(limited(pacing) && pacing->deadline > 0.0) error = now - pacing->deadline;
+    else if(!limited(pacing) && pacing->mode != RHINO_PACING_UNLIMITED && pacing->refresh_period > 0.0 && interval > 0.0) error = interval - pacing->refresh_period;
+    else measured = false;
+
+    if(measured) {
+        stats->error_total += fabs(error);
+
+        if(fabs(error) > stats->error_max) stats->error_max = fabs(error);
+        if(error > RHINO_PACING_MISS) stats->missed++;
+    }
+
+    // deadlines stay on a fixed grid, a frame late by more than a period starts a new grid rather than rushing
+    // the next frames to catch up
+
+    if(limited(pacing)) {
+        pacing->deadline = pacing->deadline > 0.0 ? pacing->deadline + pacing->period : now + pacing->period;
+
+        if(pacing->deadline < now) pacing->deadline = now + pacing->period;
+    }
+}
+
+void rhino_pacing_print_stats(rhino_pacing* pacing) {
+    rhino_pacing_stats* stats = &pacing->stats;
+
+    if(stats->frames == 0) return;
+
+    double mean = stats->intervals ? stats->interval_total / stats->intervals : 0.0;
+    double variance = stats->intervals ? stats->interval_squares / stats->intervals - mean * mean : 0.0;
+    double deviation = variance > 0.0 ? sqrt(variance) : 0.0;
+
+    printf("pacing : %s, interval %.2f ms +- %.3f ms, ", mode_names[pacing->mode], mean * 1000.0, deviation * 1000.0);
+
+    if(pacing->mode == RHINO_PACING_UNLIMITED || (!limited(pacing) && pacing->refresh_period <= 0.0)) printf("no deadline, ");
+    else printf("error %.3f ms average %.3f ms worst, %u missed, ", stats->error_total * 1000.0 / stats->frames, stats->error_max * 1000.0, stats->missed);
+
+    printf("%.2f ms slept %.2f ms spun %.2f ms input to present per frame\n", stats->slept * 1000.0 / stats->frames, stats->spun * 1000.0 / stats->frames, stats->latency_total * 1000.0 / stats->frames);
+
+    memset(stats, 0, sizeof(rhino_pacing_stats));
+}
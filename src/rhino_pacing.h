@@ -0,0 +1,107 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+// frame pacing, decides when frames start and when they are presented. vsync modes leave it to the driver, the
+// limiter waits for evenly spaced deadlines on CLOCK_MONOTONIC by sleeping most of the way and spinning the rest,
+// and low latency additionally holds back the start of a frame so input is sampled as late as the frame's
+// predicted cost allows
+
+typedef enum rhino_pacing_mode_t {
+    RHINO_PACING_UNLIMITED,
+    RHINO_PACING_VSYNC,
+    RHINO_PACING_ADAPTIVE,
+    RHINO_PACING_LIMIT,
+    RHINO_PACING_LOW_LATENCY
+} rhino_pacing_mode;
+
+#define RHINO_PACING_TARGET_FPS 60.0
+
+// waits shorter than this spin from the start, longer ones sleep until the spin window before the deadline. the
+// window grows to twice the worst oversleep seen lately so the scheduler waking late does not miss the deadline
+
+#define RHINO_PACING_MIN_SPIN 0.0002
+#define RHINO_PACING_MAX_SPIN 0.004
+
+// low latency starts a frame this much earlier than its predicted cost on top of the cost's spread
+
+#define RHINO_PACING_LATENCY_MARGIN 0.0005
+
+// presents later than this past their deadline count as missed
+
+#define RHINO_PACING_MISS 0.001
+
+// taken and reset by rhino_pacing_print_stats. error is how far a present landed from its deadline, interval the
+// time between presents and latency the time from sampling input to presenting
+
+typedef struct rhino_pacing_stats_t {
+    unsigned int frames;
+    unsigned int intervals;
+    unsigned int missed;
+    double interval_total, interval_squares;
+    double error_total, error_max;
+    double latency_total;
+    double slept, spun;
+} rhino_pacing_stats;
+
+typedef struct rhino_pacing_t {
+    rhino_pacing_mode mode;
+    double period;
+
+    // the refresh period vsync presents are measured against, 0 when unknown
+
+    double refresh_period;
+
+    double deadline;
+    double last_present;
+    double frame_start;
+
+    // time spent waiting since the last frame started, the frame time handed to the quality governor leaves it out.
+    // vsync modes wait inside the swap, which starts at swap_start
+
+    double waited;
+    double last_waited;
+    double swap_start;
+
+    // running average of the oversleep, and of a frame's cost from start to present with its spread
+
+    double oversleep;
+    double work, work_spread;
+
+    rhino_pacing_stats stats;
+} rhino_pacing;
+
+// fps is the limiter's target, refresh_rate the monitor's in hz or 0
+
+void rhino_pacing_init(rhino_pacing* pacing, rhino_pacing_mode mode, double fps, int refresh_rate);
+
+// false for a name that is not a mode
+
+bool rhino_pacing_mode_from_name(const char* name, rhino_pacing_mode* mode);
+
+const char* rhino_pacing_mode_name(rhino_pacing_mode mode);
+
+// sets the swap interval for the mode, the context has to be current. adaptive falls back to vsync when the driver
+// cannot tear late frames
+
+void rhino_pacing_apply(rhino_pacing* pacing);
+
+// seconds on CLOCK_MONOTONIC
+
+double rhino_pacing_clock(void);
+
+// before input is sampled, low latency waits here
+
+void rhino_pacing_begin_frame(rhino_pacing* pacing);
+
+// right before the swap, the limiter waits here for the deadline
+
+void rhino_pacing_present(rhino_pacing* pacing);
+
+// right after the swap, measures the frame against its deadline and sets the next one
+
+void rhino_pacing_presented(rhino_pacing* pacing);
+
+void rhino_pacing_print_stats(rhino_pacing* pacing);
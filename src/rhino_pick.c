@@ -0,0 +1,118 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <float.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_pick.h"
+#include "rhino_scene.h"
+#include "rhino_bvh.h"
+#include "rhino_global.h"
+
+typedef struct pick_context_t {
+    rhino_scene* scene;
+    unsigned int triangle;
+} pick_context;
+
+void rhino_pick_ray(rhino_camera* camera, vec4 viewport, float x, float y, vec3 origin, vec3 direction) {
+    // glm_unproject inverts on every call, the camera keeps the inverse cached instead
+
+    vec4* inv_view_proj = rhino_camera_inv_view_proj(camera);
+
+    float window_y = viewport[3] - y;
+
+    vec3 far_point;
+
+    glm_unprojecti((vec3){x, window_y, 0.0f}, inv_view_proj, viewport, origin);
+    glm_unprojecti((vec3){x, window_y, 1.0f}, inv_view_proj, viewport, far_point);
+
+    glm_vec3_sub(far_point, origin, direction);
+    glm_vec3_normalize(direction);
+}
+
+// entity level hit, moves the ray into object space and walks the mesh bvh. an affine transform keeps the ray
+// parameter, so distances found in object space are still world distances along the normalised world ray
+
+static bool entity_hit(void* user, unsigned int primitive, vec3 origin, vec3 direction, float* t) {
+    pick_context* context = user;
+    rhino_entity* entity = &context->scene->entities[primitive];
+
+    mat4 inv_model;
+    glm_mat4_inv(entity->model, inv_model);
+
+    vec3 local_origin, local_direction;
+
+    glm_mat4_mulv3(inv_model, origin, 1.0f, local_origin);
+    glm_mat4_mulv3(inv_model, direction, 0.0f, local_direction);
+
+    rhino_mesh* mesh = entity->mesh;
+    unsigned int triangle;
+
+    if(!rhino_bvh_intersect_triangles(&mesh->bvh, (float*)mesh->vertices, sizeof(rhino_vertex) / sizeof(float), mesh->indices, local_origin, local_direction, t, &triangle)) return false;
+
+    context->triangle = triangle;
+
+    return true;
+}
+
+bool rhino_pick_scene(rhino_scene* scene, vec3 origin, vec3 direction, rhino_pick_hit* hit) {
+    // entity bvh is only rebuilt after something moved
+
+    if(scene->tlas_dirty) {
+        float* bounds = malloc(scene->entity_count * 6 * sizeof(float));
+
+        for(int i = 0; i < scene->entity_count; i++) {
+            glm_vec3_copy(scene->entities[i].world_bounds[0], &bounds[i * 6]);
+            glm_vec3_copy(scene->entities[i].world_bounds[1], &bounds[i * 6 + 3]);
+        }
+
+        rhino_bvh_destroy(&scene->tlas);
+        rhino_bvh_build(&scene->tlas, bounds, scene->entity_count);
+
+        free(bounds);
+
+        scene->tlas_dirty = false;
+    }
+
+    pick_context context = { scene, 0 };
+
+    float t = FLT_MAX;
+    unsigned int entity;
+
+    if(!rhino_bvh_intersect(&scene->tlas, origin, direction, &t, &entity, entity_hit, &context)) return false;
+
+    hit->entity = entity;
+    hit->triangle = context.triangle;
+    hit->distance = t;
+
+    glm_ray_at(origin, direction, t, hit->position);
+
+    return true;
+}
+
+bool rhino_pick(rhino_scene* scene, rhino_camera* camera, vec4 viewport, rhino_pick_hit* hit) {
+    float x = viewport[2] * 0.5f;
+    float y = viewport[3] * 0.5f;
+
+    // cursor is in window coordinates, scale into framebuffer pixels for high dpi displays
+
+    if(rhino.mouse.unlocked) {
+        int width = rhino.mouse.window_width, height = rhino.mouse.window_height;
+
+        if(width > 0 && height > 0) {
+            x = (float)rhino.mouse.x_pos * viewport[2] / width;
+            y = (float)rhino.mouse.y_pos * viewport[3] / height;
+        }
+    }
+
+    vec3 origin, direction;
+
+    rhino_pick_ray(camera, viewport, x, y, origin, direction);
+
+    return rhino_pick_scene(scene, origin, direction, hit);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_scene.h"
+#include "rhino_camera.h"
+
+typedef struct rhino_pick_hit_t {
+    int entity;
+    unsigned int triangle;
+    float distance;
+    vec3 position;
+} rhino_pick_hit;
+
+// world space ray through a framebuffer position (origin top left, as glfw reports the cursor)
+
+void rhino_pick_ray(rhino_camera* camera, vec4 viewport, float x, float y, vec3 origin, vec3 direction);
+
+// closest triangle hit in the scene, walks the entity bvh then the hit entity's triangle bvh
+
+bool rhino_pick_scene(rhino_scene* scene, vec3 origin, vec3 direction, rhino_pick_hit* hit);
+
+// picks under rhino.mouse, or through the screen centre while the cursor is captured for mouse look
+
+bool rhino_pick(rhino_scene* scene, rhino_camera* camera, vec4 viewport, rhino_pick_hit* hit);
@@ -0,0 +1,529 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_point_shadows.h"
+#include "rhino_global.h"
+#include "shaders.h"
+
+// quadtree node states, a split node's children are only meaningful while it stays split
+
+#define NODE_FREE 0
+#define NODE_SPLIT 1
+#define NODE_USED 2
+
+#define ROOTS (RHINO_POINT_SHADOW_ATLAS / RHINO_POINT_SHADOW_MAX_TILE)
+
+// cube faces in +x, -x, +y, -y, +z, -z order. the lighting shaders pick faces and rebuild uvs from the same
+// forward and up vectors, right is always cross(forward, up)
+
+static const float face_forward[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+static const float face_up[6][3] = { { 0, 1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 }, { 0, 1, 0 }, { 0, 1, 0 } };
+
+static int level_width(int level) {
+    return ROOTS << level;
+}
+
+static int tile_size(int level) {
+    return RHINO_POINT_SHADOW_MAX_TILE >> level;
+}
+
+// returns a free node at target below (x, y), first pass only walks nodes that are already split so small tiles
+// fill in around each other before another big node is broken up
+
+static int find_node(rhino_point_shadows* shadows, int level, int x, int y, int target, bool split_free) {
+    int width = level_width(level);
+    unsigned char* state = &shadows->nodes[level][x + y * width];
+
+    if(level == target) return *state == NODE_FREE ? x + y * width : -1;
+    if(*state == NODE_USED) return -1;
+
+    if(*state == NODE_FREE) {
+        if(!split_free) return -1;
+
+        // whatever the children held before is stale, a free node's whole subtree is free
+
+        *state = NODE_SPLIT;
+
+        int child_width = level_width(level + 1);
+
+        for(int c = 0; c < 4; c++) shadows->nodes[level + 1][(2 * x + c % 2) + (2 * y + c / 2) * child_width] = NODE_FREE;
+    }
+
+    for(int c = 0; c < 4; c++) {
+        int found = find_node(shadows, level + 1, 2 * x + c % 2, 2 * y + c / 2, target, split_free);
+
+        if(found >= 0) return found;
+    }
+
+    return -1;
+}
+
+static int allocate_tile(rhino_point_shadows* shadows, int level) {
+    for(int pass = 0; pass < 2; pass++) {
+        for(int y = 0; y < ROOTS; y++) {
+            for(int x = 0; x < ROOTS; x++) {
+                int found = find_node(shadows, 0, x, y, level, pass == 1);
+
+                if(found < 0) continue;
+
+                shadows->nodes[level][found] = NODE_USED;
+                shadows->stats.tiles[level]++;
+
+                return found;
+            }
+        }
+    }
+
+    return -1;
+}
+
+// frees a node and merges its parents back up while all four siblings are free
+
+static void release_tile(rhino_point_shadows* shadows, int level, int node) {
+    shadows->nodes[level][node] = NODE_FREE;
+    shadows->stats.tiles[level]--;
+
+    while(level > 0) {
+        int width = level_width(level);
+        int x = (node % width) / 2, y = (node / width) / 2;
+
+        for(int c = 0; c < 4; c++) {
+            if(shadows->nodes[level][(2 * x + c % 2) + (2 * y + c / 2) * width] != NODE_FREE) return;
+        }
+
+        level--;
+        node = x + y * level_width(level);
+        shadows->nodes[level][node] = NODE_FREE;
+    }
+}
+
+static void release_light(rhino_point_shadows* shadows, rhino_point_shadow* shadow) {
+    if(shadow->level < 0) return;
+
+    for(int f = 0; f < 6; f++) {
+        release_tile(shadows, shadow->level, shadow->tiles[f]);
+        shadow->faces[f].valid = false;
+    }
+
+    shadow->level = -1;
+}
+
+// all six tiles at one level or none at all
+
+static bool allocate_light(rhino_point_shadows* shadows, rhino_point_shadow* shadow, int level) {
+    for(int f = 0; f < 6; f++) {
+        shadow->tiles[f] = allocate_tile(shadows, level);
+
+        if(shadow->tiles[f] >= 0) continue;
+
+        while(f--) release_tile(shadows, level, shadow->tiles[f]);
+
+        return false;
+    }
+
+    shadow->level = level;
+
+    for(int f = 0; f < 6; f++) shadow->faces[f].valid = false;
+
+    return true;
+}
+
+static void face_view_proj(vec3 position, float radius, int face, mat4 dest) {
+    vec3 target;
+    glm_vec3_add(position, (float*)face_forward[face], target);
+
+    mat4 view, projection;
+    glm_lookat(position, target, (float*)face_up[face], view);
+    glm_perspective(GLM_PI_2f, 1.0f, RHINO_POINT_SHADOW_NEAR, radius, projection);
+
+    glm_mat4_mul(projection, view, dest);
+}
+
+static bool sphere_visible(vec4* planes, vec3 center, float radius) {
+    for(int p = 0; p < 6; p++) {
+        if(glm_vec3_dot(planes[p], center) + planes[p][3] < -radius) return false;
+    }
+
+    return true;
+}
+
+static int compare_coverage(const void* a, const void* b) {
+    float coverage_a = (*(rhino_point_shadow* const*)a)->coverage, coverage_b = (*(rhino_point_shadow* const*)b)->coverage;
+
+    return (coverage_a < coverage_b) - (coverage_a > coverage_b);
+}
+
+static int compare_jobs(const void* a, const void* b) {
+    float priority_a = ((const rhino_point_shadow_job*)a)->priority, priority_b = ((const rhino_point_shadow_job*)b)->priority;
+
+    return (priority_a < priority_b) - (priority_a > priority_b);
+}
+
+void rhino_point_shadows_init(rhino_point_shadows* shadows) {
+    memset(shadows, 0, sizeof(rhino_point_shadows));
+
+    for(int level = 0; level < RHINO_POINT_SHADOW_LEVELS; level++) shadows->nodes[level] = calloc(level_width(level) * level_width(level), 1);
+
+    // compared in hardware like the sun cascades
+
+    glGenTextures(1, &shadows->depth);
+    glBindTexture(GL_TEXTURE_2D, shadows->depth);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, RHINO_POINT_SHADOW_ATLAS, RHINO_POINT_SHADOW_ATLAS, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &shadows->fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadows->fbo);
+
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadows->depth, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) printf("\npoint shadow framebuffer incomplete");
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // tile table, rewritten every frame
+
+    glGenBuffers(RHINO_FRAMES_MAX, shadows->data_buffers);
+    glGenTextures(RHINO_FRAMES_MAX, shadows->data_textures);
+
+    for(int i = 0; i < RHINO_FRAMES_MAX; i++) {
+        glBindBuffer(GL_TEXTURE_BUFFER, shadows->data_buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, RHINO_POINT_SHADOW_MAX_LIGHTS * 4 * sizeof(vec4), NULL, GL_DYNAMIC_DRAW);
+
+        glBindTexture(GL_TEXTURE_BUFFER, shadows->data_textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, shadows->data_buffers[i]);
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    shadows->program = link_and_compile_shaders("vertex_shader.glsl", "shadow_fragment_shader.glsl");
+    rhino_uniforms_bind_program(shadows->program);
+
+    rhino_gpu_timer_init(&shadows->timer);
+}
+
+void rhino_point_shadows_bind_program(unsigned int program) {
+    glUseProgram(program);
+
+    glUniform1i(glGetUniformLocation(program, "point_shadow_atlas"), RHINO_POINT_SHADOW_ATLAS_UNIT);
+    glUniform1i(glGetUniformLocation(program, "point_shadow_data"), RHINO_POINT_SHADOW_DATA_UNIT);
+}
+
+int rhino_point_shadows_add(rhino_point_shadows* shadows, int light) {
+    if(shadows->count == RHINO_POINT_SHADOW_MAX_LIGHTS) return -1;
+
+    rhino_point_shadow* shadow = &shadows->shadows[shadows->count];
+
+    memset(shadow, 0, sizeof(rhino_point_shadow));
+
+    shadow->light = light;
+    shadow->level = -1;
+
+    return shadows->count++;
+}
+
+void rhino_point_shadows_clear(rhino_point_shadows* shadows) {
+    for(int i = 0; i < shadows->count; i++) release_light(shadows, &shadows->shadows[i]);
+
+    shadows->count = 0;
+}
+
+void rhino_point_shadows_update(rhino_point_shadows* shadows, rhino_lights* lights, rhino_camera* camera, float viewport_height, rhino_scene* scene, rhino_terrain* terrain) {
+    float pixels_per_unit = rhino_camera_pixels_per_unit(camera, viewport_height);
+    vec4* planes = rhino_camera_frustum(camera);
+
+    memset(&shadows->stats, 0, offsetof(rhino_point_shadow_stats, tiles));
+
+    // a static entity came or went, anything could have changed
+
+    bool static_changed = scene->static_version != shadows->static_version;
+    shadows->static_version = scene->static_version;
+
+    // screen coverage, lights off screen keep their tiles until someone else needs the space
+
+    rhino_point_shadow* order[RHINO_POINT_SHADOW_MAX_LIGHTS];
+    int visible_count = 0;
+
+    for(int i = 0; i < shadows->count; i++) {
+        rhino_point_shadow* shadow = &shadows->shadows[i];
+
+        shadow->visible = false;
+        shadow->coverage = 0.0f;
+
+        if(shadow->light >= lights->light_count) continue;
+
+        rhino_point_light* light = &lights->lights[shadow->light];
+
+        light->shadow = -1.0f;
+
+        if(!sphere_visible(planes, light->position, light->radius)) continue;
+
+        float distance = glm_vec3_distance(camera->position, light->position);
+
+        shadow->visible = true;
+        shadow->coverage = distance > light->radius ? light->radius * pixels_per_unit / distance : viewport_height;
+
+        order[visible_count++] = shadow;
+    }
+
+    // biggest on screen first so they get first pick of the atlas
+
+    qsort(order, visible_count, sizeof(rhino_point_shadow*), compare_coverage);
+
+    for(int i = 0; i < visible_count; i++) {
+        rhino_point_shadow* shadow = order[i];
+
+        float wanted = shadow->coverage * RHINO_POINT_SHADOW_TEXELS_PER_PIXEL;
+        int level = 0;
+
+        while(level < RHINO_POINT_SHADOW_LEVELS - 1 && tile_size(level + 1) >= wanted) level++;
+
+        // grow straight away, shrink only once clearly too big so lights near a size boundary do not flip
+        // between tiles and redraw every frame
+
+        if(shadow->level >= 0 && (level == shadow->level || (level > shadow->level && wanted >= tile_size(shadow->level) * RHINO_POINT_SHADOW_SHRINK))) continue;
+
+        // a light that fell back to smaller tiles keeps them until bigger ones are actually free. releasing them
+        // first would land it back on the same tiles every frame with all six faces to redraw
+
+        bool grow = shadow->level > level;
+
+        rhino_point_shadow grown;
+        rhino_point_shadow* target = shadow;
+        int last = RHINO_POINT_SHADOW_LEVELS;
+
+        if(grow) {
+            grown = *shadow;
+            grown.level = -1;
+            target = &grown;
+            last = shadow->level;
+        }
+        else release_light(shadows, shadow);
+
+        // smaller tiles when the atlas is full, then take the space of lights that are off screen
+
+        bool allocated = false;
+
+        for(int attempt = 0; attempt < 2 && !allocated; attempt++) {
+            if(attempt == 1) {
+                for(int j = 0; j < shadows->count; j++) {
+                    if(!shadows->shadows[j].visible) release_light(shadows, &shadows->shadows[j]);
+                }
+            }
+
+            for(int fallback = level; fallback < last && !allocated; fallback++) allocated = allocate_light(shadows, target, fallback);
+        }
+
+        if(grow && allocated) {
+            release_light(shadows, shadow);
+
+            shadow->level = grown.level;
+            memcpy(shadow->tiles, grown.tiles, sizeof(shadow->tiles));
+        }
+    }
+
+    // faces that need drawing, never drawn tiles go first, then by how big the light is on screen
+
+    shadows->job_count = 0;
+
+    for(int i = 0; i < visible_count; i++) {
+        rhino_point_shadow* shadow = order[i];
+
+        if(shadow->level < 0) continue;
+
+        rhino_point_light* light = &lights->lights[shadow->light];
+
+        // one terrain query per light, from the oldest face
+
+        unsigned int since = shadow->faces[0].terrain_version;
+
+        for(int f = 1; f < 6; f++) since = shadow->faces[f].terrain_version < since ? shadow->faces[f].terrain_version : since;
+
+        bool terrain_changed = rhino_terrain_changed_in(terrain, light->position, light->radius, since);
+
+        for(int f = 0; f < 6; f++) {
+            rhino_point_shadow_face* face = &shadow->faces[f];
+
+            face->queued = false;
+
+            bool dirty = !face->valid || static_changed || terrain_changed || !glm_vec3_eqv(face->position, light->position);
+
+            if(!dirty) {
+                mat4 view_proj;
+                vec4 face_planes[6];
+
+                face_view_proj(light->position, light->radius, f, view_proj);
+                glm_frustum_planes(view_proj, face_planes);
+
+                dirty = rhino_scene_dynamic_in(scene, face_planes);
+            }
+
+            if(!dirty) {
+                shadows->stats.faces_cached++;
+                continue;
+            }
+
+            shadows->jobs[shadows->job_count++] = (rhino_point_shadow_job){ shadow - shadows->shadows, f, shadow->coverage + (face->valid ? 0.0f : 1000000.0f) };
+        }
+    }
+
+    qsort(shadows->jobs, shadows->job_count, sizeof(rhino_point_shadow_job), compare_jobs);
+
+    if(shadows->job_count > RHINO_POINT_SHADOW_FACE_BUDGET) {
+        shadows->stats.faces_waiting = shadows->job_count - RHINO_POINT_SHADOW_FACE_BUDGET;
+        shadows->job_count = RHINO_POINT_SHADOW_FACE_BUDGET;
+    }
+
+    for(int i = 0; i < shadows->job_count; i++) shadows->shadows[shadows->jobs[i].shadow].faces[shadows->jobs[i].face].queued = true;
+
+    // a light is shadowed once every face holds something, stale faces waiting on the budget still count
+
+    vec4 data[RHINO_POINT_SHADOW_MAX_LIGHTS * 4];
+    memset(data, 0, sizeof(data));
+
+    for(int i = 0; i < visible_count; i++) {
+        rhino_point_shadow* shadow = order[i];
+
+        if(shadow->level < 0) continue;
+
+        bool complete = true;
+
+        for(int f = 0; f < 6; f++) complete = complete && (shadow->faces[f].valid || shadow->faces[f].queued);
+
+        if(!complete) continue;
+
+        int slot = shadow - shadows->shadows;
+        int width = level_width(shadow->level);
+        float size = (float)tile_size(shadow->level);
+
+        for(int f = 0; f < 6; f++) {
+            data[slot * 4 + f / 2][(f % 2) * 2 + 0] = (shadow->tiles[f] % width) * size / RHINO_POINT_SHADOW_ATLAS;
+            data[slot * 4 + f / 2][(f % 2) * 2 + 1] = (shadow->tiles[f] / width) * size / RHINO_POINT_SHADOW_ATLAS;
+        }
+
+        glm_vec4_copy((vec4){ size / RHINO_POINT_SHADOW_ATLAS, RHINO_POINT_SHADOW_NEAR, lights->lights[shadow->light].radius, size }, data[slot * 4 + 3]);
+
+        lights->lights[shadow->light].shadow = (float)slot;
+        shadows->stats.lights_shadowed++;
+    }
+
+    rhino_frames_write(GL_TEXTURE_BUFFER, shadows->data_buffers[rhino.frames.slot], 0, sizeof(data), data);
+}
+
+void rhino_point_shadows_render(rhino_point_shadows* shadows, rhino_lights* lights, rhino_scene* scene, rhino_terrain* terrain, rhino_uniforms* uniforms) {
+    if(shadows->job_count > 0) {
+        int viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, shadows->fbo);
+
+        // clears only touch the tile being drawn
+
+        glEnable(GL_SCISSOR_TEST);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.5f, 2.0f);
+
+        unsigned int draw_calls = rhino.stats.draw_calls;
+
+        rhino_gpu_timer_begin(&shadows->timer);
+
+        for(int i = 0; i < shadows->job_count; i++) {
+            rhino_point_shadow* shadow = &shadows->shadows[shadows->jobs[i].shadow];
+            rhino_point_shadow_face* face = &shadow->faces[shadows->jobs[i].face];
+            rhino_point_light* light = &lights->lights[shadow->light];
+
+            int width = level_width(shadow->level);
+            int size = tile_size(shadow->level);
+            int tile = shadow->tiles[shadows->jobs[i].face];
+
+            glViewport((tile % width) * size, (tile / width) * size, size, size);
+            glScissor((tile % width) * size, (tile / width) * size, size, size);
+            glClear(GL_DEPTH_BUFFER_BIT);
+
+            mat4 view_proj;
+            vec4 planes[6];
+
+            face_view_proj(light->position, light->radius, shadows->jobs[i].face, view_proj);
+            glm_frustum_planes(view_proj, planes);
+
+            glUseProgram(shadows->program);
+            glUniform1i(glGetUniformLocation(shadows->program, "shadow_layer"), -1);
+            glUniformMatrix4fv(glGetUniformLocation(shadows->program, "point_view_proj"), 1, GL_FALSE, (float*)view_proj);
+            rhino_scene_draw_shadow(scene, uniforms, planes);
+
+            glUseProgram(terrain->shadow_program);
+            glUniform1i(glGetUniformLocation(terrain->shadow_program, "shadow_layer"), -1);
+            glUniformMatrix4fv(glGetUniformLocation(terrain->shadow_program, "point_view_proj"), 1, GL_FALSE, (float*)view_proj);
+            rhino_terrain_draw_shadow(terrain, uniforms, planes);
+
+            glm_vec3_copy(light->position, face->position);
+            face->terrain_version = terrain->version;
+            face->valid = true;
+            face->queued = false;
+        }
+
+        rhino_gpu_timer_end(&shadows->timer);
+
+        shadows->stats.faces_drawn = shadows->job_count;
+        shadows->stats.draw_calls = rhino.stats.draw_calls - draw_calls;
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glDisable(GL_SCISSOR_TEST);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    glActiveTexture(GL_TEXTURE0 + RHINO_POINT_SHADOW_ATLAS_UNIT);
+    glBindTexture(GL_TEXTURE_2D, shadows->depth);
+    glActiveTexture(GL_TEXTURE0 + RHINO_POINT_SHADOW_DATA_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, shadows->data_textures[rhino.frames.slot]);
+    glActiveTexture(GL_TEXTURE0);
+
+    rhino_gpu_timer_poll(&shadows->timer, false);
+}
+
+void rhino_point_shadows_print_stats(rhino_point_shadows* shadows) {
+    rhino_point_shadow_stats* stats = &shadows->stats;
+
+    printf("point shadows : %u / %d lights shadowed, %u faces drawn (%u draws, %.3f ms), %u cached, %u waiting on the budget - tiles",
+        stats->lights_shadowed, shadows->count, stats->faces_drawn, stats->draw_calls, shadows->timer.smoothed_ms, stats->faces_cached, stats->faces_waiting);
+
+    for(int level = 0; level < RHINO_POINT_SHADOW_LEVELS; level++) printf(" %ux%d", stats->tiles[level], tile_size(level));
+
+    printf("\n");
+}
+
+void rhino_point_shadows_destroy(rhino_point_shadows* shadows) {
+    glDeleteFramebuffers(1, &shadows->fbo);
+    glDeleteTextures(1, &shadows->depth);
+    glDeleteBuffers(RHINO_FRAMES_MAX, shadows->data_buffers);
+    glDeleteTextures(RHINO_FRAMES_MAX, shadows->data_textures);
+    glDeleteProgram(shadows->program);
+
+    rhino_gpu_timer_destroy(&shadows->timer);
+
+    for(int level = 0; level < RHINO_POINT_SHADOW_LEVELS; level++) free(shadows->nodes[level]);
+
+    memset(shadows, 0, sizeof(rhino_point_shadows));
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_camera.h"
+#include "rhino_lights.h"
+#include "rhino_scene.h"
+#include "rhino_terrain.h"
+#include "rhino_timer.h"
+#include "rhino_uniforms.h"
+
+// one depth atlas shared by every shadowing point light, each light takes six square tiles (one per cube face)
+// of a single size. tiles come from a quadtree so sizes RHINO_POINT_SHADOW_MAX_TILE down to MAX_TILE >> (LEVELS - 1)
+// pack together without a fixed layout
+
+#define RHINO_POINT_SHADOW_ATLAS 4096
+#define RHINO_POINT_SHADOW_MAX_TILE 512
+#define RHINO_POINT_SHADOW_LEVELS 4
+
+#define RHINO_POINT_SHADOW_MAX_LIGHTS 64
+
+// tile texels wanted per pixel of the light's projected radius on screen, and how far coverage has to fall below
+// a tile before it is swapped for a smaller one
+
+#define RHINO_POINT_SHADOW_TEXELS_PER_PIXEL 1.0f
+#define RHINO_POINT_SHADOW_SHRINK 0.35f
+
+// faces redrawn per frame at most, the rest wait (and keep their old contents) until a later frame
+
+#define RHINO_POINT_SHADOW_FACE_BUDGET 24
+
+#define RHINO_POINT_SHADOW_NEAR 0.05f
+
+// atlas depth texture and the per light tile table, next to the light texture buffers
+
+#define RHINO_POINT_SHADOW_ATLAS_UNIT 8
+#define RHINO_POINT_SHADOW_DATA_UNIT 9
+
+// a face is valid while its tile holds the light at position with the terrain as of terrain_version
+
+typedef struct rhino_point_shadow_face_t {
+    vec3 position;
+    unsigned int terrain_version;
+    bool valid;
+    bool queued;
+} rhino_point_shadow_face;
+
+// light is the rhino_lights index, level -1 while no tiles are allocated. coverage is the projected radius in pixels
+
+typedef struct rhino_point_shadow_t {
+    int light;
+    int level;
+    int tiles[6];
+    float coverage;
+    bool visible;
+    rhino_point_shadow_face faces[6];
+} rhino_point_shadow;
+
+// everything before tiles is per frame, tiles counts what is allocated at each level
+
+typedef struct rhino_point_shadow_stats_t {
+    unsigned int faces_drawn;
+    unsigned int draw_calls;
+    unsigned int faces_waiting;
+    unsigned int faces_cached;
+    unsigned int lights_shadowed;
+    unsigned int tiles[RHINO_POINT_SHADOW_LEVELS];
+} rhino_point_shadow_stats;
+
+// a face picked for this frame's redraw
+
+typedef struct rhino_point_shadow_job_t {
+    int shadow;
+    int face;
+    float priority;
+} rhino_point_shadow_job;
+
+typedef struct rhino_point_shadows_t {
+    unsigned int fbo;
+    unsigned int depth;
+    unsigned int program;
+
+    // four rgba32f texels per slot, the six face tile origins then tile size, near and far, all in atlas uv. one
+    // copy per frame in flight
+
+    unsigned int data_buffers[RHINO_FRAMES_MAX], data_textures[RHINO_FRAMES_MAX];
+
+    // quadtree node state per level, level 0 holds the biggest tiles
+
+    unsigned char* nodes[RHINO_POINT_SHADOW_LEVELS];
+
+    rhino_point_shadow shadows[RHINO_POINT_SHADOW_MAX_LIGHTS];
+    int count;
+
+    rhino_point_shadow_job jobs[RHINO_POINT_SHADOW_MAX_LIGHTS * 6];
+    int job_count;
+
+    unsigned int static_version;
+
+    rhino_gpu_timer timer;
+    rhino_point_shadow_stats stats;
+} rhino_point_shadows;
+
+void rhino_point_shadows_init(rhino_point_shadows* shadows);
+
+// points the atlas and tile table samplers of a program at their units
+
+void rhino_point_shadows_bind_program(unsigned int program);
+
+// makes a light cast shadows, returns its slot or -1 when every slot is taken
+
+int rhino_point_shadows_add(rhino_point_shadows* shadows, int light);
+
+void rhino_point_shadows_clear(rhino_point_shadows* shadows);
+
+// sizes and allocates tiles from screen coverage, picks the faces to redraw within the budget and writes each
+// light's shadow slot. call before rhino_lights_update so the slots go up with the lights
+
+void rhino_point_shadows_update(rhino_point_shadows* shadows, rhino_lights* lights, rhino_camera* camera, float viewport_height, rhino_scene* scene, rhino_terrain* terrain);
+
+// draws the faces picked by update and binds the atlas, frame uniforms must already be uploaded
+
+void rhino_point_shadows_render(rhino_point_shadows* shadows, rhino_lights* lights, rhino_scene* scene, rhino_terrain* terrain, rhino_uniforms* uniforms);
+
+void rhino_point_shadows_print_stats(rhino_point_shadows* shadows);
+
+void rhino_point_shadows_destroy(rhino_point_shadows* shadows);
@@ -0,0 +1,416 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// rhino headers
+
+#include "rhino_post.h"
+#include "rhino_uniforms.h"
+#include "shaders.h"
+
+static const char* effect_names[RHINO_POST_EFFECTS] = { "bloom", "ssao", "fog" };
+static const int effect_divisors[RHINO_POST_EFFECTS] = { RHINO_POST_BLOOM_DIVISOR, RHINO_POST_SSAO_DIVISOR, RHINO_POST_FOG_DIVISOR };
+
+static unsigned int post_program(const char* fragment_path) {
+    unsigned int program = link_and_compile_shaders("deferred_vertex_shader.glsl", (char*)fragment_path);
+
+    rhino_uniforms_bind_program(program);
+    glUseProgram(program);
+
+    return program;
+}
+
+void rhino_post_init(rhino_post* post) {
+    memset(post, 0, sizeof(rhino_post));
+
+    for(int i = 0; i < RHINO_POST_EFFECTS; i++) {
+        rhino_post_effect* effect = &post->effects[i];
+
+        effect->name = effect_names[i];
+        effect->divisor = effect_divisors[i];
+        effect->enabled = effect->divisor > 0;
+        effect->allowed = true;
+
+        rhino_gpu_timer_init(&effect->timer);
+    }
+
+    rhino_gpu_timer_init(&post->resolve_timer);
+
+    post->bloom_threshold = RHINO_POST_BLOOM_THRESHOLD;
+    post->bloom_intensity = RHINO_POST_BLOOM_INTENSITY;
+    post->ssao_radius = RHINO_POST_SSAO_RADIUS;
+    post->ssao_intensity = RHINO_POST_SSAO_INTENSITY;
+    post->ssao_strength = RHINO_POST_SSAO_STRENGTH;
+    post->fog_density = RHINO_POST_FOG_DENSITY;
+    post->fog_falloff = RHINO_POST_FOG_FALLOFF;
+    post->fog_height = RHINO_POST_FOG_HEIGHT;
+    post->fog_distance = RHINO_POST_FOG_DISTANCE;
+    glm_vec3_one(post->fog_color);
+
+    // every source is read from unit 0 except by the composite, which reads all of them at once
+
+    post->depth_program = post_program("post_depth_shader.glsl");
+    glUniform1i(glGetUniformLocation(post->depth_program, "scene_depth"), 0);
+
+    post->blur_program = post_program("post_blur_shader.glsl");
+    glUniform1i(glGetUniformLocation(post->blur_program, "source"), 0);
+    glUniform1i(glGetUniformLocation(post->blur_program, "source_depth"), 1);
+
+    post->bloom_program = post_program("post_bloom_shader.glsl");
+    glUniform1i(glGetUniformLocation(post->bloom_program, "scene_color"), 0);
+
+    post->ssao_program = post_program("post_ssao_shader.glsl");
+    glUniform1i(glGetUniformLocation(post->ssao_program, "linear_depth"), 0);
+
+    post->fog_program = post_program("post_fog_shader.glsl");
+    glUniform1i(glGetUniformLocation(post->fog_program, "linear_depth"), 0);
+
+    post->composite_program = post_program("post_composite_shader.glsl");
+    glUniform1i(glGetUniformLocation(post->composite_program, "scene_color"), 0);
+    glUniform1i(glGetUniformLocation(post->composite_program, "scene_depth"), 1);
+    glUniform1i(glGetUniformLocation(post->composite_program, "ssao"), 2);
+    glUniform1i(glGetUniformLocation(post->composite_program, "ssao_depth"), 3);
+    glUniform1i(glGetUniformLocation(post->composite_program, "fog"), 4);
+    glUniform1i(glGetUniformLocation(post->composite_program, "fog_depth"), 5);
+    glUniform1i(glGetUniformLocation(post->composite_program, "bloom"), 6);
+
+    glGenVertexArrays(1, &post->vao);
+}
+
+// ---- passes ---- //
+
+static void bind_source(rhino_graph* graph, int unit, int resource) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, resource >= 0 ? rhino_graph_texture(graph, resource) : 0);
+}
+
+static void draw_fullscreen(rhino_post_pass* pass, unsigned int program) {
+    glActiveTexture(GL_TEXTURE0);
+
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+
+    if(pass->begin_timer) rhino_gpu_timer_begin(pass->timer);
+
+    glUseProgram(program);
+    glBindVertexArray(pass->post->vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    if(pass->end_timer) rhino_gpu_timer_end(pass->timer);
+
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+}
+
+static void depth_pass(rhino_graph* graph, void* user) {
+    rhino_post_pass* pass = user;
+    unsigned int program = pass->post->depth_program;
+
+    bind_source(graph, 0, pass->source);
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "divisor"), pass->divisor);
+
+    draw_fullscreen(pass, program);
+}
+
+static void blur_pass(rhino_graph* graph, void* user) {
+    rhino_post_pass* pass = user;
+    unsigned int program = pass->post->blur_program;
+
+    bind_source(graph, 0, pass->source);
+    bind_source(graph, 1, pass->source_depth);
+
+    glUseProgram(program);
+    glUniform2i(glGetUniformLocation(program, "direction"), pass->direction[0], pass->direction[1]);
+    glUniform1f(glGetUniformLocation(program, "depth_sigma"), pass->depth_sigma);
+
+    draw_fullscreen(pass, program);
+}
+
+static void bloom_pass(rhino_graph* graph, void* user) {
+    rhino_post_pass* pass = user;
+    unsigned int program = pass->post->bloom_program;
+
+    bind_source(graph, 0, pass->source);
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "divisor"), pass->divisor);
+    glUniform1f(glGetUniformLocation(program, "threshold"), pass->post->bloom_threshold);
+
+    draw_fullscreen(pass, program);
+}
+
+static void ssao_pass(rhino_graph* graph, void* user) {
+    rhino_post_pass* pass = user;
+    unsigned int program = pass->post->ssao_program;
+
+    bind_source(graph, 0, pass->source);
+
+    glUseProgram(program);
+    glUniform1f(glGetUniformLocation(program, "radius"), pass->post->ssao_radius);
+    glUniform1f(glGetUniformLocation(program, "intensity"), pass->post->ssao_intensity);
+
+    draw_fullscreen(pass, program);
+}
+
+// the sun shadow map stays bound on its own unit from the shadow pass
+
+static void fog_pass(rhino_graph* graph, void* user) {
+    rhino_post_pass* pass = user;
+    rhino_post* post = pass->post;
+    unsigned int program = post->fog_program;
+
+    bind_source(graph, 0, pass->source);
+
+    glUseProgram(program);
+    glUniform4f(glGetUniformLocation(program, "fog_params"), post->fog_density, post->fog_falloff, post->fog_height, post->fog_distance);
+    glUniform3fv(glGetUniformLocation(program, "fog_color"), 1, post->fog_color);
+
+    draw_fullscreen(pass, program);
+}
+
+static void composite_pass(rhino_graph* graph, void* user) {
+    rhino_post_pass* pass = user;
+    rhino_post* post = pass->post;
+    unsigned int program = post->composite_program;
+
+    bind_source(graph, 0, post->scene_color);
+    bind_source(graph, 1, post->scene_depth);
+    bind_source(graph, 2, post->results[RHINO_POST_SSAO]);
+    bind_source(graph, 3, post->result_depths[RHINO_POST_SSAO]);
+    bind_source(graph, 4, post->results[RHINO_POST_FOG]);
+    bind_source(graph, 5, post->result_depths[RHINO_POST_FOG]);
+    bind_source(graph, 6, post->results[RHINO_POST_BLOOM]);
+
+    glUseProgram(program);
+    glUniform4i(glGetUniformLocation(program, "effects"), post->results[RHINO_POST_BLOOM] >= 0, post->results[RHINO_POST_SSAO] >= 0, post->results[RHINO_POST_FOG] >= 0, 0);
+    glUniform4f(glGetUniformLocation(program, "post_params"), post->bloom_intensity, post->ssao_strength, 0.0f, 0.0f);
+
+    draw_fullscreen(pass, program);
+}
+
+// ---- declaration ---- //
+
+static int add_pass(rhino_post* post, rhino_graph* graph, const char* name, rhino_graph_execute_fn execute, rhino_gpu_timer* timer) {
+    rhino_post_pass* pass = &post->passes[post->pass_count++];
+    memset(pass, 0, sizeof(rhino_post_pass));
+
+    pass->post = post;
+    pass->timer = timer;
+    pass->source = -1;
+    pass->source_depth = -1;
+
+    return rhino_graph_add_pass(graph, name, execute, pass);
+}
+
+static rhino_post_pass* last_pass(rhino_post* post) {
+    return &post->passes[post->pass_count - 1];
+}
+
+// x then y into two fresh transients, the second lands in the texture the effect's first target just freed
+
+static int add_blur(rhino_post* post, rhino_graph* graph, const char* name, int source, int depth, GLenum format, int width, int height, rhino_gpu_timer* timer) {
+    int target = source;
+
+    for(int axis = 0; axis < 2; axis++) {
+        int next = rhino_graph_create(graph, name, format, width, height);
+        int pass = add_pass(post, graph, axis == 0 ? "post blur x" : "post blur y", blur_pass, timer);
+
+        rhino_post_pass* blur = last_pass(post);
+
+        blur->source = target;
+        blur->source_depth = depth;
+        blur->direction[axis] = 1;
+        blur->depth_sigma = depth >= 0 ? RHINO_POST_DEPTH_SIGMA : 0.0f;
+
+        rhino_graph_read(graph, pass, target);
+        if(depth >= 0) rhino_graph_read(graph, pass, depth);
+        rhino_graph_write_color(graph, pass, next);
+
+        target = next;
+    }
+
+    last_pass(post)->end_timer = true;
+
+    return target;
+}
+
+int rhino_post_declare(rhino_post* post, rhino_graph* graph, int color, int depth, int cascades, int width, int height) {
+    post->pass_count = 0;
+    post->scene_color = color;
+    post->scene_depth = depth;
+
+    bool any = false;
+
+    for(int i = 0; i < RHINO_POST_EFFECTS; i++) {
+        rhino_post_effect* effect = &post->effects[i];
+
+        post->results[i] = -1;
+        post->result_depths[i] = -1;
+
+        any |= effect->enabled && effect->allowed && effect->divisor > 0;
+    }
+
+    if(!any) return color;
+
+    // linear depth at each divisor the depth aware effects use, made by whichever effect needs it first
+
+    int depth_levels[RHINO_POST_MAX_DIVISOR + 1];
+    for(int i = 0; i <= RHINO_POST_MAX_DIVISOR; i++) depth_levels[i] = -1;
+
+    for(int i = 0; i < RHINO_POST_EFFECTS; i++) {
+        rhino_post_effect* effect = &post->effects[i];
+
+        if(!effect->enabled || !effect->allowed || effect->divisor <= 0) continue;
+
+        int divisor = effect->divisor;
+        int scaled_width = (width + divisor - 1) / divisor;
+        int scaled_height = (height + divisor - 1) / divisor;
+
+        bool begun = false;
+
+        if(i != RHINO_POST_BLOOM && depth_levels[divisor] < 0) {
+            depth_levels[divisor] = rhino_graph_create(graph, "post depth", GL_R32F, scaled_width, scaled_height);
+
+            int pass = add_pass(post, graph, "post depth", depth_pass, &effect->timer);
+
+            last_pass(post)->source = depth;
+            last_pass(post)->divisor = divisor;
+            last_pass(post)->begin_timer = true;
+            begun = true;
+
+            rhino_graph_read(graph, pass, depth);
+            rhino_graph_write_color(graph, pass, depth_levels[divisor]);
+        }
+
+        int level = i == RHINO_POST_BLOOM ? -1 : depth_levels[divisor];
+        int pass, target;
+        GLenum format;
+
+        if(i == RHINO_POST_BLOOM) {
+            format = GL_RGBA16F;
+            target = rhino_graph_create(graph, "bloom", format, scaled_width, scaled_height);
+            pass = add_pass(post, graph, "bloom bright pass", bloom_pass, &effect->timer);
+
+            last_pass(post)->source = color;
+            rhino_graph_read(graph, pass, color);
+        }
+        else if(i == RHINO_POST_SSAO) {
+            format = GL_R8;
+            target = rhino_graph_create(graph, "ssao", format, scaled_width, scaled_height);
+            pass = add_pass(post, graph, "ssao", ssao_pass, &effect->timer);
+
+            last_pass(post)->source = level;
+            rhino_graph_read(graph, pass, level);
+        }
+        else {
+            format = GL_RGBA16F;
+            target = rhino_graph_create(graph, "fog", format, scaled_width, scaled_height);
+            pass = add_pass(post, graph, "fog", fog_pass, &effect->timer);
+
+            last_pass(post)->source = level;
+            rhino_graph_read(graph, pass, level);
+            rhino_graph_read(graph, pass, cascades);
+        }
+
+        last_pass(post)->divisor = divisor;
+        last_pass(post)->begin_timer = !begun;
+        rhino_graph_write_color(graph, pass, target);
+
+        post->results[i] = add_blur(post, graph, effect->name, target, level, format, scaled_width, scaled_height, &effect->timer);
+        post->result_depths[i] = level;
+    }
+
+    int output = rhino_graph_create(graph, "post colour", GL_RGBA16F, width, height);
+    int pass = add_pass(post, graph, "post composite", composite_pass, &post->resolve_timer);
+
+    last_pass(post)->begin_timer = true;
+    last_pass(post)->end_timer = true;
+
+    rhino_graph_read(graph, pass, color);
+    rhino_graph_read(graph, pass, depth);
+
+    for(int i = 0; i < RHINO_POST_EFFECTS; i++) {
+        if(post->results[i] >= 0) rhino_graph_read(graph, pass, post->results[i]);
+        if(post->result_depths[i] >= 0) rhino_graph_read(graph, pass, post->result_depths[i]);
+    }
+
+    rhino_graph_write_color(graph, pass, output);
+
+    return output;
+}
+
+// ---- settings ---- //
+
+bool rhino_post_configure(rhino_post* post, const char* setting) {
+    const char* colon = strchr(setting, ':');
+
+    if(!colon) return false;
+
+    for(int i = 0; i < RHINO_POST_EFFECTS; i++) {
+        rhino_post_effect* effect = &post->effects[i];
+
+        if(strlen(effect->name) != (size_t)(colon - setting) || strncmp(effect->name, setting, colon - setting) != 0) continue;
+
+        int divisor = atoi(colon + 1);
+
+        if(divisor < 0 || divisor > RHINO_POST_MAX_DIVISOR) return false;
+
+        effect->enabled = divisor > 0;
+        if(divisor > 0) effect->divisor = divisor;
+
+        return true;
+    }
+
+    return false;
+}
+
+void rhino_post_toggle(rhino_post* post, rhino_post_effect_id effect) {
+    post->effects[effect].enabled = !post->effects[effect].enabled;
+
+    printf("\n%s %s at 1/%d resolution%s", post->effects[effect].name, post->effects[effect].enabled ? "on" : "off", post->effects[effect].divisor,
+        post->effects[effect].allowed ? "" : ", held off by the quality governor");
+}
+
+void rhino_post_update(rhino_post* post) {
+    for(int i = 0; i < RHINO_POST_EFFECTS; i++) rhino_gpu_timer_poll(&post->effects[i].timer, false);
+
+    rhino_gpu_timer_poll(&post->resolve_timer, false);
+}
+
+void rhino_post_print_stats(rhino_post* post) {
+    printf("post :");
+
+    for(int i = 0; i < RHINO_POST_EFFECTS; i++) {
+        rhino_post_effect* effect = &post->effects[i];
+
+        printf("%s %s ", i ? " |" : "", effect->name);
+
+        if(!effect->enabled) printf("off");
+        else if(!effect->allowed) printf("held off");
+        else printf("1/%d, %.3f ms", effect->divisor, effect->timer.smoothed_ms);
+    }
+
+    printf(" | composite %.3f ms\n", post->resolve_timer.smoothed_ms);
+}
+
+void rhino_post_destroy(rhino_post* post) {
+    for(int i = 0; i < RHINO_POST_EFFECTS; i++) rhino_gpu_timer_destroy(&post->effects[i].timer);
+
+    rhino_gpu_timer_destroy(&post->resolve_timer);
+
+    glDeleteProgram(post->depth_program);
+    glDeleteProgram(post->blur_program);
+    glDeleteProgram(post->bloom_program);
+    glDeleteProgram(post->ssao_program);
+    glDeleteProgram(post->fog_program);
+    glDeleteProgram(post->composite_program);
+    glDeleteVertexArrays(1, &post->vao);
+
+    memset(post, 0, sizeof(rhino_post));
+}
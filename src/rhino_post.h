@@ -0,0 +1,131 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_graph.h"
+#include "rhino_timer.h"
+
+// post processing stack run as frame graph passes between the scene and the present pass. every effect renders at
+// the scene size over its divisor, blurs in ping-pong targets the graph pool shares between effects of the same
+// format and divisor, and is composited back at full resolution in one pass
+
+typedef enum rhino_post_effect_id_t {
+    RHINO_POST_BLOOM,
+    RHINO_POST_SSAO,
+    RHINO_POST_FOG,
+    RHINO_POST_EFFECTS
+} rhino_post_effect_id;
+
+#define RHINO_POST_MAX_DIVISOR 8
+
+// divisors the stack starts with, 0 leaves an effect off
+
+#define RHINO_POST_BLOOM_DIVISOR 2
+#define RHINO_POST_SSAO_DIVISOR 2
+#define RHINO_POST_FOG_DIVISOR 4
+
+#define RHINO_POST_BLOOM_THRESHOLD 1.0f
+#define RHINO_POST_BLOOM_INTENSITY 0.1f
+
+// world space sampling radius and how dark full occlusion gets
+
+#define RHINO_POST_SSAO_RADIUS 0.75f
+#define RHINO_POST_SSAO_INTENSITY 1.5f
+#define RHINO_POST_SSAO_STRENGTH 0.8f
+
+// density at the base height, its falloff per metre above it, and the distance the sky counts as
+
+#define RHINO_POST_FOG_DENSITY 0.01f
+#define RHINO_POST_FOG_FALLOFF 0.15f
+#define RHINO_POST_FOG_HEIGHT -1.0f
+#define RHINO_POST_FOG_DISTANCE 150.0f
+
+// blur taps further than this fraction of the centre's depth away barely count
+
+#define RHINO_POST_DEPTH_SIGMA 0.05f
+
+#define RHINO_POST_MAX_PASSES 16
+
+// allowed is the quality governor's say, enabled the user's. gpu time covers every pass of the effect
+
+typedef struct rhino_post_effect_t {
+    const char* name;
+    bool enabled;
+    bool allowed;
+    int divisor;
+
+    rhino_gpu_timer timer;
+} rhino_post_effect;
+
+struct rhino_post_t;
+
+// what one post pass of this frame works on, handed to the graph as the pass's user data. timer is begun by the
+// first pass of an effect and ended by its last
+
+typedef struct rhino_post_pass_t {
+    struct rhino_post_t* post;
+    rhino_gpu_timer* timer;
+    bool begin_timer, end_timer;
+
+    int source;
+    int source_depth;
+    int divisor;
+    int direction[2];
+    float depth_sigma;
+} rhino_post_pass;
+
+typedef struct rhino_post_t {
+    rhino_post_effect effects[RHINO_POST_EFFECTS];
+
+    float bloom_threshold, bloom_intensity;
+    float ssao_radius, ssao_intensity, ssao_strength;
+    float fog_density, fog_falloff, fog_height, fog_distance;
+    vec3 fog_color;
+
+    unsigned int depth_program;
+    unsigned int blur_program;
+    unsigned int bloom_program;
+    unsigned int ssao_program;
+    unsigned int fog_program;
+    unsigned int composite_program;
+    unsigned int vao;
+
+    // depth downsamples and the composite
+
+    rhino_gpu_timer resolve_timer;
+
+    // this frame's resources, -1 for effects that are off
+
+    int scene_color, scene_depth;
+    int results[RHINO_POST_EFFECTS];
+    int result_depths[RHINO_POST_EFFECTS];
+
+    rhino_post_pass passes[RHINO_POST_MAX_PASSES];
+    int pass_count;
+} rhino_post;
+
+void rhino_post_init(rhino_post* post);
+
+// declares this frame's post passes over a scene colour and depth of width by height, cascades is the imported sun
+// shadow map the fog reads. returns the colour resource to present, color itself when every effect is off
+
+int rhino_post_declare(rhino_post* post, rhino_graph* graph, int color, int depth, int cascades, int width, int height);
+
+// "name:divisor" from the command line, divisor 0 switches the effect off. false for anything unrecognised
+
+bool rhino_post_configure(rhino_post* post, const char* setting);
+
+void rhino_post_toggle(rhino_post* post, rhino_post_effect_id effect);
+
+// polls the effect timers, call once per frame after the graph executed
+
+void rhino_post_update(rhino_post* post);
+
+void rhino_post_print_stats(rhino_post* post);
+
+void rhino_post_destroy(rhino_post* post);
@@ -0,0 +1,603 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_probes.h"
+#include "rhino_terrain.h"
+
+#define RAY_OFFSET 0.002f
+#define SHADOW_RAY_MAX 1000.0f
+
+#define TERRAIN_STEP 1.0f
+
+#define GOLDEN_ANGLE 2.39996323f
+
+// static triangles the probes are traced against, one normal and albedo per triangle
+
+typedef struct probe_world_t {
+    float* positions;
+    unsigned int* indices;
+    unsigned int vertex_count;
+    vec3* normals;
+    float* albedo;
+    unsigned int triangle_count;
+    rhino_bvh4 bvh;
+} probe_world;
+
+// real sh basis up to band 2, in the order the shaders evaluate it
+
+static void sh_basis(const float* d, float* out) {
+    out[0] = 0.282095f;
+    out[1] = 0.488603f * d[1];
+    out[2] = 0.488603f * d[2];
+    out[3] = 0.488603f * d[0];
+    out[4] = 1.092548f * d[0] * d[1];
+    out[5] = 1.092548f * d[1] * d[2];
+    out[6] = 0.315392f * (3.0f * d[2] * d[2] - 1.0f);
+    out[7] = 1.092548f * d[0] * d[2];
+    out[8] = 0.546274f * (d[0] * d[0] - d[1] * d[1]);
+}
+
+// radiance to irradiance is a convolution with the clamped cosine, pi, 2pi / 3 and pi / 4 per band. folded together
+// with the basis constants so the shaders only evaluate the polynomial
+
+static const float irradiance_factors[RHINO_PROBE_COEFFICIENTS] = {
+    3.141593f * 0.282095f,
+    2.094395f * 0.488603f, 2.094395f * 0.488603f, 2.094395f * 0.488603f,
+    0.785398f * 1.092548f, 0.785398f * 1.092548f, 0.785398f * 0.315392f, 0.785398f * 1.092548f, 0.785398f * 0.546274f
+};
+
+static void sky_radiance(rhino_probe_environment* environment, vec3 direction, vec3 radiance) {
+    float up = direction[1] > 0.0f ? direction[1] : 0.0f;
+
+    glm_vec3_lerp(environment->sky_horizon, environment->sky_zenith, up, radiance);
+}
+
+static bool sphere_touches_box(vec3 center, float radius, vec3 box[2]) {
+    float distance = 0.0f;
+
+    for(int k = 0; k < 3; k++) {
+        float d = center[k] < box[0][k] ? box[0][k] - center[k] : center[k] > box[1][k] ? center[k] - box[1][k] : 0.0f;
+        distance += d * d;
+    }
+
+    return distance <= radius * radius;
+}
+
+// ---- world ---- //
+
+static void world_add(probe_world* world, const float* positions, unsigned int stride, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count, mat4 model, float albedo) {
+    unsigned int base = world->vertex_count;
+
+    world->positions = realloc(world->positions, (world->vertex_count + vertex_count) * 3 * sizeof(float));
+    world->indices = realloc(world->indices, (world->triangle_count * 3 + index_count) * sizeof(unsigned int));
+    world->normals = realloc(world->normals, (world->triangle_count + index_count / 3) * sizeof(vec3));
+    world->albedo = realloc(world->albedo, (world->triangle_count + index_count / 3) * sizeof(float));
+
+    for(unsigned int i = 0; i < vertex_count; i++) glm_mat4_mulv3(model, (float*)&positions[i * stride], 1.0f, &world->positions[(base + i) * 3]);
+
+    for(unsigned int i = 0; i < index_count / 3; i++) {
+        unsigned int* triangle = &world->indices[(world->triangle_count + i) * 3];
+        vec3 edge1, edge2;
+
+        for(int k = 0; k < 3; k++) triangle[k] = base + indices[i * 3 + k];
+
+        glm_vec3_sub(&world->positions[triangle[1] * 3], &world->positions[triangle[0] * 3], edge1);
+        glm_vec3_sub(&world->positions[triangle[2] * 3], &world->positions[triangle[0] * 3], edge2);
+        glm_vec3_cross(edge1, edge2, world->normals[world->triangle_count + i]);
+        glm_vec3_normalize(world->normals[world->triangle_count + i]);
+
+        world->albedo[world->triangle_count + i] = albedo;
+    }
+
+    world->vertex_count += vertex_count;
+    world->triangle_count += index_count / 3;
+}
+
+// static entities (only the full detail indices are kept on the cpu) and a heightfield patch covering everything
+// the probes can reach
+
+static void world_build(probe_world* world, rhino_probes* probes, rhino_scene* scene, rhino_probe_environment* environment) {
+    memset(world, 0, sizeof(*world));
+
+    for(int i = 0; i < scene->entity_count; i++) {
+        rhino_entity* entity = &scene->entities[i];
+
+        if(entity->dynamic) continue;
+
+        rhino_mesh* mesh = entity->mesh;
+
+        world_add(world, (float*)mesh->vertices, sizeof(rhino_vertex) / sizeof(float), mesh->vertex_count, mesh->indices, mesh->index_count, entity->model, environment->albedo);
+    }
+
+    float x0 = probes->origin[0] - RHINO_PROBE_RAY_MAX;
+    float z0 = probes->origin[2] - RHINO_PROBE_RAY_MAX;
+    int columns = (int)ceilf(((probes->size[0] - 1) * probes->spacing + 2.0f * RHINO_PROBE_RAY_MAX) / TERRAIN_STEP) + 1;
+    int rows = (int)ceilf(((probes->size[2] - 1) * probes->spacing + 2.0f * RHINO_PROBE_RAY_MAX) / TERRAIN_STEP) + 1;
+
+    float* positions = malloc(columns * rows * 3 * sizeof(float));
+    unsigned int* indices = malloc((columns - 1) * (rows - 1) * 6 * sizeof(unsigned int));
+    unsigned int index_count = 0;
+
+    for(int j = 0; j < rows; j++) {
+        for(int i = 0; i < columns; i++) {
+            float* p = &positions[(j * columns + i) * 3];
+
+            p[0] = x0 + i * TERRAIN_STEP;
+            p[2] = z0 + j * TERRAIN_STEP;
+            p[1] = rhino_terrain_height(p[0], p[2]);
+        }
+    }
+
+    for(int j = 0; j < rows - 1; j++) {
+        for(int i = 0; i < columns - 1; i++) {
+            unsigned int a = j * columns + i;
+
+            indices[index_count++] = a;
+            indices[index_count++] = a + columns;
+            indices[index_count++] = a + 1;
+            indices[index_count++] = a + 1;
+            indices[index_count++] = a + columns;
+            indices[index_count++] = a + columns + 1;
+        }
+    }
+
+    mat4 identity = GLM_MAT4_IDENTITY_INIT;
+    world_add(world, positions, 3, columns * rows, indices, index_count, identity, environment->terrain_albedo);
+
+    free(positions);
+    free(indices);
+
+    rhino_bvh4_build_triangles(&world->bvh, world->positions, 3, world->indices, world->triangle_count);
+}
+
+static void world_destroy(probe_world* world) {
+    rhino_bvh4_destroy(&world->bvh);
+    free(world->positions);
+    free(world->indices);
+    free(world->normals);
+    free(world->albedo);
+}
+
+// ---- relighting ---- //
+
+#if defined(__SSE2__)
+static float horizontal_sum(__m128 v) {
+    __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuffled);
+
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    sums = _mm_add_ss(sums, shuffled);
+
+    return _mm_cvtss_f32(sums);
+}
+#endif
+
+// adds one light to the radiance along each direction, same falloff as the lighting shaders but unshadowed
+
+static void add_light(rhino_probes* probes, unsigned int base, rhino_point_light* light, float radiance[3][RHINO_PROBE_DIRECTIONS]) {
+    float* px = probes->hit_position[0] + base;
+    float* py = probes->hit_position[1] + base;
+    float* pz = probes->hit_position[2] + base;
+    float* nx = probes->hit_normal[0] + base;
+    float* ny = probes->hit_normal[1] + base;
+    float* nz = probes->hit_normal[2] + base;
+    float* albedo = probes->hit_albedo + base;
+
+#if defined(__SSE2__)
+    __m128 light_x = _mm_set1_ps(light->position[0]);
+    __m128 light_y = _mm_set1_ps(light->position[1]);
+    __m128 light_z = _mm_set1_ps(light->position[2]);
+    __m128 inverse_radius = _mm_set1_ps(1.0f / light->radius);
+    __m128 color_r = _mm_set1_ps(light->color[0]);
+    __m128 color_g = _mm_set1_ps(light->color[1]);
+    __m128 color_b = _mm_set1_ps(light->color[2]);
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 epsilon = _mm_set1_ps(1e-8f);
+
+    for(int j = 0; j < RHINO_PROBE_DIRECTIONS; j += 4) {
+        __m128 dx = _mm_sub_ps(light_x, _mm_loadu_ps(px + j));
+        __m128 dy = _mm_sub_ps(light_y, _mm_loadu_ps(py + j));
+        __m128 dz = _mm_sub_ps(light_z, _mm_loadu_ps(pz + j));
+        __m128 distance_squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 distance = _mm_sqrt_ps(_mm_max_ps(distance_squared, epsilon));
+
+        __m128 facing = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(nx + j), dx), _mm_mul_ps(_mm_loadu_ps(ny + j), dy)), _mm_mul_ps(_mm_loadu_ps(nz + j), dz));
+        __m128 cosine = _mm_max_ps(_mm_div_ps(facing, distance), zero);
+
+        __m128 ratio = _mm_mul_ps(distance, inverse_radius);
+        ratio = _mm_mul_ps(ratio, ratio);
+        __m128 window = _mm_min_ps(_mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(ratio, ratio)), zero), one);
+
+        __m128 weight = _mm_mul_ps(_mm_mul_ps(cosine, _mm_mul_ps(window, window)), _mm_loadu_ps(albedo + j));
+        weight = _mm_div_ps(weight, _mm_add_ps(one, distance_squared));
+
+        _mm_storeu_ps(radiance[0] + j, _mm_add_ps(_mm_loadu_ps(radiance[0] + j), _mm_mul_ps(weight, color_r)));
+        _mm_storeu_ps(radiance[1] + j, _mm_add_ps(_mm_loadu_ps(radiance[1] + j), _mm_mul_ps(weight, color_g)));
+        _mm_storeu_ps(radiance[2] + j, _mm_add_ps(_mm_loadu_ps(radiance[2] + j), _mm_mul_ps(weight, color_b)));
+    }
+#else
+    for(int j = 0; j < RHINO_PROBE_DIRECTIONS; j++) {
+        float dx = light->position[0] - px[j], dy = light->position[1] - py[j], dz = light->position[2] - pz[j];
+        float distance_squared = dx * dx + dy * dy + dz * dz;
+        float distance = sqrtf(distance_squared > 1e-8f ? distance_squared : 1e-8f);
+
+        float cosine = (nx[j] * dx + ny[j] * dy + nz[j] * dz) / distance;
+        if(cosine < 0.0f) cosine = 0.0f;
+
+        float ratio = distance / light->radius;
+        ratio *= ratio;
+        float window = glm_clamp(1.0f - ratio * ratio, 0.0f, 1.0f);
+
+        float weight = cosine * window * window * albedo[j] / (1.0f + distance_squared);
+
+        for(int c = 0; c < 3; c++) radiance[c][j] += weight * light->color[c];
+    }
+#endif
+}
+
+// projects the radiance onto the basis and writes the irradiance coefficients into the probe's texels
+
+static void project(rhino_probes* probes, int probe, float radiance[3][RHINO_PROBE_DIRECTIONS]) {
+    float coefficients[RHINO_PROBE_COEFFICIENTS][3];
+
+    for(int k = 0; k < RHINO_PROBE_COEFFICIENTS; k++) {
+#if defined(__SSE2__)
+        __m128 sum_r = _mm_setzero_ps(), sum_g = _mm_setzero_ps(), sum_b = _mm_setzero_ps();
+
+        for(int j = 0; j < RHINO_PROBE_DIRECTIONS; j += 4) {
+            __m128 basis = _mm_loadu_ps(probes->basis[k] + j);
+
+            sum_r = _mm_add_ps(sum_r, _mm_mul_ps(basis, _mm_loadu_ps(radiance[0] + j)));
+            sum_g = _mm_add_ps(sum_g, _mm_mul_ps(basis, _mm_loadu_ps(radiance[1] + j)));
+            sum_b = _mm_add_ps(sum_b, _mm_mul_ps(basis, _mm_loadu_ps(radiance[2] + j)));
+        }
+
+        coefficients[k][0] = horizontal_sum(sum_r);
+        coefficients[k][1] = horizontal_sum(sum_g);
+        coefficients[k][2] = horizontal_sum(sum_b);
+#else
+        coefficients[k][0] = coefficients[k][1] = coefficients[k][2] = 0.0f;
+
+        for(int j = 0; j < RHINO_PROBE_DIRECTIONS; j++) {
+            for(int c = 0; c < 3; c++) coefficients[k][c] += probes->basis[k][j] * radiance[c][j];
+        }
+#endif
+    }
+
+    int x = probe % probes->size[0];
+    int y = (probe / probes->size[0]) % probes->size[1];
+    int z = probe / (probes->size[0] * probes->size[1]);
+    int width = probes->size[0] * RHINO_PROBE_TEXELS;
+
+    for(int i = 0; i < RHINO_PROBE_COEFFICIENTS * 3; i++) {
+        int texel = i / 4;
+        float* row = &probes->texels[((z * probes->size[1] + y) * width + texel * probes->size[0] + x) * 4];
+
+        row[i % 4] = coefficients[i / 3][i % 3] * irradiance_factors[i / 3];
+    }
+}
+
+static void relight(rhino_probes* probes, int probe, rhino_lights* lights) {
+    float radiance[3][RHINO_PROBE_DIRECTIONS];
+    unsigned int base = probe * RHINO_PROBE_DIRECTIONS;
+
+    for(int c = 0; c < 3; c++) memcpy(radiance[c], probes->unlit[c] + base, sizeof(radiance[c]));
+
+    if(lights) {
+        for(int i = 0; i < lights->light_count; i++) {
+            rhino_point_light* light = &lights->lights[i];
+
+            if(sphere_touches_box(light->position, light->radius, probes->reach[probe])) add_light(probes, base, light, radiance);
+        }
+    }
+
+    project(probes, probe, radiance);
+}
+
+// marks every probe whose hits the sphere reaches
+
+static void mark_stale(rhino_probes* probes, vec3 center, float radius) {
+    int lo[3], hi[3];
+
+    for(int k = 0; k < 3; k++) {
+        lo[k] = (int)floorf((center[k] - radius - RHINO_PROBE_RAY_MAX - probes->origin[k]) / probes->spacing);
+        hi[k] = (int)ceilf((center[k] + radius + RHINO_PROBE_RAY_MAX - probes->origin[k]) / probes->spacing);
+
+        if(lo[k] < 0) lo[k] = 0;
+        if(hi[k] > probes->size[k] - 1) hi[k] = probes->size[k] - 1;
+        if(lo[k] > hi[k]) return;
+    }
+
+    for(int z = lo[2]; z <= hi[2]; z++) {
+        for(int y = lo[1]; y <= hi[1]; y++) {
+            for(int x = lo[0]; x <= hi[0]; x++) {
+                int probe = x + probes->size[0] * (y + probes->size[1] * z);
+
+                if(probes->stale[probe] || !sphere_touches_box(center, radius, probes->reach[probe])) continue;
+
+                probes->stale[probe] = 1;
+                probes->stale_count++;
+            }
+        }
+    }
+}
+
+static void upload(rhino_probes* probes, int z0, int z1) {
+    int width = probes->size[0] * RHINO_PROBE_TEXELS;
+
+    glBindTexture(GL_TEXTURE_3D, probes->texture);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, z0, width, probes->size[1], z1 - z0 + 1, GL_RGBA, GL_FLOAT, &probes->texels[z0 * probes->size[1] * width * 4]);
+}
+
+// ---- public ---- //
+
+void rhino_probes_init(rhino_probes* probes, vec3 origin, int size[3], float spacing) {
+    memset(probes, 0, sizeof(*probes));
+
+    glm_vec3_copy(origin, probes->origin);
+    probes->spacing = spacing;
+    memcpy(probes->size, size, sizeof(probes->size));
+    probes->count = size[0] * size[1] * size[2];
+
+    // evenly spread directions on a fibonacci spiral, each one stands for the same solid angle
+
+    for(int j = 0; j < RHINO_PROBE_DIRECTIONS; j++) {
+        float* d = probes->directions[j];
+        float y = 1.0f - (2.0f * j + 1.0f) / RHINO_PROBE_DIRECTIONS;
+        float r = sqrtf(1.0f - y * y);
+
+        d[0] = cosf(GOLDEN_ANGLE * j) * r;
+        d[1] = y;
+        d[2] = sinf(GOLDEN_ANGLE * j) * r;
+
+        float basis[RHINO_PROBE_COEFFICIENTS];
+        sh_basis(d, basis);
+
+        for(int k = 0; k < RHINO_PROBE_COEFFICIENTS; k++) probes->basis[k][j] = basis[k] * 4.0f * GLM_PIf / RHINO_PROBE_DIRECTIONS;
+    }
+
+    unsigned int samples = probes->count * RHINO_PROBE_DIRECTIONS;
+
+    probes->positions = malloc(probes->count * sizeof(vec3));
+    probes->reach = malloc(probes->count * sizeof(*probes->reach));
+    probes->hit_albedo = malloc(samples * sizeof(float));
+
+    for(int k = 0; k < 3; k++) {
+        probes->hit_position[k] = malloc(samples * sizeof(float));
+        probes->hit_normal[k] = malloc(samples * sizeof(float));
+        probes->unlit[k] = malloc(samples * sizeof(float));
+    }
+
+    probes->stale = calloc(probes->count, 1);
+    probes->texels = calloc(probes->count * RHINO_PROBE_TEXELS * 4, sizeof(float));
+
+    // the filtering that interpolates between probes is plain hardware trilinear
+
+    glGenTextures(1, &probes->texture);
+    glBindTexture(GL_TEXTURE_3D, probes->texture);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16F, size[0] * RHINO_PROBE_TEXELS, size[1], size[2], 0, GL_RGBA, GL_FLOAT, probes->texels);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+}
+
+void rhino_probes_bake(rhino_probes* probes, rhino_scene* scene, rhino_probe_environment* environment) {
+    double start = glfwGetTime();
+
+    probe_world world;
+    world_build(&world, probes, scene, environment);
+
+    vec3 to_sun;
+    glm_vec3_negate_to(environment->sun_direction, to_sun);
+    glm_vec3_normalize(to_sun);
+
+    unsigned long long rays = 0;
+
+    for(int probe = 0; probe < probes->count; probe++) {
+        int x = probe % probes->size[0];
+        int y = (probe / probes->size[0]) % probes->size[1];
+        int z = probe / (probes->size[0] * probes->size[1]);
+
+        float* position = probes->positions[probe];
+        glm_vec3_copy((vec3){x * probes->spacing, y * probes->spacing, z * probes->spacing}, position);
+        glm_vec3_add(position, probes->origin, position);
+
+        float ground = rhino_terrain_height(position[0], position[2]) + RHINO_PROBE_GROUND_OFFSET;
+        if(position[1] < ground) position[1] = ground;
+
+        glm_vec3_copy(position, probes->reach[probe][0]);
+        glm_vec3_copy(position, probes->reach[probe][1]);
+
+        for(int j = 0; j < RHINO_PROBE_DIRECTIONS; j++) {
+            unsigned int sample = probe * RHINO_PROBE_DIRECTIONS + j;
+            float* direction = probes->directions[j];
+
+            // misses and back faces keep the probe's own position so the light loop stays finite, their zero
+            // albedo drops them
+
+            vec3 hit, normal, radiance;
+            glm_vec3_copy(position, hit);
+            glm_vec3_zero(normal);
+            glm_vec3_zero(radiance);
+
+            float albedo = 0.0f;
+            float t = RHINO_PROBE_RAY_MAX;
+            unsigned int triangle;
+
+            rays++;
+
+            if(!rhino_bvh4_intersect(&world.bvh, position, direction, &t, &triangle)) sky_radiance(environment, direction, radiance);
+            else if(glm_vec3_dot(world.normals[triangle], direction) < 0.0f) {
+                glm_vec3_copy(world.normals[triangle], normal);
+                glm_vec3_muladds(direction, t, hit);
+
+                albedo = world.albedo[triangle] / GLM_PIf;
+
+                // sun with one shadow ray, sky as if the hit saw the half of it its normal faces
+
+                vec3 irradiance, sky;
+                glm_vec3_zero(irradiance);
+
+                float cosine = glm_vec3_dot(normal, to_sun);
+
+                if(cosine > 0.0f) {
+                    vec3 origin;
+                    glm_vec3_copy(hit, origin);
+                    glm_vec3_muladds(normal, RAY_OFFSET, origin);
+
+                    rays++;
+
+                    if(!rhino_bvh4_occluded(&world.bvh, origin, to_sun, SHADOW_RAY_MAX)) glm_vec3_scale(environment->sun_color, cosine, irradiance);
+                }
+
+                sky_radiance(environment, normal, sky);
+                glm_vec3_muladds(sky, GLM_PIf * (0.5f + 0.5f * normal[1]), irradiance);
+
+                glm_vec3_scale(irradiance, albedo, radiance);
+
+                glm_vec3_minv(probes->reach[probe][0], hit, probes->reach[probe][0]);
+                glm_vec3_maxv(probes->reach[probe][1], hit, probes->reach[probe][1]);
+            }
+
+            probes->hit_albedo[sample] = albedo;
+
+            for(int k = 0; k < 3; k++) {
+                probes->hit_position[k][sample] = hit[k];
+                probes->hit_normal[k][sample] = normal[k];
+                probes->unlit[k][sample] = radiance[k];
+            }
+        }
+
+        relight(probes, probe, NULL);
+    }
+
+    world_destroy(&world);
+
+    upload(probes, 0, probes->size[2] - 1);
+
+    // no light has been seen yet, the first update marks everything stale
+
+    probes->light_state_count = -1;
+
+    probes->stats.bake_seconds = glfwGetTime() - start;
+    probes->stats.bake_rays = rays;
+
+    printf("\nprobes : %d (%d x %d x %d) traced in %.3f s, %llu rays", probes->count, probes->size[0], probes->size[1], probes->size[2], probes->stats.bake_seconds, rays);
+}
+
+void rhino_probes_update(rhino_probes* probes, rhino_lights* lights) {
+    if(probes->stats.bake_rays == 0) return;
+
+    double start = glfwGetTime();
+
+    probes->stats.relit = 0;
+    probes->stats.lights_moved = 0;
+
+    // a different set of lights relights everything, otherwise only around lights that moved or changed size
+
+    if(lights->light_count != probes->light_state_count) {
+        probes->light_state = realloc(probes->light_state, (lights->light_count > 0 ? lights->light_count : 1) * sizeof(vec4));
+        probes->light_state_count = lights->light_count;
+
+        for(int i = 0; i < lights->light_count; i++) glm_vec4(lights->lights[i].position, lights->lights[i].radius, probes->light_state[i]);
+
+        memset(probes->stale, 1, probes->count);
+        probes->stale_count = probes->count;
+    }
+    else {
+        for(int i = 0; i < lights->light_count; i++) {
+            rhino_point_light* light = &lights->lights[i];
+            float* state = probes->light_state[i];
+
+            if(glm_vec3_distance2(light->position, state) < RHINO_PROBE_MOVE_THRESHOLD * RHINO_PROBE_MOVE_THRESHOLD && light->radius == state[3]) continue;
+
+            mark_stale(probes, state, state[3]);
+            mark_stale(probes, light->position, light->radius);
+
+            glm_vec4(light->position, light->radius, state);
+            probes->stats.lights_moved++;
+        }
+    }
+
+    // stale probes in grid order from where the last frame stopped, the touched z range goes up in one call
+
+    int z0 = probes->size[2], z1 = -1;
+
+    for(int visited = 0; visited < probes->count && probes->stale_count > 0 && probes->stats.relit < RHINO_PROBE_BUDGET; visited++) {
+        int probe = probes->cursor;
+        probes->cursor = (probes->cursor + 1) % probes->count;
+
+        if(!probes->stale[probe]) continue;
+
+        relight(probes, probe, lights);
+
+        probes->stale[probe] = 0;
+        probes->stale_count--;
+        probes->stats.relit++;
+
+        int z = probe / (probes->size[0] * probes->size[1]);
+        if(z < z0) z0 = z;
+        if(z > z1) z1 = z;
+    }
+
+    if(z1 >= 0) upload(probes, z0, z1);
+
+    probes->stats.stale = probes->stale_count;
+    probes->stats.relight_seconds = glfwGetTime() - start;
+}
+
+void rhino_probes_frame(rhino_probes* probes, rhino_frame_block* frame) {
+    glm_vec4(probes->origin, probes->spacing, frame->probe_origin);
+    glm_vec4((vec3){(float)probes->size[0], (float)probes->size[1], (float)probes->size[2]}, probes->stats.bake_rays > 0 ? 1.0f : 0.0f, frame->probe_size);
+}
+
+void rhino_probes_bind_program(unsigned int program) {
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "probe_grid"), RHINO_PROBE_UNIT);
+}
+
+void rhino_probes_bind(rhino_probes* probes) {
+    glActiveTexture(GL_TEXTURE0 + RHINO_PROBE_UNIT);
+    glBindTexture(GL_TEXTURE_3D, probes->texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void rhino_probes_print_stats(rhino_probes* probes) {
+    rhino_probe_stats* stats = &probes->stats;
+
+    printf("probes : %u relit (%u lights moved), %u stale, %.3f ms\n", stats->relit, stats->lights_moved, stats->stale, stats->relight_seconds * 1000.0);
+}
+
+void rhino_probes_destroy(rhino_probes* probes) {
+    glDeleteTextures(1, &probes->texture);
+
+    free(probes->positions);
+    free(probes->reach);
+    free(probes->hit_albedo);
+
+    for(int k = 0; k < 3; k++) {
+        free(probes->hit_position[k]);
+        free(probes->hit_normal[k]);
+        free(probes->unlit[k]);
+    }
+
+    free(probes->light_state);
+    free(probes->stale);
+    free(probes->texels);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_bvh.h"
+#include "rhino_lights.h"
+#include "rhino_scene.h"
+#include "rhino_uniforms.h"
+
+// regular grid of L2 spherical harmonic irradiance probes for objects without a lightmap. each probe traces a fixed
+// set of directions once against the static scene, relighting only re-shades the stored hits and projects them again
+
+#define RHINO_PROBE_DIRECTIONS 64
+#define RHINO_PROBE_COEFFICIENTS 9
+
+// 27 floats per probe in seven rgba texels. the grid texture lays the seven texels out as seven grid sized slabs
+// side by side along x, sampling stays between the first and last probe of a slab so filtering never crosses one
+
+#define RHINO_PROBE_TEXELS 7
+
+#define RHINO_PROBE_UNIT 11
+
+// probe rays stop here and count as sky, lights further than this from everything a probe sees never relight it
+
+#define RHINO_PROBE_RAY_MAX 16.0f
+
+// probes below the terrain are lifted to this far above it
+
+#define RHINO_PROBE_GROUND_OFFSET 0.5f
+
+// probes relit per frame at most, and how far a light has to move before the probes around it are marked stale
+
+#define RHINO_PROBE_BUDGET 64
+#define RHINO_PROBE_MOVE_THRESHOLD 0.25f
+
+// static lighting the probes are traced with, sky radiance is a gradient from horizon to zenith
+
+typedef struct rhino_probe_environment_t {
+    vec3 sun_direction;
+    vec3 sun_color;
+    vec3 sky_zenith;
+    vec3 sky_horizon;
+    float albedo;
+    float terrain_albedo;
+} rhino_probe_environment;
+
+typedef struct rhino_probe_stats_t {
+    double bake_seconds;
+    unsigned long long bake_rays;
+    double relight_seconds;
+    unsigned int relit;
+    unsigned int lights_moved;
+    unsigned int stale;
+} rhino_probe_stats;
+
+typedef struct rhino_probes_t {
+    vec3 origin;
+    float spacing;
+    int size[3];
+    int count;
+
+    // probe positions after lifting, and the box around each probe's hits
+
+    vec3* positions;
+    vec3 (*reach)[2];
+
+    // per probe, RHINO_PROBE_DIRECTIONS entries each. hit position, normal and albedo over albedo / pi (zero for
+    // misses and back faces) as separate arrays so four hits load into one simd register. unlit is the radiance
+    // along each direction without the point lights, sky for misses and the bounced sun and sky for hits
+
+    float* hit_position[3];
+    float* hit_normal[3];
+    float* hit_albedo;
+    float* unlit[3];
+
+    // sh basis of every direction, premultiplied by the solid angle each one stands for
+
+    float basis[RHINO_PROBE_COEFFICIENTS][RHINO_PROBE_DIRECTIONS];
+    float directions[RHINO_PROBE_DIRECTIONS][3];
+
+    // light position and radius as of the last time the probes around it were marked stale
+
+    vec4* light_state;
+    int light_state_count;
+
+    unsigned char* stale;
+    int stale_count;
+    int cursor;
+
+    // cpu copy of the grid texture, slabs of RHINO_PROBE_TEXELS as laid out on the gpu
+
+    float* texels;
+    unsigned int texture;
+
+    rhino_probe_stats stats;
+} rhino_probes;
+
+// size probes along each axis, spacing apart from origin. nothing is traced until rhino_probes_bake
+
+void rhino_probes_init(rhino_probes* probes, vec3 origin, int size[3], float spacing);
+
+// traces every probe against the static entities and the terrain under the grid, then lights them without point
+// lights. the point lights come in through rhino_probes_update over the following frames
+
+void rhino_probes_bake(rhino_probes* probes, rhino_scene* scene, rhino_probe_environment* environment);
+
+// marks the probes around moved lights stale and relights up to RHINO_PROBE_BUDGET of them
+
+void rhino_probes_update(rhino_probes* probes, rhino_lights* lights);
+
+// fills the probe grid fields of the frame block
+
+void rhino_probes_frame(rhino_probes* probes, rhino_frame_block* frame);
+
+// points the probe_grid sampler of a program at RHINO_PROBE_UNIT
+
+void rhino_probes_bind_program(unsigned int program);
+
+void rhino_probes_bind(rhino_probes* probes);
+
+void rhino_probes_print_stats(rhino_probes* probes);
+
+void rhino_probes_destroy(rhino_probes* probes);
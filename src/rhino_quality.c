@@ -0,0 +1,186 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// rhino headers
+
+#include "rhino_quality.h"
+#include "rhino_shadows.h"
+
+// best to worst, every step gives up a little of each knob rather than all of one
+
+static const rhino_quality_level default_ladder[] = {
+    { "ultra", RHINO_SHADOW_RESOLUTION, 4, 0, 0, 0.0f, RHINO_QUALITY_POST_ALL },
+    { "high", RHINO_SHADOW_RESOLUTION, 3, 0, 256, 0.0f, RHINO_QUALITY_POST_ALL },
+    { "medium", 1024, 3, 1, 128, 0.5f, RHINO_QUALITY_POST_SHARPEN | RHINO_QUALITY_POST_BLOOM | RHINO_QUALITY_POST_FOG },
+    { "low", 1024, 2, 1, 64, 1.0f, RHINO_QUALITY_POST_FOG },
+    { "minimum", 512, 1, 2, 32, 1.5f, 0 }
+};
+
+void rhino_quality_init(rhino_quality* quality, float budget_ms) {
+    memset(quality, 0, sizeof(rhino_quality));
+
+    quality->enabled = true;
+    quality->budget_ms = budget_ms;
+    quality->level_count = sizeof(default_ladder) / sizeof(default_ladder[0]);
+
+    memcpy(quality->levels, default_ladder, sizeof(default_ladder));
+}
+
+bool rhino_quality_load(rhino_quality* quality, const char* path) {
+    FILE* file = fopen(path, "r");
+
+    if(!file) {
+        printf("\nfailed to open quality ladder %s", path);
+        return false;
+    }
+
+    rhino_quality_level levels[RHINO_QUALITY_MAX_LEVELS];
+    int count = 0;
+
+    char line[256];
+    int line_number = 0;
+
+    while(fgets(line, sizeof(line), file)) {
+        line_number++;
+
+        char* start = line;
+        while(*start == ' ' || *start == '\t') start++;
+
+        if(*start == '#' || *start == '\n' || *start == '\r' || *start == '\0') continue;
+
+        if(count == RHINO_QUALITY_MAX_LEVELS) {
+            printf("\nquality ladder %s has more than %d levels, the rest are ignored", path, RHINO_QUALITY_MAX_LEVELS);
+            break;
+        }
+
+        rhino_quality_level* level = &levels[count];
+        unsigned int post;
+
+        if(sscanf(start, "%31s %d %d %d %d %f %u", level->name, &level->shadow_resolution, &level->shadow_cascades, &level->lod_bias, &level->light_cap, &level->mip_bias, &post) != 7) {
+            printf("\nquality ladder %s line %d is not name, shadow resolution, cascades, lod bias, light cap, mip bias, post", path, line_number);
+            continue;
+        }
+
+        level->post = post;
+        count++;
+    }
+
+    fclose(file);
+
+    if(count == 0) return false;
+
+    memcpy(quality->levels, levels, count * sizeof(rhino_quality_level));
+    quality->level_count = count;
+
+    // backoff counts belong to the old ladder's levels
+
+    memset(quality->failures, 0, sizeof(quality->failures));
+    quality->good_windows = 0;
+
+    rhino_quality_set_level(quality, 0);
+
+    printf("\nloaded %d quality levels from %s", count, path);
+
+    return true;
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+
+    return (x > y) - (x < y);
+}
+
+// nearest rank on a sorted window
+
+static float percentile(float* sorted, int count, float p) {
+    int rank = (int)(p * count + 0.999f) - 1;
+
+    if(rank < 0) rank = 0;
+    if(rank >= count) rank = count - 1;
+
+    return sorted[rank];
+}
+
+bool rhino_quality_frame(rhino_quality* quality, float frame_ms) {
+    quality->window[quality->window_count++] = frame_ms;
+
+    if(quality->window_count < RHINO_QUALITY_WINDOW) return false;
+
+    quality->window_count = 0;
+
+    float sorted[RHINO_QUALITY_WINDOW];
+    memcpy(sorted, quality->window, sizeof(sorted));
+    qsort(sorted, RHINO_QUALITY_WINDOW, sizeof(float), compare_floats);
+
+    rhino_quality_stats* stats = &quality->stats;
+
+    stats->p50 = percentile(sorted, RHINO_QUALITY_WINDOW, 0.50f);
+    stats->p95 = percentile(sorted, RHINO_QUALITY_WINDOW, 0.95f);
+    stats->p99 = percentile(sorted, RHINO_QUALITY_WINDOW, 0.99f);
+    stats->windows++;
+
+    if(!quality->enabled) return false;
+
+    if(quality->skip_window) {
+        quality->skip_window = false;
+        return false;
+    }
+
+    int next = quality->level;
+
+    if(stats->p95 > quality->budget_ms * RHINO_QUALITY_DOWN_RATIO) {
+        quality->good_windows = 0;
+
+        if(quality->level + 1 < quality->level_count) {
+            if(quality->failures[quality->level] < RHINO_QUALITY_MAX_BACKOFF) quality->failures[quality->level]++;
+            next = quality->level + 1;
+        }
+    }
+    else if(stats->p95 < quality->budget_ms * RHINO_QUALITY_UP_RATIO) {
+        quality->good_windows++;
+
+        // the level above is the one that might have been given up before
+
+        if(quality->level > 0 && quality->good_windows >= RHINO_QUALITY_UP_WINDOWS << quality->failures[quality->level - 1]) next = quality->level - 1;
+    }
+    else quality->good_windows = 0;
+
+    if(next == quality->level) return false;
+
+    printf("\nquality : %s -> %s, frame time p50 %.2f p95 %.2f p99 %.2f ms over %d frames for a %.2f ms budget",
+        quality->levels[quality->level].name, quality->levels[next].name, stats->p50, stats->p95, stats->p99, RHINO_QUALITY_WINDOW, quality->budget_ms);
+
+    quality->level = next;
+    quality->good_windows = 0;
+    quality->skip_window = true;
+    stats->changes++;
+
+    return true;
+}
+
+rhino_quality_level* rhino_quality_current(rhino_quality* quality) {
+    return &quality->levels[quality->level];
+}
+
+void rhino_quality_set_level(rhino_quality* quality, int level) {
+    if(level < 0) level = 0;
+    if(level >= quality->level_count) level = quality->level_count - 1;
+
+    quality->level = level;
+    quality->window_count = 0;
+    quality->good_windows = 0;
+    quality->skip_window = false;
+}
+
+void rhino_quality_print_stats(rhino_quality* quality) {
+    rhino_quality_stats* stats = &quality->stats;
+    rhino_quality_level* level = rhino_quality_current(quality);
+
+    printf("quality : %s (%d of %d, %s) - frame time p50 %.2f p95 %.2f p99 %.2f ms for a %.2f ms budget, %u changes in %u windows\n",
+        level->name, quality->level + 1, quality->level_count, quality->enabled ? "governed" : "fixed",
+        stats->p50, stats->p95, stats->p99, quality->budget_ms, stats->changes, stats->windows);
+}
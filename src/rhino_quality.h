@@ -0,0 +1,103 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+// quality governor, watches frame time percentiles over windows of frames and steps down or up a ladder of quality
+// levels. dynamic resolution follows the average gpu time every few frames, the governor answers to the slow tail
+// the scale cannot fix
+
+#define RHINO_QUALITY_MAX_LEVELS 16
+#define RHINO_QUALITY_NAME_LENGTH 32
+
+// frames per window, percentiles are taken over each full window
+
+#define RHINO_QUALITY_WINDOW 120
+
+// a window whose p95 goes this far over the budget steps down a level, one whose p95 stays this far under it for
+// RHINO_QUALITY_UP_WINDOWS windows in a row steps up. the gap between the two is the hysteresis
+
+#define RHINO_QUALITY_DOWN_RATIO 1.1f
+#define RHINO_QUALITY_UP_RATIO 0.75f
+#define RHINO_QUALITY_UP_WINDOWS 3
+
+// each time a level had to be left again, climbing back to it takes twice as many good windows, up to this many
+// doublings
+
+#define RHINO_QUALITY_MAX_BACKOFF 4
+
+// post effects a level leaves on
+
+#define RHINO_QUALITY_POST_SHARPEN (1 << 0)
+#define RHINO_QUALITY_POST_BLOOM (1 << 1)
+#define RHINO_QUALITY_POST_SSAO (1 << 2)
+#define RHINO_QUALITY_POST_FOG (1 << 3)
+#define RHINO_QUALITY_POST_ALL 0xffffffffu
+
+// one rung of the ladder. light_cap 0 shades every light, mip_bias is added to every scene texture's lod
+
+typedef struct rhino_quality_level_t {
+    char name[RHINO_QUALITY_NAME_LENGTH];
+    int shadow_resolution;
+    int shadow_cascades;
+    int lod_bias;
+    int light_cap;
+    float mip_bias;
+    unsigned int post;
+} rhino_quality_level;
+
+typedef struct rhino_quality_stats_t {
+    float p50, p95, p99;
+    unsigned int windows;
+    unsigned int changes;
+} rhino_quality_stats;
+
+// level 0 is the best, the ladder is walked towards level_count - 1 under load
+
+typedef struct rhino_quality_t {
+    bool enabled;
+    float budget_ms;
+
+    rhino_quality_level levels[RHINO_QUALITY_MAX_LEVELS];
+    int level_count;
+    int level;
+
+    float window[RHINO_QUALITY_WINDOW];
+    int window_count;
+
+    // good windows in a row, and how often each level was stepped down from
+
+    int good_windows;
+    int failures[RHINO_QUALITY_MAX_LEVELS];
+
+    // the window a change happens in mixes both levels, it is thrown away
+
+    bool skip_window;
+
+    rhino_quality_stats stats;
+} rhino_quality;
+
+// starts on the best level of the default ladder
+
+void rhino_quality_init(rhino_quality* quality, float budget_ms);
+
+// replaces the ladder with one read from a text file, one level per line as name, shadow resolution, cascades, lod
+// bias, light cap, mip bias and post effects as a mask of RHINO_QUALITY_POST bits (1 sharpen, 2 bloom, 4 ssao,
+// 8 fog). blank lines and lines starting with # are skipped. returns false and keeps the current ladder if nothing
+// could be read
+
+bool rhino_quality_load(rhino_quality* quality, const char* path);
+
+// records a frame time, returns true when the level changed and has to be applied
+
+bool rhino_quality_frame(rhino_quality* quality, float frame_ms);
+
+rhino_quality_level* rhino_quality_current(rhino_quality* quality);
+
+// jumps to a level directly, forgetting the window so far
+
+void rhino_quality_set_level(rhino_quality* quality, int level);
+
+void rhino_quality_print_stats(rhino_quality* quality);
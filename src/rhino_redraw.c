@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// rhino headers
+
+#include "rhino_redraw.h"
+
+static const char* source_names[RHINO_REDRAW_SOURCES] = { "input", "window", "simulation", "streaming", "animation", "progressive" };
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+void rhino_redraw_init(rhino_redraw* redraw, bool on_demand) {
+    memset(redraw, 0, sizeof(rhino_redraw));
+
+    redraw->on_demand = on_demand;
+    atomic_init(&redraw->dirty, RHINO_REDRAW_WINDOW);
+
+    pthread_mutex_init(&redraw->lock, NULL);
+    pthread_cond_init(&redraw->wake, NULL);
+
+    redraw->stats.start = now();
+
+    if(on_demand) printf("\nrendering on demand");
+}
+
+void rhino_redraw_request(rhino_redraw* redraw, unsigned int sources) {
+    // only the request that makes the frame dirty has to wake the render thread, later ones ride along
+
+    if(atomic_fetch_or(&redraw->dirty, sources) != 0) return;
+
+    pthread_mutex_lock(&redraw->lock);
+    pthread_cond_signal(&redraw->wake);
+    pthread_mutex_unlock(&redraw->lock);
+}
+
+void rhino_redraw_set_continuous(rhino_redraw* redraw, unsigned int sources, bool continuous) {
+    if(continuous) redraw->continuous |= sources;
+    else redraw->continuous &= ~sources;
+}
+
+unsigned int rhino_redraw_wait(rhino_redraw* redraw) {
+    redraw->last_idle = 0.0;
+
+    if(redraw->on_demand && !redraw->continuous && atomic_load(&redraw->dirty) == 0) {
+        double start = now();
+
+        pthread_mutex_lock(&redraw->lock);
+
+        while(atomic_load(&redraw->dirty) == 0) pthread_cond_wait(&redraw->wake, &redraw->lock);
+
+        pthread_mutex_unlock(&redraw->lock);
+
+        redraw->last_idle = now() - start;
+        redraw->stats.idle_seconds += redraw->last_idle;
+    }
+
+    unsigned int sources = atomic_exchange(&redraw->dirty, 0) | redraw->continuous;
+
+    redraw->stats.frames++;
+
+    for(int i = 0; i < RHINO_REDRAW_SOURCES; i++) {
+        if(sources & (1u << i)) redraw->stats.sources[i]++;
+    }
+
+    return sources;
+}
+
+void rhino_redraw_print_stats(rhino_redraw* redraw) {
+    rhino_redraw_stats* stats = &redraw->stats;
+
+    if(!redraw->on_demand) return;
+
+    // idle stretches make the time between prints uneven, measure it
+
+    double time = now();
+    double seconds = time - stats->start;
+
+    printf("redraw : %u frames drawn in %.1f s, idle %.0f%% of the time, frames asked for by", stats->frames, seconds, seconds > 0.0 ? stats->idle_seconds * 100.0 / seconds : 0.0);
+
+    for(int i = 0; i < RHINO_REDRAW_SOURCES; i++) printf(" %s %u", source_names[i], stats->sources[i]);
+
+    printf("\n");
+
+    memset(stats, 0, sizeof(rhino_redraw_stats));
+    stats->start = time;
+}
+
+void rhino_redraw_destroy(rhino_redraw* redraw) {
+    pthread_mutex_destroy(&redraw->lock);
+    pthread_cond_destroy(&redraw->wake);
+}
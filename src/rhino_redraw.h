@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// render on demand. anything that changes what is on screen requests a redraw naming its source, from any thread,
+// and the render thread sleeps until one comes in instead of drawing the same frame over and over. systems that
+// animate every frame opt in as continuous sources
+
+// sources, kept as bits
+
+#define RHINO_REDRAW_INPUT (1 << 0)
+#define RHINO_REDRAW_WINDOW (1 << 1)
+#define RHINO_REDRAW_SIMULATION (1 << 2)
+#define RHINO_REDRAW_STREAMING (1 << 3)
+#define RHINO_REDRAW_ANIMATION (1 << 4)
+#define RHINO_REDRAW_PROGRESSIVE (1 << 5)
+
+#define RHINO_REDRAW_SOURCES 6
+
+// taken and reset by rhino_redraw_print_stats, sources counts the frames each source asked for. start is when the
+// stats were last reset
+
+typedef struct rhino_redraw_stats_t {
+    double start;
+    unsigned int frames;
+    unsigned int sources[RHINO_REDRAW_SOURCES];
+    double idle_seconds;
+} rhino_redraw_stats;
+
+typedef struct rhino_redraw_t {
+    bool on_demand;
+
+    // sources drawn every frame whether or not anything asked
+
+    unsigned int continuous;
+
+    // requested since the render thread last took them
+
+    atomic_uint dirty;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+
+    // seconds the last rhino_redraw_wait slept, frame times leave it out
+
+    double last_idle;
+
+    rhino_redraw_stats stats;
+} rhino_redraw;
+
+// off draws every frame like before, the first frame is always drawn
+
+void rhino_redraw_init(rhino_redraw* redraw, bool on_demand);
+
+// any thread
+
+void rhino_redraw_request(rhino_redraw* redraw, unsigned int sources);
+
+void rhino_redraw_set_continuous(rhino_redraw* redraw, unsigned int sources, bool continuous);
+
+// render thread only, sleeps until a redraw is requested and returns what asked for it. returns at once when not
+// on demand or while a continuous source is set
+
+unsigned int rhino_redraw_wait(rhino_redraw* redraw);
+
+void rhino_redraw_print_stats(rhino_redraw* redraw);
+
+void rhino_redraw_destroy(rhino_redraw* redraw);
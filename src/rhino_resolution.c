@@ -0,0 +1,183 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+// rhino headers
+
+#include "rhino_resolution.h"
+#include "shaders.h"
+
+void rhino_resolution_init(rhino_resolution* resolution) {
+    memset(resolution, 0, sizeof(rhino_resolution));
+
+    resolution->dynamic = true;
+    resolution->scale = RHINO_RESOLUTION_MAX_SCALE;
+    resolution->target_ms = RHINO_RESOLUTION_TARGET_MS;
+    resolution->filter = RHINO_UPSCALE_SHARPEN;
+
+    rhino_gpu_timer_init(&resolution->timer);
+
+    resolution->program = link_and_compile_shaders("deferred_vertex_shader.glsl", "upscale_fragment_shader.glsl");
+
+    glUseProgram(resolution->program);
+    glUniform1i(glGetUniformLocation(resolution->program, "source"), RHINO_UPSCALE_SOURCE_UNIT);
+    resolution->sharpness_location = glGetUniformLocation(resolution->program, "sharpness");
+    resolution->target_size_location = glGetUniformLocation(resolution->program, "inv_target_size");
+
+    glGenVertexArrays(1, &resolution->vao);
+}
+
+void rhino_resolution_size(rhino_resolution* resolution, int width, int height, int* scaled_width, int* scaled_height) {
+    *scaled_width = (int)(width * resolution->scale + 0.5f);
+    *scaled_height = (int)(height * resolution->scale + 0.5f);
+
+    if(*scaled_width < 1) *scaled_width = 1;
+    if(*scaled_height < 1) *scaled_height = 1;
+}
+
+void rhino_resolution_begin(rhino_resolution* resolution) {
+    rhino_gpu_timer_begin(&resolution->timer);
+}
+
+void rhino_resolution_end(rhino_resolution* resolution) {
+    rhino_gpu_timer_end(&resolution->timer);
+}
+
+static float snap_scale(float scale) {
+    scale = floorf(scale / RHINO_RESOLUTION_STEP + 0.001f) * RHINO_RESOLUTION_STEP;
+
+    if(scale < RHINO_RESOLUTION_MIN_SCALE) scale = RHINO_RESOLUTION_MIN_SCALE;
+    if(scale > RHINO_RESOLUTION_MAX_SCALE) scale = RHINO_RESOLUTION_MAX_SCALE;
+
+    return scale;
+}
+
+// gpu time is taken to follow the pixel count, so the scale moves by the square root of how far off it is. both
+// directions aim for the middle of the band between the target and the headroom so a change does not land right
+// on the edge of the next one
+
+static float next_scale(float scale, double average_ms, float target_ms) {
+    double low = target_ms * (1.0 - RHINO_RESOLUTION_HEADROOM);
+
+    if(average_ms <= target_ms && average_ms >= low) return scale;
+
+    double aim = target_ms * (1.0 - RHINO_RESOLUTION_HEADROOM * 0.5);
+    float wanted = scale * (float)sqrt(aim / average_ms);
+
+    if(wanted < scale - RHINO_RESOLUTION_MAX_CHANGE) wanted = scale - RHINO_RESOLUTION_MAX_CHANGE;
+    if(wanted > scale + RHINO_RESOLUTION_MAX_CHANGE) wanted = scale + RHINO_RESOLUTION_MAX_CHANGE;
+
+    // at least a step in the direction asked for, snapping alone could round a small change away
+
+    if(average_ms > target_ms) return snap_scale(fminf(wanted, scale - RHINO_RESOLUTION_STEP));
+
+    return snap_scale(fmaxf(wanted, scale + RHINO_RESOLUTION_STEP));
+}
+
+void rhino_resolution_update(rhino_resolution* resolution, bool wait) {
+    rhino_resolution_stats* stats = &resolution->stats;
+
+    stats->history[stats->head] = resolution->scale;
+    stats->head = (stats->head + 1) % RHINO_RESOLUTION_HISTORY;
+    if(stats->count < RHINO_RESOLUTION_HISTORY) stats->count++;
+
+    // the timer only keeps its latest result, poll once per frame and take whatever arrived
+
+    rhino_gpu_timer_poll(&resolution->timer, wait);
+
+    if(resolution->timer.samples == resolution->timer_samples) return;
+
+    resolution->timer_samples = resolution->timer.samples;
+
+    // frames queued before the last change still report the old scale
+
+    if(resolution->settle > 0) {
+        resolution->settle--;
+        return;
+    }
+
+    resolution->sample_ms += resolution->timer.last_ms;
+    resolution->sample_count++;
+
+    if(resolution->sample_count < RHINO_RESOLUTION_INTERVAL) return;
+
+    double average_ms = resolution->sample_ms / resolution->sample_count;
+
+    stats->last_average_ms = average_ms;
+    resolution->sample_ms = 0.0;
+    resolution->sample_count = 0;
+
+    if(!resolution->dynamic) return;
+
+    float scale = next_scale(resolution->scale, average_ms, resolution->target_ms);
+
+    if(scale == resolution->scale) return;
+
+    resolution->scale = scale;
+    resolution->settle = RHINO_TIMER_LATENCY;
+    stats->changes++;
+}
+
+void rhino_resolution_upscale(rhino_resolution* resolution, unsigned int texture) {
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glActiveTexture(GL_TEXTURE0 + RHINO_UPSCALE_SOURCE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+
+    glUseProgram(resolution->program);
+    glUniform1f(resolution->sharpness_location, resolution->filter == RHINO_UPSCALE_SHARPEN ? RHINO_UPSCALE_SHARPNESS : 0.0f);
+    glUniform2f(resolution->target_size_location, 1.0f / viewport[2], 1.0f / viewport[3]);
+
+    glBindVertexArray(resolution->vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+}
+
+float rhino_resolution_average(rhino_resolution* resolution) {
+    rhino_resolution_stats* stats = &resolution->stats;
+
+    if(stats->count == 0) return resolution->scale;
+
+    float sum = 0.0f;
+
+    for(int i = 0; i < stats->count; i++) sum += stats->history[i];
+
+    return sum / stats->count;
+}
+
+void rhino_resolution_print_stats(rhino_resolution* resolution, int width, int height) {
+    rhino_resolution_stats* stats = &resolution->stats;
+
+    float low = resolution->scale, high = resolution->scale;
+
+    for(int i = 0; i < stats->count; i++) {
+        low = fminf(low, stats->history[i]);
+        high = fmaxf(high, stats->history[i]);
+    }
+
+    int scaled_width, scaled_height;
+    rhino_resolution_size(resolution, width, height, &scaled_width, &scaled_height);
+
+    printf("resolution : %.2f scale (%dx%d of %dx%d, %s, %s upscale) - gpu %.3f ms for a %.3f ms target, last %d frames %.2f to %.2f averaging %.2f, %u changes\n",
+        resolution->scale, scaled_width, scaled_height, width, height, resolution->dynamic ? "dynamic" : "fixed",
+        resolution->filter == RHINO_UPSCALE_SHARPEN ? "sharpened" : "bilinear", stats->last_average_ms, resolution->target_ms,
+        stats->count, low, high, rhino_resolution_average(resolution), stats->changes);
+}
+
+void rhino_resolution_destroy(rhino_resolution* resolution) {
+    rhino_gpu_timer_destroy(&resolution->timer);
+    glDeleteProgram(resolution->program);
+    glDeleteVertexArrays(1, &resolution->vao);
+
+    memset(resolution, 0, sizeof(rhino_resolution));
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "rhino_timer.h"
+
+// dynamic resolution, the scene renders into targets scaled down from the framebuffer and is upscaled to it in
+// the present pass. a controller reads the gpu time of whole frames and moves the scale towards a target frame time
+
+#define RHINO_RESOLUTION_TARGET_MS (1000.0f / 60.0f)
+
+// scales are multiples of RHINO_RESOLUTION_STEP so the frame graph pool only ever sees a handful of sizes
+
+#define RHINO_RESOLUTION_MIN_SCALE 0.5f
+#define RHINO_RESOLUTION_MAX_SCALE 1.0f
+#define RHINO_RESOLUTION_STEP 0.05f
+
+// frames of gpu time averaged before each decision, and how far a single decision may move the scale
+
+#define RHINO_RESOLUTION_INTERVAL 15
+#define RHINO_RESOLUTION_MAX_CHANGE 0.15f
+
+// hysteresis, the scale only goes up once frames come in this far under the target, and only down once they go over
+// it. between the two it holds still
+
+#define RHINO_RESOLUTION_HEADROOM 0.15f
+
+// frames of scale kept for the stats
+
+#define RHINO_RESOLUTION_HISTORY 120
+
+#define RHINO_UPSCALE_SOURCE_UNIT 0
+
+// how much of the neighbourhood difference the sharpening filter adds back
+
+#define RHINO_UPSCALE_SHARPNESS 0.6f
+
+typedef enum rhino_upscale_filter_t {
+    RHINO_UPSCALE_BILINEAR,
+    RHINO_UPSCALE_SHARPEN
+} rhino_upscale_filter;
+
+// history is a ring of the scale every frame rendered at, head is the next slot written
+
+typedef struct rhino_resolution_stats_t {
+    float history[RHINO_RESOLUTION_HISTORY];
+    int head;
+    int count;
+    unsigned int changes;
+    double last_average_ms;
+} rhino_resolution_stats;
+
+typedef struct rhino_resolution_t {
+    bool dynamic;
+    float scale;
+    float target_ms;
+    rhino_upscale_filter filter;
+
+    // gpu time of every pass of a frame, samples taken before the last change are skipped by settle
+
+    rhino_gpu_timer timer;
+    unsigned int timer_samples;
+    int settle;
+    double sample_ms;
+    int sample_count;
+
+    unsigned int program;
+    int sharpness_location;
+    int target_size_location;
+    unsigned int vao;
+
+    rhino_resolution_stats stats;
+} rhino_resolution;
+
+void rhino_resolution_init(rhino_resolution* resolution);
+
+// scene targets for a framebuffer of this size, never smaller than a pixel
+
+void rhino_resolution_size(rhino_resolution* resolution, int width, int height, int* scaled_width, int* scaled_height);
+
+// bracket everything the frame draws so the controller sees the whole gpu frame
+
+void rhino_resolution_begin(rhino_resolution* resolution);
+
+void rhino_resolution_end(rhino_resolution* resolution);
+
+// collects finished timings and moves the scale once enough of them arrived, wait blocks on outstanding queries.
+// a fixed scale still records its history
+
+void rhino_resolution_update(rhino_resolution* resolution, bool wait);
+
+// draws texture over the bound framebuffer's viewport with the active filter
+
+void rhino_resolution_upscale(rhino_resolution* resolution, unsigned int texture);
+
+// average scale over the history
+
+float rhino_resolution_average(rhino_resolution* resolution);
+
+void rhino_resolution_print_stats(rhino_resolution* resolution, int width, int height);
+
+void rhino_resolution_destroy(rhino_resolution* resolution);
@@ -0,0 +1,127 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_scene.h"
+#include "rhino_global.h"
+
+void rhino_scene_init(rhino_scene* scene) {
+    memset(scene, 0, sizeof(rhino_scene));
+}
+
+int rhino_scene_add(rhino_scene* scene, rhino_mesh* mesh, unsigned int texture, float texture_scale) {
+    if(scene->entity_count == scene->entity_capacity) {
+        scene->entity_capacity = scene->entity_capacity ? scene->entity_capacity * 2 : 16;
+        scene->entities = realloc(scene->entities, scene->entity_capacity * sizeof(rhino_entity));
+    }
+
+    rhino_entity* entity = &scene->entities[scene->entity_count];
+
+    memset(entity, 0, sizeof(rhino_entity));
+
+    entity->mesh = mesh;
+    entity->texture = texture;
+    entity->texture_scale = texture_scale;
+    entity->lod.prev_lod = -1;
+    entity->lod.fade = 1.0f;
+
+    glm_mat4_identity(entity->model);
+    glm_vec3_copy(mesh->bounds[0], entity->world_bounds[0]);
+    glm_vec3_copy(mesh->bounds[1], entity->world_bounds[1]);
+
+    scene->tlas_dirty = true;
+    scene->static_version++;
+
+    return scene->entity_count++;
+}
+
+void rhino_scene_update(rhino_scene* scene) {
+    for(int i = 0; i < scene->entity_count; i++) {
+        rhino_entity* entity = &scene->entities[i];
+
+        glm_aabb_transform(entity->mesh->bounds, entity->model, entity->world_bounds);
+    }
+
+    scene->tlas_dirty = true;
+}
+
+void rhino_scene_record(rhino_scene* scene, rhino_command_buffer* buffer, int part, int parts, float pixels_per_unit) {
+    int begin = scene->entity_count * part / parts;
+    int end = scene->entity_count * (part + 1) / parts;
+
+    for(int i = begin; i < end; i++) {
+        rhino_entity* entity = &scene->entities[i];
+
+        rhino_lod_submit(entity->mesh, &entity->lod, entity->model, pixels_per_unit);
+
+        rhino_object_block block;
+        glm_mat4_copy(entity->model, block.model);
+        glm_vec4_copy((vec4){entity->texture_scale, 0.0f, 0.0f, 0.0f}, block.params);
+        glm_vec4_copy(entity->lightmap, block.lightmap);
+
+        // anything without a lightmap takes its indirect light from the probe grid
+
+        if(entity->lightmap[0] == 0.0f) block.lightmap[3] = 1.0f;
+
+        // the replay drops the bind when the last entity had the same texture
+
+        rhino_command_texture(buffer, 0, entity->texture);
+        rhino_lod_record(entity->mesh, &entity->lod, buffer, &block);
+    }
+}
+
+void rhino_scene_draw_shadow(rhino_scene* scene, rhino_uniforms* uniforms, vec4 planes[6]) {
+    if(scene->entity_count == 0) return;
+
+    unsigned int offsets[scene->entity_count];
+
+    for(int i = 0; i < scene->entity_count; i++) {
+        rhino_entity* entity = &scene->entities[i];
+
+        if(!glm_aabb_frustum(entity->world_bounds, planes)) continue;
+
+        rhino_object_block block;
+        glm_mat4_copy(entity->model, block.model);
+        glm_vec4_copy((vec4){entity->texture_scale, 0.0f, 0.0f, 0.0f}, block.params);
+        glm_vec4_zero(block.lightmap);
+
+        offsets[i] = rhino_uniforms_push(uniforms, &block);
+    }
+
+    rhino_uniforms_flush(uniforms);
+
+    // no cross-fade here, a dithered caster would leave holes in the shadow
+
+    for(int i = 0; i < scene->entity_count; i++) {
+        rhino_entity* entity = &scene->entities[i];
+
+        if(!glm_aabb_frustum(entity->world_bounds, planes)) continue;
+
+        rhino_uniforms_bind_object(uniforms, offsets[i]);
+        rhino_mesh_draw(entity->mesh, entity->lod.lod);
+    }
+}
+
+bool rhino_scene_dynamic_in(rhino_scene* scene, vec4 planes[6]) {
+    for(int i = 0; i < scene->entity_count; i++) {
+        rhino_entity* entity = &scene->entities[i];
+
+        if(entity->dynamic && glm_aabb_frustum(entity->world_bounds, planes)) return true;
+    }
+
+    return false;
+}
+
+void rhino_scene_destroy(rhino_scene* scene) {
+    free(scene->entities);
+    rhino_bvh_destroy(&scene->tlas);
+
+    memset(scene, 0, sizeof(rhino_scene));
+}
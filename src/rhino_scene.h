@@ -0,0 +1,70 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_mesh.h"
+#include "rhino_lod.h"
+#include "rhino_bvh.h"
+#include "rhino_uniforms.h"
+#include "rhino_commands.h"
+
+// a drawable instance of a mesh, world_bounds is refreshed by rhino_scene_update. dynamic entities may move every
+// frame, anything else is assumed to stay put so cached shadow cascades can keep it. lightmap is the scale and offset
+// of the entity's rect in the baked lightmap, zero while it has none
+
+typedef struct rhino_entity_t {
+    rhino_mesh* mesh;
+    mat4 model;
+    vec3 world_bounds[2];
+    unsigned int texture;
+    float texture_scale;
+    rhino_lod_state lod;
+    bool dynamic;
+    vec4 lightmap;
+} rhino_entity;
+
+// tlas is a bvh over entity world bounds, rebuilt lazily by queries once tlas_dirty is set
+
+typedef struct rhino_scene_t {
+    rhino_entity* entities;
+    int entity_count;
+    int entity_capacity;
+    rhino_bvh tlas;
+    bool tlas_dirty;
+
+    // bumped whenever the static part of the scene changes, caches built from it compare against this
+
+    unsigned int static_version;
+} rhino_scene;
+
+void rhino_scene_init(rhino_scene* scene);
+
+// returns the entity index, the model matrix starts as identity
+
+int rhino_scene_add(rhino_scene* scene, rhino_mesh* mesh, unsigned int texture, float texture_scale);
+
+// recompute world space bounds after model matrices changed
+
+void rhino_scene_update(rhino_scene* scene);
+
+// records part of parts of the entities with lod selection, pixels_per_unit as in rhino_lod_select. textures go to
+// unit 0 for the program's sampler, the program is the caller's to record. every part may be recorded on a thread
+// of its own at once
+
+void rhino_scene_record(rhino_scene* scene, rhino_command_buffer* buffer, int part, int parts, float pixels_per_unit);
+
+// depth only draw of the entities inside planes (glm_frustum_planes order) with whichever lod the camera picked
+// last, the shadow program must be bound
+
+void rhino_scene_draw_shadow(rhino_scene* scene, rhino_uniforms* uniforms, vec4 planes[6]);
+
+// true if any dynamic entity touches the volume
+
+bool rhino_scene_dynamic_in(rhino_scene* scene, vec4 planes[6]);
+
+void rhino_scene_destroy(rhino_scene* scene);
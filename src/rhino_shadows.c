@@ -0,0 +1,322 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_shadows.h"
+#include "rhino_global.h"
+#include "shaders.h"
+
+// cascade cameras sit at the origin looking along the sun, so fitting and snapping happen in a space that only
+// rotates when the sun does
+
+static void orient_cascades(rhino_shadows* shadows) {
+    vec3 up = { 0.0f, 1.0f, 0.0f };
+
+    if(fabsf(shadows->sun_direction[1]) > 0.99f) glm_vec3_copy((vec3){ 1.0f, 0.0f, 0.0f }, up);
+
+    for(int i = 0; i < RHINO_SHADOW_CASCADES; i++) rhino_camera_look_at(&shadows->cascades[i].camera, shadows->sun_direction, up);
+}
+
+// longest diagonal of the view between two depths, either across the far end or from a near corner to the
+// opposite far one. worked out from the projection rather than the corners so it stays bit for bit the same while
+// the camera moves
+
+static float slice_diameter(rhino_camera* camera, float near_depth, float far_depth) {
+    float near_width, near_height, far_width, far_height;
+
+    if(camera->orthographic) {
+        near_width = far_width = (camera->right - camera->left) * 0.5f;
+        near_height = far_height = (camera->top - camera->bottom) * 0.5f;
+    }
+    else {
+        float tangent = tanf(camera->fov * 0.5f);
+
+        near_height = near_depth * tangent;
+        far_height = far_depth * tangent;
+        near_width = near_height * camera->aspect;
+        far_width = far_height * camera->aspect;
+    }
+
+    float across = 2.0f * sqrtf(far_width * far_width + far_height * far_height);
+    float through = sqrtf((near_width + far_width) * (near_width + far_width) + (near_height + far_height) * (near_height + far_height) + (far_depth - near_depth) * (far_depth - near_depth));
+
+    return glm_max(across, through);
+}
+
+void rhino_shadows_init(rhino_shadows* shadows) {
+    memset(shadows, 0, sizeof(rhino_shadows));
+
+    shadows->resolution = RHINO_SHADOW_RESOLUTION;
+    shadows->cascade_count = RHINO_SHADOW_CASCADES;
+
+    // one depth layer per cascade, compared in hardware so a single fetch gives 2x2 pcf
+
+    glGenTextures(1, &shadows->depth);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadows->depth);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, shadows->resolution, shadows->resolution, RHINO_SHADOW_CASCADES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    glGenFramebuffers(1, &shadows->fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadows->fbo);
+
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadows->depth, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) printf("\nshadow framebuffer incomplete");
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // scene meshes, the terrain brings its own shadow program
+
+    shadows->program = link_and_compile_shaders("vertex_shader.glsl", "shadow_fragment_shader.glsl");
+    rhino_uniforms_bind_program(shadows->program);
+
+    for(int i = 0; i < RHINO_SHADOW_CASCADES; i++) {
+        rhino_shadow_cascade* cascade = &shadows->cascades[i];
+
+        rhino_camera_init_orthographic(&cascade->camera, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
+        rhino_gpu_timer_init(&cascade->timer);
+    }
+
+    rhino_shadows_set_sun(shadows, (vec3){ 0.0f, -1.0f, 0.0f }, (vec3){ 1.0f, 1.0f, 1.0f });
+}
+
+void rhino_shadows_bind_program(unsigned int program) {
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "shadow_map"), RHINO_SHADOW_UNIT);
+}
+
+void rhino_shadows_set_sun(rhino_shadows* shadows, vec3 direction, vec3 color) {
+    vec3 normalised;
+    glm_vec3_normalize_to(direction, normalised);
+
+    glm_vec3_copy(color, shadows->sun_color);
+
+    if(glm_vec3_eqv(normalised, shadows->sun_direction)) return;
+
+    glm_vec3_copy(normalised, shadows->sun_direction);
+
+    orient_cascades(shadows);
+    rhino_shadows_invalidate(shadows);
+}
+
+void rhino_shadows_set_quality(rhino_shadows* shadows, int resolution, int cascade_count) {
+    if(resolution < RHINO_SHADOW_MIN_RESOLUTION) resolution = RHINO_SHADOW_MIN_RESOLUTION;
+    if(resolution > RHINO_SHADOW_RESOLUTION) resolution = RHINO_SHADOW_RESOLUTION;
+    if(cascade_count < 1) cascade_count = 1;
+    if(cascade_count > RHINO_SHADOW_CASCADES) cascade_count = RHINO_SHADOW_CASCADES;
+
+    if(resolution != shadows->resolution) {
+        shadows->resolution = resolution;
+
+        // same texture name, so the frame graph import and the framebuffer attachment stay valid
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadows->depth);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, RHINO_SHADOW_CASCADES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    shadows->cascade_count = cascade_count;
+
+    rhino_shadows_invalidate(shadows);
+}
+
+void rhino_shadows_invalidate(rhino_shadows* shadows) {
+    for(int i = 0; i < RHINO_SHADOW_CASCADES; i++) shadows->cascades[i].valid = false;
+}
+
+void rhino_shadows_update(rhino_shadows* shadows, rhino_camera* camera, rhino_frame_block* frame) {
+    vec4 corners[8];
+    glm_frustum_corners(rhino_camera_inv_view_proj(camera), corners);
+
+    float near_plane = camera->near_plane;
+    float far_plane = glm_min(RHINO_SHADOW_DISTANCE, camera->far_plane);
+    float depth_range = camera->far_plane - camera->near_plane;
+
+    for(int i = 0; i < RHINO_SHADOW_CASCADES; i++) {
+        rhino_shadow_cascade* cascade = &shadows->cascades[i];
+
+        if(i >= shadows->cascade_count) {
+            glm_mat4_copy(frame->shadow_view_proj[i - 1], frame->shadow_view_proj[i]);
+            frame->shadow_splits[i] = frame->shadow_splits[i - 1];
+            frame->shadow_texel[i] = frame->shadow_texel[i - 1];
+            continue;
+        }
+
+        // practical split scheme, logarithmic spacing keeps texel density even while the linear part stops the
+        // first cascade from becoming tiny
+
+        float t = (float)(i + 1) / shadows->cascade_count;
+
+        cascade->split_near = i == 0 ? near_plane : shadows->cascades[i - 1].split_far;
+        cascade->split_far = RHINO_SHADOW_SPLIT_LAMBDA * near_plane * powf(far_plane / near_plane, t) + (1.0f - RHINO_SHADOW_SPLIT_LAMBDA) * (near_plane + (far_plane - near_plane) * t);
+
+        // corners of this slice of the view, near plane first (left bottom, left top, right top, right bottom)
+
+        vec4 near_corners[4], far_corners[4];
+        glm_frustum_corners_at(corners, cascade->split_near - near_plane, depth_range, near_corners);
+        glm_frustum_corners_at(corners, cascade->split_far - near_plane, depth_range, far_corners);
+
+        vec4 slice[8];
+        memcpy(&slice[0], near_corners, sizeof(near_corners));
+        memcpy(&slice[4], far_corners, sizeof(far_corners));
+
+        vec3 box[2];
+        glm_frustum_box(slice, rhino_camera_view(&cascade->camera), box);
+
+        // the widest the slice can ever project to is its longest diagonal, sizing the cascade by that instead of
+        // the box keeps the texel size constant while the camera turns, and snapping the origin to whole texels
+        // keeps edges from crawling while it moves
+
+        float diameter = slice_diameter(camera, cascade->split_near, cascade->split_far);
+
+        bool cached = i >= RHINO_SHADOW_CACHED_FROM;
+        float padding = cached ? diameter * RHINO_SHADOW_CACHE_MARGIN : diameter * 2.0f / shadows->resolution;
+        float extent = diameter + padding;
+        float texel = extent / shadows->resolution;
+        float step = cached ? floorf(padding / texel) * texel : texel;
+
+        float left = floorf(box[0][0] / step) * step;
+        float bottom = floorf(box[0][1] / step) * step;
+
+        // the view looks down -z, casters between the sun and the slice sit at smaller distances
+
+        float near_distance = floorf((-box[1][2] - RHINO_SHADOW_CASTER_DISTANCE) / step) * step;
+        float far_distance = ceilf(-box[0][2] / step) * step;
+
+        rhino_camera_set_orthographic(&cascade->camera, left, left + extent, bottom, bottom + extent, near_distance, far_distance);
+
+        cascade->texel_size = texel;
+
+        glm_mat4_copy(rhino_camera_view_proj(&cascade->camera), frame->shadow_view_proj[i]);
+        frame->shadow_splits[i] = cascade->split_far;
+        frame->shadow_texel[i] = texel;
+    }
+
+    glm_vec4(shadows->sun_direction, 0.0f, frame->sun_direction);
+    glm_vec4(shadows->sun_color, 1.0f, frame->sun_color);
+}
+
+void rhino_shadows_render(rhino_shadows* shadows, rhino_scene* scene, rhino_terrain* terrain, rhino_uniforms* uniforms) {
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // static geometry changed underneath the cached cascades
+
+    if(terrain->version != shadows->terrain_version || scene->static_version != shadows->static_version) {
+        rhino_shadows_invalidate(shadows);
+
+        shadows->terrain_version = terrain->version;
+        shadows->static_version = scene->static_version;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, shadows->fbo);
+    glViewport(0, 0, shadows->resolution, shadows->resolution);
+
+    // casters nearer than the cascade's near plane are flattened onto it instead of being clipped away, the slope
+    // scaled offset handles acne on surfaces facing away from the sun
+
+    glEnable(GL_DEPTH_CLAMP);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.5f, 2.0f);
+
+    for(int i = 0; i < shadows->cascade_count; i++) {
+        rhino_shadow_cascade* cascade = &shadows->cascades[i];
+
+        vec4* planes = rhino_camera_frustum(&cascade->camera);
+        vec4* view_proj = rhino_camera_view_proj(&cascade->camera);
+
+        // a cached cascade is reused while it sits in the same place, nothing static changed and no dynamic
+        // entity is inside it
+
+        bool dynamic = rhino_scene_dynamic_in(scene, planes);
+
+        if(i >= RHINO_SHADOW_CACHED_FROM && cascade->valid && !dynamic && memcmp(view_proj, cascade->rendered, sizeof(mat4)) == 0) {
+            cascade->skips++;
+            continue;
+        }
+
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadows->depth, 0, i);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        unsigned int draw_calls = rhino.stats.draw_calls;
+
+        rhino_gpu_timer_begin(&cascade->timer);
+
+        glUseProgram(shadows->program);
+        glUniform1i(glGetUniformLocation(shadows->program, "shadow_layer"), i + 1);
+        rhino_scene_draw_shadow(scene, uniforms, planes);
+
+        glUseProgram(terrain->shadow_program);
+        glUniform1i(glGetUniformLocation(terrain->shadow_program, "shadow_layer"), i + 1);
+        rhino_terrain_draw_shadow(terrain, uniforms, planes);
+
+        rhino_gpu_timer_end(&cascade->timer);
+
+        cascade->draw_calls = rhino.stats.draw_calls - draw_calls;
+        cascade->renders++;
+
+        // a layer holding a moving caster has to be drawn again once it leaves
+
+        glm_mat4_copy(view_proj, cascade->rendered);
+        cascade->valid = !dynamic;
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDisable(GL_DEPTH_CLAMP);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    glActiveTexture(GL_TEXTURE0 + RHINO_SHADOW_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadows->depth);
+    glActiveTexture(GL_TEXTURE0);
+
+    for(int i = 0; i < RHINO_SHADOW_CASCADES; i++) rhino_gpu_timer_poll(&shadows->cascades[i].timer, false);
+}
+
+void rhino_shadows_print_stats(rhino_shadows* shadows) {
+    printf("shadows : %d px,", shadows->resolution);
+
+    for(int i = 0; i < shadows->cascade_count; i++) {
+        rhino_shadow_cascade* cascade = &shadows->cascades[i];
+
+        printf("%s cascade %d (%.0f m) ", i ? " |" : "", i, cascade->split_far);
+
+        if(cascade->renders == 0) printf("cached");
+        else printf("%.3f ms, %u draws", cascade->timer.smoothed_ms, cascade->draw_calls);
+
+        if(i >= RHINO_SHADOW_CACHED_FROM) printf(", %u drawn / %u reused", cascade->renders, cascade->skips);
+
+        cascade->renders = 0;
+        cascade->skips = 0;
+    }
+
+    printf("\n");
+}
+
+void rhino_shadows_destroy(rhino_shadows* shadows) {
+    glDeleteFramebuffers(1, &shadows->fbo);
+    glDeleteTextures(1, &shadows->depth);
+    glDeleteProgram(shadows->program);
+
+    for(int i = 0; i < RHINO_SHADOW_CASCADES; i++) rhino_gpu_timer_destroy(&shadows->cascades[i].timer);
+
+    memset(shadows, 0, sizeof(rhino_shadows));
+}
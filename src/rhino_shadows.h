@@ -0,0 +1,112 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_uniforms.h"
+#include "rhino_camera.h"
+#include "rhino_timer.h"
+#include "rhino_scene.h"
+#include "rhino_terrain.h"
+
+// one square depth layer per cascade (RHINO_SHADOW_CASCADES lives in rhino_uniforms.h with the frame block).
+// resolution and how many cascades are in use can be lowered at runtime, these are the defaults
+
+#define RHINO_SHADOW_RESOLUTION 2048
+#define RHINO_SHADOW_MIN_RESOLUTION 256
+#define RHINO_SHADOW_UNIT 7
+
+// cascades cover the view up to this distance, split between logarithmic (1) and linear (0) spacing
+
+#define RHINO_SHADOW_DISTANCE 160.0f
+#define RHINO_SHADOW_SPLIT_LAMBDA 0.75f
+
+// how far towards the sun casters are still picked up in front of a cascade's slice of the view
+
+#define RHINO_SHADOW_CASTER_DISTANCE 100.0f
+
+// cascades from this one on are cached, they cover this much extra area so their placement only has to move
+// once the camera crossed a margin sized step instead of every texel
+
+#define RHINO_SHADOW_CACHED_FROM 2
+#define RHINO_SHADOW_CACHE_MARGIN 0.25f
+
+// the camera is fitted around a slice of the view, view_proj is only copied into rendered once the layer
+// actually holds it
+
+typedef struct rhino_shadow_cascade_t {
+    rhino_camera camera;
+    float split_near, split_far;
+    float texel_size;
+
+    mat4 rendered;
+    bool valid;
+
+    // stats, renders and skips since the last print, draw calls of the last render
+
+    rhino_gpu_timer timer;
+    unsigned int renders;
+    unsigned int skips;
+    unsigned int draw_calls;
+} rhino_shadow_cascade;
+
+typedef struct rhino_shadows_t {
+    unsigned int fbo;
+    unsigned int depth;
+    unsigned int program;
+
+    // size of every layer, and the first cascade_count layers covering the shadow distance between them
+
+    int resolution;
+    int cascade_count;
+
+    // direction the light travels, normalised
+
+    vec3 sun_direction;
+    vec3 sun_color;
+
+    rhino_shadow_cascade cascades[RHINO_SHADOW_CASCADES];
+
+    // what the cached cascades were rendered from
+
+    unsigned int terrain_version;
+    unsigned int static_version;
+} rhino_shadows;
+
+void rhino_shadows_init(rhino_shadows* shadows);
+
+// points the shadow_map sampler of a program at RHINO_SHADOW_UNIT
+
+void rhino_shadows_bind_program(unsigned int program);
+
+// changing the sun invalidates every cached cascade
+
+void rhino_shadows_set_sun(rhino_shadows* shadows, vec3 direction, vec3 color);
+
+// reallocates the layers at a new size and spreads the shadow distance over cascade_count cascades, unused ones
+// repeat the last split so the shaders never pick them
+
+void rhino_shadows_set_quality(rhino_shadows* shadows, int resolution, int cascade_count);
+
+// forces every cascade to redraw next frame
+
+void rhino_shadows_invalidate(rhino_shadows* shadows);
+
+// fits the cascades around camera and writes their matrices, splits and the sun into frame
+
+void rhino_shadows_update(rhino_shadows* shadows, rhino_camera* camera, rhino_frame_block* frame);
+
+// draws the cascades that need it once frame is uploaded, then binds the map for the lighting passes.
+// leaves the default framebuffer bound with the viewport it found
+
+void rhino_shadows_render(rhino_shadows* shadows, rhino_scene* scene, rhino_terrain* terrain, rhino_uniforms* uniforms);
+
+// gpu time and draw calls per cascade, and how often the cached ones were reused since the last call
+
+void rhino_shadows_print_stats(rhino_shadows* shadows);
+
+void rhino_shadows_destroy(rhino_shadows* shadows);
@@ -0,0 +1,289 @@
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_sim.h"
+
+// set on middle when the slot behind it holds a tick the reader has not seen
+
+#define SLOT_NEW 4u
+#define SLOT_MASK 3u
+
+// ---- triple buffer ---- //
+
+// the ticking thread fills back, then trades it for middle
+
+static void publish(rhino_sim* sim, rhino_sim_state* previous, rhino_sim_state* current) {
+    rhino_sim_snapshot* slot = &sim->slots[sim->back];
+
+    slot->previous = *previous;
+    slot->current = *current;
+
+    sim->back = atomic_exchange_explicit(&sim->middle, sim->back | SLOT_NEW, memory_order_acq_rel) & SLOT_MASK;
+}
+
+// the reader trades front for middle only when middle is newer, otherwise front is still the latest
+
+static rhino_sim_snapshot* latest(rhino_sim* sim) {
+    if(atomic_load_explicit(&sim->middle, memory_order_relaxed) & SLOT_NEW) {
+        sim->front = atomic_exchange_explicit(&sim->middle, sim->front, memory_order_acq_rel) & SLOT_MASK;
+    }
+
+    return &sim->slots[sim->front];
+}
+
+// ---- ticking ---- //
+
+static void tick(rhino_sim* sim) {
+    double tick_start = glfwGetTime();
+
+    pthread_mutex_lock(&sim->input_lock);
+
+    unsigned int buttons = sim->buttons;
+    float yaw = sim->look_yaw, pitch = sim->look_pitch;
+
+    sim->look_yaw = sim->look_pitch = 0.0f;
+
+    pthread_mutex_unlock(&sim->input_lock);
+
+    rhino_sim_state previous = sim->state;
+    rhino_sim_state* state = &sim->state;
+
+    // look, then move along the new facing, sideways and up stay level
+
+    rhino_camera_rotate(&sim->camera, yaw, pitch);
+
+    float step = (float)(sim->speed * (buttons & RHINO_SIM_FAST ? 2.0 : 1.0) * RHINO_SIM_STEP);
+
+    vec3 front, side, world_up = { 0.0f, 1.0f, 0.0f };
+
+    rhino_camera_front(&sim->camera, front);
+    glm_cross(front, world_up, side);
+    glm_normalize(side);
+
+    vec3 move = GLM_VEC3_ZERO_INIT;
+
+    if(buttons & RHINO_SIM_FORWARD) glm_vec3_muladds(front, step, move);
+    else if(buttons & RHINO_SIM_BACK) glm_vec3_muladds(front, -step, move);
+
+    if(buttons & RHINO_SIM_RIGHT) glm_vec3_muladds(side, step, move);
+    else if(buttons & RHINO_SIM_LEFT) glm_vec3_muladds(side, -step, move);
+
+    if(buttons & RHINO_SIM_UP) glm_vec3_muladds(world_up, step, move);
+    else if(buttons & RHINO_SIM_DOWN) glm_vec3_muladds(world_up, -step, move);
+
+    rhino_camera_move(&sim->camera, move);
+
+    // time is a multiple of the step rather than a running sum, it never drifts
+
+    state->tick++;
+    state->time = state->tick * RHINO_SIM_STEP;
+    state->due = state->time + sim->dropped_time;
+
+    if(sim->animate) state->crate_angle = fmod(state->crate_angle + RHINO_SIM_CRATE_SPEED * RHINO_SIM_STEP, 360.0);
+
+    glm_vec3_copy(sim->camera.position, state->position);
+    glm_quat_copy(sim->camera.orientation, state->orientation);
+
+    publish(sim, &previous, state);
+
+    // the tick after the last change still needs a frame, interpolation only settles on the final state then
+
+    bool changed = sim->animate || !glm_vec3_eqv(previous.position, state->position) || !glm_vec4_eqv(previous.orientation, state->orientation);
+
+    if(sim->redraw && (changed || sim->changing)) rhino_redraw_request(sim->redraw, RHINO_REDRAW_SIMULATION);
+
+    sim->changing = changed;
+
+    atomic_fetch_add_explicit(&sim->stats.ticks, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sim->stats.tick_nanoseconds, (unsigned long long)((glfwGetTime() - tick_start) * 1e9), memory_order_relaxed);
+}
+
+// clock time the next tick is due at
+
+static double next_due(rhino_sim* sim) {
+    return (sim->state.tick + 1) * RHINO_SIM_STEP + sim->dropped_time;
+}
+
+// nothing a tick would change and no frame waiting on one, the input lock is held. changing covers the tick that
+// settles interpolation on the final state
+
+static bool settled(rhino_sim* sim) {
+    return sim->redraw && sim->redraw->on_demand && !sim->animate && !sim->changing && sim->buttons == 0 && sim->look_yaw == 0.0f && sim->look_pitch == 0.0f;
+}
+
+// sleeps while settled, ticking at the full rate would keep a core awake while the render thread idles
+
+static void park(rhino_sim* sim) {
+    pthread_mutex_lock(&sim->input_lock);
+
+    if(!settled(sim) || atomic_load(&sim->quit)) {
+        pthread_mutex_unlock(&sim->input_lock);
+        return;
+    }
+
+    double start = glfwGetTime();
+
+    while(!atomic_load(&sim->quit) && settled(sim)) pthread_cond_wait(&sim->wake, &sim->input_lock);
+
+    pthread_mutex_unlock(&sim->input_lock);
+
+    atomic_fetch_add_explicit(&sim->stats.parked_nanoseconds, (unsigned long long)((glfwGetTime() - start) * 1e9), memory_order_relaxed);
+
+    // the time parked is given up like a stall's without counting as dropped, the next tick is due right away
+
+    double late = rhino_sim_clock(sim) - next_due(sim);
+
+    if(late > 0.0) sim->dropped_time += late;
+}
+
+static void* sim_thread(void* arg) {
+    rhino_sim* sim = arg;
+
+    while(!atomic_load(&sim->quit)) {
+        park(sim);
+
+        double now = rhino_sim_clock(sim);
+        double wait = next_due(sim) - now;
+
+        if(wait > 0.0) {
+            struct timespec duration = { 0, (long)(wait * 1e9) };
+            nanosleep(&duration, NULL);
+            continue;
+        }
+
+        // too far behind to catch up, give the time up rather than simulate a burst of ticks nobody sees
+
+        double behind = -wait / RHINO_SIM_STEP;
+
+        if(behind > RHINO_SIM_MAX_CATCHUP) {
+            unsigned long long skipped = (unsigned long long)behind - RHINO_SIM_MAX_CATCHUP;
+
+            sim->dropped_time += skipped * RHINO_SIM_STEP;
+            atomic_fetch_add_explicit(&sim->stats.dropped, skipped, memory_order_relaxed);
+        }
+
+        tick(sim);
+    }
+
+    return NULL;
+}
+
+void rhino_sim_init(rhino_sim* sim, rhino_camera* camera, double speed) {
+    memset(sim, 0, sizeof(rhino_sim));
+
+    sim->speed = speed;
+    sim->camera = *camera;
+    sim->animate = true;
+
+    glm_vec3_copy(camera->position, sim->state.position);
+    glm_quat_copy(camera->orientation, sim->state.orientation);
+
+    // back, middle and front start out as distinct slots, the reader's front already holds the starting state
+
+    sim->back = 0;
+    atomic_init(&sim->middle, 1);
+    sim->front = 2;
+
+    for(int i = 0; i < 3; i++) sim->slots[i].previous = sim->slots[i].current = sim->state;
+
+    pthread_mutex_init(&sim->input_lock, NULL);
+    pthread_cond_init(&sim->wake, NULL);
+}
+
+void rhino_sim_start(rhino_sim* sim, bool threaded) {
+    sim->threaded = threaded;
+    sim->start = threaded ? glfwGetTime() : 0.0;
+
+    if(threaded) pthread_create(&sim->thread, NULL, sim_thread, sim);
+
+    printf("\nsimulation ticking at %.0f Hz %s", RHINO_SIM_RATE, threaded ? "on its own thread" : "with the frames");
+}
+
+void rhino_sim_advance(rhino_sim* sim, double time) {
+    if(sim->threaded) return;
+
+    // a little slack so a frame landing exactly on a tick boundary takes that tick despite rounding
+
+    while(next_due(sim) <= time + 1e-9) tick(sim);
+}
+
+double rhino_sim_clock(rhino_sim* sim) {
+    return glfwGetTime() - sim->start;
+}
+
+void rhino_sim_input(rhino_sim* sim, unsigned int buttons) {
+    pthread_mutex_lock(&sim->input_lock);
+
+    if(buttons != sim->buttons) pthread_cond_signal(&sim->wake);
+
+    sim->buttons = buttons;
+    pthread_mutex_unlock(&sim->input_lock);
+}
+
+void rhino_sim_look(rhino_sim* sim, float yaw, float pitch) {
+    pthread_mutex_lock(&sim->input_lock);
+    sim->look_yaw += yaw;
+    sim->look_pitch += pitch;
+    pthread_cond_signal(&sim->wake);
+    pthread_mutex_unlock(&sim->input_lock);
+}
+
+void rhino_sim_interpolate(rhino_sim* sim, double time, rhino_sim_state* state) {
+    rhino_sim_snapshot* snapshot = latest(sim);
+
+    rhino_sim_state* previous = &snapshot->previous;
+    rhino_sim_state* current = &snapshot->current;
+
+    // previous is shown when current was due and current a tick later, by then the next tick has landed
+
+    float alpha = (float)glm_clamp((time - current->due) / RHINO_SIM_STEP, 0.0, 1.0);
+
+    *state = *current;
+    state->time = previous->time + (current->time - previous->time) * alpha;
+
+    glm_vec3_lerp(previous->position, current->position, alpha, state->position);
+    glm_quat_slerp(previous->orientation, current->orientation, alpha, state->orientation);
+
+    // the shorter way round across the wrap
+
+    double turn = current->crate_angle - previous->crate_angle;
+
+    if(turn > 180.0) turn -= 360.0;
+    if(turn < -180.0) turn += 360.0;
+
+    state->crate_angle = previous->crate_angle + turn * alpha;
+}
+
+void rhino_sim_print_stats(rhino_sim* sim, float seconds) {
+    unsigned long long ticks = atomic_exchange(&sim->stats.ticks, 0);
+    unsigned long long dropped = atomic_exchange(&sim->stats.dropped, 0);
+    unsigned long long nanoseconds = atomic_exchange(&sim->stats.tick_nanoseconds, 0);
+    unsigned long long parked = atomic_exchange(&sim->stats.parked_nanoseconds, 0);
+
+    printf("simulation : %.1f ticks/s at %.0f Hz, %.3f ms per tick, %llu ticks dropped, parked %.0f%% of the time\n", ticks / seconds, RHINO_SIM_RATE, ticks ? nanoseconds / 1e6 / ticks : 0.0, dropped, parked / 1e7 / seconds);
+}
+
+void rhino_sim_destroy(rhino_sim* sim) {
+    if(sim->threaded) {
+        pthread_mutex_lock(&sim->input_lock);
+        atomic_store(&sim->quit, true);
+        pthread_cond_signal(&sim->wake);
+        pthread_mutex_unlock(&sim->input_lock);
+
+        pthread_join(sim->thread, NULL);
+    }
+
+    pthread_mutex_destroy(&sim->input_lock);
+    pthread_cond_destroy(&sim->wake);
+}
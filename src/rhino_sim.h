@@ -0,0 +1,142 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_camera.h"
+#include "rhino_redraw.h"
+
+// fixed timestep simulation, ticks at RHINO_SIM_RATE on its own thread against a double precision clock and
+// publishes every tick through a lock free triple buffer. rendering interpolates between the last two ticks one
+// tick behind real time, so slow frames no longer slow the world down and fast ones still move smoothly
+
+#define RHINO_SIM_RATE 120.0
+#define RHINO_SIM_STEP (1.0 / RHINO_SIM_RATE)
+
+// after a stall the simulation catches up at most this many ticks and lets the rest of the time go
+
+#define RHINO_SIM_MAX_CATCHUP 8
+
+// crate spin in degrees per second
+
+#define RHINO_SIM_CRATE_SPEED -60.0
+
+// movement keys held, sampled by the main thread and applied by every tick until they change
+
+#define RHINO_SIM_FORWARD (1 << 0)
+#define RHINO_SIM_BACK (1 << 1)
+#define RHINO_SIM_LEFT (1 << 2)
+#define RHINO_SIM_RIGHT (1 << 3)
+#define RHINO_SIM_UP (1 << 4)
+#define RHINO_SIM_DOWN (1 << 5)
+#define RHINO_SIM_FAST (1 << 6)
+
+// everything a tick produces. time is seconds of simulation, due is when on the clock the tick was scheduled. they
+// drift apart only when a stall made the simulation let time go. crate_angle is kept wrapped in degrees
+
+typedef struct rhino_sim_state_t {
+    unsigned long long tick;
+    double time;
+    double due;
+    vec3 position;
+    versor orientation;
+    double crate_angle;
+} rhino_sim_state;
+
+// one slot of the triple buffer, the tick before travels with the tick so the reader always has a pair
+
+typedef struct rhino_sim_snapshot_t {
+    rhino_sim_state previous;
+    rhino_sim_state current;
+} rhino_sim_snapshot;
+
+// written by the ticking thread, taken and reset by rhino_sim_print_stats. parked is time the thread slept with
+// nothing to simulate
+
+typedef struct rhino_sim_stats_t {
+    atomic_ullong ticks;
+    atomic_ullong dropped;
+    atomic_ullong tick_nanoseconds;
+    atomic_ullong parked_nanoseconds;
+} rhino_sim_stats;
+
+typedef struct rhino_sim_t {
+    bool threaded;
+    double start;
+    double speed;
+
+    // whether the crate spins, and where ticks that change the state ask for a redraw (if anywhere). changing is
+    // whether the last tick changed it
+
+    bool animate;
+    rhino_redraw* redraw;
+    bool changing;
+
+    // clock time given up to stalls
+
+    double dropped_time;
+
+    // owned by whichever thread ticks, the camera is only used for its movement maths
+
+    rhino_sim_state state;
+    rhino_camera camera;
+
+    // slot middle is shared and flagged whenever a tick landed since the reader last swapped it for front. back
+    // belongs to the ticking thread and front to the reader
+
+    rhino_sim_snapshot slots[3];
+    atomic_uint middle;
+    int back;
+    int front;
+
+    // input handed from the main thread, look is accumulated until a tick takes it. when rendering on demand with
+    // nothing animating, held or turning the ticking thread parks on wake until input arrives
+
+    pthread_mutex_t input_lock;
+    pthread_cond_t wake;
+    unsigned int buttons;
+    float look_yaw, look_pitch;
+
+    pthread_t thread;
+    atomic_bool quit;
+
+    rhino_sim_stats stats;
+} rhino_sim;
+
+// starts from the camera's position and orientation, speed is world units per second
+
+void rhino_sim_init(rhino_sim* sim, rhino_camera* camera, double speed);
+
+// threaded runs the ticks on a thread of their own from now on, otherwise the caller drives them with
+// rhino_sim_advance, as headless runs do to stay deterministic
+
+void rhino_sim_start(rhino_sim* sim, bool threaded);
+
+// runs every tick due by time, seconds since start. only for unthreaded simulations
+
+void rhino_sim_advance(rhino_sim* sim, double time);
+
+// seconds since start on the simulation's clock
+
+double rhino_sim_clock(rhino_sim* sim);
+
+// replaces the held movement keys, a mask of RHINO_SIM bits
+
+void rhino_sim_input(rhino_sim* sim, unsigned int buttons);
+
+// adds mouse look in radians to what the next tick turns by
+
+void rhino_sim_look(rhino_sim* sim, float yaw, float pitch);
+
+// the state at time seconds after start, interpolated between the last two ticks a tick behind time
+
+void rhino_sim_interpolate(rhino_sim* sim, double time, rhino_sim_state* state);
+
+void rhino_sim_print_stats(rhino_sim* sim, float seconds);
+
+void rhino_sim_destroy(rhino_sim* sim);
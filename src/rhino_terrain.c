@@ -0,0 +1,689 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_terrain.h"
+#include "shaders.h"
+#include "rhino_global.h"
+
+#define GRID RHINO_TERRAIN_GRID
+#define LAST (RHINO_TERRAIN_GRID - 1)
+#define SLOT_COUNT (RHINO_TERRAIN_SLOTS * RHINO_TERRAIN_SLOTS)
+#define CHUNK_BYTES (GRID * GRID * 2 * sizeof(float))
+#define GRID_SPACING (RHINO_TERRAIN_CHUNK_SIZE / LAST)
+
+typedef struct chunk_request_t {
+    int x, z;
+    float distance;
+} chunk_request;
+
+float rhino_terrain_height(float x, float z) {
+    // fractal sum of perlin octaves
+
+    float height = 0.0f;
+    float amplitude = 1.0f;
+    float frequency = RHINO_TERRAIN_FREQUENCY;
+
+    for(int i = 0; i < RHINO_TERRAIN_OCTAVES; i++) {
+        height += glm_perlin_vec2((vec2){x * frequency, z * frequency}) * amplitude;
+        amplitude *= 0.5f;
+        frequency *= 2.0f;
+    }
+
+    return RHINO_TERRAIN_BASE_HEIGHT + height * RHINO_TERRAIN_AMPLITUDE;
+}
+
+static int trailing_zeros(int v) {
+    if(v == 0) return RHINO_TERRAIN_LODS;
+
+    int count = 0;
+
+    while(!(v & 1)) {
+        v >>= 1;
+        count++;
+    }
+
+    return count;
+}
+
+// fills heights then the morph targets, a vertex first dropped by lod m + 1 morphs onto the edge (or quad diagonal)
+// of that coarser grid. diagonals follow the triangulation in build_lod_indices
+
+static float* generate_chunk(int chunk_x, int chunk_z, float* min_height, float* max_height) {
+    float* data = malloc(CHUNK_BYTES);
+
+    float origin_x = chunk_x * RHINO_TERRAIN_CHUNK_SIZE;
+    float origin_z = chunk_z * RHINO_TERRAIN_CHUNK_SIZE;
+
+    *min_height = INFINITY;
+    *max_height = -INFINITY;
+
+    for(int j = 0; j < GRID; j++) {
+        for(int i = 0; i < GRID; i++) {
+            float h = rhino_terrain_height(origin_x + i * GRID_SPACING, origin_z + j * GRID_SPACING);
+
+            data[(j * GRID + i) * 2] = h;
+
+            if(h < *min_height) *min_height = h;
+            if(h > *max_height) *max_height = h;
+        }
+    }
+
+    #define H(i, j) data[((j) * GRID + (i)) * 2]
+
+    for(int j = 0; j < GRID; j++) {
+        for(int i = 0; i < GRID; i++) {
+            int m = trailing_zeros(i) < trailing_zeros(j) ? trailing_zeros(i) : trailing_zeros(j);
+            float target = H(i, j);
+
+            if(m < RHINO_TERRAIN_LODS - 1) {
+                int step = 1 << m;
+                bool odd_i = (i >> m) & 1;
+                bool odd_j = (j >> m) & 1;
+
+                if(odd_i && !odd_j) target = (H(i - step, j) + H(i + step, j)) * 0.5f;
+                else if(!odd_i && odd_j) target = (H(i, j - step) + H(i, j + step)) * 0.5f;
+                else if((i - step == 0 && j - step == 0) || (i + step == LAST && j + step == LAST)) target = (H(i - step, j - step) + H(i + step, j + step)) * 0.5f;
+                else target = (H(i + step, j - step) + H(i - step, j + step)) * 0.5f;
+            }
+
+            data[(j * GRID + i) * 2 + 1] = target;
+        }
+    }
+
+    #undef H
+
+    return data;
+}
+
+// background job generating the chunk in slot begin
+
+static void generate_job(void* data, int begin, int end) {
+    rhino_terrain* terrain = data;
+    rhino_terrain_chunk* chunk = &terrain->chunks[begin];
+
+    double start = glfwGetTime();
+
+    float min_height, max_height;
+    float* vertex_data = generate_chunk(chunk->x, chunk->z, &min_height, &max_height);
+
+    double elapsed = glfwGetTime() - start;
+
+    pthread_mutex_lock(&terrain->lock);
+
+    chunk->vertex_data = vertex_data;
+    chunk->min_height = min_height;
+    chunk->max_height = max_height;
+
+    terrain->results[terrain->result_count++] = begin;
+    terrain->stats.chunks_generated++;
+    terrain->stats.generation_seconds += elapsed;
+
+    pthread_mutex_unlock(&terrain->lock);
+
+    rhino_redraw_request(&rhino.redraw, RHINO_REDRAW_STREAMING);
+}
+
+// border strip between the outer row and the row one step inside, merged like a zipper. stitched edges skip every
+// other outer vertex to match a neighbour one lod coarser. ties pick the side that keeps the anti-diagonal split
+
+static unsigned int build_edge_strip(int edge, int step, bool stitched, unsigned int* dest) {
+    int outer_step = stitched ? step * 2 : step;
+    int outer_count = LAST / outer_step + 1;
+    int inner_count = (LAST - 2 * step) / step + 1;
+    bool ties_outer = edge == 0 || edge == 3;
+
+    unsigned int count = 0;
+    int o = 0, n = 0;
+
+    #define OUTER_T(k) ((k) * outer_step)
+    #define INNER_T(k) (step + (k) * step)
+
+    while(o < outer_count - 1 || n < inner_count - 1) {
+        bool advance_outer;
+
+        if(o == outer_count - 1) advance_outer = false;
+        else if(n == inner_count - 1) advance_outer = true;
+        else if(OUTER_T(o + 1) == INNER_T(n + 1)) advance_outer = ties_outer;
+        else advance_outer = OUTER_T(o + 1) < INNER_T(n + 1);
+
+        int points[3][2];
+        int ts[3] = { OUTER_T(o), INNER_T(n), advance_outer ? OUTER_T(o + 1) : INNER_T(n + 1) };
+        bool outer[3] = { true, false, advance_outer };
+
+        for(int k = 0; k < 3; k++) {
+            int t = ts[k];
+            int d = outer[k] ? 0 : step;
+
+            switch(edge) {
+                case 0: points[k][0] = t; points[k][1] = d; break;
+                case 1: points[k][0] = LAST - d; points[k][1] = t; break;
+                case 2: points[k][0] = t; points[k][1] = LAST - d; break;
+                default: points[k][0] = d; points[k][1] = t; break;
+            }
+
+            dest[count++] = points[k][1] * GRID + points[k][0];
+        }
+
+        if(advance_outer) o++;
+        else n++;
+    }
+
+    #undef OUTER_T
+    #undef INNER_T
+
+    return count;
+}
+
+static unsigned int build_lod_indices(int lod, int stitch_mask, unsigned int* dest) {
+    int step = 1 << lod;
+    unsigned int count = 0;
+
+    // interior quads split along the anti-diagonal
+
+    for(int z = step; z < LAST - step; z += step) {
+        for(int x = step; x < LAST - step; x += step) {
+            unsigned int a = z * GRID + x;
+            unsigned int b = a + step;
+            unsigned int c = a + step * GRID;
+            unsigned int d = c + step;
+
+            dest[count++] = a; dest[count++] = c; dest[count++] = b;
+            dest[count++] = b; dest[count++] = c; dest[count++] = d;
+        }
+    }
+
+    for(int edge = 0; edge < 4; edge++) count += build_edge_strip(edge, step, stitch_mask & (1 << edge), &dest[count]);
+
+    return count;
+}
+
+static int slot_index(int x, int z) {
+    int sx = ((x % RHINO_TERRAIN_SLOTS) + RHINO_TERRAIN_SLOTS) % RHINO_TERRAIN_SLOTS;
+    int sz = ((z % RHINO_TERRAIN_SLOTS) + RHINO_TERRAIN_SLOTS) % RHINO_TERRAIN_SLOTS;
+
+    return sz * RHINO_TERRAIN_SLOTS + sx;
+}
+
+// distance from a point to the chunk footprint, heights default to the full terrain range before generation
+
+static float chunk_distance(int x, int z, float min_height, float max_height, vec3 position) {
+    vec3 box[2] = {
+        { x * RHINO_TERRAIN_CHUNK_SIZE, min_height, z * RHINO_TERRAIN_CHUNK_SIZE },
+        { (x + 1) * RHINO_TERRAIN_CHUNK_SIZE, max_height, (z + 1) * RHINO_TERRAIN_CHUNK_SIZE }
+    };
+
+    vec3 closest;
+
+    for(int k = 0; k < 3; k++) closest[k] = glm_clamp(position[k], box[0][k], box[1][k]);
+
+    return glm_vec3_distance(closest, position);
+}
+
+static int compare_requests(const void* a, const void* b) {
+    const chunk_request* ra = a;
+    const chunk_request* rb = b;
+
+    return (ra->distance > rb->distance) - (ra->distance < rb->distance);
+}
+
+static void chunk_box(rhino_terrain_chunk* chunk, vec3 box[2]) {
+    glm_vec3_copy((vec3){ chunk->x * RHINO_TERRAIN_CHUNK_SIZE, chunk->min_height, chunk->z * RHINO_TERRAIN_CHUNK_SIZE }, box[0]);
+    glm_vec3_copy((vec3){ (chunk->x + 1) * RHINO_TERRAIN_CHUNK_SIZE, chunk->max_height, (chunk->z + 1) * RHINO_TERRAIN_CHUNK_SIZE }, box[1]);
+}
+
+static void evict_chunk(rhino_terrain* terrain, rhino_terrain_chunk* chunk) {
+    if(chunk->state == RHINO_CHUNK_RESIDENT) {
+        glDeleteVertexArrays(1, &chunk->vao);
+        glDeleteBuffers(1, &chunk->vbo);
+
+        terrain->version++;
+    }
+
+    free(chunk->vertex_data);
+
+    chunk->vertex_data = NULL;
+    chunk->vao = chunk->vbo = 0;
+    chunk->state = RHINO_CHUNK_EMPTY;
+}
+
+// vertex arrays are not shared with the loader's context, so the chunk's is built here around the handed over buffer
+
+static void chunk_uploaded(void* data, int index, unsigned int vbo) {
+    rhino_terrain* terrain = data;
+    rhino_terrain_chunk* chunk = &terrain->chunks[index];
+
+    chunk->vbo = vbo;
+
+    glGenVertexArrays(1, &chunk->vao);
+    glBindVertexArray(chunk->vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, chunk->vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrain->ebo);
+
+    glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (GLvoid*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (GLvoid*)sizeof(float));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+
+    chunk->state = RHINO_CHUNK_RESIDENT;
+    chunk->changed = ++terrain->version;
+}
+
+static void setup_program(unsigned int program) {
+    glUseProgram(program);
+
+    float lod_ranges[RHINO_TERRAIN_LODS];
+
+    for(int i = 0; i < RHINO_TERRAIN_LODS; i++) lod_ranges[i] = RHINO_TERRAIN_LOD0_RANGE * (float)(1 << i);
+
+    glUniform1fv(glGetUniformLocation(program, "lod_ranges"), RHINO_TERRAIN_LODS, lod_ranges);
+    glUniform1i(glGetUniformLocation(program, "lod_count"), RHINO_TERRAIN_LODS);
+    glUniform1i(glGetUniformLocation(program, "grid_size"), GRID);
+    glUniform1f(glGetUniformLocation(program, "grid_spacing"), GRID_SPACING);
+    glUniform1f(glGetUniformLocation(program, "morph_start"), RHINO_TERRAIN_MORPH_START);
+    glUniform1i(glGetUniformLocation(program, "texture_sample1"), 0);
+
+    rhino_uniforms_bind_program(program);
+}
+
+void rhino_terrain_init(rhino_terrain* terrain) {
+    memset(terrain, 0, sizeof(rhino_terrain));
+
+    // shared index buffer, every lod with every combination of stitched edges
+
+    unsigned int* indices = malloc(RHINO_TERRAIN_LODS * 16 * LAST * LAST * 6 * sizeof(unsigned int));
+    unsigned int total = 0;
+
+    for(int lod = 0; lod < RHINO_TERRAIN_LODS; lod++) {
+        for(int mask = 0; mask < 16; mask++) {
+            terrain->index_offsets[lod][mask] = total;
+            terrain->index_counts[lod][mask] = build_lod_indices(lod, mask, &indices[total]);
+
+            total += terrain->index_counts[lod][mask];
+        }
+    }
+
+    glGenBuffers(1, &terrain->ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrain->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, total * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    terrain->stats.index_bytes = total * sizeof(unsigned int);
+
+    free(indices);
+
+    // forward, g-buffer and shadow programs, constant uniforms are set once here
+
+    terrain->program = link_and_compile_shaders("terrain_vertex_shader.glsl", "fragment_shader.glsl");
+    terrain->gbuffer_program = link_and_compile_shaders("terrain_vertex_shader.glsl", "gbuffer_fragment_shader.glsl");
+    terrain->shadow_program = link_and_compile_shaders("terrain_vertex_shader.glsl", "shadow_fragment_shader.glsl");
+
+    setup_program(terrain->program);
+    setup_program(terrain->gbuffer_program);
+    setup_program(terrain->shadow_program);
+
+    pthread_mutex_init(&terrain->lock, NULL);
+}
+
+void rhino_terrain_update(rhino_terrain* terrain, rhino_camera* camera) {
+    // collect finished chunks
+
+    pthread_mutex_lock(&terrain->lock);
+
+    for(int i = 0; i < terrain->result_count; i++) terrain->chunks[terrain->results[i]].state = RHINO_CHUNK_READY;
+
+    terrain->pending -= terrain->result_count;
+    terrain->result_count = 0;
+
+    pthread_mutex_unlock(&terrain->lock);
+
+    // the loader thread uploads them, the cpu copy goes with the request and is dropped once the gpu has it
+
+    for(int i = 0; i < SLOT_COUNT; i++) {
+        rhino_terrain_chunk* chunk = &terrain->chunks[i];
+
+        if(chunk->state != RHINO_CHUNK_READY) continue;
+
+        float* vertex_data = chunk->vertex_data;
+
+        chunk->vertex_data = NULL;
+        chunk->state = RHINO_CHUNK_UPLOADING;
+
+        rhino_loader_buffer(&rhino.loader, vertex_data, CHUNK_BYTES, chunk_uploaded, terrain, i);
+    }
+
+    // drop anything that fell out of view, keep a chunk of slack so the edge does not thrash
+
+    float keep_distance = RHINO_TERRAIN_VIEW_DISTANCE + RHINO_TERRAIN_CHUNK_SIZE;
+    int used_slots = 0;
+
+    for(int i = 0; i < SLOT_COUNT; i++) {
+        rhino_terrain_chunk* chunk = &terrain->chunks[i];
+
+        if(chunk->state == RHINO_CHUNK_READY || chunk->state == RHINO_CHUNK_RESIDENT) {
+            if(chunk_distance(chunk->x, chunk->z, chunk->min_height, chunk->max_height, camera->position) > keep_distance) evict_chunk(terrain, chunk);
+        }
+
+        if(chunk->state != RHINO_CHUNK_EMPTY) used_slots++;
+    }
+
+    // request missing chunks nearest first, within the memory budget
+
+    int radius = (int)ceilf(RHINO_TERRAIN_VIEW_DISTANCE / RHINO_TERRAIN_CHUNK_SIZE);
+    int center_x = (int)floorf(camera->position[0] / RHINO_TERRAIN_CHUNK_SIZE);
+    int center_z = (int)floorf(camera->position[2] / RHINO_TERRAIN_CHUNK_SIZE);
+
+    chunk_request requests[(2 * radius + 1) * (2 * radius + 1)];
+    int request_count = 0;
+
+    for(int z = center_z - radius; z <= center_z + radius; z++) {
+        for(int x = center_x - radius; x <= center_x + radius; x++) {
+            rhino_terrain_chunk* chunk = &terrain->chunks[slot_index(x, z)];
+
+            if(chunk->state != RHINO_CHUNK_EMPTY && chunk->x == x && chunk->z == z) continue;
+
+            float distance = chunk_distance(x, z, RHINO_TERRAIN_BASE_HEIGHT - RHINO_TERRAIN_AMPLITUDE, RHINO_TERRAIN_BASE_HEIGHT + RHINO_TERRAIN_AMPLITUDE, camera->position);
+
+            if(distance > RHINO_TERRAIN_VIEW_DISTANCE) continue;
+
+            requests[request_count++] = (chunk_request){ x, z, distance };
+        }
+    }
+
+    qsort(requests, request_count, sizeof(chunk_request), compare_requests);
+
+    // slots to generate, queued once the lock is dropped since a job may run on the spot and take it
+
+    int queued[RHINO_TERRAIN_MAX_PENDING];
+    int queued_count = 0;
+
+    pthread_mutex_lock(&terrain->lock);
+
+    for(int r = 0; r < request_count && terrain->pending < RHINO_TERRAIN_MAX_PENDING; r++) {
+        rhino_terrain_chunk* chunk = &terrain->chunks[slot_index(requests[r].x, requests[r].z)];
+
+        // slot still generating or uploading for another position, try again next frame
+
+        if(chunk->state == RHINO_CHUNK_QUEUED || chunk->state == RHINO_CHUNK_UPLOADING) continue;
+
+        if(chunk->state != RHINO_CHUNK_EMPTY) {
+            evict_chunk(terrain, chunk);
+            used_slots--;
+        }
+
+        // over budget, make room by dropping the farthest resident chunk if it is further than this one
+
+        if((size_t)(used_slots + 1) * CHUNK_BYTES > RHINO_TERRAIN_MEMORY_BUDGET) {
+            rhino_terrain_chunk* farthest = NULL;
+            float farthest_distance = requests[r].distance;
+
+            for(int i = 0; i < SLOT_COUNT; i++) {
+                rhino_terrain_chunk* other = &terrain->chunks[i];
+
+                if(other->state != RHINO_CHUNK_RESIDENT) continue;
+
+                float distance = chunk_distance(other->x, other->z, other->min_height, other->max_height, camera->position);
+
+                if(distance > farthest_distance) {
+                    farthest = other;
+                    farthest_distance = distance;
+                }
+            }
+
+            if(!farthest) break;
+
+            evict_chunk(terrain, farthest);
+            used_slots--;
+        }
+
+        chunk->x = requests[r].x;
+        chunk->z = requests[r].z;
+        chunk->state = RHINO_CHUNK_QUEUED;
+
+        queued[queued_count++] = chunk - terrain->chunks;
+        terrain->pending++;
+        used_slots++;
+    }
+
+    pthread_mutex_unlock(&terrain->lock);
+
+    // the background queue is first in first out, so nearest chunks still come first
+
+    for(int i = 0; i < queued_count; i++) rhino_jobs_run_background(&rhino.jobs, generate_job, terrain, queued[i], queued[i] + 1, &terrain->generating);
+
+    // lod from distance to the chunk bounds, then restrict neighbours to one level apart so stitching holds
+
+    vec4* planes = rhino_camera_frustum(camera);
+
+    // previous lod and stitch mask per slot, any change means the drawn surface changed
+
+    int previous[SLOT_COUNT];
+
+    terrain->stats.resident_chunks = 0;
+
+    for(int i = 0; i < SLOT_COUNT; i++) {
+        rhino_terrain_chunk* chunk = &terrain->chunks[i];
+
+        if(chunk->state != RHINO_CHUNK_RESIDENT) continue;
+
+        previous[i] = chunk->lod * 16 + chunk->stitch_mask;
+
+        float distance = chunk_distance(chunk->x, chunk->z, chunk->min_height, chunk->max_height, camera->position);
+
+        chunk->lod = 0;
+
+        while(rhino.lod.enabled && chunk->lod < RHINO_TERRAIN_LODS - 1 && distance >= RHINO_TERRAIN_LOD0_RANGE * (float)(1 << chunk->lod)) chunk->lod++;
+
+        vec3 box[2];
+        chunk_box(chunk, box);
+
+        chunk->visible = glm_aabb_frustum(box, planes);
+
+        terrain->stats.resident_chunks++;
+    }
+
+    static const int neighbour_offsets[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+    for(bool changed = true; changed;) {
+        changed = false;
+
+        for(int i = 0; i < SLOT_COUNT; i++) {
+            rhino_terrain_chunk* chunk = &terrain->chunks[i];
+
+            if(chunk->state != RHINO_CHUNK_RESIDENT) continue;
+
+            for(int n = 0; n < 4; n++) {
+                int nx = chunk->x + neighbour_offsets[n][0], nz = chunk->z + neighbour_offsets[n][1];
+                rhino_terrain_chunk* neighbour = &terrain->chunks[slot_index(nx, nz)];
+
+                if(neighbour->state != RHINO_CHUNK_RESIDENT || neighbour->x != nx || neighbour->z != nz) continue;
+
+                if(chunk->lod > neighbour->lod + 1) {
+                    chunk->lod = neighbour->lod + 1;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    for(int i = 0; i < SLOT_COUNT; i++) {
+        rhino_terrain_chunk* chunk = &terrain->chunks[i];
+
+        if(chunk->state != RHINO_CHUNK_RESIDENT) continue;
+
+        chunk->stitch_mask = 0;
+
+        for(int n = 0; n < 4; n++) {
+            int nx = chunk->x + neighbour_offsets[n][0], nz = chunk->z + neighbour_offsets[n][1];
+            rhino_terrain_chunk* neighbour = &terrain->chunks[slot_index(nx, nz)];
+
+            if(neighbour->state != RHINO_CHUNK_RESIDENT || neighbour->x != nx || neighbour->z != nz) continue;
+
+            if(neighbour->lod > chunk->lod) chunk->stitch_mask |= 1 << n;
+        }
+
+        if(chunk->lod * 16 + chunk->stitch_mask != previous[i]) chunk->changed = ++terrain->version;
+    }
+
+    terrain->stats.resident_bytes = (size_t)terrain->stats.resident_chunks * CHUNK_BYTES;
+}
+
+// chunks drawn by a pass, the camera's visibility when planes is null, otherwise everything inside them
+
+static bool chunk_drawn(rhino_terrain_chunk* chunk, vec4* planes) {
+    if(chunk->state != RHINO_CHUNK_RESIDENT) return false;
+    if(!planes) return chunk->visible;
+
+    vec3 box[2];
+    chunk_box(chunk, box);
+
+    return glm_aabb_frustum(box, planes);
+}
+
+static void draw_chunks(rhino_terrain* terrain, rhino_uniforms* uniforms, vec4* planes) {
+    // write every drawn chunk's block first so they go up in a single upload
+
+    unsigned int offsets[SLOT_COUNT];
+    bool drawn[SLOT_COUNT];
+
+    for(int i = 0; i < SLOT_COUNT; i++) {
+        rhino_terrain_chunk* chunk = &terrain->chunks[i];
+
+        drawn[i] = chunk_drawn(chunk, planes);
+
+        if(!drawn[i]) continue;
+
+        rhino_object_block block;
+
+        glm_translate_make(block.model, (vec3){chunk->x * RHINO_TERRAIN_CHUNK_SIZE, 0.0f, chunk->z * RHINO_TERRAIN_CHUNK_SIZE});
+        glm_vec4_copy((vec4){1.0f, 0.0f, (float)chunk->lod, (float)chunk->stitch_mask}, block.params);
+        glm_vec4_zero(block.lightmap);
+
+        offsets[i] = rhino_uniforms_push(uniforms, &block);
+    }
+
+    rhino_uniforms_flush(uniforms);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, terrain->texture);
+
+    for(int i = 0; i < SLOT_COUNT; i++) {
+        rhino_terrain_chunk* chunk = &terrain->chunks[i];
+
+        if(!drawn[i]) continue;
+
+        unsigned int count = terrain->index_counts[chunk->lod][chunk->stitch_mask];
+
+        rhino_uniforms_bind_object(uniforms, offsets[i]);
+
+        glBindVertexArray(chunk->vao);
+        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (GLvoid*)(terrain->index_offsets[chunk->lod][chunk->stitch_mask] * sizeof(unsigned int)));
+
+        rhino.stats.triangles += count / 3;
+        rhino.stats.triangles_full_detail += terrain->index_counts[0][0] / 3;
+        rhino.stats.draw_calls++;
+    }
+
+    glBindVertexArray(0);
+}
+
+void rhino_terrain_record(rhino_terrain* terrain, rhino_command_buffer* buffer, int part, int parts) {
+    int begin = SLOT_COUNT * part / parts;
+    int end = SLOT_COUNT * (part + 1) / parts;
+
+    rhino_command_texture(buffer, 0, terrain->texture);
+
+    for(int i = begin; i < end; i++) {
+        rhino_terrain_chunk* chunk = &terrain->chunks[i];
+
+        if(!chunk_drawn(chunk, NULL)) continue;
+
+        rhino_object_block block;
+
+        glm_translate_make(block.model, (vec3){chunk->x * RHINO_TERRAIN_CHUNK_SIZE, 0.0f, chunk->z * RHINO_TERRAIN_CHUNK_SIZE});
+        glm_vec4_copy((vec4){1.0f, 0.0f, (float)chunk->lod, (float)chunk->stitch_mask}, block.params);
+        glm_vec4_zero(block.lightmap);
+
+        rhino_command_object(buffer, &block);
+        rhino_command_draw(buffer, chunk->vao, terrain->index_counts[chunk->lod][chunk->stitch_mask], terrain->index_offsets[chunk->lod][chunk->stitch_mask]);
+
+        buffer->counters.triangles_full_detail += terrain->index_counts[0][0] / 3;
+    }
+}
+
+void rhino_terrain_draw_shadow(rhino_terrain* terrain, rhino_uniforms* uniforms, vec4 planes[6]) {
+    draw_chunks(terrain, uniforms, planes);
+}
+
+bool rhino_terrain_changed_in(rhino_terrain* terrain, vec3 center, float radius, unsigned int since) {
+    if(terrain->version == since) return false;
+
+    for(int i = 0; i < SLOT_COUNT; i++) {
+        rhino_terrain_chunk* chunk = &terrain->chunks[i];
+
+        if(chunk->state != RHINO_CHUNK_RESIDENT || chunk->changed <= since) continue;
+
+        vec3 box[2];
+        chunk_box(chunk, box);
+
+        // squared distance from the centre to the box
+
+        float distance = 0.0f;
+
+        for(int axis = 0; axis < 3; axis++) {
+            float outside = glm_max(box[0][axis] - center[axis], 0.0f) + glm_max(center[axis] - box[1][axis], 0.0f);
+            distance += outside * outside;
+        }
+
+        if(distance <= radius * radius) return true;
+    }
+
+    return false;
+}
+
+void rhino_terrain_print_stats(rhino_terrain* terrain, float seconds) {
+    pthread_mutex_lock(&terrain->lock);
+
+    rhino_terrain_stats stats = terrain->stats;
+
+    terrain->stats.chunks_generated = 0;
+    terrain->stats.generation_seconds = 0.0;
+
+    pthread_mutex_unlock(&terrain->lock);
+
+    double vertices = (double)stats.chunks_generated * GRID * GRID;
+
+    printf("terrain : %u chunks resident, %.2f / %.2f MB vertex memory + %.1f KB shared indices\n", stats.resident_chunks, stats.resident_bytes / (1024.0 * 1024.0), RHINO_TERRAIN_MEMORY_BUDGET / (1024.0 * 1024.0), stats.index_bytes / 1024.0);
+
+    if(stats.chunks_generated > 0) {
+        printf("terrain : generated %u chunks (%.1f chunks/s, %.2f Mverts/s per thread, %.3f ms per chunk)\n", stats.chunks_generated, stats.chunks_generated / seconds, vertices / stats.generation_seconds / 1000000.0, stats.generation_seconds * 1000.0 / stats.chunks_generated);
+    }
+}
+
+void rhino_terrain_destroy(rhino_terrain* terrain) {
+    // queued jobs write into the slots, let them finish. chunks done after the last update are owned by their slot
+    // either way
+
+    rhino_jobs_wait(&rhino.jobs, &terrain->generating);
+
+    for(int i = 0; i < SLOT_COUNT; i++) evict_chunk(terrain, &terrain->chunks[i]);
+
+    glDeleteBuffers(1, &terrain->ebo);
+    glDeleteProgram(terrain->program);
+    glDeleteProgram(terrain->gbuffer_program);
+    glDeleteProgram(terrain->shadow_program);
+
+    pthread_mutex_destroy(&terrain->lock);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_uniforms.h"
+#include "rhino_commands.h"
+#include "rhino_camera.h"
+#include "rhino_jobs.h"
+
+// chunk layout, every chunk is a GRID x GRID heightfield covering CHUNK_SIZE world units
+
+#define RHINO_TERRAIN_CHUNK_SIZE 16.0f
+#define RHINO_TERRAIN_GRID 33
+#define RHINO_TERRAIN_LODS 4
+
+// lod k is used up to LOD0_RANGE * 2^k world units away, the last 30% of each range morphs into the next lod
+
+#define RHINO_TERRAIN_LOD0_RANGE 64.0f
+#define RHINO_TERRAIN_MORPH_START 0.7f
+
+// streaming, chunks live in a SLOTS x SLOTS toroidal window around the camera
+
+#define RHINO_TERRAIN_VIEW_DISTANCE 200.0f
+#define RHINO_TERRAIN_SLOTS 32
+#define RHINO_TERRAIN_MEMORY_BUDGET (8 * 1024 * 1024)
+#define RHINO_TERRAIN_MAX_PENDING 64
+
+// heightfield shape
+
+#define RHINO_TERRAIN_BASE_HEIGHT -9.0f
+#define RHINO_TERRAIN_AMPLITUDE 10.0f
+#define RHINO_TERRAIN_FREQUENCY 0.015f
+#define RHINO_TERRAIN_OCTAVES 5
+
+// uploading chunks have handed their vertex data to rhino.loader and become resident once it hands the buffer back
+
+typedef enum rhino_chunk_state_t {
+    RHINO_CHUNK_EMPTY,
+    RHINO_CHUNK_QUEUED,
+    RHINO_CHUNK_READY,
+    RHINO_CHUNK_UPLOADING,
+    RHINO_CHUNK_RESIDENT
+} rhino_chunk_state;
+
+// vertex data is interleaved (height, morph height), the morph height is where the vertex sits once the
+// coarser lod that drops it takes over. x and z come from gl_VertexID in the terrain shader
+
+typedef struct rhino_terrain_chunk_t {
+    int x, z;
+    rhino_chunk_state state;
+    float* vertex_data;
+    float min_height, max_height;
+    unsigned int vao, vbo;
+    int lod;
+    int stitch_mask;
+    bool visible;
+
+    // terrain version when this chunk's drawn surface last changed
+
+    unsigned int changed;
+} rhino_terrain_chunk;
+
+typedef struct rhino_terrain_stats_t {
+    unsigned int chunks_generated;
+    double generation_seconds;
+    unsigned int resident_chunks;
+    size_t resident_bytes;
+    size_t index_bytes;
+} rhino_terrain_stats;
+
+typedef struct rhino_terrain_t {
+    rhino_terrain_chunk chunks[RHINO_TERRAIN_SLOTS * RHINO_TERRAIN_SLOTS];
+
+    // one index buffer shared by every chunk, ranges per lod and per stitched edge mask
+
+    unsigned int ebo;
+    unsigned int index_offsets[RHINO_TERRAIN_LODS][16];
+    unsigned int index_counts[RHINO_TERRAIN_LODS][16];
+
+    // forward, deferred and shadow programs, draw uses whichever is bound
+
+    unsigned int program;
+    unsigned int gbuffer_program;
+    unsigned int shadow_program;
+    unsigned int texture;
+
+    // bumped whenever resident geometry changes (uploads, evictions, lod or stitch changes). vertex morphing
+    // follows the camera continuously and does not count
+
+    unsigned int version;
+
+    // chunks are generated by background jobs, one per chunk slot. results are slot indices, generating counts the
+    // jobs still out
+
+    pthread_mutex_t lock;
+    int results[RHINO_TERRAIN_SLOTS * RHINO_TERRAIN_SLOTS];
+    int result_count;
+    int pending;
+    rhino_job_counter generating;
+
+    rhino_terrain_stats stats;
+} rhino_terrain;
+
+// compiles the terrain programs, builds the shared index buffers
+
+void rhino_terrain_init(rhino_terrain* terrain);
+
+// streams chunks in and out around the camera, sends finished chunks to the loader and picks lods
+
+void rhino_terrain_update(rhino_terrain* terrain, rhino_camera* camera);
+
+// records part of parts of the chunk slots, the resident visible ones with an object block each. the program is the
+// caller's to record, every part may be recorded on a thread of its own at once
+
+void rhino_terrain_record(rhino_terrain* terrain, rhino_command_buffer* buffer, int part, int parts);
+
+// draws every resident chunk inside planes (glm_frustum_planes order) with the shadow program bound
+
+void rhino_terrain_draw_shadow(rhino_terrain* terrain, rhino_uniforms* uniforms, vec4 planes[6]);
+
+// true if a resident chunk touching the sphere changed after version since
+
+bool rhino_terrain_changed_in(rhino_terrain* terrain, vec3 center, float radius, unsigned int since);
+
+// height of the full detail surface, same function the generator jobs evaluate
+
+float rhino_terrain_height(float x, float z);
+
+// prints generation throughput and memory use since the last call
+
+void rhino_terrain_print_stats(rhino_terrain* terrain, float seconds);
+
+void rhino_terrain_destroy(rhino_terrain* terrain);
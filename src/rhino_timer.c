@@ -0,0 +1,64 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+// rhino headers
+
+#include "rhino_timer.h"
+
+void rhino_gpu_timer_init(rhino_gpu_timer* timer) {
+    memset(timer, 0, sizeof(rhino_gpu_timer));
+
+    glGenQueries(RHINO_TIMER_LATENCY * 2, &timer->queries[0][0]);
+}
+
+void rhino_gpu_timer_begin(rhino_gpu_timer* timer) {
+    timer->active = !timer->pending[timer->current];
+
+    if(timer->active) glQueryCounter(timer->queries[timer->current][0], GL_TIMESTAMP);
+}
+
+void rhino_gpu_timer_end(rhino_gpu_timer* timer) {
+    if(!timer->active) return;
+
+    glQueryCounter(timer->queries[timer->current][1], GL_TIMESTAMP);
+
+    timer->pending[timer->current] = true;
+    timer->current = (timer->current + 1) % RHINO_TIMER_LATENCY;
+    timer->active = false;
+}
+
+void rhino_gpu_timer_poll(rhino_gpu_timer* timer, bool wait) {
+    // slots were filled in ring order, so the oldest one sits right after the newest
+
+    for(int i = 0; i < RHINO_TIMER_LATENCY; i++) {
+        int slot = (timer->current + i) % RHINO_TIMER_LATENCY;
+
+        if(!timer->pending[slot]) continue;
+
+        if(!wait) {
+            int available = 0;
+            glGetQueryObjectiv(timer->queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+            if(!available) break;
+        }
+
+        GLuint64 start, end;
+
+        glGetQueryObjectui64v(timer->queries[slot][0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(timer->queries[slot][1], GL_QUERY_RESULT, &end);
+
+        timer->pending[slot] = false;
+        timer->last_ms = (double)(end - start) / 1000000.0;
+        timer->smoothed_ms = timer->samples ? timer->smoothed_ms + (timer->last_ms - timer->smoothed_ms) * RHINO_TIMER_SMOOTHING : timer->last_ms;
+        timer->samples++;
+    }
+}
+
+void rhino_gpu_timer_destroy(rhino_gpu_timer* timer) {
+    glDeleteQueries(RHINO_TIMER_LATENCY * 2, &timer->queries[0][0]);
+
+    memset(timer, 0, sizeof(rhino_gpu_timer));
+}
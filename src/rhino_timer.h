@@ -0,0 +1,42 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+// frames a timer query may stay in flight before its slot is reused, results are read this many frames late at most
+
+#define RHINO_TIMER_LATENCY 4
+
+// how much of each new sample goes into the smoothed value
+
+#define RHINO_TIMER_SMOOTHING 0.1f
+
+// gpu time between begin and end, measured with timestamp queries so timers can nest or overlap freely.
+// results are collected by rhino_gpu_timer_poll without stalling unless asked to wait
+
+typedef struct rhino_gpu_timer_t {
+    unsigned int queries[RHINO_TIMER_LATENCY][2];
+    bool pending[RHINO_TIMER_LATENCY];
+    int current;
+    bool active;
+
+    double last_ms;
+    double smoothed_ms;
+    unsigned int samples;
+} rhino_gpu_timer;
+
+void rhino_gpu_timer_init(rhino_gpu_timer* timer);
+
+// a begin whose slot is still waiting on an old result is skipped along with its end
+
+void rhino_gpu_timer_begin(rhino_gpu_timer* timer);
+
+void rhino_gpu_timer_end(rhino_gpu_timer* timer);
+
+// reads every finished query oldest first, wait blocks until all of them are done
+
+void rhino_gpu_timer_poll(rhino_gpu_timer* timer, bool wait);
+
+void rhino_gpu_timer_destroy(rhino_gpu_timer* timer);
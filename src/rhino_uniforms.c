@@ -0,0 +1,126 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libs/cglm/cglm.h"
+
+// rhino headers
+
+#include "rhino_uniforms.h"
+
+void rhino_uniforms_init(rhino_uniforms* uniforms) {
+    memset(uniforms, 0, sizeof(rhino_uniforms));
+
+    int alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    if(alignment < 1) alignment = 1;
+
+    uniforms->stride = ((sizeof(rhino_object_block) + alignment - 1) / alignment) * alignment;
+    uniforms->capacity = RHINO_OBJECT_CAPACITY;
+    uniforms->staging = malloc(uniforms->capacity * uniforms->stride);
+
+    glGenBuffers(RHINO_FRAMES_MAX, uniforms->frame_ubos);
+    glGenBuffers(RHINO_FRAMES_MAX, uniforms->object_ubos);
+
+    for(int i = 0; i < RHINO_FRAMES_MAX; i++) {
+        glBindBuffer(GL_UNIFORM_BUFFER, uniforms->frame_ubos[i]);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(rhino_frame_block), NULL, GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, uniforms->object_ubos[i]);
+        glBufferData(GL_UNIFORM_BUFFER, uniforms->capacity * uniforms->stride, NULL, GL_DYNAMIC_DRAW);
+
+        uniforms->gpu_capacities[i] = uniforms->capacity;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, RHINO_FRAME_BINDING, uniforms->frame_ubos[0]);
+
+    printf("\nuniform buffers created, object block stride %u bytes (alignment %d)", uniforms->stride, alignment);
+}
+
+void rhino_uniforms_bind_program(unsigned int program) {
+    unsigned int frame_index = glGetUniformBlockIndex(program, "frame_block");
+    unsigned int object_index = glGetUniformBlockIndex(program, "object_block");
+
+    if(frame_index != GL_INVALID_INDEX) glUniformBlockBinding(program, frame_index, RHINO_FRAME_BINDING);
+    if(object_index != GL_INVALID_INDEX) glUniformBlockBinding(program, object_index, RHINO_OBJECT_BINDING);
+}
+
+void rhino_uniforms_begin_frame(rhino_uniforms* uniforms, rhino_frame_block* frame, int slot) {
+    uniforms->slot = slot;
+
+    // the slot's fence has passed, nothing on the gpu reads these copies any more so they are written in place
+
+    rhino_frames_write(GL_UNIFORM_BUFFER, uniforms->frame_ubos[slot], 0, sizeof(rhino_frame_block), frame);
+    glBindBufferBase(GL_UNIFORM_BUFFER, RHINO_FRAME_BINDING, uniforms->frame_ubos[slot]);
+
+    // last frame's growth reaches this slot's copy now
+
+    if(uniforms->capacity > uniforms->gpu_capacities[slot]) {
+        glBindBuffer(GL_UNIFORM_BUFFER, uniforms->object_ubos[slot]);
+        glBufferData(GL_UNIFORM_BUFFER, uniforms->capacity * uniforms->stride, NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        uniforms->gpu_capacities[slot] = uniforms->capacity;
+    }
+
+    uniforms->count = 0;
+    uniforms->flushed = 0;
+}
+
+unsigned int rhino_uniforms_push(rhino_uniforms* uniforms, rhino_object_block* block) {
+    if(uniforms->count == uniforms->capacity) {
+        uniforms->capacity *= 2;
+        uniforms->staging = realloc(uniforms->staging, uniforms->capacity * uniforms->stride);
+    }
+
+    unsigned int offset = uniforms->count * uniforms->stride;
+
+    memcpy(&uniforms->staging[offset], block, sizeof(rhino_object_block));
+    uniforms->count++;
+
+    return offset;
+}
+
+void rhino_uniforms_flush(rhino_uniforms* uniforms) {
+    if(uniforms->flushed == uniforms->count) return;
+
+    int slot = uniforms->slot;
+
+    // grown past the gpu buffer mid-frame. the new storage starts out undefined, and blocks flushed earlier this
+    // frame may still be bound by draws to come, so everything staged goes up again
+
+    if(uniforms->capacity > uniforms->gpu_capacities[slot]) {
+        glBindBuffer(GL_UNIFORM_BUFFER, uniforms->object_ubos[slot]);
+        glBufferData(GL_UNIFORM_BUFFER, uniforms->capacity * uniforms->stride, NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        uniforms->gpu_capacities[slot] = uniforms->capacity;
+        uniforms->flushed = 0;
+    }
+
+    // earlier flushes this frame wrote below start, draws reading them are untouched
+
+    unsigned int start = uniforms->flushed * uniforms->stride;
+
+    rhino_frames_write(GL_UNIFORM_BUFFER, uniforms->object_ubos[slot], start, (uniforms->count - uniforms->flushed) * uniforms->stride, &uniforms->staging[start]);
+
+    uniforms->flushed = uniforms->count;
+}
+
+void rhino_uniforms_bind_object(rhino_uniforms* uniforms, unsigned int offset) {
+    glBindBufferRange(GL_UNIFORM_BUFFER, RHINO_OBJECT_BINDING, uniforms->object_ubos[uniforms->slot], offset, sizeof(rhino_object_block));
+}
+
+void rhino_uniforms_destroy(rhino_uniforms* uniforms) {
+    glDeleteBuffers(RHINO_FRAMES_MAX, uniforms->frame_ubos);
+    glDeleteBuffers(RHINO_FRAMES_MAX, uniforms->object_ubos);
+    free(uniforms->staging);
+
+    memset(uniforms, 0, sizeof(rhino_uniforms));
+}
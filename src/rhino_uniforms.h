@@ -0,0 +1,93 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "libs/cglm/cglm.h"
+
+#include "rhino_frames.h"
+
+// uniform block binding points, every program is pointed at these by rhino_uniforms_bind_program
+
+#define RHINO_FRAME_BINDING 0
+#define RHINO_OBJECT_BINDING 1
+
+#define RHINO_SHADOW_CASCADES 4
+
+// object blocks are packed into one buffer per frame, this is the starting capacity in blocks, it grows as needed
+
+#define RHINO_OBJECT_CAPACITY 1024
+
+// std140 mirror of frame_block in the shaders, vec3s are padded out to vec4s
+
+typedef struct rhino_frame_block_t {
+    mat4 view;
+    mat4 projection;
+    mat4 view_proj;
+    mat4 inv_view_proj;
+    vec4 camera_pos;
+    vec4 time;                              // x elapsed seconds, y delta time
+    vec4 cluster_params;                    // log depth scale and bias, tile width and height in pixels
+    int cluster_size[4];                    // clusters along x, y and z, point light count
+    mat4 shadow_view_proj[RHINO_SHADOW_CASCADES];
+    vec4 shadow_splits;                     // view depth where each cascade ends
+    vec4 shadow_texel;                      // world size of one shadow map texel per cascade
+    vec4 sun_direction;                     // direction the light travels, w unused
+    vec4 sun_color;
+    vec4 probe_origin;                      // first probe's position, w the spacing between probes
+    vec4 probe_size;                        // probes along x, y and z, w 1 once the grid is traced
+} rhino_frame_block;
+
+// std140 mirror of object_block, params are texture scale, lod fade and the terrain chunk lod and stitch mask.
+// lightmap is the uv scale and offset into the baked lightmap, zero scale when the object has none, in which case w
+// is 1 when the object takes its indirect light from the probe grid
+
+typedef struct rhino_object_block_t {
+    mat4 model;
+    vec4 params;
+    vec4 lightmap;
+} rhino_object_block;
+
+// both buffers have a copy per frame in flight, slot picks the one this frame writes and draws from
+
+typedef struct rhino_uniforms_t {
+    unsigned int frame_ubos[RHINO_FRAMES_MAX];
+    unsigned int object_ubos[RHINO_FRAMES_MAX];
+    int slot;
+
+    // blocks are written to staging at stride bytes apart, stride is the block size rounded up to
+    // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT so each one can be bound with glBindBufferRange
+
+    unsigned char* staging;
+    unsigned int stride;
+    unsigned int capacity;
+    unsigned int gpu_capacities[RHINO_FRAMES_MAX];
+    unsigned int count;
+    unsigned int flushed;
+} rhino_uniforms;
+
+void rhino_uniforms_init(rhino_uniforms* uniforms);
+
+// points the frame_block and object_block of a program at the shared binding points
+
+void rhino_uniforms_bind_program(unsigned int program);
+
+// uploads the per-frame block into the slot's buffers and starts filling its object buffer
+
+void rhino_uniforms_begin_frame(rhino_uniforms* uniforms, rhino_frame_block* frame, int slot);
+
+// appends an object block and returns its byte offset, only valid for drawing after the next flush
+
+unsigned int rhino_uniforms_push(rhino_uniforms* uniforms, rhino_object_block* block);
+
+// uploads every block pushed since the last flush in one call
+
+void rhino_uniforms_flush(rhino_uniforms* uniforms);
+
+// selects the object block at offset for the following draws
+
+void rhino_uniforms_bind_object(rhino_uniforms* uniforms, unsigned int offset);
+
+void rhino_uniforms_destroy(rhino_uniforms* uniforms);
@@ -0,0 +1,34 @@
+#version 330 core
+
+// bright pass for bloom, a box of four bilinear taps spread over the block each output texel covers so nothing
+// between them is skipped, then everything above the threshold with a soft knee
+
+out vec4 frag_color;
+
+uniform sampler2D scene_color;
+uniform int divisor;
+uniform float threshold;
+
+// fireflies from single very bright pixels would turn into flickering blobs
+
+const float max_brightness = 64.0;
+
+void main()
+{
+   vec2 texel = 1.0 / vec2(textureSize(scene_color, 0));
+   vec2 centre = gl_FragCoord.xy * float(divisor) * texel;
+   vec2 spread = texel * float(divisor) * 0.25;
+
+   vec3 color = texture(scene_color, centre + vec2(-spread.x, -spread.y)).rgb;
+   color += texture(scene_color, centre + vec2(spread.x, -spread.y)).rgb;
+   color += texture(scene_color, centre + vec2(-spread.x, spread.y)).rgb;
+   color += texture(scene_color, centre + vec2(spread.x, spread.y)).rgb;
+   color = min(color * 0.25, vec3(max_brightness));
+
+   float brightness = max(color.r, max(color.g, color.b));
+   float knee = threshold * 0.5;
+   float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+   soft = soft * soft / (4.0 * knee + 0.0001);
+
+   frag_color = vec4(color * max(soft, brightness - threshold) / max(brightness, 0.0001), 1.0);
+}
@@ -0,0 +1,41 @@
+#version 330 core
+
+// one direction of a separable 9 tap gaussian at the source's own resolution. with a depth sigma taps are also
+// weighted by how close their depth is to the centre's, so occlusion and fog do not bleed across silhouettes
+
+out vec4 frag_color;
+
+uniform sampler2D source;
+uniform sampler2D source_depth;
+uniform ivec2 direction;
+uniform float depth_sigma;
+
+const float weights[5] = float[5](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+void main()
+{
+   ivec2 pixel = ivec2(gl_FragCoord.xy);
+   ivec2 size = textureSize(source, 0) - 1;
+
+   float centre_depth = depth_sigma > 0.0 ? texelFetch(source_depth, pixel, 0).r : 0.0;
+
+   vec4 sum = texelFetch(source, pixel, 0) * weights[0];
+   float total = weights[0];
+
+   for(int i = 1; i < 5; i++) {
+      for(int side = -1; side <= 1; side += 2) {
+         ivec2 tap = clamp(pixel + direction * i * side, ivec2(0), size);
+         float weight = weights[i];
+
+         if(depth_sigma > 0.0) {
+            float depth = texelFetch(source_depth, tap, 0).r;
+            weight *= exp(-abs(depth - centre_depth) / (centre_depth * depth_sigma + 0.001));
+         }
+
+         sum += texelFetch(source, tap, 0) * weight;
+         total += weight;
+      }
+   }
+
+   frag_color = sum / total;
+}
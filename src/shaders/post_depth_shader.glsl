@@ -0,0 +1,46 @@
+#version 330 core
+
+// linear view depth of the scene at a post effect's resolution, the nearest of the block's corners so thin
+// foreground never vanishes from the low resolution copy the bilateral upsample compares against
+
+out vec4 frag_color;
+
+uniform sampler2D scene_depth;
+uniform int divisor;
+
+layout (std140) uniform frame_block {
+   mat4 view;
+   mat4 projection;
+   mat4 view_proj;
+   mat4 inv_view_proj;
+   vec4 camera_pos;
+   vec4 time;
+   vec4 cluster_params;
+   ivec4 cluster_size;
+   mat4 shadow_view_proj[4];
+   vec4 shadow_splits;
+   vec4 shadow_texel;
+   vec4 sun_direction;
+   vec4 sun_color;
+   vec4 probe_origin;
+   vec4 probe_size;
+};
+
+float linear_depth(float depth)
+{
+   return projection[3][2] / (depth * 2.0 - 1.0 + projection[2][2]);
+}
+
+void main()
+{
+   ivec2 size = textureSize(scene_depth, 0) - 1;
+   ivec2 block = ivec2(gl_FragCoord.xy) * divisor;
+   int last = divisor - 1;
+
+   float d0 = texelFetch(scene_depth, min(block, size), 0).r;
+   float d1 = texelFetch(scene_depth, min(block + ivec2(last, 0), size), 0).r;
+   float d2 = texelFetch(scene_depth, min(block + ivec2(0, last), size), 0).r;
+   float d3 = texelFetch(scene_depth, min(block + ivec2(last, last), size), 0).r;
+
+   frag_color = vec4(linear_depth(min(min(d0, d1), min(d2, d3))), 0.0, 0.0, 1.0);
+}
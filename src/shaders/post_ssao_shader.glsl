@@ -0,0 +1,103 @@
+#version 330 core
+
+// screen space ambient occlusion from the low resolution linear depth alone. the normal comes from whichever
+// neighbour on each axis is closer in depth, samples are spread over the hemisphere around it with a per pixel
+// rotation the blur afterwards smooths out
+
+out vec4 frag_color;
+
+uniform sampler2D linear_depth;
+uniform float radius;
+uniform float intensity;
+
+layout (std140) uniform frame_block {
+   mat4 view;
+   mat4 projection;
+   mat4 view_proj;
+   mat4 inv_view_proj;
+   vec4 camera_pos;
+   vec4 time;
+   vec4 cluster_params;
+   ivec4 cluster_size;
+   mat4 shadow_view_proj[4];
+   vec4 shadow_splits;
+   vec4 shadow_texel;
+   vec4 sun_direction;
+   vec4 sun_color;
+   vec4 probe_origin;
+   vec4 probe_size;
+};
+
+#define SAMPLES 12
+
+vec3 view_position(ivec2 pixel, vec2 size)
+{
+   float depth = texelFetch(linear_depth, pixel, 0).r;
+   vec2 ndc = (vec2(pixel) + 0.5) / size * 2.0 - 1.0;
+
+   return vec3(ndc.x * depth / projection[0][0], ndc.y * depth / projection[1][1], -depth);
+}
+
+float interleaved_gradient_noise(vec2 position)
+{
+   return fract(52.9829189 * fract(dot(position, vec2(0.06711056, 0.00583715))));
+}
+
+void main()
+{
+   ivec2 pixel = ivec2(gl_FragCoord.xy);
+   ivec2 limit = textureSize(linear_depth, 0) - 1;
+   vec2 size = vec2(textureSize(linear_depth, 0));
+
+   float far_plane = projection[3][2] / (projection[2][2] + 1.0);
+   vec3 position = view_position(pixel, size);
+
+   if(-position.z > far_plane * 0.99) {
+      frag_color = vec4(1.0);
+      return;
+   }
+
+   vec3 left = position - view_position(max(pixel - ivec2(1, 0), ivec2(0)), size);
+   vec3 right = view_position(min(pixel + ivec2(1, 0), limit), size) - position;
+   vec3 down = position - view_position(max(pixel - ivec2(0, 1), ivec2(0)), size);
+   vec3 up = view_position(min(pixel + ivec2(0, 1), limit), size) - position;
+
+   vec3 dx = abs(left.z) < abs(right.z) ? left : right;
+   vec3 dy = abs(down.z) < abs(up.z) ? down : up;
+   vec3 normal = normalize(cross(dx, dy));
+
+   if(dot(normal, position) > 0.0) normal = -normal;
+
+   float angle = interleaved_gradient_noise(gl_FragCoord.xy) * 6.2831853;
+   vec3 helper = abs(normal.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+   vec3 tangent = normalize(cross(helper, normal));
+   vec3 bitangent = cross(normal, tangent);
+
+   float occlusion = 0.0;
+
+   for(int i = 0; i < SAMPLES; i++) {
+      // golden angle spiral over a cosine weighted hemisphere, samples pulled in towards the centre
+
+      float t = (float(i) + 0.5) / float(SAMPLES);
+      float phi = float(i) * 2.3999632 + angle;
+      float spread = sqrt(t);
+
+      vec3 direction = tangent * cos(phi) * spread + bitangent * sin(phi) * spread + normal * sqrt(1.0 - t);
+      vec3 sample_position = position + direction * radius * mix(0.2, 1.0, t * t);
+
+      vec4 clip = projection * vec4(sample_position, 1.0);
+      vec2 uv = clip.xy / clip.w * 0.5 + 0.5;
+
+      if(any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0)))) continue;
+
+      float scene_depth = texelFetch(linear_depth, min(ivec2(uv * size), limit), 0).r;
+      float sample_depth = -sample_position.z;
+
+      // occluders much nearer than the radius are something else in front, they fade out
+
+      float range = smoothstep(0.0, 1.0, radius / abs(-position.z - scene_depth));
+      occlusion += (scene_depth < sample_depth - 0.02 ? 1.0 : 0.0) * range;
+   }
+
+   frag_color = vec4(clamp(1.0 - occlusion / float(SAMPLES) * intensity, 0.0, 1.0));
+}
@@ -0,0 +1,80 @@
+#version 330 core
+
+// terrain chunk vertex, x and z come from the vertex index in the chunk grid
+
+layout (location = 0) in float height;
+layout (location = 1) in float morph_height;
+
+out vec2 uv_coord;
+out vec4 worldpos;
+out vec2 lightmap_uv;
+
+layout (std140) uniform frame_block {
+   mat4 view;
+   mat4 projection;
+   mat4 view_proj;
+   mat4 inv_view_proj;
+   vec4 camera_pos;
+   vec4 time;
+   vec4 cluster_params;
+   ivec4 cluster_size;
+   mat4 shadow_view_proj[4];
+   vec4 shadow_splits;
+   vec4 shadow_texel;
+   vec4 sun_direction;
+   vec4 sun_color;
+   vec4 probe_origin;
+   vec4 probe_size;
+};
+
+// model translates the chunk to its origin, object_params z and w hold the chunk lod and stitch mask
+
+layout (std140) uniform object_block {
+   mat4 model;
+   vec4 object_params;
+   vec4 object_lightmap;
+};
+
+// constant for the lifetime of the terrain, set once at init
+
+uniform float grid_spacing;
+uniform int grid_size;
+uniform int lod_count;
+uniform float lod_ranges[4];
+uniform float morph_start;
+
+// 0 draws the camera view, n draws into shadow cascade n - 1 and -1 into a point light cube face with
+// point_view_proj, morphing always follows the camera
+
+uniform int shadow_layer;
+uniform mat4 point_view_proj;
+
+void main()
+{
+   int i = gl_VertexID % grid_size;
+   int j = gl_VertexID / grid_size;
+   int last = grid_size - 1;
+   int lod = int(object_params.z);
+   int stitch_mask = int(object_params.w);
+
+   // edges stitched to a coarser neighbour morph exactly like that neighbour does
+
+   bool stitched = (j == 0 && (stitch_mask & 1) != 0) || (i == last && (stitch_mask & 2) != 0) || (j == last && (stitch_mask & 4) != 0) || (i == 0 && (stitch_mask & 8) != 0);
+   int vertex_lod = stitched ? lod + 1 : lod;
+   int step = 1 << vertex_lod;
+
+   vec3 pos = (model * vec4(float(i) * grid_spacing, height, float(j) * grid_spacing, 1.0)).xyz;
+
+   // only vertices dropped by the next lod move, they slide onto the coarser surface towards the end of the range
+
+   if(vertex_lod < lod_count - 1 && ((i / step) % 2 != 0 || (j / step) % 2 != 0)) {
+      float range = lod_ranges[vertex_lod];
+      float morph = clamp((distance(pos, camera_pos.xyz) - range * morph_start) / (range * (1.0 - morph_start)), 0.0, 1.0);
+      pos.y = mix(height, morph_height, morph);
+   }
+
+   uv_coord = pos.xz * 0.25;
+   lightmap_uv = vec2(0.0);
+   worldpos = vec4(pos, 1.0);
+   gl_Position = (shadow_layer > 0 ? shadow_view_proj[shadow_layer - 1] : shadow_layer < 0 ? point_view_proj : view_proj) * worldpos;
+}
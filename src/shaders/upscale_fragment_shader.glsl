@@ -0,0 +1,38 @@
+#version 330 core
+
+// upscales the scene target to the framebuffer, plain bilinear with sharpness 0. otherwise the bilinear sample gets
+// back some of the detail the lower resolution lost by adding its difference to the four texels around it, clamped
+// to their range so edges do not ring
+
+out vec4 frag_color;
+
+uniform sampler2D source;
+uniform float sharpness;
+
+// one over the size of the viewport being drawn, not of the source
+
+uniform vec2 inv_target_size;
+
+void main()
+{
+   vec2 uv = gl_FragCoord.xy * inv_target_size;
+   vec3 color = texture(source, uv).rgb;
+
+   if(sharpness > 0.0) {
+      vec2 texel = 1.0 / vec2(textureSize(source, 0));
+
+      vec3 left = texture(source, uv - vec2(texel.x, 0.0)).rgb;
+      vec3 right = texture(source, uv + vec2(texel.x, 0.0)).rgb;
+      vec3 down = texture(source, uv - vec2(0.0, texel.y)).rgb;
+      vec3 up = texture(source, uv + vec2(0.0, texel.y)).rgb;
+
+      vec3 low = min(color, min(min(left, right), min(down, up)));
+      vec3 high = max(color, max(max(left, right), max(down, up)));
+
+      vec3 blurred = (left + right + down + up) * 0.25;
+
+      color = clamp(color + (color - blurred) * sharpness, low, high);
+   }
+
+   frag_color = vec4(color, 1.0);
+}
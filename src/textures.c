@@ -7,7 +7,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "libs/stb_image.h"
 
-void load_texture(char* texture_path, int texture_unit) {
+unsigned int load_texture(char* texture_path, int texture_unit) {
     // generate texture object
 
     unsigned int texture;
@@ -59,4 +59,6 @@ void load_texture(char* texture_path, int texture_unit) {
     else {
         printf("error loading texture %s", texture_path);
     }
+
+    return texture;
 }
\ No newline at end of file
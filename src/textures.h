@@ -5,6 +5,6 @@
 #include <stdio.h>
 #include <stdbool.h>
 
-// loads image from path to a texture unit
+// loads image from path to a texture unit, returns the texture object so it can be rebound later
 
-void load_texture(char* texture_path, int texture_unit);
\ No newline at end of file
+unsigned int load_texture(char* texture_path, int texture_unit);
\ No newline at end of file